@@ -0,0 +1,83 @@
+// SPDX-License-Identifier: AGPL-1.0-only
+// Copyright (C) 2018 Ludvig Strigeus <info@tunsafe.com>. All Rights Reserved.
+//
+// The stitched ChaCha20-Poly1305 kernels are off by default, so nothing
+// else runs them. Checks the AVX2 one, and the AVX-512VL one at 256-bit
+// width when the cpu has it, byte for byte against the two pass path.
+#define WITH_STITCHED_CHACHA20POLY1305 1
+#define WITH_AVX512_OPTIMIZATIONS 1
+#include "linux_test.h"
+
+typedef void StitchedFunc(uint8 *dst, const uint8 *src, size_t len,
+                          const uint8 *ad, size_t ad_len,
+                          const uint32 state[16], const uint8 poly_key[POLY1305_KEY_SIZE],
+                          bool decrypt, uint8 mac[POLY1305_MAC_SIZE]);
+
+static uint32 rnd_state = 1;
+
+static uint32 Rand() {
+  rnd_state = rnd_state * 1103515245 + 12345;
+  return rnd_state >> 8;
+}
+
+static void TestKernel(const char *name, StitchedFunc *func) {
+  static uint8 src[9000], ref[9000 + 16], out[9000 + 16], ad[64], key[32];
+  uint8 ref_mac[16], mac[16];
+  for (int iter = 0; iter < 50000; iter++) {
+    // Lengths near the ends of the 512-byte chunks are the interesting ones.
+    // The kernels are only called from STITCHED_MIN_LEN and up.
+    size_t len = (Rand() & 3) == 0 ? (Rand() % 16 + 2) * STITCHED_CHUNK + Rand() % 3 - 1 : Rand() % 9000;
+    if (len < STITCHED_MIN_LEN)
+      len = STITCHED_MIN_LEN;
+    bool ones = (Rand() & 7) == 0;
+    for (size_t i = 0; i < len; i++)
+      src[i] = ones ? 0xff : (uint8)Rand();
+    for (size_t i = 0; i < 32; i++)
+      key[i] = ones ? 0xff : (uint8)Rand();
+    size_t ad_len = Rand() % 3 == 0 ? Rand() % 64 : 0;
+    for (size_t i = 0; i < ad_len; i++)
+      ad[i] = (uint8)Rand();
+    uint64 nonce = ((uint64)Rand() << 32) ^ Rand();
+    bool decrypt = iter & 1, in_place = (iter >> 1) & 1;
+
+    ChaChaState st;
+    InitializeChaChaState(&st, key, nonce);
+    chacha20_crypt(&st.chacha20_state, st.block0, st.block0, sizeof(st.block0));
+    uint32 state[16];
+    memcpy(state, st.chacha20_state.state, sizeof(state));
+    if (decrypt) {
+      poly1305_getmac(ad, ad_len, src, len, st.block0, ref_mac);
+      chacha20_crypt(&st.chacha20_state, ref, src, (uint32)len);
+    } else {
+      chacha20_crypt(&st.chacha20_state, ref, src, (uint32)len);
+      poly1305_getmac(ad, ad_len, ref, len, st.block0, ref_mac);
+    }
+
+    memcpy(out, src, len);
+    func(out, in_place ? out : src, len, ad, ad_len, state, st.block0, decrypt, mac);
+    TEST_CHECK(memcmp(out, ref, len) == 0);
+    TEST_CHECK(memcmp(mac, ref_mac, 16) == 0);
+  }
+  printf("%s passed\n", name);
+}
+
+int main(int argc, char **argv) {
+  InitCpuFeatures();
+#if CHACHA20_WITH_STITCHED
+  if (X86_PCAP_AVX2)
+    TestKernel("avx2", chacha20poly1305_stitched_avx2);
+  else
+    printf("avx2 skipped, no AVX2\n");
+#if CHACHA20_WITH_AVX512
+  if (X86_PCAP_AVX512VL)
+    TestKernel("avx512vl", chacha20poly1305_stitched_avx512vl);
+  else
+    printf("avx512vl skipped, no AVX-512VL\n");
+#else
+  printf("avx512vl skipped, not built on this target\n");
+#endif  // CHACHA20_WITH_AVX512
+#else
+  printf("skipped, the stitched kernels aren't built on this target\n");
+#endif  // CHACHA20_WITH_STITCHED
+  return 0;
+}
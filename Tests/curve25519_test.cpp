@@ -0,0 +1,90 @@
+// SPDX-License-Identifier: AGPL-1.0-only
+// Copyright (C) 2018 Ludvig Strigeus <info@tunsafe.com>. All Rights Reserved.
+//
+// The RFC 7748 test vectors for X25519, run through each implementation:
+// the MULX/ADX one with 64-bit limbs when the cpu has it, the one with
+// 51-bit limbs, the portable reference, and the fixed base comb.
+#include "linux_test.h"
+
+typedef void Curve25519Func(uint8 *mypublic, const uint8 *secret, const uint8 *basepoint);
+
+static void FromHex(uint8 out[32], const char *hex) {
+  for (int i = 0; i < 32; i++)
+    sscanf(hex + i * 2, "%2hhx", &out[i]);
+}
+
+static bool Matches(const uint8 a[32], const char *hex) {
+  uint8 b[32];
+  FromHex(b, hex);
+  return memcmp(a, b, 32) == 0;
+}
+
+// Section 5.2, the second vector also checks that bit 255 of u is ignored.
+static const struct {
+  const char *scalar, *u, *result;
+} kVectors[] = {
+  {"a546e36bf0527c9d3b16154b82465edd62144c0ac1fc5a18506a2244ba449ac4",
+   "e6db6867583030db3594c1a424b15f7c726624ec26b3353b10a903a6d0ab1c4c",
+   "c3da55379de9c6908e94ea4df28d084f32eccf03491c71f754b4075577a28552"},
+  {"4b66e9d4d1b4673c5ad22691957d6af5c11b6421e0ea01d42ca4169e7918ba0d",
+   "e5210f12786811d3f4b7959d0538ae2c31dbe7106fc03c3efc4cd549c715a493",
+   "95cbde9476e8907d7aade45cb4b873f88b595a68799fa152e6f8f7647aac7957"},
+};
+
+static void TestImplementation(const char *name, Curve25519Func *func) {
+  uint8 scalar[32], u[32], out[32];
+  for (size_t i = 0; i < ARRAY_SIZE(kVectors); i++) {
+    FromHex(scalar, kVectors[i].scalar);
+    FromHex(u, kVectors[i].u);
+    func(out, scalar, u);
+    TEST_CHECK(Matches(out, kVectors[i].result));
+  }
+
+  // Section 5.2 iterations, k and u both start out as 9.
+  uint8 k[32] = {9}, next[32];
+  memset(u, 0, sizeof(u));
+  u[0] = 9;
+  for (int i = 1; i <= 1000; i++) {
+    func(next, k, u);
+    memcpy(u, k, 32);
+    memcpy(k, next, 32);
+    if (i == 1)
+      TEST_CHECK(Matches(k, "422c8e7a6227d7bca1350b3e2bb7279f7897b87bb6854b783c60e80311ae3079"));
+  }
+  TEST_CHECK(Matches(k, "684cf59ba83309552800ef566f2f4d3c1c3887c49360e3875f2eb94d99532c51"));
+
+  // Section 6.1, the Diffie-Hellman example.
+  uint8 alice[32], bob[32], alice_pub[32], bob_pub[32];
+  FromHex(alice, "77076d0a7318a57d3c16c17251b26645df4c2f87ebc0992ab177fba51db92c2a");
+  FromHex(bob, "5dab087e624a8a4b79e17f8b83800ee66f3bb1292618b6fd1c2f8b27ff88e0eb");
+  func(alice_pub, alice, kCurve25519Basepoint);
+  TEST_CHECK(Matches(alice_pub, "8520f0098930a754748b7ddcb43ef75a0dbf3a0d26381af4eba4a98eaa9b4e6a"));
+  func(bob_pub, bob, kCurve25519Basepoint);
+  TEST_CHECK(Matches(bob_pub, "de9edb7d7b7dc1b4d35b61c2ece435373f8343c85b78674dadfc7e146f882b4f"));
+  func(out, alice, bob_pub);
+  TEST_CHECK(Matches(out, "4a5d9d5ba4ce2de1728e3bf480350f25e07e21c947d19e3376f09b3c1e161742"));
+  func(out, bob, alice_pub);
+  TEST_CHECK(Matches(out, "4a5d9d5ba4ce2de1728e3bf480350f25e07e21c947d19e3376f09b3c1e161742"));
+  printf("%s passed\n", name);
+}
+
+int main(int argc, char **argv) {
+  InitCpuFeatures();
+  if (X86_PCAP_BMI2 && X86_PCAP_ADX)
+    TestImplementation("Fe64", curve25519_donna_x64_mulx);
+  else
+    printf("Fe64 skipped, no BMI2 and ADX\n");
+  TestImplementation("Fe51", curve25519_donna_x64_51);
+  TestImplementation("ref", curve25519_donna_ref);
+
+  // The comb gives the same public keys as the ladder.
+  uint8 secret[32], a[32], b[32];
+  for (int i = 0; i < 256; i++) {
+    OsGetRandomBytes(secret, 32);
+    curve25519_base(a, secret);
+    curve25519_donna_ref(b, secret, kCurve25519Basepoint);
+    TEST_CHECK(memcmp(a, b, 32) == 0);
+  }
+  printf("base passed\n");
+  return 0;
+}
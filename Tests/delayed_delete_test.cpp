@@ -0,0 +1,86 @@
+// SPDX-License-Identifier: AGPL-1.0-only
+// Copyright (C) 2018 Ludvig Strigeus <info@tunsafe.com>. All Rights Reserved.
+//
+// MultithreadedDelayedDelete must not free anything while a data thread may
+// still see it, that is while some online thread sits at an older epoch.
+// Objects are freed once the epoch is two past the one they were sealed in,
+// and a thread that's offline doesn't hold that up.
+#include "linux_test.h"
+
+static int freed;
+
+static void CountFree(void *x) {
+  freed++;
+}
+
+// Runs |func| on a thread of its own and waits for it.
+static void RunOnThread(std::function<void()> func) {
+  class Runner : public Thread::Runner {
+  public:
+    explicit Runner(std::function<void()> func) : func_(func) {}
+    virtual void ThreadMain() override { func_(); }
+  private:
+    std::function<void()> func_;
+  };
+  Runner runner(func);
+  Thread thread;
+  thread.StartThread(&runner);
+  thread.StopThread();
+}
+
+int main(int argc, char **argv) {
+  MultithreadedDelayedDelete dd;
+  dd.Configure(2);
+  dd.Checkpoint(0);
+  dd.Checkpoint(1);
+
+  // Added on the main thread, sealed in epoch 0.
+  for (int i = 0; i < 3; i++)
+    dd.Add(&CountFree, NULL);
+  TEST_CHECK(dd.pending() == 3);
+  dd.MainCheckpoint();
+  TEST_CHECK(dd.epoch() == 1 && freed == 0 && dd.pending() == 3);
+
+  // Thread 1 is still at epoch 0, so the epoch can't advance.
+  for (int i = 0; i < 5; i++) {
+    dd.Checkpoint(0);
+    dd.MainCheckpoint();
+  }
+  TEST_CHECK(dd.epoch() == 1 && freed == 0 && dd.pending() == 3);
+
+  // Once it catches up the epoch is two past, and they're freed.
+  dd.Checkpoint(1);
+  dd.MainCheckpoint();
+  TEST_CHECK(dd.epoch() == 2 && freed == 3 && dd.pending() == 0);
+
+  // Thread 1 goes offline, and thread 0 adds more than one batch from a
+  // thread of its own, sealed in epoch 2.
+  dd.Offline(1);
+  RunOnThread([&] {
+    for (int i = 0; i < 70; i++)
+      dd.Add(&CountFree, NULL);
+    dd.Checkpoint(0);
+  });
+  TEST_CHECK(dd.pending() == 70);
+  dd.MainCheckpoint();
+  TEST_CHECK(dd.epoch() == 3 && freed == 3 && dd.pending() == 70);
+  dd.MainCheckpoint();
+  // Thread 0 hasn't seen epoch 3 yet.
+  TEST_CHECK(dd.epoch() == 3 && freed == 3);
+  dd.Checkpoint(0);
+  dd.MainCheckpoint();
+  TEST_CHECK(dd.epoch() == 4 && freed == 73 && dd.pending() == 0);
+
+  // Added while the main thread advances the epoch, and then left pending
+  // until Flush.
+  RunOnThread([&] {
+    dd.Add(&CountFree, NULL);
+    dd.Offline(0);
+  });
+  dd.MainCheckpoint();
+  TEST_CHECK(dd.epoch() == 5 && freed == 73 && dd.pending() == 1);
+  dd.Flush();
+  TEST_CHECK(freed == 74 && dd.pending() == 0);
+  printf("freed %d, epoch %u\n", freed, dd.epoch());
+  return 0;
+}
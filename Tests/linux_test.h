@@ -0,0 +1,18 @@
+// SPDX-License-Identifier: AGPL-1.0-only
+// Copyright (C) 2018 Ludvig Strigeus <info@tunsafe.com>. All Rights Reserved.
+//
+// Shared by the Linux tests, which are built by run_linux_tests.sh. Each
+// test is a program of its own that pulls in the whole amalgam, with the
+// main of tunsafe renamed out of the way.
+#pragma once
+
+#define main tunsafe_main
+#include "tunsafe_amalgam.cpp"
+#undef main
+
+#define TEST_CHECK(x) do { \
+    if (!(x)) { \
+      fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #x); \
+      exit(1); \
+    } \
+  } while (0)
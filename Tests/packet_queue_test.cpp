@@ -0,0 +1,45 @@
+// SPDX-License-Identifier: AGPL-1.0-only
+// Copyright (C) 2018 Ludvig Strigeus <info@tunsafe.com>. All Rights Reserved.
+//
+// A producer that may not wait must get back what doesn't fit in a full
+// PacketQueueMt, in order, and the queue must count it as dropped.
+#include "linux_test.h"
+
+int main(int argc, char **argv) {
+  enum { kExtra = 100 };
+  PacketQueueMt queue;
+  PacketList list, overflow;
+
+  for (int i = 0; i < PacketQueueMt::kCapacity + kExtra; i++) {
+    Packet *p = AllocPacket();
+    p->seq = i;
+    list.Append(p);
+  }
+  queue.Push(&list, &overflow);
+  TEST_CHECK(list.head == NULL && list.count == 0);
+  TEST_CHECK(overflow.count == kExtra);
+  TEST_CHECK(queue.drops() == kExtra);
+  int n = 0;
+  for (Packet *p = overflow.head; p; p = Packet_NEXT(p), n++)
+    TEST_CHECK(p->seq == (uint16)(PacketQueueMt::kCapacity + n));
+  TEST_CHECK(n == kExtra);
+  FreePacketList(overflow.head);
+  overflow.Clear();
+
+  // The full queue drops a single packet too.
+  queue.TryPush(AllocPacket());
+  TEST_CHECK(queue.drops() == kExtra + 1);
+
+  // What was queued comes out in order, and there's room again.
+  queue.Pop(&list, 0);
+  TEST_CHECK(list.count == PacketQueueMt::kCapacity);
+  n = 0;
+  for (Packet *p = list.head; p; p = Packet_NEXT(p), n++)
+    TEST_CHECK(p->seq == (uint16)n);
+  FreePacketList(list.head);
+  list.Clear();
+  queue.TryPush(AllocPacket());
+  TEST_CHECK(queue.drops() == kExtra + 1);
+  printf("dropped %llu\n", (unsigned long long)queue.drops());
+  return 0;
+}
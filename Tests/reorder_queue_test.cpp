@@ -0,0 +1,138 @@
+// SPDX-License-Identifier: AGPL-1.0-only
+// Copyright (C) 2018 Ludvig Strigeus <info@tunsafe.com>. All Rights Reserved.
+//
+// Workers complete runs of packets in any order, from several threads, and
+// the ReorderQueue must release their output in the order it was stamped.
+// A run is completed under its last sequence number like WorkerLoop does,
+// some runs produce nothing and some are cancelled instead. The window must
+// fill up and drop, and the sequence numbers wrap around many times.
+#include "linux_test.h"
+
+enum {
+  kThreads = 4,
+  kRounds = 40,
+  kMaxRun = 8,
+};
+
+static uint32 Random(uint32 *state) {
+  *state = *state * 1103515245 + 12345;
+  return *state >> 16;
+}
+
+static uint32 GetIndex(Packet *p) {
+  return ReadLE32(p->data);
+}
+
+class Worker : public Thread::Runner {
+public:
+  ReorderQueue *queue;
+  std::vector<PacketList> runs;
+  uint32 rng;
+
+  virtual void ThreadMain() override {
+    // Out of order, and a few runs per call.
+    for (size_t i = runs.size(); i > 1; i--)
+      std::swap(runs[i - 1], runs[Random(&rng) % i]);
+    std::vector<ReorderQueue::Completion> done;
+    for (size_t i = 0; i < runs.size(); i++) {
+      PacketList *run = &runs[i];
+      uint16 seq = run->head->seq;
+      int count = run->count;
+      for (int j = 1; j < count; j++) {
+        ReorderQueue::Completion c = {seq++, 0, NULL, NULL};
+        done.push_back(c);
+      }
+      // Some runs produce no output, like keepalives.
+      if (run->head->userdata) {
+        FreePacketList(run->head);
+        run->Clear();
+      }
+      ReorderQueue::Completion c = {seq, run->count, run->head, run->tail};
+      done.push_back(c);
+      if (Random(&rng) % 3 == 0 || i == runs.size() - 1) {
+        queue->Complete(done.data(), done.size());
+        done.clear();
+      }
+      if (Random(&rng) % 8 == 0)
+        sched_yield();
+    }
+    runs.clear();
+  }
+};
+
+int main(int argc, char **argv) {
+  PacketQueueMt out;
+  ReorderQueue reorder(&out);
+  Worker workers[kThreads];
+  uint32 rng = 1, index = 0;
+  uint64 want_drops = 0;
+  uint32 stamped = 0;
+
+  for (int round = 0; round < kRounds; round++) {
+    // The first round is short, so later windows straddle the wraparound.
+    int n = (round == 0) ? 1000 : ReorderQueue::kWindow;
+    std::vector<uint32> want;
+    PacketList cancel;
+    for (int i = 0; i < n; ) {
+      int len = std::min<int>(1 + Random(&rng) % kMaxRun, n - i);
+      bool cancelled = Random(&rng) % 16 == 0, consumed = Random(&rng) % 4 == 0;
+      PacketList run;
+      for (int j = 0; j < len; j++, i++) {
+        Packet *p = AllocPacket();
+        TEST_CHECK(reorder.Stamp(p));
+        TEST_CHECK(p->seq == (uint16)stamped++);
+        p->userdata = consumed;
+        if (!cancelled && !consumed)
+          want.push_back(index);
+        WriteLE32(p->data, index++);
+        run.Append(p);
+      }
+      if (cancelled) {
+        cancel.AppendList(&run);
+      } else {
+        workers[Random(&rng) % kThreads].runs.push_back(run);
+      }
+    }
+    if (n == ReorderQueue::kWindow) {
+      // Nothing has been completed, the window is full.
+      Packet *p = AllocPacket();
+      TEST_CHECK(!reorder.Stamp(p));
+      FreePacket(p);
+      want_drops++;
+    }
+    TEST_CHECK(reorder.drops() == want_drops);
+
+    Thread threads[kThreads];
+    for (int i = 0; i < kThreads; i++) {
+      workers[i].queue = &reorder;
+      workers[i].rng = Random(&rng);
+      threads[i].StartThread(&workers[i]);
+    }
+    // Like the reader cancels what didn't fit in a full inbox.
+    reorder.Cancel(&cancel);
+    TEST_CHECK(cancel.head == NULL);
+    for (int i = 0; i < kThreads; i++)
+      threads[i].StopThread();
+
+    PacketList list;
+    out.Pop(&list, 0);
+    TEST_CHECK(list.count == (int)want.size());
+    size_t i = 0;
+    for (Packet *p = list.head; p; p = Packet_NEXT(p))
+      TEST_CHECK(GetIndex(p) == want[i++]);
+    FreePacketList(list.head);
+    list.Clear();
+
+    // Everything was completed, so there's a full window again.
+    Packet *p = AllocPacket();
+    TEST_CHECK(reorder.Stamp(p));
+    stamped++;
+    index++;
+    PacketList single;
+    single.Append(p);
+    reorder.Cancel(&single);
+  }
+  TEST_CHECK(stamped > 0x10000 + ReorderQueue::kWindow);
+  printf("stamped %u, dropped %llu\n", stamped, (unsigned long long)reorder.drops());
+  return 0;
+}
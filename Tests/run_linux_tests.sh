@@ -0,0 +1,25 @@
+#!/bin/sh
+# Builds and runs the Linux tests, from the root of the repository.
+# Tests that need root, like xdp_veth_test.sh, are run separately.
+set -e
+
+CXX=${CXX:-clang++-6.0}
+OUT=$(mktemp -d)
+trap 'rm -rf "$OUT"' EXIT
+
+$CXX -c -march=skylake-avx512 -o "$OUT/poly1305-x64-linux.o" crypto/poly1305/poly1305-x64-linux.s
+$CXX -c -march=skylake-avx512 -o "$OUT/chacha20-x64-linux.o" crypto/chacha20/chacha20-x64-linux.s
+
+for test in Tests/*_test.cpp; do
+  name=$(basename "$test" .cpp)
+  $CXX -I . -O2 -g -DWITH_NETWORK_BSD=1 -mssse3 -pthread -o "$OUT/$name" "$test" \
+    crypto/aesgcm/aesni_gcm-x64-linux.s \
+    crypto/aesgcm/aesni-x64-linux.s \
+    crypto/aesgcm/ghash-x64-linux.s \
+    "$OUT/chacha20-x64-linux.o" \
+    "$OUT/poly1305-x64-linux.o" \
+    -lrt
+  echo "Running $name"
+  "$OUT/$name"
+done
+echo "All tests passed"
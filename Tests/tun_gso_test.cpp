@@ -0,0 +1,201 @@
+// SPDX-License-Identifier: AGPL-1.0-only
+// Copyright (C) 2018 Ludvig Strigeus <info@tunsafe.com>. All Rights Reserved.
+//
+// TSO/USO super-packets read from tun are split into segments by
+// FixupGsoSegment, which must get every header right the way a NIC would.
+// Runs of TCP segments written to tun are merged back by CoalesceTcpSegments
+// into one packet with a virtio_net_hdr.
+#include "linux_test.h"
+
+enum {
+  kMss = 1000,
+  kPayload = 3 * kMss + 500,
+  kSegments = 4,
+  kSeq = 0xFFFFF000,
+  kIpId = 0xFFFE,
+};
+
+static uint8 payload[kPayload];
+
+// Ones' complement sum, written independently of the one in network_bsd.cpp.
+static uint32 Sum16(const uint8 *data, size_t size, uint32 sum) {
+  for (size_t i = 0; i + 1 < size; i += 2)
+    sum += data[i] << 8 | data[i + 1];
+  if (size & 1)
+    sum += data[size - 1] << 8;
+  return sum;
+}
+
+static uint16 Fold(uint32 sum) {
+  while (sum >> 16)
+    sum = (sum & 0xFFFF) + (sum >> 16);
+  return sum;
+}
+
+static uint32 PseudoHeaderSum(const uint8 *data, uint32 l4_offs, uint32 l4_size, uint8 proto) {
+  uint32 sum = (data[0] >> 4) == 4 ? Sum16(data + 12, 8, 0) : Sum16(data + 8, 32, 0);
+  return sum + proto + l4_size;
+}
+
+// Build a super-packet with |kPayload| bytes of payload, returns its size.
+static uint32 BuildSuperPacket(uint8 *data, bool ipv6, bool is_tcp, uint8 tcp_flags, uint32 *l4_offs_out) {
+  uint32 l4_offs = ipv6 ? 40 : 20, l4_hdr = is_tcp ? 32 : 8;
+  uint32 size = l4_offs + l4_hdr + kPayload;
+  uint8 proto = is_tcp ? IPPROTO_TCP : IPPROTO_UDP;
+  memset(data, 0, l4_offs + l4_hdr);
+  if (ipv6) {
+    data[0] = 0x60;
+    WriteBE16(data + 4, size - 40);
+    data[6] = proto;
+    data[7] = 64;
+    data[8] = 0xfd, data[23] = 1;
+    data[24] = 0xfd, data[39] = 2;
+  } else {
+    data[0] = 0x45;
+    WriteBE16(data + 2, size);
+    WriteBE16(data + 4, kIpId);
+    WriteBE16(data + 6, 0x4000);
+    data[8] = 64;
+    data[9] = proto;
+    WriteBE32(data + 12, 0x0a000001);
+    WriteBE32(data + 16, 0x0a000002);
+  }
+  uint8 *l4 = data + l4_offs;
+  WriteBE16(l4, 40000);
+  WriteBE16(l4 + 2, 443);
+  if (is_tcp) {
+    WriteBE32(l4 + 4, kSeq);
+    WriteBE32(l4 + 8, 12345);
+    l4[12] = (l4_hdr / 4) << 4;
+    l4[13] = tcp_flags;
+    WriteBE16(l4 + 14, 512);
+    // NOP, NOP, timestamp
+    l4[20] = 1, l4[21] = 1, l4[22] = 8, l4[23] = 10;
+    WriteBE32(l4 + 24, 1111);
+    WriteBE32(l4 + 28, 2222);
+  }
+  memcpy(l4 + l4_hdr, payload, kPayload);
+  // The kernel leaves the pseudo header sum in the checksum field.
+  WriteBE16(l4 + (is_tcp ? 16 : 6), Fold(PseudoHeaderSum(data, l4_offs, size - l4_offs, proto)));
+  *l4_offs_out = l4_offs;
+  return size;
+}
+
+// Split a super-packet like TunSocketBsd::HandleGsoPacket does, check all
+// the segments and return them as a list.
+static Packet *SplitAndCheck(bool ipv6, bool is_tcp, uint8 tcp_flags) {
+  static uint8 super[65536];
+  uint32 l4_offs;
+  uint32 size = BuildSuperPacket(super, ipv6, is_tcp, tcp_flags, &l4_offs);
+  uint32 hdr_size = l4_offs + (is_tcp ? 32 : 8);
+  Packet *first = NULL, **link = &first;
+  for (uint32 i = 0; i < kSegments; i++) {
+    uint32 seg_payload = std::min<uint32>(kMss, kPayload - i * kMss);
+    Packet *q = AllocPacket();
+    TEST_CHECK(q != NULL);
+    memcpy(q->data, super, hdr_size);
+    memcpy(q->data + hdr_size, super + hdr_size + i * kMss, seg_payload);
+    q->size = hdr_size + seg_payload;
+    FixupGsoSegment(q->data, l4_offs, q->size, i, kMss, i == kSegments - 1, is_tcp);
+
+    const uint8 *d = q->data, *l4 = d + l4_offs;
+    uint32 l4_size = q->size - l4_offs;
+    if (ipv6) {
+      TEST_CHECK(ReadBE16(d + 4) == q->size - 40);
+    } else {
+      TEST_CHECK(ReadBE16(d + 2) == q->size);
+      TEST_CHECK(ReadBE16(d + 4) == (uint16)(kIpId + i));
+      TEST_CHECK(Fold(Sum16(d, 20, 0)) == 0xFFFF);
+    }
+    TEST_CHECK(memcmp(d + hdr_size, payload + i * kMss, seg_payload) == 0);
+    TEST_CHECK(Fold(Sum16(l4, l4_size, PseudoHeaderSum(d, l4_offs, l4_size, is_tcp ? IPPROTO_TCP : IPPROTO_UDP))) == 0xFFFF);
+    if (is_tcp) {
+      uint8 want = tcp_flags;
+      if (i != kSegments - 1)
+        want &= ~(kTcpFin | kTcpPsh);
+      if (i != 0)
+        want &= ~kTcpCwr;
+      TEST_CHECK(ReadBE32(l4 + 4) == (uint32)(kSeq + i * kMss));
+      TEST_CHECK(l4[13] == want);
+    } else {
+      TEST_CHECK(ReadBE16(l4 + 4) == l4_size);
+    }
+    *link = q;
+    link = &Packet_NEXT(q);
+  }
+  *link = NULL;
+  return first;
+}
+
+static void FreeList(Packet *p) {
+  while (p) {
+    Packet *next = Packet_NEXT(p);
+    FreePacket(p);
+    p = next;
+  }
+}
+
+// Merge the segments back and check that the result is the super-packet.
+static void CoalesceAndCheck(bool ipv6, Packet *segments) {
+  struct virtio_net_hdr vhdr;
+  uint8 header[TunSocketBsd::kMaxGsoHeaderSize];
+  struct iovec iov[TunSocketBsd::kMaxCoalesce + 1];
+  memset(&vhdr, 0, sizeof(vhdr));
+  int n = CoalesceTcpSegments(segments, &vhdr, header, iov);
+  TEST_CHECK(n == kSegments);
+
+  uint32 l4_offs = ipv6 ? 40 : 20, hdr_size = l4_offs + 32;
+  TEST_CHECK(vhdr.flags == VIRTIO_NET_HDR_F_NEEDS_CSUM);
+  TEST_CHECK(vhdr.gso_type == (ipv6 ? VIRTIO_NET_HDR_GSO_TCPV6 : VIRTIO_NET_HDR_GSO_TCPV4));
+  TEST_CHECK(vhdr.hdr_len == hdr_size && vhdr.gso_size == kMss);
+  TEST_CHECK(vhdr.csum_start == l4_offs && vhdr.csum_offset == 16);
+  TEST_CHECK(iov[0].iov_base == header && iov[0].iov_len == hdr_size);
+
+  static uint8 merged[65536];
+  uint32 size = 0;
+  for (int i = 0; i <= n; i++) {
+    memcpy(merged + size, iov[i].iov_base, iov[i].iov_len);
+    size += iov[i].iov_len;
+  }
+  TEST_CHECK(size == hdr_size + kPayload);
+  TEST_CHECK(memcmp(merged + hdr_size, payload, kPayload) == 0);
+  uint8 *l4 = merged + l4_offs;
+  if (ipv6) {
+    TEST_CHECK(ReadBE16(merged + 4) == size - 40);
+  } else {
+    TEST_CHECK(ReadBE16(merged + 2) == size);
+    TEST_CHECK(ReadBE16(merged + 4) == kIpId);
+    TEST_CHECK(Fold(Sum16(merged, 20, 0)) == 0xFFFF);
+  }
+  TEST_CHECK(ReadBE32(l4 + 4) == kSeq);
+  TEST_CHECK(l4[13] == (kTcpAck | kTcpPsh));
+  // Complete the checksum like the kernel would, then verify it.
+  WriteBE16(l4 + 16, ~Fold(Sum16(l4, size - l4_offs, 0)));
+  TEST_CHECK(Fold(Sum16(l4, size - l4_offs, PseudoHeaderSum(merged, l4_offs, size - l4_offs, IPPROTO_TCP))) == 0xFFFF);
+}
+
+int main(int argc, char **argv) {
+  InitCpuFeatures();
+  for (int i = 0; i < kPayload; i++)
+    payload[i] = (uint8)(i * 7 + 3);
+
+  for (int ipv6 = 0; ipv6 < 2; ipv6++) {
+    FreeList(SplitAndCheck(ipv6, false, 0));
+    FreeList(SplitAndCheck(ipv6, true, kTcpAck | kTcpPsh | kTcpFin | kTcpCwr));
+
+    Packet *segments = SplitAndCheck(ipv6, true, kTcpAck | kTcpPsh);
+    CoalesceAndCheck(ipv6, segments);
+
+    // A gap in the sequence numbers stops the merge.
+    Packet *third = Packet_NEXT(Packet_NEXT(segments));
+    uint8 *th = third->data + (ipv6 ? 40 : 20);
+    WriteBE32(th + 4, ReadBE32(th + 4) + 1);
+    struct virtio_net_hdr vhdr;
+    uint8 header[TunSocketBsd::kMaxGsoHeaderSize];
+    struct iovec iov[TunSocketBsd::kMaxCoalesce + 1];
+    TEST_CHECK(CoalesceTcpSegments(segments, &vhdr, header, iov) == 2);
+    FreeList(segments);
+  }
+  printf("split and merged %d segments\n", kSegments);
+  return 0;
+}
@@ -0,0 +1,74 @@
+// SPDX-License-Identifier: AGPL-1.0-only
+// Copyright (C) 2018 Ludvig Strigeus <info@tunsafe.com>. All Rights Reserved.
+//
+// Datagrams that don't fit in a packet must be dropped by the batched UDP
+// reader with GRO enabled, both plain ones that spill into the GRO buffer
+// and GRO datagrams whose segments are too big.
+#include "linux_test.h"
+
+class NullInterface : public UdpInterface, public TunInterface {
+public:
+  virtual bool Configure(int listen_port_udp, int listen_port_tcp) override { return true; }
+  virtual bool Configure(const TunConfig &&config, TunConfigOut *out) override { return true; }
+  virtual void WriteUdpPacket(Packet *packet) override { FreePacket(packet); }
+  virtual void WriteTunPacket(Packet *packet) override { FreePacket(packet); }
+};
+
+static void SendDatagram(int fd, const sockaddr_in &sin, const uint8 *data, size_t size, uint16 segment_size) {
+  struct iovec iov = {(void*)data, size};
+  struct msghdr mh = {0};
+  char cmsg_buf[CMSG_SPACE(sizeof(uint16))] = {0};
+  mh.msg_name = (void*)&sin;
+  mh.msg_namelen = sizeof(sin);
+  mh.msg_iov = &iov;
+  mh.msg_iovlen = 1;
+  if (segment_size) {
+    mh.msg_control = cmsg_buf;
+    mh.msg_controllen = sizeof(cmsg_buf);
+    struct cmsghdr *cm = CMSG_FIRSTHDR(&mh);
+    cm->cmsg_level = SOL_UDP;
+    cm->cmsg_type = UDP_SEGMENT;
+    cm->cmsg_len = CMSG_LEN(sizeof(uint16));
+    memcpy(CMSG_DATA(cm), &segment_size, sizeof(segment_size));
+  }
+  TEST_CHECK(sendmsg(fd, &mh, 0) == (ssize_t)size);
+}
+
+int main(int argc, char **argv) {
+  InitCpuFeatures();
+  NetworkBsd::NetworkBsdDelegate delegate;
+  NetworkBsd network(&delegate, 16);
+  NullInterface null_interface;
+  WireguardProcessor processor(&null_interface, &null_interface, NULL);
+  UdpSocketBsd udp(&network, &processor);
+  udp.SetGroEnabled(true);
+  TEST_CHECK(udp.Initialize(0));
+
+  sockaddr_in sin = {0};
+  socklen_t sin_len = sizeof(sin);
+  TEST_CHECK(getsockname(udp.GetFd(), (sockaddr*)&sin, &sin_len) == 0);
+  sin.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  int fd = socket(AF_INET, SOCK_DGRAM, 0);
+  TEST_CHECK(fd >= 0);
+
+  static uint8 data[9000];
+  memset(data, 0x55, sizeof(data));
+  // Too big for a packet, without and with GRO.
+  SendDatagram(fd, sin, data, 3000, 0);
+  SendDatagram(fd, sin, data, 9000, 3000);
+  // These fit, three single packets and one GRO datagram of three.
+  SendDatagram(fd, sin, data, 100, 0);
+  SendDatagram(fd, sin, data, kPacketCapacity, 0);
+  SendDatagram(fd, sin, data, 300, 100);
+
+  for (int i = 0; i < 100 && udp.DoRead(); i++) {}
+
+  NetworkBsd::Stats &stats = network.stats();
+  printf("received %llu, oversized %llu, gro datagrams %llu\n",
+         (unsigned long long)stats.udp_recv_packets, (unsigned long long)stats.udp_rx_oversized,
+         (unsigned long long)stats.udp_recv_gro_datagrams);
+  TEST_CHECK(stats.udp_recv_packets == 5);
+  TEST_CHECK(stats.udp_rx_oversized == 2);
+  close(fd);
+  return 0;
+}
@@ -0,0 +1,115 @@
+// SPDX-License-Identifier: AGPL-1.0-only
+// Copyright (C) 2018 Ludvig Strigeus <info@tunsafe.com>. All Rights Reserved.
+//
+// Sends through io_uring that find the socket buffer full must go out once
+// it has room, not be dropped. The kernel usually waits for room itself, a
+// send that fails with EAGAIN anyway is retried by RetrySend. Writes to tun
+// through io_uring are counted when they complete.
+#include "linux_test.h"
+
+class NullInterface : public UdpInterface, public TunInterface {
+public:
+  virtual bool Configure(int listen_port_udp, int listen_port_tcp) override { return true; }
+  virtual bool Configure(const TunConfig &&config, TunConfigOut *out) override { return true; }
+  virtual void WriteUdpPacket(Packet *packet) override { FreePacket(packet); }
+  virtual void WriteTunPacket(Packet *packet) override { FreePacket(packet); }
+};
+
+static Packet *MakePacket(size_t size) {
+  Packet *packet = AllocPacket();
+  TEST_CHECK(packet != NULL);
+  packet->size = (unsigned)size;
+  memset(packet->data, 0x55, size);
+  return packet;
+}
+
+// Submits what's queued and handles completions until |done| or timeout.
+template<typename F>
+static void RunUntil(IoUringBsd *uring, F done) {
+  for (int i = 0; i < 100 && !done(); i++) {
+    uring->DoEndloop();
+    struct pollfd pfd = {uring->GetFd(), POLLIN, 0};
+    poll(&pfd, 1, 10);
+    while (uring->DoRoundRobin()) {}
+  }
+}
+
+int main(int argc, char **argv) {
+  InitCpuFeatures();
+  NetworkBsd::NetworkBsdDelegate delegate;
+  NetworkBsd network(&delegate, 16);
+  if (!network.UseIoUring()) {
+    printf("io_uring not supported, skipped\n");
+    return 0;
+  }
+  IoUringBsd *uring = network.io_uring();
+  NetworkBsd::Stats &stats = network.stats();
+  NullInterface null_interface;
+  WireguardProcessor processor(&null_interface, &null_interface, NULL);
+
+  UdpSocketBsd udp(&network, &processor);
+  TEST_CHECK(udp.Initialize(0));
+  TEST_CHECK(udp.UseIoUring());
+
+  // Loopback udp packets give back their send buffer as soon as they're
+  // sent, so the buffer never fills. A seqpacket socket, which ignores the
+  // destination address, takes the place of the udp socket. Its buffer fills
+  // up while nobody reads from the other end.
+  int fds[2];
+  TEST_CHECK(socketpair(AF_UNIX, SOCK_SEQPACKET, 0, fds) == 0);
+  int one = 1;
+  TEST_CHECK(setsockopt(fds[0], SOL_SOCKET, SO_SNDBUF, &one, sizeof(one)) == 0);
+  fcntl(fds[0], F_SETFL, O_NONBLOCK);
+  TEST_CHECK(dup2(fds[0], udp.GetFd()) >= 0);
+  close(fds[0]);
+
+  enum { kBurst = 64, kSize = 1000 };
+  sockaddr_in sin = {0};
+  sin.sin_family = AF_INET;
+  sin.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  for (int i = 0; i < kBurst; i++) {
+    Packet *packet = MakePacket(kSize);
+    packet->addr.sin = sin;
+    packet->sin_size = sizeof(sin);
+    udp.WritePacket(packet);
+  }
+  RunUntil(uring, [&] { return false; });
+  TEST_CHECK(stats.uring_udp_send_packets < kBurst);
+  TEST_CHECK(stats.uring_send_drops == 0);
+
+  // Reading makes room and the waiting sends go through.
+  static uint8 buf[65536];
+  int received = 0;
+  RunUntil(uring, [&] {
+    while (recv(fds[1], buf, sizeof(buf), MSG_DONTWAIT) == kSize)
+      received++;
+    return stats.uring_udp_send_packets == kBurst;
+  });
+  while (recv(fds[1], buf, sizeof(buf), MSG_DONTWAIT) == kSize)
+    received++;
+  printf("sent %llu, retries %llu, drops %llu\n",
+         (unsigned long long)stats.uring_udp_send_packets, (unsigned long long)stats.uring_send_retries,
+         (unsigned long long)stats.uring_send_drops);
+  TEST_CHECK(stats.uring_udp_send_packets == kBurst);
+  TEST_CHECK(stats.uring_send_drops == 0);
+  TEST_CHECK(received == kBurst);
+  close(fds[1]);
+
+  // A datagram socket stands in for the tun device.
+  int tun_fds[2];
+  TEST_CHECK(socketpair(AF_UNIX, SOCK_DGRAM, 0, tun_fds) == 0);
+  TunSocketBsd tun(&network, &processor);
+  TEST_CHECK(tun.Initialize(tun_fds[0]));
+  TEST_CHECK(tun.UseIoUring());
+  for (int i = 0; i < kBurst; i++)
+    tun.WritePacket(MakePacket(kSize));
+  RunUntil(uring, [&] { return tun.tx_packets() == kBurst; });
+  printf("tun tx %llu, errors %llu, drops %llu\n", (unsigned long long)tun.tx_packets(),
+         (unsigned long long)stats.uring_tun_write_errors, (unsigned long long)stats.uring_tun_write_drops);
+  TEST_CHECK(tun.tx_packets() == kBurst);
+  TEST_CHECK(stats.uring_tun_write_errors == 0 && stats.uring_tun_write_drops == 0);
+  for (int i = 0; i < kBurst; i++)
+    TEST_CHECK(recv(tun_fds[1], buf, sizeof(buf), MSG_DONTWAIT) == kSize);
+  close(tun_fds[1]);
+  return 0;
+}
@@ -0,0 +1,142 @@
+#!/bin/sh
+# Runs two tunsafe instances in network namespaces joined by a veth pair,
+# the first one with --xdp, and checks that the tunnel works over AF_XDP.
+# A frame spoofing the second peer's address from another MAC must not
+# redirect the replies. Needs root, run from the root of the repository
+# after building tunsafe.
+set -e
+
+TUNSAFE=$(realpath "${TUNSAFE:-./tunsafe}")
+NS1=tsxdp1
+NS2=tsxdp2
+DIR=$(mktemp -d)
+
+cleanup() {
+  [ -f "$DIR/pid1" ] && kill -INT $(cat "$DIR/pid1") 2>/dev/null
+  [ -f "$DIR/pid2" ] && kill -INT $(cat "$DIR/pid2") 2>/dev/null
+  [ -f "$DIR/pids" ] && kill $(cat "$DIR/pids") 2>/dev/null
+  sleep 0.5
+  ip netns del $NS1 2>/dev/null
+  ip netns del $NS2 2>/dev/null
+  rm -rf "$DIR"
+}
+trap cleanup EXIT
+
+# Sends udp datagrams from namespace $1 to $2 through the tunnel until one
+# is echoed back.
+echo_through_tunnel() {
+  ip netns exec $1 python3 - $2 <<'EOF'
+import socket, sys
+s = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+s.settimeout(1)
+for i in range(5):
+  s.sendto(b'hello', (sys.argv[1], 7777))
+  try:
+    if s.recv(100) == b'hello':
+      sys.exit(0)
+  except socket.timeout:
+    pass
+sys.exit(1)
+EOF
+}
+
+fail() {
+  echo "FAIL: $1"
+  cat "$DIR/log1" "$DIR/log2"
+  exit 1
+}
+
+ip netns add $NS1
+ip netns add $NS2
+ip link add xv1 netns $NS1 type veth peer name xv2 netns $NS2
+ip -n $NS1 addr add 10.98.0.1/24 dev xv1
+ip -n $NS2 addr add 10.98.0.2/24 dev xv2
+for ns in $NS1 $NS2; do
+  ip -n $ns link set lo up
+done
+ip -n $NS1 link set xv1 up
+ip -n $NS2 link set xv2 up
+
+KEY1=$("$TUNSAFE" genkey)
+KEY2=$("$TUNSAFE" genkey)
+PUB1=$(echo "$KEY1" | "$TUNSAFE" pubkey)
+PUB2=$(echo "$KEY2" | "$TUNSAFE" pubkey)
+
+cat > "$DIR/c1.conf" <<EOF
+[Interface]
+PrivateKey = $KEY1
+ListenPort = 51820
+Address = 10.201.0.1/24
+[Peer]
+PublicKey = $PUB2
+AllowedIPs = 10.201.0.2/32
+EOF
+
+cat > "$DIR/c2.conf" <<EOF
+[Interface]
+PrivateKey = $KEY2
+ListenPort = 51820
+Address = 10.201.0.2/24
+[Peer]
+PublicKey = $PUB1
+AllowedIPs = 10.201.0.1/32
+Endpoint = 10.98.0.1:51820
+EOF
+
+ip netns exec $NS1 "$TUNSAFE" start -n xdptun1 --xdp xv1 "$DIR/c1.conf" > "$DIR/log1" 2>&1 &
+echo $! > "$DIR/pid1"
+ip netns exec $NS2 "$TUNSAFE" start -n xdptun2 "$DIR/c2.conf" > "$DIR/log2" 2>&1 &
+echo $! > "$DIR/pid2"
+for ns in $NS1 $NS2; do
+  ip netns exec $ns python3 -c "
+import socket
+s = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+s.bind(('0.0.0.0', 7777))
+while True:
+  d, a = s.recvfrom(100)
+  s.sendto(d, a)
+" &
+  echo $! >> "$DIR/pids"
+done
+sleep 1.5
+
+echo_through_tunnel $NS2 10.201.0.1 || fail "no traffic over xdp"
+
+# Send a frame from the second peer's ip and port, but from another MAC.
+# If it were trusted, packets sent to the peer would no longer reach it.
+MAC1=$(ip netns exec $NS1 cat /sys/class/net/xv1/address)
+ip netns exec $NS2 python3 - "$MAC1" <<'EOF'
+import socket, struct, sys
+dst = bytes.fromhex(sys.argv[1].replace(':', ''))
+payload = struct.pack('<I', 4) + bytes(60)
+udp = struct.pack('!HHHH', 51820, 51820, 8 + len(payload), 0) + payload
+ip = struct.pack('!BBHHHBBH4s4s', 0x45, 0, 20 + len(udp), 0, 0x4000, 64, 17, 0,
+                 socket.inet_aton('10.98.0.2'), socket.inet_aton('10.98.0.1'))
+s = sum(struct.unpack('!10H', ip))
+s = (s & 0xffff) + (s >> 16)
+ip = ip[:10] + struct.pack('!H', ~(s + (s >> 16)) & 0xffff) + ip[12:]
+eth = dst + bytes.fromhex('02deadbeef01') + b'\x08\x00'
+sock = socket.socket(socket.AF_PACKET, socket.SOCK_RAW)
+sock.bind(('xv2', 0))
+sock.send(eth + ip + udp)
+EOF
+
+echo_through_tunnel $NS1 10.201.0.2 || fail "spoofed frame redirected the peer"
+
+STATS=$(ip netns exec $NS1 python3 - <<'EOF'
+import socket
+s = socket.socket(socket.AF_UNIX)
+s.connect('/var/run/wireguard/xdptun1.sock')
+s.sendall(b'get=1\n\n')
+r = b''
+while not r.endswith(b'\n\n'):
+  d = s.recv(4096)
+  if not d:
+    break
+  r += d
+print(r.decode())
+EOF
+)
+echo "$STATS" | grep -q '^xdp_rx_packets=[1-9]' || fail "no packets received over xdp"
+echo "$STATS" | grep -q '^xdp_tx_packets=[1-9]' || fail "no packets sent over xdp"
+echo "xdp_veth_test passed"
@@ -4,14 +4,36 @@
 #include "tunsafe_types.h"
 #include "crypto/chacha20poly1305.h"
 #include "crypto/aesgcm/aes.h"
+#include "crypto/curve25519/curve25519-donna.h"
 #include "tunsafe_cpu.h"
+#include "wireguard_proto.h"
+#include "wireguard.h"
+#include "wireguard_config.h"
+#include "tunsafe_dnsresolve.h"
+#include "tunsafe_endian.h"
+#include "util.h"
+#if defined(OS_LINUX)
+#include "network_bsd.h"
+#endif
 
 #include <functional>
+#include <atomic>
+#include <algorithm>
+#include <vector>
 #include <string.h>
 
 #if defined(OS_FREEBSD) || defined(OS_LINUX)
 #include <time.h>
 #include <stdlib.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/resource.h>
+#if defined(OS_LINUX)
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <errno.h>
+#endif
 typedef uint64 LARGE_INTEGER;
 void QueryPerformanceCounter(LARGE_INTEGER *x) {
   struct timespec ts;
@@ -46,9 +68,403 @@ void QueryPerformanceFrequency(LARGE_INTEGER *x) {
 
 int gcm_self_test();
 
+#if defined(OS_LINUX)
+// Measure the cost of one wakeup of the event loop, with one ready socket
+// out of |num_sockets|, for poll with the NetworkBsd scan of all slots and
+// for epoll.
+static void BenchmarkPollWakeup(int num_sockets) {
+  int64 a, b, f;
+  QueryPerformanceFrequency((LARGE_INTEGER*)&f);
+  struct pollfd *pfd = new struct pollfd[num_sockets];
+  int epfd = epoll_create1(0), i;
+  for (i = 0; i < num_sockets; i++) {
+    pfd[i].fd = eventfd(0, EFD_NONBLOCK);
+    pfd[i].events = POLLIN;
+    if (pfd[i].fd < 0)
+      break;
+    struct epoll_event ev;
+    ev.events = EPOLLIN;
+    ev.data.u32 = i;
+    epoll_ctl(epfd, EPOLL_CTL_ADD, pfd[i].fd, &ev);
+  }
+  num_sockets = i;
+  const int kIterations = 20000;
+  uint64 value = 1;
+  int ready = 0;
 
+  QueryPerformanceCounter((LARGE_INTEGER*)&b);
+  for (int j = 0; j < kIterations; j++) {
+    write(pfd[j % num_sockets].fd, &value, sizeof(value));
+    poll(pfd, num_sockets, -1);
+    for (i = num_sockets - 1; i >= 0; i--) {
+      if (pfd[i].revents) {
+        read(pfd[i].fd, &value, sizeof(value));
+        ready++;
+      }
+    }
+  }
+  QueryPerformanceCounter((LARGE_INTEGER*)&a);
+  double poll_us = (double)(a - b) * 1000000 / f / kIterations;
+
+  QueryPerformanceCounter((LARGE_INTEGER*)&b);
+  for (int j = 0; j < kIterations; j++) {
+    struct epoll_event events[16];
+    write(pfd[j % num_sockets].fd, &value, sizeof(value));
+    int n = epoll_wait(epfd, events, 16, -1);
+    for (i = 0; i < n; i++) {
+      read(pfd[events[i].data.u32].fd, &value, sizeof(value));
+      ready++;
+    }
+  }
+  QueryPerformanceCounter((LARGE_INTEGER*)&a);
+  double epoll_us = (double)(a - b) * 1000000 / f / kIterations;
+
+  RINFO("wakeup with %4d sockets: poll %.2f us, epoll %.2f us", num_sockets, poll_us, epoll_us);
+  for (i = 0; i < num_sockets; i++)
+    close(pfd[i].fd);
+  close(epfd);
+  delete [] pfd;
+}
+#endif  // defined(OS_LINUX)
 
 void *fake_glb;
+
+// Measure the cost of one timer tick with |num_peers| peers, of which 100
+// have timers expiring every tick and the rest are idle, compared to walking
+// all peers like it was done before the timer heap.
+static void BenchmarkPeerTimers(int num_peers) {
+  int64 a, b, f;
+  QueryPerformanceFrequency((LARGE_INTEGER*)&f);
+  WgDevice dev;
+  const int kTicks = 1000, kActivePeers = 100;
+  uint64 now = 1000000, idle = now + (kTicks + 1) * 1000;
+  for (int i = 0; i < num_peers; i++)
+    dev.SetPeerTimer(dev.AddPeer(), i < kActivePeers ? now + 1 + i : idle + (uint64)i * 7919 % 600000);
+
+  QueryPerformanceCounter((LARGE_INTEGER*)&b);
+  for (int j = 0; j < kTicks; j++) {
+    now += 1000;
+    while (WgPeer *peer = dev.PopExpiredPeerTimer(now))
+      dev.SetPeerTimer(peer, now + 1);
+  }
+  QueryPerformanceCounter((LARGE_INTEGER*)&a);
+  double heap_us = (double)(a - b) * 1000000 / f / kTicks;
+
+  size_t due = 0;
+  QueryPerformanceCounter((LARGE_INTEGER*)&b);
+  for (int j = 0; j < kTicks; j++) {
+    for (WgPeer *peer = dev.first_peer(); peer; peer = peer->next_peer())
+      due += (peer->timer_deadline() <= now);
+  }
+  QueryPerformanceCounter((LARGE_INTEGER*)&a);
+  double walk_us = (double)(a - b) * 1000000 / f / kTicks;
+  fake_glb = (void*)due;
+
+  RINFO("timer tick with %6d peers: heap %.2f us, walk all peers %.2f us", num_peers, heap_us, walk_us);
+}
+
+// Measure the cost of an ephemeral key pair with the variable base ladder
+// and with the fixed base tables, and of a whole handshake initiation,
+// which also does one variable base DH.
+static void BenchmarkHandshake() {
+  int64 a, b, f;
+  QueryPerformanceFrequency((LARGE_INTEGER*)&f);
+  const int kIterations = 2000;
+  uint8 priv_a[32] = {1, 2, 3}, priv_b[32] = {4, 5, 6}, key[32] = {7, 8, 9};
+  WgDevice dev_a, dev_b;
+  WgPublicKey pub_b;
+
+  dev_a.SetPrivateKey(priv_a);
+  dev_b.SetPrivateKey(priv_b);
+  memcpy(pub_b.bytes, dev_b.public_key(), sizeof(pub_b.bytes));
+  WgPeer *peer = dev_a.AddPeer();
+  peer->SetPublicKey(pub_b);
+
+  QueryPerformanceCounter((LARGE_INTEGER*)&b);
+  for (int i = 0; i < kIterations; i++)
+    curve25519_donna(key, key, kCurve25519Basepoint);
+  QueryPerformanceCounter((LARGE_INTEGER*)&a);
+  double ladder_us = (double)(a - b) * 1000000 / f / kIterations;
+
+  QueryPerformanceCounter((LARGE_INTEGER*)&b);
+  for (int i = 0; i < kIterations; i++)
+    curve25519_base(key, key);
+  QueryPerformanceCounter((LARGE_INTEGER*)&a);
+  double base_us = (double)(a - b) * 1000000 / f / kIterations;
+
+  Packet *packet = AllocPacket();
+  QueryPerformanceCounter((LARGE_INTEGER*)&b);
+  for (int i = 0; i < kIterations; i++)
+    peer->CreateMessageHandshakeInitiation(packet);
+  QueryPerformanceCounter((LARGE_INTEGER*)&a);
+  double init_us = (double)(a - b) * 1000000 / f / kIterations;
+  FreePacket(packet);
+  fake_glb = key;
+
+  RINFO("ephemeral key: ladder %.1f us, fixed base %.1f us (%.2fx), handshake initiation %.1f us",
+        ladder_us, base_us, ladder_us / base_us, init_us);
+}
+
+#if WITH_WG_THREADING && defined(OS_LINUX)
+enum {
+  kBenchmarkPort = 51820,
+  kBenchmarkPeers = 8,
+  kBenchmarkPacketSize = 1420,
+  kBenchmarkPackets = 200000,
+};
+
+// Stands in for the udp and tun devices of a processor. Handshake packets are
+// delivered to remote |i| when sent to port kBenchmarkPort + i, data packets
+// are counted and dropped. Once |data_plane| is set everything goes there.
+class BenchmarkPipe : public UdpInterface, public TunInterface {
+public:
+  BenchmarkPipe() : data_plane(NULL), data_packets(0) {}
+  virtual bool Configure(int listen_port_udp, int listen_port_tcp) override { return true; }
+  virtual bool Configure(const TunConfig &&config, TunConfigOut *out) override {
+    out->enable_neighbor_discovery_spoofing = false;
+    return true;
+  }
+  virtual void WriteUdpPacket(Packet *packet) override {
+    if (data_plane) {
+      if (!data_plane->WriteUdpPacket(packet))
+        FreePacket(packet);
+      return;
+    }
+    size_t i = ntohs(packet->addr.sin.sin_port) - kBenchmarkPort;
+    if (ReadLE32(packet->data) != MESSAGE_DATA && i < remotes.size()) {
+      packet->addr = remote_addr;
+      packet->protocol = kPacketProtocolUdp;
+      remotes[i]->HandleUdpPacket(packet, false);
+      return;
+    }
+    data_packets++;
+    FreePacket(packet);
+  }
+  virtual void WriteTunPacket(Packet *packet) override {
+    if (data_plane)
+      data_plane->WriteTunPacket(packet);
+    else
+      FreePacket(packet);
+  }
+
+  ThreadedDataPlaneBsd *data_plane;
+  std::vector<WireguardProcessor*> remotes;
+  // The address the remotes see the packets coming from.
+  IpAddr remote_addr;
+  uint64 data_packets;
+};
+
+// One of the peers of the benchmark, it only takes part in the handshake.
+struct BenchmarkRemote {
+  BenchmarkRemote() : proc(&pipe, &pipe, NULL) {}
+  BenchmarkPipe pipe;
+  WireguardProcessor proc;
+};
+
+// Writes |num_packets| packets to the tun device, one to each peer in turn.
+class BenchmarkTunWriter : public Thread::Runner {
+public:
+  virtual void ThreadMain() override {
+    enum { kBatchSize = 64 };
+    struct mmsghdr msgs[kBatchSize];
+    struct iovec iov[kBatchSize];
+    memset(msgs, 0, sizeof(msgs));
+    for (int i = 0; i < kBatchSize; i++) {
+      iov[i].iov_base = (void*)packets[i % kBenchmarkPeers];
+      iov[i].iov_len = kBenchmarkPacketSize;
+      msgs[i].msg_hdr.msg_iov = &iov[i];
+      msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+    // The socket blocks while the tun reader is behind.
+    for (int sent = 0; sent < num_packets; ) {
+      int r = sendmmsg(fd, msgs, std::min<int>(kBatchSize, num_packets - sent), 0);
+      if (r < 0) {
+        if (errno == EINTR)
+          continue;
+        RERROR("Benchmark write to tun failed: %d", errno);
+        break;
+      }
+      sent += r;
+    }
+  }
+  int fd, num_packets;
+  const uint8 (*packets)[kBenchmarkPacketSize];
+};
+
+// A config with address 10.99.1.|host| and |num_peers| peers, addressed from
+// 10.99.1.|first_peer_host| on. With |with_endpoints|, peer i is at
+// 10.0.0.2 port kBenchmarkPort + i.
+static void MakeBenchmarkConfig(char *buf, size_t buf_size, const uint8 *priv, int host,
+                                const uint8 (*peer_privs)[32], int num_peers, int first_peer_host, bool with_endpoints) {
+  char b64[64];
+  base64_encode(priv, 32, b64, sizeof(b64), NULL);
+  size_t n = snprintf(buf, buf_size, "[Interface]\nPrivateKey = %s\nAddress = 10.99.1.%d/24\n", b64, host);
+  for (int i = 0; i < num_peers && n < buf_size; i++) {
+    WgDevice tmp;
+    tmp.SetPrivateKey(peer_privs[i]);
+    base64_encode(tmp.public_key(), 32, b64, sizeof(b64), NULL);
+    n += snprintf(buf + n, buf_size - n, "[Peer]\nPublicKey = %s\nAllowedIPs = 10.99.1.%d/32\n", b64, first_peer_host + i);
+    if (with_endpoints && n < buf_size)
+      n += snprintf(buf + n, buf_size - n, "Endpoint = 10.0.0.2:%d\n", kBenchmarkPort + i);
+  }
+}
+
+static void SetBenchmarkAddr(IpAddr *addr, uint32 ip, int port) {
+  memset(addr, 0, sizeof(*addr));
+  addr->sin.sin_family = AF_INET;
+  addr->sin.sin_port = htons(port);
+  addr->sin.sin_addr.s_addr = htonl(ip);
+}
+
+// Configures |proc| with kBenchmarkPeers peers and completes the handshake
+// with each of them.
+static bool ConnectBenchmarkPeers(WireguardProcessor *proc, BenchmarkPipe *pipe, BenchmarkRemote *remotes,
+                                  const uint8 (*packets)[kBenchmarkPacketSize]) {
+  uint8 priv[1][32] = {{1, 2, 3}}, remote_priv[kBenchmarkPeers][32] = {{0}};
+  char config[2048];
+  DnsResolver dns_resolver(NULL);
+
+  for (int i = 0; i < kBenchmarkPeers; i++) {
+    remote_priv[i][0] = 4;
+    remote_priv[i][1] = i + 1;
+  }
+  MakeBenchmarkConfig(config, sizeof(config), priv[0], 1, remote_priv, kBenchmarkPeers, 2, true);
+  if (!ParseWireGuardConfigString(proc, config, strlen(config), &dns_resolver))
+    return false;
+  SetBenchmarkAddr(&pipe->remote_addr, 0x0A000001, kBenchmarkPort);
+  for (int i = 0; i < kBenchmarkPeers; i++) {
+    MakeBenchmarkConfig(config, sizeof(config), remote_priv[i], 2 + i, priv, 1, 1, false);
+    if (!ParseWireGuardConfigString(&remotes[i].proc, config, strlen(config), &dns_resolver) ||
+        !remotes[i].proc.Start())
+      return false;
+    SetBenchmarkAddr(&remotes[i].pipe.remote_addr, 0x0A000002, kBenchmarkPort + i);
+    remotes[i].pipe.remotes.push_back(proc);
+    pipe->remotes.push_back(&remotes[i].proc);
+  }
+  if (!proc->Start())
+    return false;
+  // The first packet to each peer triggers the handshake, which completes
+  // right away.
+  for (int i = 0; i < kBenchmarkPeers; i++) {
+    Packet *p = AllocPacket();
+    memcpy(p->data, packets[i], kBenchmarkPacketSize);
+    p->size = kBenchmarkPacketSize;
+    proc->HandleTunPacket(p);
+  }
+  proc->RunAllMainThreadScheduled();
+  return pipe->data_packets >= kBenchmarkPeers;
+}
+
+// Sends kBenchmarkPackets packets through a ThreadedDataPlaneBsd with
+// |num_workers| workers, and returns the encryption throughput in MB/s. A
+// datagram socketpair stands in for the tun device, and a seqpacket one for
+// the udp socket. Unlike loopback udp, it makes the udp writer wait instead of
+// dropping when the reader falls behind, and it ignores the peer addresses.
+static double BenchmarkDataPlane(int num_workers, const uint8 (*packets)[kBenchmarkPacketSize], uint64 *drops) {
+  int64 a, b, f;
+  QueryPerformanceFrequency((LARGE_INTEGER*)&f);
+  BenchmarkPipe pipe;
+  WireguardProcessor proc(&pipe, &pipe, NULL);
+  BenchmarkRemote *remotes = new BenchmarkRemote[kBenchmarkPeers];
+  int udp_fds[2], tun_fds[2];
+  if (!ConnectBenchmarkPeers(&proc, &pipe, remotes, packets)) {
+    RERROR("Benchmark handshake failed");
+    delete [] remotes;
+    return 0;
+  }
+  if (socketpair(AF_UNIX, SOCK_SEQPACKET, 0, udp_fds) != 0 ||
+      socketpair(AF_UNIX, SOCK_DGRAM, 0, tun_fds) != 0)
+    tunsafe_die("socketpair failed");
+
+  NetworkBsd::NetworkBsdDelegate delegate;
+  NetworkBsd network(&delegate, 16);
+  ThreadedDataPlaneBsd *data_plane = new ThreadedDataPlaneBsd(&network, &proc, &pipe, num_workers, 1);
+  data_plane->InitializeUdpSocket(udp_fds[0]);
+  data_plane->InitializeTun(&tun_fds[0]);
+  pipe.data_plane = data_plane;
+  data_plane->Start();
+
+  BenchmarkTunWriter writer;
+  writer.fd = tun_fds[1];
+  writer.num_packets = kBenchmarkPackets;
+  writer.packets = packets;
+  Thread thread;
+  QueryPerformanceCounter((LARGE_INTEGER*)&b);
+  a = b;
+  thread.StartThread(&writer);
+
+  // Count what comes out of the udp socket, on the main thread which also
+  // does the work of the main loop.
+  enum { kBatchSize = 64 };
+  static uint8 buf[kBatchSize][kBenchmarkPacketSize + 64];
+  struct mmsghdr msgs[kBatchSize];
+  struct iovec iov[kBatchSize];
+  memset(msgs, 0, sizeof(msgs));
+  for (int i = 0; i < kBatchSize; i++) {
+    iov[i].iov_base = buf[i];
+    iov[i].iov_len = sizeof(buf[i]);
+    msgs[i].msg_hdr.msg_iov = &iov[i];
+    msgs[i].msg_hdr.msg_iovlen = 1;
+  }
+  uint64 received = 0;
+  while (received < kBenchmarkPackets) {
+    // What's dropped never arrives, stop once nothing has come for a while.
+    struct pollfd pfd = {udp_fds[1], POLLIN, 0};
+    if (poll(&pfd, 1, 1000) <= 0)
+      break;
+    int r = recvmmsg(udp_fds[1], msgs, kBatchSize, MSG_DONTWAIT, NULL);
+    for (int i = 0; i < r; i++) {
+      // Keepalives are just a header.
+      if (msgs[i].msg_len > 32 && ReadLE32(buf[i]) == MESSAGE_DATA)
+        received++;
+    }
+    if (r > 0)
+      QueryPerformanceCounter((LARGE_INTEGER*)&a);
+    proc.RunAllMainThreadScheduled();
+    data_plane->MainCheckpoint();
+  }
+  thread.StopThread();
+  data_plane->Stop();
+  pipe.data_plane = NULL;
+  delete data_plane;
+  close(tun_fds[1]);
+  close(udp_fds[1]);
+  delete [] remotes;
+
+  *drops = kBenchmarkPackets - received;
+  return a > b ? (double)received * kBenchmarkPacketSize * 0.000001 / (a - b) * f : 0;
+}
+
+// Measure how the encryption throughput of the multithreaded data plane
+// scales with the number of workers, for 1420 byte packets spread over
+// several peers. The packets go all the way from the tun reader through the
+// workers and the reorder queue to the udp writer.
+static void BenchmarkThreadScaling() {
+  static uint8 packets[kBenchmarkPeers][kBenchmarkPacketSize];
+  int num_cpus = std::max<int>((int)sysconf(_SC_NPROCESSORS_ONLN), 1);
+  for (int i = 0; i < kBenchmarkPeers; i++) {
+    uint8 *packet = packets[i];
+    packet[0] = 0x45;
+    WriteBE16(packet + 2, kBenchmarkPacketSize);
+    WriteBE32(packet + 12, 0x0A630101);
+    WriteBE32(packet + 16, 0x0A630102 + i);
+  }
+  double single_mbs = 0;
+  for (int n = 1; ; n = std::min(n * 2, num_cpus)) {
+    uint64 drops;
+    double mbs = BenchmarkDataPlane(n, packets, &drops);
+    if (mbs == 0)
+      return;
+    if (n == 1)
+      single_mbs = mbs;
+    RINFO("encrypt with %2d workers: %.1f MB/s (%.2fx), %llu dropped", n, mbs, mbs / single_mbs,
+          (unsigned long long)drops);
+    if (n == num_cpus)
+      break;
+  }
+}
+#endif  // WITH_WG_THREADING && defined(OS_LINUX)
+
 void Benchmark() {
   int64 a, b, f, t1 = 0, t2 = 0;
 
@@ -84,6 +500,31 @@ size_t max_bytes = 1000000000;
   RunOneBenchmark("chacha20-encrypt", [&](size_t i) -> uint64 { chacha20poly1305_encrypt(dst, dst, 1460, NULL, 0, i, key); return 1460; });
   RunOneBenchmark("chacha20-decrypt", [&](size_t i) -> uint64 { chacha20poly1305_decrypt_get_mac(dst, dst, 1460, NULL, 0, i, key, mac); return 1460; });
 
+  // Small packets, one at a time and 8 per multi-buffer call.
+  static const int kSmallSizes[] = {64, 128, 256, 512};
+  uint8 small[8][512 + 16];
+  memset(small, 0, sizeof(small));
+  for (size_t j = 0; j < ARRAY_SIZE(kSmallSizes); j++) {
+    int size = kSmallSizes[j];
+    char name[64];
+    snprintf(name, sizeof(name), "chacha20-encrypt-%d", size);
+    RunOneBenchmark(name, [&](size_t i) -> uint64 {
+      for (int k = 0; k < 8; k++)
+        chacha20poly1305_encrypt(small[k], small[k], size, NULL, 0, i, key);
+      return size * 8;
+    });
+    snprintf(name, sizeof(name), "chacha20-encrypt-%d-multi", size);
+    RunOneBenchmark(name, [&](size_t i) -> uint64 {
+      ChaCha20Poly1305Job jobs[8];
+      for (int k = 0; k < 8; k++) {
+        ChaCha20Poly1305Job job = {small[k], small[k], (size_t)size, NULL, 0, i, key, NULL};
+        jobs[k] = job;
+      }
+      chacha20poly1305_encrypt_multi(jobs, 8);
+      return size * 8;
+    });
+  }
+
   RunOneBenchmark("poly1305-only", [&](size_t i) -> uint64 { poly1305_get_mac(dst, 1460, NULL, 0, i, key, mac); return 1460; });
 
 #if WITH_AESGCM
@@ -95,4 +536,27 @@ size_t max_bytes = 1000000000;
     RunOneBenchmark("aes128-gcm-decrypt", [&](size_t i) -> uint64 { aesgcm_decrypt_get_mac(dst, dst, 1460, NULL, 0, i, &sctx, mac); return 1460; });
   }
 #endif   //  WITH_AESGCM
+
+  BenchmarkHandshake();
+
+  static const int kPeerCounts[] = {1000, 10000, 50000, 100000};
+  for (size_t i = 0; i < ARRAY_SIZE(kPeerCounts); i++)
+    BenchmarkPeerTimers(kPeerCounts[i]);
+
+#if WITH_WG_THREADING && defined(OS_LINUX)
+  BenchmarkThreadScaling();
+#endif  // WITH_WG_THREADING && defined(OS_LINUX)
+
+#if defined(OS_LINUX)
+  // NetworkBsd supports up to 1000 sockets, stay within the fd limit.
+  struct rlimit rl;
+  int max_sockets = 1000;
+  if (getrlimit(RLIMIT_NOFILE, &rl) == 0 && rl.rlim_cur < 1024)
+    max_sockets = (int)rl.rlim_cur - 24;
+  for (int num_sockets = 1; ; num_sockets *= 4) {
+    BenchmarkPollWakeup(std::min(num_sockets, max_sockets));
+    if (num_sockets >= max_sockets)
+      break;
+  }
+#endif  // defined(OS_LINUX)
 }
@@ -0,0 +1,131 @@
+// SPDX-License-Identifier: AGPL-1.0-only
+// Copyright (C) 2018 Ludvig Strigeus <info@tunsafe.com>. All Rights Reserved.
+//
+// Single pass ChaCha20-Poly1305. Included once per instruction set by
+// chacha20poly1305.cpp, with STITCHED_FUNC, STITCHED_TARGET and
+// STITCHED_ROTL(v, n) defined.
+//
+// Eight consecutive blocks of the stream are computed side by side, one per
+// 32-bit lane, and the scalar poly1305 runs on the 512 bytes of ciphertext of
+// the same chunk (decrypt) or the previous chunk (encrypt) between the vector
+// rounds, so both halves of the AEAD touch the data while it's in L1.
+
+#define STITCHED_QUARTER_ROUND(x, a, b, c, d) \
+	x[a] = _mm256_add_epi32(x[a], x[b]); x[d] = STITCHED_ROTL(_mm256_xor_si256(x[d], x[a]), 16); \
+	x[c] = _mm256_add_epi32(x[c], x[d]); x[b] = STITCHED_ROTL(_mm256_xor_si256(x[b], x[c]), 12); \
+	x[a] = _mm256_add_epi32(x[a], x[b]); x[d] = STITCHED_ROTL(_mm256_xor_si256(x[d], x[a]), 8); \
+	x[c] = _mm256_add_epi32(x[c], x[d]); x[b] = STITCHED_ROTL(_mm256_xor_si256(x[b], x[c]), 7);
+
+// Spreads the |mac_blocks| poly1305 blocks at |mac_src| evenly over the 20
+// half rounds.
+#define STITCHED_ABSORB(half) \
+	if (mac_blocks) { \
+		for (const uint8 *lim = mac_src + ((half) + 1) * mac_blocks / 20 * POLY1305_BLOCK_SIZE; m != lim; m += POLY1305_BLOCK_SIZE) \
+			poly1305_64_block(&reg, m, 1); \
+	}
+
+SAFEBUFFERS STITCHED_TARGET static void STITCHED_FUNC(uint8 *dst, const uint8 *src, size_t len,
+                                                      const uint8 *ad, size_t ad_len,
+                                                      const uint32 state[16], const uint8 poly_key[POLY1305_KEY_SIZE],
+                                                      bool decrypt, uint8 mac[POLY1305_MAC_SIZE]) {
+  __aligned(32) uint8 ks[STITCHED_CHUNK];
+  const uint8 *mac_src = NULL, *m;
+  size_t mac_blocks = 0;
+  __m256i x[16], y[16], out[16];
+  poly1305_64 poly;
+  size_t pos = 0;
+  int i;
+#if !defined(STITCHED_NATIVE_ROTATE)
+  const __m256i rot16 = _mm256_setr_epi8(2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13,
+                                         2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13);
+  const __m256i rot8 = _mm256_setr_epi8(3, 0, 1, 2, 7, 4, 5, 6, 11, 8, 9, 10, 15, 12, 13, 14,
+                                        3, 0, 1, 2, 7, 4, 5, 6, 11, 8, 9, 10, 15, 12, 13, 14);
+#endif  // !defined(STITCHED_NATIVE_ROTATE)
+
+  poly1305_64_init(&poly, poly_key);
+  poly1305_64_update_padded(&poly, ad, ad_len);
+
+  for (i = 0; i < 16; i++)
+    x[i] = _mm256_set1_epi32(state[i]);
+  x[12] = _mm256_add_epi32(x[12], _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+
+  for (;;) {
+    size_t n = len - pos;
+    if (n > STITCHED_CHUNK)
+      n = STITCHED_CHUNK;
+    // When decrypting, the ciphertext of this chunk is absorbed while its
+    // rounds run, except for a trailing partial block.
+    if (decrypt) {
+      mac_src = src + pos;
+      mac_blocks = n / POLY1305_BLOCK_SIZE;
+    }
+    if (n == 0)
+      break;
+    // |poly| has its address taken, so work on a copy that can live in
+    // registers during the rounds.
+    poly1305_64 reg = poly;
+    m = mac_src;
+    for (i = 0; i < 16; i++)
+      y[i] = x[i];
+    for (i = 0; i < 20; i += 2) {
+      STITCHED_QUARTER_ROUND(y, 0, 4, 8, 12)
+      STITCHED_QUARTER_ROUND(y, 1, 5, 9, 13)
+      STITCHED_QUARTER_ROUND(y, 2, 6, 10, 14)
+      STITCHED_QUARTER_ROUND(y, 3, 7, 11, 15)
+      STITCHED_ABSORB(i)
+      STITCHED_QUARTER_ROUND(y, 0, 5, 10, 15)
+      STITCHED_QUARTER_ROUND(y, 1, 6, 11, 12)
+      STITCHED_QUARTER_ROUND(y, 2, 7, 8, 13)
+      STITCHED_QUARTER_ROUND(y, 3, 4, 9, 14)
+      STITCHED_ABSORB(i + 1)
+    }
+    poly = reg;
+    if (decrypt)
+      poly1305_64_update_padded(&poly, m, n % POLY1305_BLOCK_SIZE);
+    for (i = 0; i < 16; i++)
+      y[i] = _mm256_add_epi32(y[i], x[i]);
+    x[12] = _mm256_add_epi32(x[12], _mm256_set1_epi32(8));
+    multi_transpose(y, out);
+    multi_transpose(y + 8, out + 8);
+
+    uint8 *d = dst + pos;
+    const uint8 *s = src + pos;
+    if (n == STITCHED_CHUNK) {
+      for (i = 0; i < 8; i++) {
+        _mm256_storeu_si256((__m256i*)(d + i * 64), _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(s + i * 64)), out[i]));
+        _mm256_storeu_si256((__m256i*)(d + i * 64 + 32), _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(s + i * 64 + 32)), out[8 + i]));
+      }
+    } else {
+      size_t j = 0;
+      for (i = 0; i < 8; i++) {
+        _mm256_store_si256((__m256i*)(ks + i * 64), out[i]);
+        _mm256_store_si256((__m256i*)(ks + i * 64 + 32), out[8 + i]);
+      }
+      for (; j + 32 <= n; j += 32)
+        _mm256_storeu_si256((__m256i*)(d + j), _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(s + j)), _mm256_load_si256((const __m256i*)(ks + j))));
+      for (; j < n; j++)
+        d[j] = s[j] ^ ks[j];
+    }
+    if (!decrypt) {
+      // The ciphertext of this chunk is absorbed during the rounds of the
+      // next one, or right here if it's the last.
+      mac_src = d;
+      mac_blocks = STITCHED_CHUNK / POLY1305_BLOCK_SIZE;
+      if (n != STITCHED_CHUNK) {
+        poly1305_64_update_padded(&poly, d, n);
+        mac_blocks = 0;
+      }
+    }
+    pos += n;
+  }
+  // Ciphertext of a final full chunk when encrypting.
+  if (mac_blocks && !decrypt)
+    poly1305_64_update_padded(&poly, mac_src, STITCHED_CHUNK);
+  poly1305_64_finish(&poly, ad_len, len, poly_key + 16, mac);
+
+  memzero_crypto(ks, sizeof(ks));
+  memzero_crypto(&poly, sizeof(poly));
+}
+
+#undef STITCHED_ABSORB
+#undef STITCHED_QUARTER_ROUND
@@ -557,6 +557,199 @@ static inline void InitializeChaChaState(ChaChaState *st, const uint8 key[CHACHA
   Write64((uint8*)st + 64 + 7 * 8, 0);
 }
 
+#if defined(ARCH_CPU_X86_64) && CHACHA20_WITH_ASM
+#define CHACHA20_WITH_MULTI 1
+#else
+#define CHACHA20_WITH_MULTI 0
+#endif
+
+#if CHACHA20_WITH_MULTI
+#include <immintrin.h>
+
+#if defined(COMPILER_MSVC)
+#define TARGET_AVX2
+#else
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+enum {
+  MULTI_LANES = 8,
+  // Longer packets keep the single packet kernels busy on their own.
+  MULTI_MAX_LEN = 768,
+};
+
+#define MULTI_ROTL(v, n) _mm256_or_si256(_mm256_slli_epi32(v, n), _mm256_srli_epi32(v, 32 - (n)))
+
+#define MULTI_QUARTER_ROUND(x, a, b, c, d) \
+	x[a] = _mm256_add_epi32(x[a], x[b]); x[d] = _mm256_shuffle_epi8(_mm256_xor_si256(x[d], x[a]), rot16); \
+	x[c] = _mm256_add_epi32(x[c], x[d]); x[b] = MULTI_ROTL(_mm256_xor_si256(x[b], x[c]), 12); \
+	x[a] = _mm256_add_epi32(x[a], x[b]); x[d] = _mm256_shuffle_epi8(_mm256_xor_si256(x[d], x[a]), rot8); \
+	x[c] = _mm256_add_epi32(x[c], x[d]); x[b] = MULTI_ROTL(_mm256_xor_si256(x[b], x[c]), 7);
+
+// Transposes 8 state words of 8 lanes, so that out[lane] holds 32 bytes of
+// keystream of that lane.
+TARGET_AVX2 static FORCEINLINE void multi_transpose(const __m256i *x, __m256i *out) {
+  __m256i t0 = _mm256_unpacklo_epi32(x[0], x[1]), t1 = _mm256_unpackhi_epi32(x[0], x[1]);
+  __m256i t2 = _mm256_unpacklo_epi32(x[2], x[3]), t3 = _mm256_unpackhi_epi32(x[2], x[3]);
+  __m256i t4 = _mm256_unpacklo_epi32(x[4], x[5]), t5 = _mm256_unpackhi_epi32(x[4], x[5]);
+  __m256i t6 = _mm256_unpacklo_epi32(x[6], x[7]), t7 = _mm256_unpackhi_epi32(x[6], x[7]);
+  __m256i u0 = _mm256_unpacklo_epi64(t0, t2), u1 = _mm256_unpackhi_epi64(t0, t2);
+  __m256i u2 = _mm256_unpacklo_epi64(t1, t3), u3 = _mm256_unpackhi_epi64(t1, t3);
+  __m256i u4 = _mm256_unpacklo_epi64(t4, t6), u5 = _mm256_unpackhi_epi64(t4, t6);
+  __m256i u6 = _mm256_unpacklo_epi64(t5, t7), u7 = _mm256_unpackhi_epi64(t5, t7);
+  out[0] = _mm256_permute2x128_si256(u0, u4, 0x20);
+  out[1] = _mm256_permute2x128_si256(u1, u5, 0x20);
+  out[2] = _mm256_permute2x128_si256(u2, u6, 0x20);
+  out[3] = _mm256_permute2x128_si256(u3, u7, 0x20);
+  out[4] = _mm256_permute2x128_si256(u0, u4, 0x31);
+  out[5] = _mm256_permute2x128_si256(u1, u5, 0x31);
+  out[6] = _mm256_permute2x128_si256(u2, u6, 0x31);
+  out[7] = _mm256_permute2x128_si256(u3, u7, 0x31);
+}
+#endif  // CHACHA20_WITH_MULTI
+
+// The stitched kernels need 128-bit multiplies for their scalar poly1305.
+#if WITH_STITCHED_CHACHA20POLY1305 && CHACHA20_WITH_MULTI && !defined(COMPILER_MSVC)
+#define CHACHA20_WITH_STITCHED 1
+#else
+#define CHACHA20_WITH_STITCHED 0
+#endif
+
+#if CHACHA20_WITH_STITCHED
+enum {
+  STITCHED_CHUNK = 8 * CHACHA20_BLOCK_SIZE,
+  // Below this there's too little to overlap, the first chunk's rounds
+  // and the last chunk's mac run on their own.
+  STITCHED_MIN_LEN = 1024,
+};
+
+typedef unsigned __int128 uint128;
+
+// Poly1305 in base 2^64, small enough to run in the scalar units while the
+// vector units are busy with ChaCha20. The accumulator is h0 + h1 * 2^64 +
+// h2 * 2^128, partially reduced.
+struct poly1305_64 {
+  uint64 r0, r1, s1;
+  uint64 h0, h1, h2;
+};
+
+static FORCEINLINE void poly1305_64_init(poly1305_64 *st, const uint8 key[16]) {
+  st->r0 = ReadLE64(key) & 0x0ffffffc0fffffff;
+  st->r1 = ReadLE64(key + 8) & 0x0ffffffc0ffffffc;
+  st->s1 = st->r1 + (st->r1 >> 2);
+  st->h0 = st->h1 = st->h2 = 0;
+}
+
+static FORCEINLINE void poly1305_64_block(poly1305_64 *st, const uint8 *m, uint64 padbit) {
+  uint64 r0 = st->r0, r1 = st->r1, s1 = st->s1;
+  uint64 h0, h1, h2, t, c;
+  uint128 d0, d1;
+
+  t = ReadLE64(m);
+  h0 = st->h0 + t;
+  c = h0 < t;
+  t = ReadLE64(m + 8) + c;
+  h1 = st->h1 + t;
+  h2 = st->h2 + (h1 < t) + (t < c) + padbit;
+
+  // h *= r, with 2^130 folded back in as 5 through s1.
+  d0 = (uint128)h0 * r0 + (uint128)h1 * s1;
+  d1 = (uint128)h0 * r1 + (uint128)h1 * r0 + (uint128)(h2 * s1) + (uint64)(d0 >> 64);
+  h2 = h2 * r0 + (uint64)(d1 >> 64);
+  h0 = (uint64)d0;
+  h1 = (uint64)d1;
+
+  // Reduce everything above bit 130.
+  c = (h2 >> 2) + (h2 & ~(uint64)3);
+  h0 += c;
+  c = h0 < c;
+  h1 += c;
+  st->h0 = h0;
+  st->h1 = h1;
+  st->h2 = (h2 & 3) + (h1 < c);
+}
+
+// Absorbs |len| bytes followed by zero padding up to the block size, the
+// way the AEAD construction pads both the ad and the ciphertext.
+static void poly1305_64_update_padded(poly1305_64 *st, const uint8 *m, size_t len) {
+  uint8 block[POLY1305_BLOCK_SIZE];
+  for (; len >= POLY1305_BLOCK_SIZE; len -= POLY1305_BLOCK_SIZE, m += POLY1305_BLOCK_SIZE)
+    poly1305_64_block(st, m, 1);
+  if (len) {
+    memcpy(block, m, len);
+    memset(block + len, 0, sizeof(block) - len);
+    poly1305_64_block(st, block, 1);
+  }
+}
+
+static void poly1305_64_finish(poly1305_64 *st, uint64 ad_len, uint64 src_len, const uint8 nonce[16], uint8 mac[POLY1305_MAC_SIZE]) {
+  uint8 block[POLY1305_BLOCK_SIZE];
+  uint64 g0, g1, g2, mask;
+  uint128 t;
+
+  WriteLE64(block, ad_len);
+  WriteLE64(block + 8, src_len);
+  poly1305_64_block(st, block, 1);
+
+  // Subtract 2^130 - 5 if h is at least that.
+  t = (uint128)st->h0 + 5;
+  g0 = (uint64)t;
+  t = (uint128)st->h1 + (uint64)(t >> 64);
+  g1 = (uint64)t;
+  g2 = st->h2 + (uint64)(t >> 64);
+  mask = 0 - (g2 >> 2);
+  g0 = (st->h0 & ~mask) | (g0 & mask);
+  g1 = (st->h1 & ~mask) | (g1 & mask);
+
+  t = (uint128)g0 + ReadLE64(nonce);
+  WriteLE64(mac, (uint64)t);
+  t = (uint128)g1 + ReadLE64(nonce + 8) + (uint64)(t >> 64);
+  WriteLE64(mac + 8, (uint64)t);
+}
+
+#define STITCHED_FUNC chacha20poly1305_stitched_avx2
+#define STITCHED_TARGET TARGET_AVX2
+#define STITCHED_ROTL(v, n) ((n) == 16 ? _mm256_shuffle_epi8(v, rot16) : (n) == 8 ? _mm256_shuffle_epi8(v, rot8) : MULTI_ROTL(v, n))
+#include "crypto/chacha20poly1305-stitched-impl.h"
+#undef STITCHED_FUNC
+#undef STITCHED_TARGET
+#undef STITCHED_ROTL
+
+#if CHACHA20_WITH_AVX512
+// AVX-512VL has a rotate instruction, but the chunks stay 256 bits wide so
+// that the cores don't drop to their 512-bit clocks.
+#define STITCHED_FUNC chacha20poly1305_stitched_avx512vl
+#define STITCHED_TARGET __attribute__((target("avx2,avx512f,avx512vl")))
+#define STITCHED_ROTL(v, n) _mm256_rol_epi32(v, n)
+#define STITCHED_NATIVE_ROTATE
+#include "crypto/chacha20poly1305-stitched-impl.h"
+#undef STITCHED_FUNC
+#undef STITCHED_TARGET
+#undef STITCHED_ROTL
+#undef STITCHED_NATIVE_ROTATE
+#endif  // CHACHA20_WITH_AVX512
+
+// Encrypts or decrypts with one of the stitched kernels and writes the mac
+// of the ciphertext. Returns false if none of them applies.
+static inline bool chacha20poly1305_stitched(uint8 *dst, const uint8 *src, size_t src_len,
+                                             const uint8 *ad, size_t ad_len, ChaChaState *st,
+                                             bool decrypt, uint8 mac[POLY1305_MAC_SIZE]) {
+  if (src_len < STITCHED_MIN_LEN)
+    return false;
+#if CHACHA20_WITH_AVX512
+  if (X86_PCAP_AVX512VL) {
+    chacha20poly1305_stitched_avx512vl(dst, src, src_len, ad, ad_len, st->chacha20_state.state, st->block0, decrypt, mac);
+    return true;
+  }
+#endif  // CHACHA20_WITH_AVX512
+  if (X86_PCAP_AVX2) {
+    chacha20poly1305_stitched_avx2(dst, src, src_len, ad, ad_len, st->chacha20_state.state, st->block0, decrypt, mac);
+    return true;
+  }
+  return false;
+}
+#endif  // CHACHA20_WITH_STITCHED
+
 SAFEBUFFERS void poly1305_get_mac(const uint8 *src, size_t src_len,
                      const uint8 *ad, const size_t ad_len,
                      const uint64 nonce, const uint8 key[CHACHA20POLY1305_KEYLEN],
@@ -576,6 +769,12 @@ SAFEBUFFERS void chacha20poly1305_encrypt(uint8 *dst, const uint8 *src, const si
 
   InitializeChaChaState(&st, key, nonce);
 	chacha20_crypt(&st.chacha20_state, st.block0, st.block0, sizeof(st.block0));
+#if CHACHA20_WITH_STITCHED
+  if (chacha20poly1305_stitched(dst, src, src_len, ad, ad_len, &st, false, dst + src_len)) {
+    memzero_crypto(&st, sizeof(st));
+    return;
+  }
+#endif  // CHACHA20_WITH_STITCHED
   chacha20_crypt(&st.chacha20_state, dst, src, (uint32)src_len);
   poly1305_getmac(ad, ad_len, dst, src_len, st.block0, dst + src_len);
   memzero_crypto(&st, sizeof(st));
@@ -589,6 +788,12 @@ SAFEBUFFERS void chacha20poly1305_decrypt_get_mac(uint8 *dst, const uint8 *src,
 
   InitializeChaChaState(&st, key, nonce);
   chacha20_crypt(&st.chacha20_state, st.block0, st.block0, sizeof(st.block0));
+#if CHACHA20_WITH_STITCHED
+  if (chacha20poly1305_stitched(dst, src, src_len, ad, ad_len, &st, true, mac)) {
+    memzero_crypto(&st, sizeof(st));
+    return;
+  }
+#endif  // CHACHA20_WITH_STITCHED
   poly1305_getmac(ad, ad_len, src, src_len, st.block0, mac);
   chacha20_crypt(&st.chacha20_state, dst, src, (uint32)src_len);
   memzero_crypto(&st, sizeof(st));
@@ -631,3 +836,144 @@ bool xchacha20poly1305_decrypt(uint8 *dst, const uint8 *src, const size_t src_le
 	return ret;
 }
 
+
+#if CHACHA20_WITH_MULTI
+// Each 32-bit lane of the AVX2 registers runs the ChaCha20 state of its own
+// packet, one 64-byte block per lane and round trip. When a packet is done,
+// its lane picks up the next one. Block 0 of a packet is its poly1305 key.
+SAFEBUFFERS TARGET_AVX2 static void chacha20poly1305_multi_avx2(const ChaCha20Poly1305Job *jobs, size_t count, bool decrypt) {
+  __aligned(32) uint32 state[16][MULTI_LANES];
+  __aligned(32) uint8 poly_key[MULTI_LANES][POLY1305_KEY_SIZE];
+  __aligned(32) uint8 block[CHACHA20_BLOCK_SIZE];
+  const ChaCha20Poly1305Job *lane_job[MULTI_LANES];
+  uint32 lane_pos[MULTI_LANES];
+  const __m256i rot16 = _mm256_setr_epi8(2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13,
+                                         2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13);
+  const __m256i rot8 = _mm256_setr_epi8(3, 0, 1, 2, 7, 4, 5, 6, 11, 8, 9, 10, 15, 12, 13, 14,
+                                        3, 0, 1, 2, 7, 4, 5, 6, 11, 8, 9, 10, 15, 12, 13, 14);
+  size_t next = 0;
+  int active = 0, i, lane;
+
+  memset(state, 0, sizeof(state));
+  for (lane = 0; lane < MULTI_LANES; lane++)
+    lane_job[lane] = NULL;
+
+  for (;;) {
+    // Give idle lanes the next packets.
+    for (lane = 0; lane < MULTI_LANES && next < count; lane++) {
+      if (lane_job[lane])
+        continue;
+      const ChaCha20Poly1305Job *job = &jobs[next++];
+      while (job->src_len > MULTI_MAX_LEN) {
+        if (decrypt)
+          chacha20poly1305_decrypt_get_mac(job->dst, job->src, job->src_len, job->ad, job->ad_len, job->nonce, job->key, job->mac);
+        else
+          chacha20poly1305_encrypt(job->dst, job->src, job->src_len, job->ad, job->ad_len, job->nonce, job->key);
+        if (next == count) {
+          job = NULL;
+          break;
+        }
+        job = &jobs[next++];
+      }
+      if (job == NULL)
+        break;
+      lane_job[lane] = job;
+      lane_pos[lane] = 0;
+      active++;
+      for (i = 0; i < 8; i++)
+        state[4 + i][lane] = ReadLE32(job->key + i * 4);
+      state[12][lane] = 0;
+      state[13][lane] = 0;
+      state[14][lane] = (uint32)job->nonce;
+      state[15][lane] = (uint32)(job->nonce >> 32);
+    }
+    if (active == 0)
+      break;
+
+    __m256i x[16], y[16], out[16];
+    x[0] = _mm256_set1_epi32(0x61707865);
+    x[1] = _mm256_set1_epi32(0x3320646e);
+    x[2] = _mm256_set1_epi32(0x79622d32);
+    x[3] = _mm256_set1_epi32(0x6b206574);
+    for (i = 4; i < 16; i++)
+      x[i] = _mm256_load_si256((const __m256i*)state[i]);
+    for (i = 0; i < 16; i++)
+      y[i] = x[i];
+    for (i = 0; i < 10; i++) {
+      MULTI_QUARTER_ROUND(y, 0, 4, 8, 12)
+      MULTI_QUARTER_ROUND(y, 1, 5, 9, 13)
+      MULTI_QUARTER_ROUND(y, 2, 6, 10, 14)
+      MULTI_QUARTER_ROUND(y, 3, 7, 11, 15)
+      MULTI_QUARTER_ROUND(y, 0, 5, 10, 15)
+      MULTI_QUARTER_ROUND(y, 1, 6, 11, 12)
+      MULTI_QUARTER_ROUND(y, 2, 7, 8, 13)
+      MULTI_QUARTER_ROUND(y, 3, 4, 9, 14)
+    }
+    for (i = 0; i < 16; i++)
+      y[i] = _mm256_add_epi32(y[i], x[i]);
+    _mm256_store_si256((__m256i*)state[12], _mm256_add_epi32(x[12], _mm256_set1_epi32(1)));
+    multi_transpose(y, out);
+    multi_transpose(y + 8, out + 8);
+
+    for (lane = 0; lane < MULTI_LANES; lane++) {
+      const ChaCha20Poly1305Job *job = lane_job[lane];
+      if (job == NULL)
+        continue;
+      if (state[12][lane] == 1) {
+        // The first block is the poly1305 key. The mac of the ciphertext
+        // is computed before it gets decrypted.
+        _mm256_store_si256((__m256i*)poly_key[lane], out[lane]);
+        if (decrypt)
+          poly1305_getmac(job->ad, job->ad_len, job->src, job->src_len, poly_key[lane], job->mac);
+      } else {
+        uint32 pos = lane_pos[lane], n = (uint32)job->src_len - pos;
+        if (n >= CHACHA20_BLOCK_SIZE) {
+          __m256i a = _mm256_loadu_si256((const __m256i*)(job->src + pos));
+          __m256i b = _mm256_loadu_si256((const __m256i*)(job->src + pos + 32));
+          _mm256_storeu_si256((__m256i*)(job->dst + pos), _mm256_xor_si256(a, out[lane]));
+          _mm256_storeu_si256((__m256i*)(job->dst + pos + 32), _mm256_xor_si256(b, out[8 + lane]));
+          n = CHACHA20_BLOCK_SIZE;
+        } else {
+          _mm256_store_si256((__m256i*)block, out[lane]);
+          _mm256_store_si256((__m256i*)(block + 32), out[8 + lane]);
+          if (job->dst != job->src)
+            memcpy(job->dst + pos, job->src + pos, n);
+          crypto_xor(job->dst + pos, block, n);
+        }
+        lane_pos[lane] = pos + n;
+      }
+      if (lane_pos[lane] == job->src_len) {
+        if (!decrypt)
+          poly1305_getmac(job->ad, job->ad_len, job->dst, job->src_len, poly_key[lane], job->dst + job->src_len);
+        lane_job[lane] = NULL;
+        active--;
+      }
+    }
+  }
+  memzero_crypto(state, sizeof(state));
+  memzero_crypto(poly_key, sizeof(poly_key));
+  memzero_crypto(block, sizeof(block));
+}
+#endif  // CHACHA20_WITH_MULTI
+
+void chacha20poly1305_encrypt_multi(const ChaCha20Poly1305Job *jobs, size_t count) {
+#if CHACHA20_WITH_MULTI
+  if (X86_PCAP_AVX2 && count > 1) {
+    chacha20poly1305_multi_avx2(jobs, count, false);
+    return;
+  }
+#endif  // CHACHA20_WITH_MULTI
+  for (size_t i = 0; i < count; i++)
+    chacha20poly1305_encrypt(jobs[i].dst, jobs[i].src, jobs[i].src_len, jobs[i].ad, jobs[i].ad_len, jobs[i].nonce, jobs[i].key);
+}
+
+void chacha20poly1305_decrypt_get_mac_multi(const ChaCha20Poly1305Job *jobs, size_t count) {
+#if CHACHA20_WITH_MULTI
+  if (X86_PCAP_AVX2 && count > 1) {
+    chacha20poly1305_multi_avx2(jobs, count, true);
+    return;
+  }
+#endif  // CHACHA20_WITH_MULTI
+  for (size_t i = 0; i < count; i++)
+    chacha20poly1305_decrypt_get_mac(jobs[i].dst, jobs[i].src, jobs[i].src_len, jobs[i].ad, jobs[i].ad_len, jobs[i].nonce, jobs[i].key, jobs[i].mac);
+}
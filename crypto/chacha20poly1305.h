@@ -36,4 +36,24 @@ bool xchacha20poly1305_decrypt(uint8 *dst, const uint8 *src, const size_t src_le
 void poly1305_get_mac(const uint8 *src, size_t src_len,
                      const uint8 *ad, const size_t ad_len,
                      const uint64 nonce, const uint8 key[CHACHA20POLY1305_KEYLEN],
-                     uint8 mac[CHACHA20POLY1305_AUTHTAGLEN]);
\ No newline at end of file
+                     uint8 mac[CHACHA20POLY1305_AUTHTAGLEN]);
+
+// One packet of a multi-buffer call, the packets are independent of each
+// other. When encrypting the mac is written after |dst| like
+// chacha20poly1305_encrypt does, and |mac| isn't used.
+struct ChaCha20Poly1305Job {
+  uint8 *dst;
+  const uint8 *src;
+  size_t src_len;
+  const uint8 *ad;
+  size_t ad_len;
+  uint64 nonce;
+  const uint8 *key;
+  uint8 *mac;
+};
+
+// Same as calling chacha20poly1305_encrypt / chacha20poly1305_decrypt_get_mac
+// for each job, but small packets are processed side by side, one packet per
+// vector lane.
+void chacha20poly1305_encrypt_multi(const ChaCha20Poly1305Job *jobs, size_t count);
+void chacha20poly1305_decrypt_get_mac_multi(const ChaCha20Poly1305Job *jobs, size_t count);
\ No newline at end of file
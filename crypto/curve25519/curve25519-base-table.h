@@ -0,0 +1,836 @@
+// Generated by crypto/tools/curve25519-base-table.py, do not edit.
+// kCurve25519BaseTable[j][i] = (i + 1) * 16^(2j) * B as y + x, y - x, 2dxy.
+static const uint64 kCurve25519BaseTable[32][8][12] = {
+  {
+    {0x2fbc93c6f58c3b85ull, 0xcf932dc6fb8c0e19ull, 0x270b4898643d42c2ull, 0x07cf9d3a33d4ba65ull,
+     0x9d103905d740913eull, 0xfd399f05d140beb3ull, 0xa5c18434688f8a09ull, 0x44fd2f9298f81267ull,
+     0xabc91205877aaa68ull, 0x26d9e823ccaac49eull, 0x5a1b7dcbdd43598cull, 0x6f117b689f0c65a8ull},
+    {0x9224e7fc933c71d7ull, 0x9f469d967a0ff5b5ull, 0x5aa69a65e1d60702ull, 0x590c063fa87d2e2eull,
+     0x8a99a56042b4d5a8ull, 0x8f2b810c4e60acf6ull, 0xe09e236bb16e37aaull, 0x6bb595a669c92555ull,
+     0x43faa8b3a59b7a5full, 0x36c16bdd5d9acf78ull, 0x500fa0840b3d6a31ull, 0x701af5b13ea50b73ull},
+    {0xaf25b0a84cee9730ull, 0x025a8430e8864b8aull, 0xc11b50029f016732ull, 0x7a164e1b9a80f8f4ull,
+     0x56611fe8a4fcd265ull, 0x3bd353fde5c1ba7dull, 0x8131f31a214bd6bdull, 0x2ab91587555bda62ull,
+     0x14ae933f0dd0d889ull, 0x589423221c35da62ull, 0xd170e5458cf2db4cull, 0x5a2826af12b9b4c6ull},
+    {0x287351b98efc099full, 0x6765c6f47dfd2538ull, 0xca348d3dfb0a9265ull, 0x680e910321e58727ull,
+     0x95fe050a056818bfull, 0x327e89715660faa9ull, 0xc3e8e3cd06a05073ull, 0x27933f4c7445a49aull,
+     0x5a13fbe9c476ff09ull, 0x6e9e39457b5cc172ull, 0x5ddbdcf9102b4494ull, 0x7f9d0cbf63553e2bull},
+    {0xa212bc4408a5bb33ull, 0x8d5048c3c75eed02ull, 0xdd1beb0c5abfec44ull, 0x2945ccf146e206ebull,
+     0x7f9182c3a447d6baull, 0xd50014d14b2729b7ull, 0xe33cf11cb864a087ull, 0x154a7e73eb1b55f3ull,
+     0xbcbbdbf1812a8285ull, 0x270e0807d0bdd1fcull, 0xb41b670b1bbda72dull, 0x43aabe696b3bb69aull},
+    {0x3a0ceeeb77157131ull, 0x9b27158900c8af88ull, 0x8065b668da59a736ull, 0x51e57bb6a2cc38bdull,
+     0x499806b67b7d8ca4ull, 0x575be28427d22739ull, 0xbb085ce7204553b9ull, 0x38b64c41ae417884ull,
+     0x85ac326702ea4b71ull, 0xbe70e00341a1bb01ull, 0x53e4a24b083bc144ull, 0x10b8e91a9f0d61e3ull},
+    {0x6b1a5cd0944ea3bfull, 0x7470353ab39dc0d2ull, 0x71b2528228542e49ull, 0x461bea69283c927eull,
+     0xba6f2c9aaa3221b1ull, 0x6ca021533bba23a7ull, 0x9dea764f92192c3aull, 0x1d6edd5d2e5317e0ull,
+     0xf1836dc801b8b3a2ull, 0xb3035f47053ea49aull, 0x529c41ba5877adf3ull, 0x7a9fbb1c6a0f90a7ull},
+    {0x59b7596604dd3e8full, 0x6cb30377e288702cull, 0xb1339c665ed9c323ull, 0x0915e76061bce52full,
+     0xe2a75dedf39234d9ull, 0x963d7680e1b558f9ull, 0x2c2741ac6e3c23fbull, 0x3a9024a1320e01c3ull,
+     0xe7c1f5d9c9a2911aull, 0xb8a371788bcca7d7ull, 0x636412190eb62a32ull, 0x26907c5c2ecc4e95ull},
+  },
+  {
+    {0x2eccdd0e632f9c1dull, 0x51d0b69676893115ull, 0x52dfb76ba8637a58ull, 0x6dd37d49a00eef39ull,
+     0xed5b635449aa515eull, 0xa865c49f0bc6823aull, 0x850c1fe95b42d1c4ull, 0x30d76d6f03d315b9ull,
+     0x6c4444172106e4c7ull, 0xfb53d680928d7f69ull, 0xb4739ea4694d3f26ull, 0x10c697112e864bb0ull},
+    {0x0ca62aa08358c805ull, 0x6a3d4ae37a204247ull, 0x7464d3a63b11eddcull, 0x03bf9baf550806efull,
+     0x6493c4277dbe5fdeull, 0x265d4fad19ad7ea2ull, 0x0e00dfc846304590ull, 0x25e61cabed66fe09ull,
+     0x3f13e128cc586604ull, 0x6f5873ecb459747eull, 0xa0b63dedcc1268f5ull, 0x566d78634586e22cull},
+    {0xa1054285c65a2fd0ull, 0x6c64112af31667c3ull, 0x680ae240731aee58ull, 0x14fba5f34793b22aull,
+     0x1637a49f9cc10834ull, 0xbc8e56d5a89bc451ull, 0x1cb5ec0f7f7fd2dbull, 0x33975bca5ecc35d9ull,
+     0x3cd746166985f7d4ull, 0x593e5e84c9c80057ull, 0x2fc3f2b67b61131eull, 0x14829cea83fc526cull},
+    {0x21e70b2f4e71ecb8ull, 0xe656ddb940a477e3ull, 0xbf6556cece1d4f80ull, 0x05fc3bc4535d7b7eull,
+     0xff437b8497dd95c2ull, 0x6c744e30aa4eb5a7ull, 0x9e0c5d613c85e88bull, 0x2fd9c71e5f758173ull,
+     0x24b8b3ae52afdeddull, 0x3495638ced3b30cfull, 0x33a4bc83a9be8195ull, 0x373767475c651f04ull},
+    {0x634095cb14246590ull, 0xef12144016c15535ull, 0x9e38140c8910bc60ull, 0x6bf5905730907c8cull,
+     0x2fba99fd40d1add9ull, 0xb307166f96f4d027ull, 0x4363f05215f03baeull, 0x1fbea56c3b18f999ull,
+     0x0fa778f1e1415b8aull, 0x06409ff7bac3a77eull, 0x6f52d7b89aa29a50ull, 0x02521cf67a635a56ull},
+    {0xb1146720772f5ee4ull, 0xe8f894b196079aceull, 0x4af8224d00ac824aull, 0x001753d9f7cd6cc4ull,
+     0x513fee0b0a9d5294ull, 0x8f98e75c0fdf5a66ull, 0xd4618688bfe107ceull, 0x3fa00a7e71382cedull,
+     0x3c69232d963ddb34ull, 0x1dde87dab4973858ull, 0xaad7d1f9a091f285ull, 0x12b5fe2fa048edb6ull},
+    {0xdf2b7c26ad6f1e92ull, 0x4b66d323504b8913ull, 0x8c409dc0751c8bc3ull, 0x6f7e93c20796c7b8ull,
+     0x71f0fbc496fce34dull, 0x73b9826badf35bedull, 0xd2047261ff28c561ull, 0x749b76f96fb1206full,
+     0x1f5af604aea6ae05ull, 0xc12351f1bee49c99ull, 0x61a808b5eeff6b66ull, 0x0fcec10f01e02151ull},
+    {0x3df2d29dc4244e45ull, 0x2b020e7493d8de0aull, 0x6cc8067e820c214dull, 0x413779166feab90aull,
+     0x644d58a649fe1e44ull, 0x21fcaea231ad777eull, 0x02441c5a887fd0d2ull, 0x4901aa7183c511f3ull,
+     0x08b1b7548c1af8f0ull, 0xce0f7a7c246299b4ull, 0xf760b0f91e06d939ull, 0x41bb887b726d1213ull},
+  },
+  {
+    {0x7e234c597c6691aeull, 0x64889d3d0a85b4c8ull, 0xdae2c90c354afae7ull, 0x0a871e070c6a9e1dull,
+     0x40e87d44744346beull, 0x1d48dad415b52b25ull, 0x7c3a8a18a13b603eull, 0x4eb728c12fcdbdf7ull,
+     0x3301b5994bbc8989ull, 0x736bae3a5bdd4260ull, 0x0d61ade219d59e3cull, 0x3ee7300f2685d464ull},
+    {0x43fa7947841e7518ull, 0xe5c6fa59639c46d7ull, 0xa1065e1de3052b74ull, 0x7d47c6a2cfb89030ull,
+     0xf5d255e49e7dd6b7ull, 0x8016115c610b1eacull, 0x3c99975d92e187caull, 0x13815762979125c2ull,
+     0x3fdad0148ef0d6e0ull, 0x9d3e749a91546f3cull, 0x71ec621026bb8157ull, 0x148cf58d34c9ec80ull},
+    {0xe2572f7d9ae4756dull, 0x56c345bb88f3487full, 0x9fd10b6d6960a88dull, 0x278febad4eaea1b9ull,
+     0x46a492f67934f027ull, 0x469984bef6840aa9ull, 0x5ca1bc2a89611854ull, 0x3ff2fa1ebd5dbbd4ull,
+     0xb1aa681f8c933966ull, 0x8c21949c20290c98ull, 0x39115291219d3c52ull, 0x4104dd02fe9c677bull},
+    {0x81214e06db096ab8ull, 0x21a8b6c90ce44f35ull, 0x6524c12a409e2af5ull, 0x0165b5a48efca481ull,
+     0x72b2bf5e1124422aull, 0xa1fa0c3398a33ab5ull, 0x94cb6101fa52b666ull, 0x2c863b00afaf53d5ull,
+     0xf190a474a0846a76ull, 0x12eff984cd2f7cc0ull, 0x695e290658aa2b8full, 0x591b67d9bffec8b8ull},
+    {0x99b9b3719f18b55dull, 0xe465e5faa18c641eull, 0x61081136c29f05edull, 0x489b4f867030128bull,
+     0x312f0d1c80b49bfaull, 0x5979515eabf3ec8aull, 0x727033c09ef01c88ull, 0x3de02ec7ca8f7bcbull,
+     0xd232102d3aeb92efull, 0xe16253b46116a861ull, 0x3d7eabe7190baa24ull, 0x49f5fbba496cbebfull},
+    {0x155d628c1e9c572eull, 0x8a4d86acc5884741ull, 0x91a352f6515763ebull, 0x06a1a6c28867515bull,
+     0x30949a108a5bcfd4ull, 0xdc40dd70bc6473ebull, 0x92c294c1307c0d1cull, 0x5604a86dcbfa6e74ull,
+     0x7288d1d47c1764b6ull, 0x72541140e0418b51ull, 0x9f031a6018acf6d1ull, 0x20989e89fe2742c6ull},
+    {0x1674278b85eaec2eull, 0x5621dc077acb2bdfull, 0x640a4c1661cbf45aull, 0x730b9950f70595d3ull,
+     0x499777fd3a2dcc7full, 0x32857c2ca54fd892ull, 0xa279d864d207e3a0ull, 0x0403ed1d0ca67e29ull,
+     0xc94b2d35874ec552ull, 0xc5e6c8cf98246f8dull, 0xf7cb46fa16c035ceull, 0x5bd7454308303dccull},
+    {0x85c4932115e7792aull, 0xc64c89a2bdcdddc9ull, 0x9d1e3da8ada3d762ull, 0x5bb7db123067f82cull,
+     0x7f9ad19528b24cc2ull, 0x7f6b54656335c181ull, 0x66b8b66e4fc07236ull, 0x133a78007380ad83ull,
+     0x0961f467c6ca62beull, 0x04ec21d6211952eeull, 0x182360779bd54770ull, 0x740dca6d58f0e0d2ull},
+  },
+  {
+    {0x231a8c570478433cull, 0xb7b5270ec281439dull, 0xdbaa99eae3d9079full, 0x2c03f5256c2b03d9ull,
+     0xdf48ee0752cfce4eull, 0xc3fffaf306ec08b7ull, 0x05710b2ab95459c4ull, 0x161d25fa963ea38dull,
+     0x790f18757b53a47dull, 0x307b0130cf0c5879ull, 0x31903d77257ef7f9ull, 0x699468bdbd96bbafull},
+    {0xd8dd3de66aa91948ull, 0x485064c22fc0d2ccull, 0x9b48246634fdea2full, 0x293e1c4e6c4a2e3aull,
+     0xbd1f2f46f4dafecfull, 0x7cef0114a47fd6f7ull, 0xd31ffdda4a47b37full, 0x525219a473905785ull,
+     0x376e134b925112e1ull, 0x703778b5dca15da0ull, 0xb04589af461c3111ull, 0x5b605c447f032823ull},
+    {0x3be9fec6f0e7f04cull, 0x866a579e75e34962ull, 0x5542ef161e1de61aull, 0x2f12fef4cc5abdd5ull,
+     0xb965805920c47c89ull, 0xe7f0100c923b8fccull, 0x0001256502e2ef77ull, 0x24a76dcea8aeb3eeull,
+     0x0a4522b2dfc0c740ull, 0x10d06e7f40c9a407ull, 0xc6cf144178cff668ull, 0x5e607b2518a43790ull},
+    {0xa02c431ca596cf14ull, 0xe3c42d40aed3e400ull, 0xd24526802e0f26dbull, 0x201f33139e457068ull,
+     0x58b31d8f6cdf1818ull, 0x35cfa74fc36258a2ull, 0xe1b3ff4f66e61d6eull, 0x5067acab6ccdd5f7ull,
+     0xfd527f6b08039d51ull, 0x18b14964017c0006ull, 0xd5220eb02e25a4a8ull, 0x397cba8862460375ull},
+    {0x7815c3fbc81379e7ull, 0xa6619420dde12af1ull, 0xffa9c0f885a8fdd5ull, 0x771b4022c1e1c252ull,
+     0x30c13093f05959b2ull, 0xe23aa18de9a97976ull, 0x222fd491721d5e26ull, 0x2339d320766e6c3aull,
+     0xd87dd986513a2fa7ull, 0xf5ac9b71f9d4cf08ull, 0xd06bc31b1ea283b3ull, 0x331a189219971a76ull},
+    {0x26512f3a9d7572afull, 0x5bcbe28868074a9eull, 0x84edc1c11180f7c4ull, 0x1ac9619ff649a67bull,
+     0xf5166f45fb4f80c6ull, 0x9c36c7de61c775cfull, 0xe3d4e81b9041d91cull, 0x31167c6b83bdfe21ull,
+     0xf22b3842524b1068ull, 0x5068343bee9ce987ull, 0xfc9d71844a6250c8ull, 0x612436341f08b111ull},
+    {0x8b6349e31a2d2638ull, 0x9ddfb7009bd3fd35ull, 0x7f8bf1b8a3a06ba4ull, 0x1522aa3178d90445ull,
+     0xd99d41db874e898dull, 0x09fea5f16c07dc20ull, 0x793d2c67d00f9bbcull, 0x46ebe2309e5eff40ull,
+     0x2c382f5369614938ull, 0xdafe409ab72d6d10ull, 0xe8c83391b646f227ull, 0x45fe70f50524306cull},
+    {0x62f24920c8951491ull, 0x05f007c83f630ca2ull, 0x6fbb45d2f5c9d4b8ull, 0x16619f6db57a2245ull,
+     0xda4875a6960c0b8cull, 0x5b68d076ef0e2f20ull, 0x07fb51cf3d0b8fd4ull, 0x428d1623a0e392d4ull,
+     0x084f4a4401a308fdull, 0xa82219c376a5caacull, 0xdeb8de4643d1bc7dull, 0x1d81592d60bd38c6ull},
+  },
+  {
+    {0x8765b69f7b85c5e8ull, 0x6ff0678bd168bab2ull, 0x3a70e77c1d330f9bull, 0x3a5f6d51b0af8e7cull,
+     0x61368756a60dac5full, 0x17e02f6aebabdc57ull, 0x7f193f2d4cce0f7dull, 0x20234a7789ecdcf0ull,
+     0x76d20db67178b252ull, 0x071c34f9d51ed160ull, 0xf62a4a20b3e41170ull, 0x7cd682353cffe366ull},
+    {0xa665cd6068acf4f3ull, 0x42d92d183cd7e3d3ull, 0x5759389d336025d9ull, 0x3ef0253b2b2cd8ffull,
+     0x0be1a45bd887fab6ull, 0x2a846a32ba403b6eull, 0xd9921012e96e6000ull, 0x2838c8863bdc0943ull,
+     0xd16bb0cf4a465030ull, 0xfa496b4115c577abull, 0x82cfae8af4ab419dull, 0x21dcb8a606a82812ull},
+    {0x9a8d00fabe7731baull, 0x8203607e629e1889ull, 0xb2cc023743f3d97full, 0x5d840dbf6c6f678bull,
+     0x5c6004468c9d9fc8ull, 0x2540096ed42aa3cbull, 0x125b4d4c12ee2f9cull, 0x0bc3d08194a31dabull,
+     0x706e380d309fe18bull, 0x6eb02da6b9e165c7ull, 0x57bbba997dae20abull, 0x3a4276232ac196ddull},
+    {0x3bf8c172db447ecbull, 0x5fcfc41fc6282dbdull, 0x80acffc075aa15feull, 0x0770c9e824e1a9f9ull,
+     0x4b42432c8a7084faull, 0x898a19e3dfb9e545ull, 0xbe9f00219c58e45dull, 0x1ff177cea16debd1ull,
+     0xcf61d99a45b5b5fdull, 0x860984e91b3a7924ull, 0xe7300919303e3e89ull, 0x39f264fd41500b1eull},
+    {0xd19b4aabfe097be1ull, 0xa46dfce1dfe01929ull, 0xc3c908942ca6f1ffull, 0x65c621272c35f14eull,
+     0xa7ad3417dbe7e29cull, 0xbd94376a2b9c139cull, 0xa0e91b8e93597ba9ull, 0x1712d73468889840ull,
+     0xe72b89f8ce3193ddull, 0x4d103356a125c0bbull, 0x0419a93d2e1cfe83ull, 0x22f9800ab19ce272ull},
+    {0x42029fdd9a6efdacull, 0xb912cebe34a54941ull, 0x640f64b987bdf37bull, 0x4171a4d38598cab4ull,
+     0x605a368a3e9ef8cbull, 0xe3e9c022a5504715ull, 0x553d48b05f24248full, 0x13f416cd647626e5ull,
+     0xfa2758aa99c94c8cull, 0x23006f6fb000b807ull, 0xfbd291ddadda5392ull, 0x508214fa574bd1abull},
+    {0x461a15bb53d003d6ull, 0xb2102888bcf3c965ull, 0x27c576756c683a5aull, 0x3a7758a4c86cb447ull,
+     0xc20269153ed6fe4bull, 0xa65a6739511d77c4ull, 0xcbde26462c14af94ull, 0x22f960ec6faba74bull,
+     0x548111f693ae5076ull, 0x1dae21df1dfd54a6ull, 0x12248c90f3115e65ull, 0x5d9fd15f8de7f494ull},
+    {0x3f244d2aeed7521eull, 0x8e3a9028432e9615ull, 0xe164ba772e9c16d4ull, 0x3bc187fa47eb98d8ull,
+     0x031408d36d63727full, 0x6a379aefd7c7b533ull, 0xa9e18fc5ccaee24bull, 0x332f35914f8fbed3ull,
+     0x6d470115ea86c20cull, 0x998ab7cb6c46d125ull, 0xd77832b53a660188ull, 0x450d81ce906fba03ull},
+  },
+  {
+    {0xd074d8961cae743full, 0xf86d18f5ee1c63edull, 0x97bdc55be7f4ed29ull, 0x4cbad279663ab108ull,
+     0x6e7bb6a1a6205275ull, 0xaa4f21d7413c8e83ull, 0x6f56d155e88f5cb2ull, 0x2de25d4ba6345be1ull,
+     0x80d19024a0d71fcdull, 0xc525c20afb288af8ull, 0xb1a3974b5f3a6419ull, 0x7d7fbcefe2007233ull},
+    {0xcd7c5dc5f3c29094ull, 0xc781a29a2a9105abull, 0x80c61d36421c3058ull, 0x4f9cd196dcd8d4d7ull,
+     0xfaef1e6a266b2801ull, 0x866c68c4d5739f16ull, 0xf68a2fbc1b03762cull, 0x5975435e87b75a8dull,
+     0x199297d86a7b3768ull, 0xd0d058241ad17a63ull, 0xba029cad5c1c0c17ull, 0x7ccdd084387a0307ull},
+    {0x9b0c84186760cc93ull, 0xcdae007a1ab32a99ull, 0xa88dec86620bda18ull, 0x3593ca848190ca44ull,
+     0xdca6422c6d260417ull, 0xae153d50948240bdull, 0xa9c0c1b4fb68c677ull, 0x428bd0ed61d0cf53ull,
+     0x9213189a5e849aa7ull, 0xd4d8c33565d8facdull, 0x8c52545b53fdbbd1ull, 0x27398308da2d63e6ull},
+    {0xb9a10e4c0a702453ull, 0x0fa25866d57d1bdeull, 0xffb9d9b5cd27daf7ull, 0x572c2945492c33fdull,
+     0x42c38d28435ed413ull, 0xbd50f3603278ccc9ull, 0xbb07ab1a79da03efull, 0x269597aebe8c3355ull,
+     0xc77fc745d6cd30beull, 0xe4dfe8d3e3baaefbull, 0xa22c8830aa5dda0cull, 0x7f985498c05bca80ull},
+    {0xd35615520fbf6363ull, 0x08045a45cf4dfba6ull, 0xeec24fbc873fa0c2ull, 0x30f2653cd69b12e7ull,
+     0x3849ce889f0be117ull, 0x8005ad1b7b54a288ull, 0x3da3c39f23fc921cull, 0x76c2ec470a31f304ull,
+     0x8a08c938aac10c85ull, 0x46179b60db276bcbull, 0xa920c01e0e6fac70ull, 0x2f1273f1596473daull},
+    {0x30488bd755a70bc0ull, 0x06d6b5a4f1d442e7ull, 0xead1a69ebc596162ull, 0x38ac1997edc5f784ull,
+     0x4739fc7c8ae01e11ull, 0xfd5274904a6aab9full, 0x41d98a8287728f2eull, 0x5d9e572ad85b69f2ull,
+     0x0666b517a751b13bull, 0x747d06867e9b858cull, 0xacacc011454dde49ull, 0x22dfcd9cbfe9e69cull},
+    {0x56ec59b4103be0a1ull, 0x2ee3baecd259f969ull, 0x797cb29413f5cd32ull, 0x0fe9877824cde472ull,
+     0x8ddbd2e0c30d0cd9ull, 0xad8e665facbb4333ull, 0x8f6b258c322a961full, 0x6b2916c05448c1c7ull,
+     0x7edb34d10aba913bull, 0x4ea3cd822e6dac0eull, 0x66083dff6578f815ull, 0x4c303f307ff00a17ull},
+    {0x29fc03580dd94500ull, 0xecd27aa46fbbec93ull, 0x130a155fc2e2a7f8ull, 0x416b151ab706a1d5ull,
+     0xd30a3bd617b28c85ull, 0xc5d377b739773beaull, 0xc6c6e78c1e6a5cbfull, 0x0d61b8f78b2ab7c4ull,
+     0x56a8d7efe9c136b0ull, 0xbd07e5cd58e44b20ull, 0xafe62fda1b57e0abull, 0x191a2af74277e8d2ull},
+  },
+  {
+    {0x9fe62b434f460efbull, 0xded303d4a63607d6ull, 0xf052210eb7a0da24ull, 0x237e7dbe00545b93ull,
+     0xce16f74bc53c1431ull, 0x2b9725ce2072eddeull, 0xb8b9c36fb5b23ee7ull, 0x7e2e0e450b5cc908ull,
+     0x013575ed6701b430ull, 0x231094e69f0bfd10ull, 0x75320f1583e47f22ull, 0x71afa699b11155e3ull},
+    {0xea423c1c473b50d6ull, 0x51e87a1f3b38ef10ull, 0x9b84bf5fb2c9be95ull, 0x00731fbc78f89a1cull,
+     0x65ce6f9b3953b61dull, 0xc65839eaafa141e6ull, 0x0f435ffda9f759feull, 0x021142e9c2b1c28eull,
+     0xe430c71848f81880ull, 0xbf960c225ecec119ull, 0xb6dae0836bba15e3ull, 0x4c4d6f3347e15808ull},
+    {0x2f0cddfc988f1970ull, 0x6b916227b0b9f51bull, 0x6ec7b6c4779176beull, 0x38bf9500a88f9fa8ull,
+     0x18f7eccfc17d1fc9ull, 0x6c75f5a651403c14ull, 0xdbde712bf7ee0cdfull, 0x193fddaaa7e47a22ull,
+     0x1fd2c93c37e8876full, 0xa2f61e5a18d1462cull, 0x5080f58239241276ull, 0x6a6fb99ebf0d4969ull},
+    {0xeeb122b5b6e423c6ull, 0x939d7010f286ff8eull, 0x90a92a831dcf5d8cull, 0x136fda9f42c5eb10ull,
+     0x6a46c1bb560855ebull, 0x2416bb38f893f09dull, 0xd71d11378f71acc1ull, 0x75f76914a31896eaull,
+     0xf94cdfb1a305bdd1ull, 0x0f364b9d9ff82c08ull, 0x2a87d8a5c3bb588aull, 0x022183510be8dcbaull},
+    {0x9d5a710143307a7full, 0xb063de9ec47da45full, 0x22bbfe52be927ad3ull, 0x1387c441fd40426cull,
+     0x4af766385ead2d14ull, 0xa08ed880ca7c5830ull, 0x0d13a6e610211e3dull, 0x6a071ce17b806c03ull,
+     0xb5d3c3d187978af8ull, 0x722b5a3d7f0e4413ull, 0x0d7b4848bb477ca0ull, 0x3171b26aaf1edc92ull},
+    {0xa60db7d8b28a47d1ull, 0xa6bf14d61770a4f1ull, 0xd4a1f89353ddbd58ull, 0x6c514a63344243e9ull,
+     0xa92f319097564ca8ull, 0xff7bb84c2275e119ull, 0x4f55fe37a4875150ull, 0x221fd4873cf0835aull,
+     0x2322204f3a156341ull, 0xfb73e0e9ba0a032dull, 0xfce0dd4c410f030eull, 0x48daa596fb924aaaull},
+    {0x14f61d5dc84c9793ull, 0x9941f9e3ef418206ull, 0xcdf5b88f346277acull, 0x58c837fa0e8a79a9ull,
+     0x6eca8e665ca59cc7ull, 0xa847254b2e38aca0ull, 0x31afc708d21e17ceull, 0x676dd6fccad84af7ull,
+     0x0cf9688596fc9058ull, 0x1ddcbbf37b56a01bull, 0xdcc2e77d4935d66aull, 0x1c4f73f2c6a57f0aull},
+    {0xb36e706efc7c3484ull, 0x73dfc9b4c3c1cf61ull, 0xeb1d79c9781cc7e5ull, 0x70459adb7daf675cull,
+     0x0e7a4fbd305fa0bbull, 0x829d4ce054c663adull, 0xf421c3832fe33848ull, 0x795ac80d1bf64c42ull,
+     0x1b91db4991b42bb3ull, 0x572696234b02dccaull, 0x9fdf9ee51f8c78dcull, 0x5fe162848ce21fd3ull},
+  },
+  {
+    {0x2879852d5d7cb208ull, 0xb8dedd70687df2e7ull, 0xdc0bffab21687891ull, 0x2b44c043677daa35ull,
+     0x4e59214fe194961aull, 0x49be7dc70d71cd4full, 0x9300cfd23b50f22dull, 0x4789d446fc917232ull,
+     0x1a1c87ab074eb78eull, 0xfac6d18e99daf467ull, 0x3eacbbcd484f9067ull, 0x60c52eef2bb9a4e4ull},
+    {0x702bc5c27cae6d11ull, 0x44c7699b54a48cabull, 0xefbc4056ba492eb2ull, 0x70d77248d9b6676dull,
+     0x0b5d89bc3bfd8bf1ull, 0xb06b9237c9f3551aull, 0x0e4c16b0d53028f5ull, 0x10bc9c312ccfcaabull,
+     0xaa8ae84b3ec2a05bull, 0x98699ef4ed1781e0ull, 0x794513e4708e85d1ull, 0x63755bd3a976f413ull},
+    {0x3dc7101897f1acb7ull, 0x5dda7d5ec165bbd8ull, 0x508e5b9c0fa1020full, 0x2763751737c52a56ull,
+     0xb55fa03e2ad10853ull, 0x356f75909ee63569ull, 0x9ff9f1fdbe69b890ull, 0x0d8cc1c48bc16f84ull,
+     0x029402d36eb419a9ull, 0xf0b44e7e77b460a5ull, 0xcfa86230d43c4956ull, 0x70c2dd8a7ad166e7ull},
+    {0x91d4967db8ed7e13ull, 0x74252f0ad776817aull, 0xe40982e00d852564ull, 0x32b8613816a53ce5ull,
+     0x656194509f6fec0eull, 0xee2e7ea946c6518dull, 0x9733c1f367e09b5cull, 0x2e0fac6363948495ull,
+     0x79e7f7bee448cd64ull, 0x6ac83a67087886d0ull, 0xf89fd4d9a0e4db2eull, 0x4179215c735a4f41ull},
+    {0xe4ae33b9286bcd34ull, 0xb7ef7eb6559dd6dcull, 0x278b141fb3d38e1full, 0x31fa85662241c286ull,
+     0x8c7094e7d7dced2aull, 0x97fb8ac347d39c70ull, 0xe13be033a906d902ull, 0x700344a30cd99d76ull,
+     0xaf826c422e3622f4ull, 0xc12029879833502dull, 0x9bc1b7e12b389123ull, 0x24bb2312a9952489ull},
+    {0x41f80c2af5f85c6bull, 0x687284c304fa6794ull, 0x8945df99a3ba1badull, 0x0d1d2af9ffeb5d16ull,
+     0xb1a8ed1732de67c3ull, 0x3cb49418461b4948ull, 0x8ebd434376cfbcd2ull, 0x0fee3e871e188008ull,
+     0xa9da8aa132621edfull, 0x30b822a159226579ull, 0x4004197ba79ac193ull, 0x16acd79718531d76ull},
+    {0xc959c6c57887b6adull, 0x94e19ead5f90febaull, 0x16e24e62a342f504ull, 0x164ed34b18161700ull,
+     0x72df72af2d9b1d3dull, 0x63462a36a432245aull, 0x3ecea07916b39637ull, 0x123e0ef6b9302309ull,
+     0x487ed94c192fe69aull, 0x61ae2cea3a911513ull, 0x877bf6d3b9a4de27ull, 0x78da0fc61073f3ebull},
+    {0xa29f80f1680c3a94ull, 0x71f77e151ae9e7e6ull, 0x1100f15848017973ull, 0x054aa4b316b38dddull,
+     0x5bf15d28e52bc66aull, 0x2c47e31870f01a8eull, 0x2419afbc06c28bddull, 0x2d25deeb256b173aull,
+     0xdfc8468d19267cb8ull, 0x0b28789c66e54dafull, 0x2aeb1d2a666eec17ull, 0x134610a6ab7da760ull},
+  },
+  {
+    {0xcd2a65e777d1f515ull, 0x548991878faa60f1ull, 0xb1b73bbcdabc06e5ull, 0x654878cba97cc9fbull,
+     0x51138ec78df6b0feull, 0x5397da89e575f51bull, 0x09207a1d717af1b9ull, 0x2102fdba2b20d650ull,
+     0x969ee405055ce6a1ull, 0x36bca7681251ad29ull, 0x3a1af517aa7da415ull, 0x0ad725db29ecb2baull},
+    {0xfec7bc0c9b056f85ull, 0x537d5268e7f5ffd7ull, 0x77afc6624312aefaull, 0x4f675f5302399fd9ull,
+     0xdc4267b1834e2457ull, 0xb67544b570ce1bc5ull, 0x1af07a0bf7d15ed7ull, 0x4aefcffb71a03650ull,
+     0xc32d36360415171eull, 0xcd2bef118998483bull, 0x870a6eadd0945110ull, 0x0bccbb72a2a86561ull},
+    {0x186d5e4c50fe1296ull, 0xe0397b82fee89f7eull, 0x3bc7f6c5507031b0ull, 0x6678fd69108f37c2ull,
+     0x185e962feab1a9c8ull, 0x86e7e63565147dcdull, 0xb092e031bb5b6df2ull, 0x4024f0ab59d6b73eull,
+     0x1586fa31636863c2ull, 0x07f68c48572d33f2ull, 0x4f73cc9f789eaefcull, 0x2d42e2108ead4701ull},
+    {0x21717b0d0f537593ull, 0x914e690b131e064cull, 0x1bb687ae752ae09full, 0x420bf3a79b423c6eull,
+     0x97f5131594dfd29bull, 0x6155985d313f4c6aull, 0xeba13f0708455010ull, 0x676b2608b8d2d322ull,
+     0x8138ba651c5b2b47ull, 0x8671b6ec311b1b80ull, 0x7bff0cb1bc3135b0ull, 0x745d2ffa9c0cf1e0ull},
+    {0x6036df5721d34e6aull, 0xb1db8827997bb3d0ull, 0xd3c209c3c8756afaull, 0x06e15be54c1dc839ull,
+     0xbf525a1e2bc9c8bdull, 0xea5b260826479d81ull, 0xd511c70edf0155dbull, 0x1ae23ceb960cf5d0ull,
+     0x5b725d871932994aull, 0x32351cb5ceb1dab0ull, 0x7dc41549dab7ca05ull, 0x58ded861278ec1f7ull},
+    {0x2dfb5ba8b6c2c9a8ull, 0x48eeef8ef52c598cull, 0x33809107f12d1573ull, 0x08ba696b531d5bd8ull,
+     0xd8173793f266c55cull, 0xc8c976c5cc454e49ull, 0x5ce382f8bc26c3a8ull, 0x2ff39de85485f6f9ull,
+     0x77ed3eeec3efc57aull, 0x04e05517d4ff4811ull, 0xea3d7a3ff1a671cbull, 0x120633b4947cfe54ull},
+    {0x82bd31474912100aull, 0xde237b6d7e6fbe06ull, 0xe11e761911ea79c6ull, 0x07433be3cb393bdeull,
+     0x0b94987891610042ull, 0x4ee7b13cecebfae8ull, 0x70be739594f0a4c0ull, 0x35d30a99b4d59185ull,
+     0xff7944c05ce997f4ull, 0x575d3de4b05c51a3ull, 0x583381fd5a76847cull, 0x2d873ede7af6da9full},
+    {0xaa6202e14e5df981ull, 0xa20d59175015e1f5ull, 0x18a275d3bae21d6cull, 0x0543618a01600253ull,
+     0x157a316443373409ull, 0xfab8b7eef4aa81d9ull, 0xb093fee6f5a64806ull, 0x2e773654707fa7b6ull,
+     0x0deabdf4974c23c1ull, 0xaa6f0a259dce4693ull, 0x04202cb8a29aba2cull, 0x4b1443362d07960dull},
+  },
+  {
+    {0x967c54e91c529ccbull, 0x30f6269264c635fbull, 0x2747aff478121965ull, 0x17038418eaf66f5cull,
+     0xccc4b7c7b66e1f7aull, 0x44157e25f50c2f7eull, 0x3ef06dfc713eaf1cull, 0x582f446752da63f7ull,
+     0xc6317bd320324ce4ull, 0xa81042e8a4488bc4ull, 0xb21ef18b4e5a1364ull, 0x0c2a1c4bcda28dc9ull},
+    {0xedc4814869bd6945ull, 0x0d6d907dbe1c8d22ull, 0xc63bd212d55cc5abull, 0x5a6a9b30a314dc83ull,
+     0xd24dc7d06f1f0447ull, 0xb2269e3edb87c059ull, 0xd15b0272fbb2d28full, 0x7c558bd1c6f64877ull,
+     0xd0ec1524d396463dull, 0x12bb628ac35a24f0ull, 0xa50c3a791cbc5fa4ull, 0x0404a5ca0afbafc3ull},
+    {0x62bc9e1b2a416fd1ull, 0xb5c6f728e350598bull, 0x04343fd83d5d6967ull, 0x39527516e7f8ee98ull,
+     0x8c1f40070aa743d6ull, 0xccbad0cb5b265ee8ull, 0x574b046b668fd2deull, 0x46395bfdcadd9633ull,
+     0x117fdb2d1a5d9a9cull, 0x9c7745bcd1005c2aull, 0xefd4bef154d56feaull, 0x76579a29e822d016ull},
+    {0x333cb51352b434f2ull, 0xd832284993de80e1ull, 0xb5512887750d35ceull, 0x02c514bb2a2777c1ull,
+     0x45b68e7e49c02a17ull, 0x23cd51a2bca9a37full, 0x3ed65f11ec224c1bull, 0x43a384dc9e05bdb1ull,
+     0x684bd5da8bf1b645ull, 0xfb8bd37ef6b54b53ull, 0x313916d7a9b0d253ull, 0x1160920961548059ull},
+    {0x7a385616369b4dcdull, 0x75c02ca7655c3563ull, 0x7dc21bf9d4f18021ull, 0x2f637d7491e6e042ull,
+     0xb44d166929dacfaaull, 0xda529f4c8413598full, 0xe9ef63ca453d5559ull, 0x351e125bc5698e0bull,
+     0xd4b49b461af67bbeull, 0xd603037ac8ab8961ull, 0x71dee19ff9a699fbull, 0x7f182d06e7ce2a9aull},
+    {0x09454b728e217522ull, 0xaa58e8f4d484b8d8ull, 0xd358254d7f46903cull, 0x44acc043241c5217ull,
+     0x7a7c8e64ab0168ecull, 0xcb5a4a5515edc543ull, 0x095519d347cd0edaull, 0x67d4ac8c343e93b0ull,
+     0x1c7d6bbb4f7a5777ull, 0x8b35fed4918313e1ull, 0x4adca1c6c96b4684ull, 0x556d1c8312ad71bdull},
+    {0x81f06756b11be821ull, 0x0faff82310a3f3ddull, 0xf8b2d0556a99465dull, 0x097abe38cc8c7f05ull,
+     0x17ef40e30c8d3982ull, 0x31f7073e15a3fa34ull, 0x4f21f3cb0773646eull, 0x746c6c6d1d824effull,
+     0x0c49c9877ea52da4ull, 0x4c4369559bdc1d43ull, 0x022c3809f7ccebd2ull, 0x577e14a34bee84bdull},
+    {0x94fecebebd4dd72bull, 0xf46a4fda060f2211ull, 0x124a5977c0c8d1ffull, 0x705304b8fb009295ull,
+     0xf0e268ac61a73b0aull, 0xf2fafa103791a5f5ull, 0xc1e13e826b6d00e9ull, 0x60fa7ee96fd78f42ull,
+     0xb63d1d354d296ec6ull, 0xf3c3053e5fad31d8ull, 0x670b958cb4bd42ecull, 0x21398e0ca16353fdull},
+  },
+  {
+    {0x2798aaf9b4b75601ull, 0x5eac72135c8dad72ull, 0xd2ceaa6161b7a023ull, 0x1bbfb284e98f7d4eull,
+     0x89f5058a382b33f3ull, 0x5ae2ba0bad48c0b4ull, 0x8f93b503a53db36eull, 0x5aa3ed9d95a232e6ull,
+     0x656777e9c7d96561ull, 0xcb2b125472c78036ull, 0x65053299d9506eeeull, 0x4a07e14e5e8957ccull},
+    {0x240b58cdc477a49bull, 0xfd38dade6447f017ull, 0x19928d32a7c86aadull, 0x50af7aed84afa081ull,
+     0x4ee412cb980df999ull, 0xa315d76f3c6ec771ull, 0xbba5edde925c77fdull, 0x3f0bac391d313402ull,
+     0x6e4fde0115f65be5ull, 0x29982621216109b2ull, 0x780205810badd6d9ull, 0x1921a316baebd006ull},
+    {0xd75aad9ad9f3c18bull, 0x566a0eef60b1c19cull, 0x3e9a0bac255c0ed9ull, 0x7b049deca062c7f5ull,
+     0x89422f7edfb870fcull, 0x2c296beb4f76b3bdull, 0x0738f1d436c24df7ull, 0x6458df41e273aeb0ull,
+     0xdccbe37a35444483ull, 0x758879330fedbe93ull, 0x786004c312c5dd87ull, 0x6093dccbc2950e64ull},
+    {0x6bdeeebe6084034bull, 0x3199c2b6780fb854ull, 0x973376abb62d0695ull, 0x6e3180c98b647d90ull,
+     0x1ff39a8585e0706dull, 0x36d0a5d8b3e73933ull, 0x43b9f2e1718f453bull, 0x57d1ea084827a97cull,
+     0xee7ab6e7a128b071ull, 0xa4c1596d93a88baaull, 0xf7b4de82b2216130ull, 0x363e999ddd97bd18ull},
+    {0x2f1848dce24baec6ull, 0x769b7255babcaf60ull, 0x90cb3c6e3cefe931ull, 0x231f979bc6f9b355ull,
+     0x96a843c135ee1fc4ull, 0x976eb35508e4c8cfull, 0xb42f6801b58cd330ull, 0x48ee9b78693a052bull,
+     0x5c31de4bcc2af3c6ull, 0xb04bb030fe208d1full, 0xb78d7009c14fb466ull, 0x079bfa9b08792413ull},
+    {0xf3c9ed80a2d54245ull, 0x0aa08b7877f63952ull, 0xd76dac63d1085475ull, 0x1ef4fb159470636bull,
+     0xe3903a51da300df4ull, 0x843964233da95ab0ull, 0xed3cf12d0b356480ull, 0x038c77f684817194ull,
+     0x854e5ee65b167becull, 0x59590a4296d0cdc2ull, 0x72b2df3498102199ull, 0x575ee92a4a0bff56ull},
+    {0x5d46bc450aa4d801ull, 0xc3af1227a533b9d8ull, 0x389e3b262b8906c2ull, 0x200a1e7e382f581bull,
+     0xd4c080908a182fcfull, 0x30e170c299489dbdull, 0x05babd5752f733deull, 0x43d4e7112cd3fd00ull,
+     0x518db967eaf93ac5ull, 0x71bc989b056652c0ull, 0xfe2b85d9567197f5ull, 0x050eca52651e4e38ull},
+    {0x97ac397660e668eaull, 0x9b19bbfe153ab497ull, 0x4cb179b534eca79full, 0x6151c09fa131ae57ull,
+     0xc3431ade453f0c9cull, 0xe9f5045eff703b9bull, 0xfcd97ac9ed847b3dull, 0x4b0ee6c21c58f4c6ull,
+     0x3af55c0dfdf05d96ull, 0xdd262ee02ab4ee7aull, 0x11b2bb8712171709ull, 0x1fef24fa800f030bull},
+  },
+  {
+    {0x22d2aff530976b86ull, 0x8d90b806c2d24604ull, 0xdca1896c4de5bae5ull, 0x28005fe6c8340c17ull,
+     0x37d653fb1aa73196ull, 0x0f9495303fd76418ull, 0xad200b09fb3a17b2ull, 0x544d49292fc8613eull,
+     0x6aefba9f34528688ull, 0x5c1bff9425107da1ull, 0xf75bbbcd66d94b36ull, 0x72e472930f316dfaull},
+    {0x07f3f635d32a7627ull, 0x7aaa4d865f6566f0ull, 0x3c85e79728d04450ull, 0x1fee7f000fe06438ull,
+     0x2695208c9781084full, 0xb1502a0b23450ee1ull, 0xfd9daea603efde02ull, 0x5a9d2e8c2733a34cull,
+     0x765305da03dbf7e5ull, 0xa4daf2491434cdbdull, 0x7b4ad5cdd24a88ecull, 0x00f94051ee040543ull},
+    {0xd7ef93bb07af9753ull, 0x583ed0cf3db766a7ull, 0xce6998bf6e0b1ec5ull, 0x47b7ffd25dd40452ull,
+     0x8d356b23c3d330b2ull, 0xf21c8b9bb0471b06ull, 0xb36c316c6e42b83cull, 0x07d79c7e8beab10dull,
+     0x87fbfb9cbc08dd12ull, 0x8a066b3ae1eec29bull, 0x0d57242bdb1fc1bfull, 0x1c3520a35ea64bb6ull},
+    {0xcda86f40216bc059ull, 0x1fbb231d12bcd87eull, 0xb4956a9e17c70990ull, 0x38750c3b66d12e55ull,
+     0x80d253a6bccba34aull, 0x3e61c3a13838219bull, 0x90c3b6019882e396ull, 0x1c3d05775d0ee66full,
+     0x692ef1409422e51aull, 0xcbc0c73c2b5df671ull, 0x21014fe7744ce029ull, 0x0621e2c7d330487cull},
+    {0xb7ae1796b0dbf0f3ull, 0x54dfafb9e17ce196ull, 0x25923071e9aaa3b4ull, 0x5d8e589ca1002e9dull,
+     0xaf9860cc8259838dull, 0x90ea48c1c69f9adcull, 0x6526483765581e30ull, 0x0007d6097bd3a5bcull,
+     0xc0bf1d950842a94bull, 0xb2d3c363588f2e3eull, 0x0a961438bb51e2efull, 0x1583d7783c1cbf86ull},
+    {0x90034704cc9d28c7ull, 0x1d1b679ef72cc58full, 0x16e12b5fbe5b8726ull, 0x4958064e83c5580aull,
+     0xeceea2ef5da27ae1ull, 0x597c3a1455670174ull, 0xc9a62a126609167aull, 0x252a5f2e81ed8f70ull,
+     0x0d2894265066e80dull, 0xfcc3f785307c8c6bull, 0x1b53da780c1112fdull, 0x079c170bd843b388ull},
+    {0xcdd6cd50c0d5d056ull, 0x9af7686dbb03573bull, 0x3ca6723ff3c3ef48ull, 0x6768c0d7317b8accull,
+     0x0506ece464fa6fffull, 0xbee3431e6205e523ull, 0x3579422451b8ea42ull, 0x6dec05e34ac9fb00ull,
+     0x94b625e5f155c1b3ull, 0x417bf3a7997b7b91ull, 0xc22cbddc6d6b2600ull, 0x51445e14ddcd52f4ull},
+    {0x893147ab2bbea455ull, 0x8c53a24f92079129ull, 0x4b49f948be30f7a7ull, 0x12e990086e4fd43dull,
+     0x57502b4b3b144951ull, 0x8e67ff6b444bbcb3ull, 0xb8bd6927166385dbull, 0x13186f31e39295c8ull,
+     0xf10c96b37fdfbb2eull, 0x9f9a935e121ceaf9ull, 0xdf1136c43a5b983full, 0x77b2e3f05d3e99afull},
+  },
+  {
+    {0xd598639c12ddb0a4ull, 0xa5d19f30c024866bull, 0xd17c2f0358fce460ull, 0x07a195152e095e8aull,
+     0x296fa9c59c2ec4deull, 0xbc8b61bf4f84f3cbull, 0x1c7706d917a8f908ull, 0x63b795fc7ad3255dull,
+     0xa8368f02389e5fc8ull, 0x90433b02cf8de43bull, 0xafa1fd5dc5412643ull, 0x3e8fe83d032f0137ull},
+    {0x08704c8de8efd13cull, 0xdfc51a8e33e03731ull, 0xa59d5da51260cde3ull, 0x22d60899a6258c86ull,
+     0x2f8b15b90570a294ull, 0x94f2427067084549ull, 0xde1c5ae161bbfd84ull, 0x75ba3b797fac4007ull,
+     0x6239dbc070cdd196ull, 0x60fe8a8b6c7d8a9aull, 0xb38847bceb401260ull, 0x0904d07b87779e5eull},
+    {0xf4322d6648f940b9ull, 0x06952f0cbd2d0c39ull, 0x167697ada081f931ull, 0x6240aacebaf72a6cull,
+     0xb4ce1fd4ddba919cull, 0xcf31db3ec74c8daaull, 0x2c63cc63ad86cc51ull, 0x43e2143fbc1dde07ull,
+     0xf834749c5ba295a0ull, 0xd6947c5bca37d25aull, 0x66f13ba7e7c9316aull, 0x56bdaf238db40cacull},
+    {0x1310d36cc19d3bb2ull, 0x062a6bb7622386b9ull, 0x7c9b8591d7a14f5cull, 0x03aa31507e1e5754ull,
+     0x362ab9e3f53533ebull, 0x338568d56eb93d40ull, 0x9e0e14521d5a5572ull, 0x1d24a86d83741318ull,
+     0xf4ec7648ffd4ce1full, 0xe045eaf054ac8c1cull, 0x88d225821d09357cull, 0x43b261dc9aeb4859ull},
+    {0x19513d8b6c951364ull, 0x94fe7126000bf47bull, 0x028d10ddd54f9567ull, 0x02b4d5e242940964ull,
+     0xe55b1e1988bb79bbull, 0xa09ed07dc17a359dull, 0xb02c2ee2603dea33ull, 0x326055cf5b276bc2ull,
+     0xb4a155cb28d18df2ull, 0xeacc4646186ce508ull, 0xc49cf4936c824389ull, 0x27a6c809ae5d3410ull},
+    {0xcd2c270ac43d6954ull, 0xdd4a3e576a66cab2ull, 0x79fa592469d7036cull, 0x221503603d8c2599ull,
+     0x8ba6ebcd1f0db188ull, 0x37d3d73a675a5be8ull, 0xf22edfa315f5585aull, 0x2cb67174ff60a17eull,
+     0x59eecdf9390be1d0ull, 0xa9422044728ce3f1ull, 0x82891c667a94f0f4ull, 0x7b1df4b73890f436ull},
+    {0x5f2e221807f8f58cull, 0xe3555c9fd49409d4ull, 0xb2aaa88d1fb6a630ull, 0x68698245d352e03dull,
+     0xe492f2e0b3b2a224ull, 0x7c6c9e062b551160ull, 0x15eb8fe20d7f7b0eull, 0x61fcef2658fc5992ull,
+     0xdbb15d852a18187aull, 0xf3e4aad386ddacd7ull, 0x44bae2810ff6c482ull, 0x46cf4c473daf01cfull},
+    {0x213c6ea7f1498140ull, 0x7c1e7ef8392b4854ull, 0x2488c38c5629cebaull, 0x1065aae50d8cc5bbull,
+     0x426525ed9ec4e5f9ull, 0x0e5eda0116903303ull, 0x72b1a7f2cbe5cadcull, 0x29387bcd14eb5f40ull,
+     0x1c2c4525df200d57ull, 0x5c3b2dd6bfca674aull, 0x0a07e7b1e1834030ull, 0x69a198e64f1ce716ull},
+  },
+  {
+    {0xe1014434dcc5caedull, 0x47ed5d963c84fb33ull, 0x70019576ed86a0e7ull, 0x25b2697bd267f9e4ull,
+     0x9062b2e0d91a78bcull, 0x47c9889cc8509667ull, 0x9df54a66405070b8ull, 0x7369e6a92493a1bfull,
+     0x9d673ffb13986864ull, 0x3ca5fbd9415dc7b8ull, 0xe04ecc3bdf273b5eull, 0x1420683db54e4cd2ull},
+    {0x34eebb6fc1cc5ad0ull, 0x6a1b0ce99646ac8bull, 0xd3b0da49a66bde53ull, 0x31e83b4161d081c1ull,
+     0xb478bd1e249dd197ull, 0x620c35005e58c102ull, 0xfb02d32fccbaac5cull, 0x60b63bebf508a72dull,
+     0x97e8c7129e062b4full, 0x49e48f4f29320ad8ull, 0x5bece14b6f18683full, 0x55cf1eb62d550317ull},
+    {0x3076b5e37df58c52ull, 0xd73ab9dde799cc36ull, 0xbd831ce34913ee20ull, 0x1a56fbaa62ba0133ull,
+     0x5879101065c23d58ull, 0x8b9d086d5094819cull, 0xe2402fa912c55fa7ull, 0x669a6564570891d4ull,
+     0x943e6b505c9dc9ecull, 0x302557bba77c371aull, 0x9873ae5641347651ull, 0x13c4836799c58a5cull},
+    {0xc4dcfb6a5d8bd080ull, 0xdeebc4ec571a4842ull, 0xd4b2e883b8e55365ull, 0x50bdc87dc8e5b827ull,
+     0x423a5d465ab3e1b9ull, 0xfc13c187c7f13f61ull, 0x19f83664ecb5b9b6ull, 0x66f80c93a637b607ull,
+     0x606d37836edfe111ull, 0x32353e15f011abd9ull, 0x64b03ac325b73b96ull, 0x1dd56444725fd5aeull},
+    {0xc297e60008bac89aull, 0x7d4cea11eae1c3e0ull, 0xf3e38be19fe7977cull, 0x3a3a450f63a305cdull,
+     0x8fa47ff83362127dull, 0xbc9f6ac471cd7c15ull, 0x6e71454349220c8bull, 0x0e645912219f732eull,
+     0x078f2f31d8394627ull, 0x389d3183de94a510ull, 0xd1e36c6d17996f80ull, 0x318c8d9393a9a87bull},
+    {0x5d669e29ab1dd398ull, 0xfc921658342d9e3bull, 0x55851dfdf35973cdull, 0x509a41c325950af6ull,
+     0xf2745d032afffe19ull, 0x0c9f3c497f24db66ull, 0xbc98d3e3ba8598efull, 0x224c7c679a1d5314ull,
+     0xbdc06edca6f925e9ull, 0x793ef3f4641b1f33ull, 0x82ec12809d833e89ull, 0x05bff02328a11389ull},
+    {0x6881a0dd0dc512e4ull, 0x4fe70dc844a5fafeull, 0x1f748e6b8f4a5240ull, 0x576277cdee01a3eaull,
+     0x3632137023cae00bull, 0x544acf0ad1accf59ull, 0x96741049d21a1c88ull, 0x780b8cc3fa2a44a7ull,
+     0x1ef38abc234f305full, 0x9a577fbd1405de08ull, 0x5e82a51434e62a0dull, 0x5ff418726271b7a1ull},
+    {0xe5db47e813b69540ull, 0xf35d2a3b432610e1ull, 0xac1f26e938781276ull, 0x29d4db8ca0a0cb69ull,
+     0x398e080c1789db9dull, 0xa7602025f3e778f5ull, 0xfa98894c06bd035dull, 0x106a03dc25a966beull,
+     0xd9ad0aaf333353d0ull, 0x38669da5acd309e5ull, 0x3c57658ac888f7f0ull, 0x4ab38a51052cbefaull},
+  },
+  {
+    {0xd6cfd1ef5fddc09cull, 0xe82b3efdf7575dceull, 0x25d56b5d201634c2ull, 0x3041c6bb04ed2b9bull,
+     0xda7c2b256768d593ull, 0x98c1c0574422ca13ull, 0xf1a80bd5ca0ace1dull, 0x29cdd1adc088a690ull,
+     0x0ff2f2f9d956e148ull, 0xade797759f356b2eull, 0x1a4698bb5f6c025cull, 0x104bbd6814049a7bull},
+    {0xa95d9a5fd67ff163ull, 0xe92be69d4cc75681ull, 0xb7f8024cde20f257ull, 0x204f2a20fb072df5ull,
+     0x51f0fd3168f1ed67ull, 0x2c811dcdd86f3bc2ull, 0x44dc5c4304d2f2deull, 0x5be8cc57092a7149ull,
+     0xc8143b3d30ebb079ull, 0x7589155abd652e30ull, 0x653c3c318f6d5c31ull, 0x2570fb17c279161full},
+    {0x192ea9550bb8245aull, 0xc8e6fba88f9050d1ull, 0x7986ea2d88a4c935ull, 0x241c5f91de018668ull,
+     0x3efa367f2cb61575ull, 0xf5f96f761cd6026cull, 0xe8c7142a65b52562ull, 0x3dcb65ea53030acdull,
+     0x28d8172940de6caaull, 0x8fbf2cf022d9733aull, 0x16d7fcdd235b01d1ull, 0x08420edd5fcdf0e5ull},
+    {0x0358c34e04f410ceull, 0xb6135b5a276e0685ull, 0x5d9670c7ebb91521ull, 0x04d654f321db889cull,
+     0xcdff20ab8362fa4aull, 0x57e118d4e21a3e6eull, 0xe3179617fc39e62bull, 0x0d9a53efbc1769fdull,
+     0x5e7dc116ddbdb5d5ull, 0x2954deb68da5dd2dull, 0x1cb608173334a292ull, 0x4a7a4f2618991ad7ull},
+    {0x24c3b291af372a4bull, 0x93da8270718147f2ull, 0xdd84856486899ef2ull, 0x4a96314223e0ee33ull,
+     0xf4a718025fb15f95ull, 0x3df65f346b5c1b8full, 0xcdfcf08500e01112ull, 0x11b50c4cddd31848ull,
+     0xa6e8274408a4ffd6ull, 0x738e177e9c1576d9ull, 0x773348b63d02b3f2ull, 0x4f4bce4dce6bcc51ull},
+    {0x30e2616ec49d0b6full, 0xe456718fcaec2317ull, 0x48eb409bf26b4fa6ull, 0x3042cee561595f37ull,
+     0xa71fce5ae2242584ull, 0x26ea725692f58a9eull, 0xd21a09d71cea3cf4ull, 0x73fcdd14b71c01e6ull,
+     0x427e7079449bac41ull, 0x855ae36dbce2310aull, 0x4cae76215f841a7cull, 0x389e740c9a9ce1d6ull},
+    {0xc9bd78f6570eac28ull, 0xe55b0b3227919ce1ull, 0x65fc3eaba19b91edull, 0x25c425e5d6263690ull,
+     0x64fcb3ae34dcb9ceull, 0x97500323e348d0adull, 0x45b3f07d62c6381bull, 0x61545379465a6788ull,
+     0x3f3e06a6f1d7de6eull, 0x3ef976278e062308ull, 0x8c14f6264e8a6c77ull, 0x6539a08915484759ull},
+    {0xddc4dbd414bb4a19ull, 0x19b2bc3c98424f8eull, 0x48a89fd736ca7169ull, 0x0f65320ef019bd90ull,
+     0xe9d21f74c3d2f773ull, 0xc150544125c46845ull, 0x624e5ce8f9b99e33ull, 0x11c5e4aac5cd186cull,
+     0xd486d1b1cafde0c6ull, 0x4f3fe6e3163b5181ull, 0x59a8af0dfaf2939aull, 0x4cabc7bdec33072aull},
+  },
+  {
+    {0xc08f788f3f78d289ull, 0xfe30a72ca1404d9full, 0xf2778bfccf65cc9dull, 0x7ee498165acb2021ull,
+     0x239e9624089c0a2eull, 0xc748c4c03afe4738ull, 0x17dbed2a764fa12aull, 0x639b93f0321c8582ull,
+     0x7bd508e39111a1c3ull, 0x2b2b90d480907489ull, 0xe7d2aec2ae72fd19ull, 0x0edf493c85b602a6ull},
+    {0x6767c4d284764113ull, 0xa090403ff7f5f835ull, 0x1c8fcffacae6bedeull, 0x04c00c54d1dfa369ull,
+     0xaecc8158599b5a68ull, 0xea574f0febade20eull, 0x4fe41d7422b67f07ull, 0x403b92e3019d4fb4ull,
+     0x4dc22f818b465cf8ull, 0x71a0f35a1480eff8ull, 0xaee8bfad04c7d657ull, 0x355bb12ab26176f4ull},
+    {0xa301dac75a8c7318ull, 0xed90039db3ceaa11ull, 0x6f077cbf3bae3f2dull, 0x7518eaf8e052ad8eull,
+     0xa71e64cc7493bbf4ull, 0xe5bd84d9eca3b0c3ull, 0x0a6bc50cfa05e785ull, 0x0f9b8132182ec312ull,
+     0xa48859c41b7f6c32ull, 0x0f2d60bcf4383298ull, 0x1815a929c9b1d1d9ull, 0x47c3871bbb1755c4ull},
+    {0xfbe65d50c85066b0ull, 0x62ecc4b0b3a299b0ull, 0xe53754ea441ae8e0ull, 0x08fea02ce8d48d5full,
+     0x5144539771ec4f48ull, 0xf805b17dc98c5d6eull, 0xf762c11a47c3c66bull, 0x00b89b85764699dcull,
+     0x824ddd7668deead0ull, 0xc86445204b685d23ull, 0xb514cfcd5d89d665ull, 0x473829a74f75d537ull},
+    {0x23d9533aad3902c9ull, 0x64c2ddceef03588full, 0x15257390cfe12fb4ull, 0x6c668b4d44e4d390ull,
+     0x82d2da754679c418ull, 0xe63bd7d8b2618df0ull, 0x355eef24ac47eb0aull, 0x2078684c4833c6b4ull,
+     0x3b48cf217a78820cull, 0xf76a0ab281273e97ull, 0xa96c65a78c8eed7bull, 0x7411a6054f8a433full},
+    {0x579ae53d18b175b4ull, 0x68713159f392a102ull, 0x8455ecba1eef35f5ull, 0x1ec9a872458c398full,
+     0x4d659d32b99dc86dull, 0x044cdc75603af115ull, 0xb34c712cdcc2e488ull, 0x7c136574fb8134ffull,
+     0xb8e6a4d400a2509bull, 0x9b81d7020bc882b4ull, 0x57e7cc9bf1957561ull, 0x3add88a5c7cd6460ull},
+    {0x85c298d459393046ull, 0x8f7e35985ff659ecull, 0x1d2ca22af2f66e3aull, 0x61ba1131a406a720ull,
+     0xab895770b635dcf2ull, 0x02dfef6cf66c1fbcull, 0x85530268beb6d187ull, 0x249929fccc879e74ull,
+     0xa3d0a0f116959029ull, 0x023b6b6cba7ebd89ull, 0x7bf15a3e26783307ull, 0x5620310cbbd8ece7ull},
+    {0x6646b5f477e285d6ull, 0x40e8ff676c8f6193ull, 0xa6ec7311abb594ddull, 0x7ec846f3658cec4dull,
+     0x528993434934d643ull, 0xb9dbf806a51222f5ull, 0x8f6d878fc3f41c22ull, 0x37676a2a4d9d9730ull,
+     0x9b5e8f3f1da22ec7ull, 0x130f1d776c01cd13ull, 0x214c8fcfa2989fb8ull, 0x6daaf723399b9dd5ull},
+  },
+  {
+    {0x583b04bfacad8ea2ull, 0x29b743e8148be884ull, 0x2b1e583b0810c5dbull, 0x2b5449e58eb3bbaaull,
+     0x5f3a7562eb3dbe47ull, 0xf7ea38548ebda0b8ull, 0x00c3e53145747299ull, 0x1304e9e71627d551ull,
+     0x789814d26adc9cfeull, 0x3c1bab3f8b48dd0bull, 0xda0fe1fff979c60aull, 0x4468de2d7c2dd693ull},
+    {0x4b9ad8c6f86307ceull, 0x21113531435d0c28ull, 0xd4a866c5657a772cull, 0x5da6427e63247352ull,
+     0x51bb355e9419469eull, 0x33e6dc4c23ddc754ull, 0x93a5b6d6447f9962ull, 0x6cce7c6ffb44bd63ull,
+     0x1a94c688deac22caull, 0xb9066ef7bbae1ff8ull, 0x88ad8c388d59580full, 0x58f29abfe79f2ca8ull},
+    {0x4b5a64bf710ecdf6ull, 0xb14ce538462c293cull, 0x3643d056d50b3ab9ull, 0x6af93724185b4870ull,
+     0xe90ecfab8de73e68ull, 0x54036f9f377e76a5ull, 0xf0495b0bbe015982ull, 0x577629c4a7f41e36ull,
+     0x3220024509c6a888ull, 0xd2e036134b558973ull, 0x83e236233c33289full, 0x701f25bb0caec18full},
+    {0x9d18f6d97cbec113ull, 0x844a06e674bfdbe4ull, 0x20f5b522ac4e60d6ull, 0x720a5bc050955e51ull,
+     0xc3a8b0f8e4616cedull, 0xf700660e9e25a87dull, 0x61e3061ff4bca59cull, 0x2e0c92bfbdc40be9ull,
+     0x0c3f09439b805a35ull, 0xe84e8b376242abfcull, 0x691417f35c229346ull, 0x0e9b9cbb144ef0ecull},
+    {0x8dee9bd55db1beeeull, 0xc9c3ab370a723fb9ull, 0x44a8f1bf1c68d791ull, 0x366d44191cfd3cdeull,
+     0xfbbad48ffb5720adull, 0xee81916bdbf90d0eull, 0xd4813152635543bfull, 0x221104eb3f337bd8ull,
+     0x9e3c1743f2bc8c14ull, 0x2eda26fcb5856c3bull, 0xccb82f0e68a7fb97ull, 0x4167a4e6bc593244ull},
+    {0xc2be2665f8ce8feeull, 0xe967ff14e880d62cull, 0xf12e6e7e2f364eeeull, 0x34b33370cb7ed2f6ull,
+     0x643b9d2876f62700ull, 0x5d1d9d400e7668ebull, 0x1b4b430321fc0684ull, 0x7938bb7e2255246aull,
+     0xcdc591ee8681d6ccull, 0xce02109ced85a753ull, 0xed7485c158808883ull, 0x1176fc6e2dfe65e4ull},
+    {0xdb90e28949770eb8ull, 0x98fbcc2aacf440a3ull, 0x21354ffeded7879bull, 0x1f6a3e54f26906b6ull,
+     0xb4af6cd05b9c619bull, 0x2ddfc9f4b2a58480ull, 0x3d4fa502ebe94dc4ull, 0x08fc3a4c677d5f34ull,
+     0x60a4c199d30734eaull, 0x40c085b631165cd6ull, 0xe2333e23f7598295ull, 0x4f2fad0116b900d1ull},
+    {0x962cd91db73bb638ull, 0xe60577aafc129c08ull, 0x6f619b39f3b61689ull, 0x3451995f2944ee81ull,
+     0x44beb24194ae4e54ull, 0x5f541c511857ef6cull, 0xa61e6b2d368d0498ull, 0x445484a4972ef7abull,
+     0x9152fcd09fea7d7cull, 0x4a816c94b0935cf6ull, 0x258e9aaa47285c40ull, 0x10b89ca6042893b7ull},
+  },
+  {
+    {0x753941be5a45f06eull, 0xd07caeed6d9c5f65ull, 0x11776b9c72ff51b6ull, 0x17d2d1d9ef0d4da9ull,
+     0x3d5947499718289cull, 0x12ebf8c524533f26ull, 0x0262bfcb14c3ef15ull, 0x20b878d577b7518eull,
+     0x27f2af18073f3e6aull, 0xfd3fe519d7521069ull, 0x22e3b72c3ca60022ull, 0x72214f63cc65c6a7ull},
+    {0x1d9db7b9f43b29c9ull, 0xd605824a4f518f75ull, 0xf2c072bd312f9dc4ull, 0x1f24ac855a1545b0ull,
+     0xb4e37f405307a693ull, 0xaba714d72f336795ull, 0xd6fbd0a773761099ull, 0x5fdf48c58171cbc9ull,
+     0x24d608328e9505aaull, 0x4748c1d10c1420eeull, 0xc7ffe45c06fb25a2ull, 0x00ba739e2ae395e6ull},
+    {0xae4426f5ea88bb26ull, 0x360679d984973bfbull, 0x5c9f030c26694e50ull, 0x72297de7d518d226ull,
+     0x592e98de5c8790d6ull, 0xe5bfb7d345c2a2dfull, 0x115a3b60f9b49922ull, 0x03283a3e67ad78f3ull,
+     0x48241dc7be0cb939ull, 0x32f19b4d8b633080ull, 0xd3dfc90d02289308ull, 0x05e1296846271945ull},
+    {0xadbfbbc8242c4550ull, 0xbcc80cecd03081d9ull, 0x843566a6f5c8df92ull, 0x78cf25d38258ce4cull,
+     0xba82eeb32d9c495aull, 0xceefc8fcf12bb97cull, 0xb02dabae93b5d1e0ull, 0x39c00c9c13698d9bull,
+     0x15ae6b8e31489d68ull, 0xaa851cab9c2bf087ull, 0xc9a75a97f04efa05ull, 0x006b52076b3ff832ull},
+    {0xf5cb7e16b9ce082dull, 0x3407f14c417abc29ull, 0xd4b36bce2bf4a7abull, 0x7de2e9561a9f75ceull,
+     0x29e0cfe19d95781cull, 0xb681df18966310e2ull, 0x57df39d370516b39ull, 0x4d57e3443bc76122ull,
+     0xde70d4f4b6a55ecbull, 0x4801527f5d85db99ull, 0xdbc9c440d3ee9a81ull, 0x6b2a90af1a6029edull},
+    {0x77ebf3245bb2d80aull, 0xd8301b472fb9079bull, 0xc647e6f24cee7333ull, 0x465812c8276c2109ull,
+     0x6923f4fc9ae61e97ull, 0x5735281de03f5fd1ull, 0xa764ae43e6edd12dull, 0x5fd8f4e9d12d3e4aull,
+     0x4d43beb22a1062d9ull, 0x7065fb753831dc16ull, 0x180d4a7bde2968d7ull, 0x05b32c2b1cb16790ull},
+    {0xf7fca42c7ad58195ull, 0x3214286e4333f3ccull, 0xb6c29d0d340b979dull, 0x31771a48567307e1ull,
+     0xc8c05eccd24da8fdull, 0xa1cf1aac05dfef83ull, 0xdbbeeff27df9cd61ull, 0x3b5556a37b471e99ull,
+     0x32b0c524e14dd482ull, 0xedb351541a2ba4b6ull, 0xa3d16048282b5af3ull, 0x4fc079d27a7336ebull},
+    {0xdc348b440c86c50dull, 0x1337cbc9cc94e651ull, 0x6422f74d643e3cb9ull, 0x241170c2bae3cd08ull,
+     0x51c938b089bf2f7full, 0x2497bd6502dfe9a7ull, 0xffffc09c7880e453ull, 0x124567cecaf98e92ull,
+     0x3ff9ab860ac473b4ull, 0xf0911dee0113e435ull, 0x4ae75060ebc6c4afull, 0x3f8612966c87000dull},
+  },
+  {
+    {0x9c18fcfa36048d13ull, 0x29159db373899dddull, 0xdc9f350b9f92d0aaull, 0x26f57eee878a19d4ull,
+     0x559a0cc9782a0ddeull, 0x551dcdb2ea718385ull, 0x7f62865b31ef238cull, 0x504aa7767973613dull,
+     0x0cab2cd55687efb1ull, 0x5180d162247af17bull, 0x85c15a344f5a2467ull, 0x4041943d9dba3069ull},
+    {0x4b217743a26caaddull, 0x47a6b424648ab7ceull, 0xcb1d4f7a03fbc9e3ull, 0x12d931429800d019ull,
+     0xc3c0eeba43ebcc96ull, 0x8d749c9c26ea9cafull, 0xd9fa95ee1c77ccc6ull, 0x1420a1d97684340full,
+     0x00c67799d337594full, 0x5e3c5140b23aa47bull, 0x44182854e35ff395ull, 0x1b4f92314359a012ull},
+    {0x33cf3030a49866b1ull, 0x251f73d2215f4859ull, 0xab82aa4051def4f6ull, 0x5ff191d56f9a23f6ull,
+     0x3e5c109d89150951ull, 0x39cefa912de9696aull, 0x20eae43f975f3020ull, 0x239b572a7f132daeull,
+     0x819ed433ac2d9068ull, 0x2883ab795fc98523ull, 0xef4572805593eb3dull, 0x020c526a758f36cbull},
+    {0xe931ef59f042cc89ull, 0x2c589c9d8e124bb6ull, 0xadc8e18aaec75997ull, 0x452cfe0a5602c50cull,
+     0x779834f89ed8dbbcull, 0xc8f2aaf9dc7ca46cull, 0xa9524cdca3e1b074ull, 0x02aacc4615313877ull,
+     0x86a0f7a0647877dfull, 0xbbc464270e607c9full, 0xab17ea25f1fb11c9ull, 0x4cfb7d7b304b877bull},
+    {0xe28699c29789ef12ull, 0x2b6ecd71df57190dull, 0xc343c857ecc970d0ull, 0x5b1d4cbc434d3ac5ull,
+     0x72b43d6cb89b75feull, 0x54c694d99c6adc80ull, 0xb8c3aa373ee34c9full, 0x14b4622b39075364ull,
+     0xb6fb2615cc0a9f26ull, 0x3a4f0e2bb88dcce5ull, 0x1301498b3369a705ull, 0x2f98f71258592dd1ull},
+    {0x2e12ae444f54a701ull, 0xfcfe3ef0a9cbd7deull, 0xcebf890d75835de0ull, 0x1d8062e9e7614554ull,
+     0x0c94a74cb50f9e56ull, 0x5b1ff4a98e8e1320ull, 0x9a2acc2182300f67ull, 0x3a6ae249d806aaf9ull,
+     0x657ada85a9907c5aull, 0x1a0ea8b591b90f62ull, 0x8d0e1dfbdf34b4e9ull, 0x298b8ce8aef25ff3ull},
+    {0x837a72ea0a2165deull, 0x3fab07b40bcf79f6ull, 0x521636c77738ae70ull, 0x6ba6271803a7d7dcull,
+     0x2a927953eff70cb2ull, 0x4b89c92a79157076ull, 0x9418457a30a7cf6aull, 0x34b8a8404d5ce485ull,
+     0xc26eecb583693335ull, 0xd5a813df63b5fefdull, 0xa293aa9aa4b22573ull, 0x71d62bdd465e1c6aull},
+    {0xcd2db5dab1f75ef5ull, 0xd77f95cf16b065f5ull, 0x14571fea3f49f085ull, 0x1c333621262b2b3dull,
+     0x6533cc28d378df80ull, 0xf6db43790a0fa4b4ull, 0xe3645ff9f701da5aull, 0x74d5f317f3172ba4ull,
+     0xa86fe55467d9ca81ull, 0x398b7c752b298c37ull, 0xda6d0892e3ac623bull, 0x4aebcc4547e9d98cull},
+  },
+  {
+    {0x0b408d9e7354b610ull, 0x806b32535ba85b6eull, 0xdbe63a034a58a207ull, 0x173bd9ddc9a1df2cull,
+     0x12f0071b276d01c9ull, 0xe7b8bac586c48c70ull, 0x5308129b71d6fba9ull, 0x5d88fbf95a3db792ull,
+     0x2b500f1efe5872dfull, 0x58d6582ed43918c1ull, 0xe6ed278ec9673ae0ull, 0x06e1cd13b19ea319ull},
+    {0x472baf629e5b0353ull, 0x3baa0b90278d0447ull, 0x0c785f469643bf27ull, 0x7f3a6a1a8d837b13ull,
+     0x40d0ad516f166f23ull, 0x118e32931fab6abeull, 0x3fe35e14a04d088eull, 0x3080603526e16266ull,
+     0xf7e644395d3d800bull, 0x95a8d555c901edf6ull, 0x68cd7830592c6339ull, 0x30d0fded2e51307eull},
+    {0x9cb4971e68b84750ull, 0xa09572296664bbcfull, 0x5c8de72672fa412bull, 0x4615084351c589d9ull,
+     0xe0594d1af21233b3ull, 0x1bdbe78ef0cc4d9cull, 0x6965187f8f499a77ull, 0x0a9214202c099868ull,
+     0xbc9019c0aeb9a02eull, 0x55c7110d16034caeull, 0x0e6df501659932ecull, 0x3bca0d2895ca5dfeull},
+    {0x9c688eb69ecc01bfull, 0xf0bc83ada644896full, 0xca2d955f5f7a9fe2ull, 0x4ea8b4038df28241ull,
+     0x40f031bc3c5d62a4ull, 0x19fc8b3ecff07a60ull, 0x98183da2130fb545ull, 0x5631deddae8f13cdull,
+     0x2aed460af1cad202ull, 0x46305305a48cee83ull, 0x9121774549f11a5full, 0x24ce0930542ca463ull},
+    {0x3fcfa155fdf30b85ull, 0xd2f7168e36372ea4ull, 0xb2e064de6492f844ull, 0x549928a7324f4280ull,
+     0x1fe890f5fd06c106ull, 0xb5c468355d8810f2ull, 0x827808fe6e8caf3eull, 0x41d4e3c28a06d74bull,
+     0xf26e32a763ee1a2eull, 0xae91e4b7d25ffdeaull, 0xbc3bd33bd17f4d69ull, 0x491b66dec0dcff6aull},
+    {0x75f04a8ed0da64a1ull, 0xed222caf67e2284bull, 0x8234a3791f7b7ba4ull, 0x4cf6b8b0b7018b67ull,
+     0x98f5b13dc7ea32a7ull, 0xe3d5f8cc7e16db98ull, 0xac0abf52cbf8d947ull, 0x08f338d0c85ee4acull,
+     0xc383a821991a73bdull, 0xab27bc01df320c7aull, 0xc13d331b84777063ull, 0x530d4a82eb078a99ull},
+    {0x6d6973456c9abf9eull, 0x257fb2fc4900a880ull, 0x2bacf412c8cfb850ull, 0x0db3e7e00cbfbd5bull,
+     0x004c3630e1f94825ull, 0x7e2d78268cab535aull, 0xc7482323cc84ff8bull, 0x65ea753f101770b9ull,
+     0x3d66fc3ee2096363ull, 0x81d62c7f61b5cb6bull, 0x0fbe044213443b1aull, 0x02a4ec1921e1a1dbull},
+    {0xf5c86162f1cf795full, 0x118c861926ee57f2ull, 0x172124851c063578ull, 0x36d12b5dec067fcfull,
+     0x5ce6259a3b24b8a2ull, 0xb8577acc45afa0b8ull, 0xcccbe6e88ba07037ull, 0x3d143c51127809bfull,
+     0x126d279179154557ull, 0xd5e48f5cfc783a0aull, 0x36bdb6e8df179bacull, 0x2ef517885ba82859ull},
+  },
+  {
+    {0x96eebffb305b2f51ull, 0xd3f938ad889596b8ull, 0xf0f52dc746d5dd25ull, 0x57968290bb3a0095ull,
+     0x4637974e8c58aedcull, 0xb9ef22fbabf041a4ull, 0xe185d956e980718aull, 0x2f1b78fab143a8a6ull,
+     0xf71ab8430a20e101ull, 0xf393658d24f0ec47ull, 0xcf7509a86ee2eed1ull, 0x7dc43e35dc2aa3e1ull},
+    {0x5a782a5c273e9718ull, 0x3576c6995e4efd94ull, 0x0f2ed8051f237d3eull, 0x044fb81d82d50a99ull,
+     0x85966665887dd9c3ull, 0xc90f9b314bb05355ull, 0xc6e08df8ef2079b1ull, 0x7ef72016758cc12full,
+     0xc1df18c5a907e3d9ull, 0x57b3371dce4c6359ull, 0xca704534b201bb49ull, 0x7f79823f9c30dd2eull},
+    {0x6a9c1ff068f587baull, 0x0827894e0050c8deull, 0x3cbf99557ded5be7ull, 0x64a9b0431c06d6f0ull,
+     0x8334d239a3b513e8ull, 0xc13670d4b91fa8d8ull, 0x12b54136f590bd33ull, 0x0a4e0373d784d9b4ull,
+     0x2eb3d6a15b7d2919ull, 0xb0b4f6a0d53a8235ull, 0x7156ce4389a45d47ull, 0x071a7d0ace18346cull},
+    {0xcc0c355220e14431ull, 0x0d65950709b15141ull, 0x9af5621b209d5f36ull, 0x7c69bcf7617755d3ull,
+     0xd3072daac887ba0bull, 0x01262905bfa562eeull, 0xcf543002c0ef768bull, 0x2c3bcc7146ea7e9cull,
+     0x07f0d7eb04e8295full, 0x10db18252f50f37dull, 0xe951a9a3171798d7ull, 0x6f5a9a7322aca51dull},
+    {0xe729d4eba3d944beull, 0x8d9e09408078af9eull, 0x4525567a47869c03ull, 0x02ab9680ee8d3b24ull,
+     0x8ba1000c2f41c6c5ull, 0xc49f79c10cfefb9bull, 0x4efa47703cc51c9full, 0x494e21a2e147afcaull,
+     0xefa48a85dde50d9aull, 0x219a224e0fb9a249ull, 0xfa091f1dd91ef6d9ull, 0x6b5d76cbea46bb34ull},
+    {0xe0f941171e782522ull, 0xf1e6ae74036936d3ull, 0x408b3ea2d0fcc746ull, 0x16fb869c03dd313eull,
+     0x8857556cec0cd994ull, 0x6472dc6f5cd01dbaull, 0xaf0169148f42b477ull, 0x0ae333f685277354ull,
+     0x288e199733b60962ull, 0x24fc72b4d8abe133ull, 0x4811f7ed0991d03eull, 0x3f81e38b8f70d075ull},
+    {0x0adb7f355f17c824ull, 0x74b923c3d74299a4ull, 0xd57c3e8bcbf8eaf7ull, 0x0ad3e2d34cdedc3dull,
+     0x7f910fcc7ed9affeull, 0x545cb8a12465874bull, 0xa8397ed24b0c4704ull, 0x50510fc104f50993ull,
+     0x6f0c0fc5336e249dull, 0x745ede19c331cfd9ull, 0xf2d6fd0009eefe1cull, 0x127c158bf0fa1ebeull},
+    {0xdea28fc4ae51b974ull, 0x1d9973d3744dfe96ull, 0x6240680b873848a8ull, 0x4ed82479d167df95ull,
+     0xf6197c422e9879a2ull, 0xa44addd452ca3647ull, 0x9b413fc14b4eaccbull, 0x354ef87d07ef4f68ull,
+     0xfee3b52260c5d975ull, 0x50352efceb41b0b8ull, 0x8808ac30a9f6653cull, 0x302d92d20539236dull},
+  },
+  {
+    {0x2dbc6fb6e4e0f177ull, 0x04e1bf29a4bd6a93ull, 0x5e1966d4787af6e8ull, 0x0edc5f5eb426d060ull,
+     0x7813c1a2bca4283dull, 0xed62f091a1863dd9ull, 0xaec7bcb8c268fa86ull, 0x10e5d3b76f1cae4cull,
+     0x5453bfd653da8e67ull, 0xe9dc1eec24a9f641ull, 0xbf87263b03578a23ull, 0x45b46c51361cba72ull},
+    {0xce9d4ddd8a7fe3e4ull, 0xab13645676620e30ull, 0x4b594f7bb30e9958ull, 0x5c1c0aef321229dfull,
+     0xa9402abf314f7fa1ull, 0xe257f1dc8e8cf450ull, 0x1dbbd54b23a8be84ull, 0x2177bfa36dcb713bull,
+     0x37081bbcfa79db8full, 0x6048811ec25f59b3ull, 0x087a76659c832487ull, 0x4ae619387d8ab5bbull},
+    {0x61117e44985bfb83ull, 0xfce0462a71963136ull, 0x83ac3448d425904bull, 0x75685abe5ba43d64ull,
+     0x8ddbf6aa5344a32eull, 0x7d88eab4b41b4078ull, 0x5eb0eb974a130d60ull, 0x1a00d91b17bf3e03ull,
+     0x6e960933eb61f2b2ull, 0x543d0fa8c9ff4952ull, 0xdf7275107af66569ull, 0x135529b623b0e6aaull},
+    {0xf5c716bce22e83feull, 0xb42beb19e80985c1ull, 0xec9da63714254aaeull, 0x5972ea051590a613ull,
+     0x18f0dbd7add1d518ull, 0x979f7888cfc11f11ull, 0x8732e1f07114759bull, 0x79b5b81a65ca3a01ull,
+     0x0fd4ac20dc8f7811ull, 0x9a9ad294ac4d4fa8ull, 0xc01b2d64b3360434ull, 0x4f7e9c95905f3bdbull},
+    {0x71c8443d355299feull, 0x8bcd3b1cdbebead7ull, 0x8092499ef1a49466ull, 0x1942eec4a144adc8ull,
+     0x62674bbc5781302eull, 0xd8520f3989addc0full, 0x8c2999ae53fbd9c6ull, 0x31993ad92e638e4cull,
+     0x7dac5319ae234992ull, 0x2c1b3d910cea3e92ull, 0x553ce494253c1122ull, 0x2a0a65314ef9ca75ull},
+    {0xcf361acd3c1c793aull, 0x2f9ebcac5a35bc3bull, 0x60e860e9a8cda6abull, 0x055dc39b6dea1a13ull,
+     0x2db7937ff7f927c2ull, 0xdb741f0617d0a635ull, 0x5982f3a21155af76ull, 0x4cf6e218647c2dedull,
+     0xb119227cc28d5bb6ull, 0x07e24ebc774dffabull, 0xa83c78cee4a32c89ull, 0x121a307710aa24b6ull},
+    {0xd659713ec77483c9ull, 0x88bfe077b82b96afull, 0x289e28231097bcd3ull, 0x527bb94a6ced3a9bull,
+     0xe4db5d5e9f034a97ull, 0xe153fc093034bc2dull, 0x460546919551d3b1ull, 0x333fc76c7a40e52dull,
+     0x563d992a995b482eull, 0x3405d07c6e383801ull, 0x485035de2f64d8e5ull, 0x6b89069b20a7a9f7ull},
+    {0x4082fa8cb5c7db77ull, 0x068686f8c734c155ull, 0x29e6c8d9f6e7a57eull, 0x0473d308a7639bcfull,
+     0x812aa0416270220dull, 0x995a89faf9245b4eull, 0xffadc4ce5072ef05ull, 0x23bc2103aa73eb73ull,
+     0xcaee792603589e05ull, 0x2b4b421246dcc492ull, 0x02a1ef74e601a94full, 0x102f73bfde04341aull},
+  },
+  {
+    {0xa2b4dae0b5511c9aull, 0x7ac860292bffff06ull, 0x981f375df5504234ull, 0x3f6bd725da4ea12dull,
+     0xeb18b9ab7f5745c6ull, 0x023a8aee5787c690ull, 0xb72712da2df7afa9ull, 0x36597d25ea5c013dull,
+     0x734d8d7b106058acull, 0xd940579e6fc6905full, 0x6466f8f99202932dull, 0x7b7ecc19da60d6d0ull},
+    {0x6dae4a51a77cfa9bull, 0x82263654e7a38650ull, 0x09bbffcd8f2d82dbull, 0x03bedc661bf5cabaull,
+     0x78c2373c695c690dull, 0xdd252e660642906eull, 0x951d44444ae12bd2ull, 0x4235ad7601743956ull,
+     0x6258cb0d078975f5ull, 0x492942549189f298ull, 0xa0cab423e2e36ee4ull, 0x0e7ce2b0cdf066a1ull},
+    {0xfea6fedfd94b70f9ull, 0xf130c051c1fcba2dull, 0x4882d47e7f2fab89ull, 0x615256138aeceeb5ull,
+     0xc494643ac48c85a3ull, 0xfd361df43c6139adull, 0x09db17dd3ae94d48ull, 0x666e0a5d8fb4674aull,
+     0x2abbf64e4870cb0dull, 0xcd65bcf0aa458b6bull, 0x9abe4eba75e8985dull, 0x7f0bc810d514dee4ull},
+    {0x83ac9dad737213a0ull, 0x9ff6f8ba2ef72e98ull, 0x311e2edd43ec6957ull, 0x1d3a907ddec5ab75ull,
+     0xb9006ba426f4136full, 0x8d67369e57e03035ull, 0xcbc8dfd94f463c28ull, 0x0d1f8dbcf8eedbf5ull,
+     0xba1693313ed081dcull, 0x29329fad851b3480ull, 0x0128013c030321cbull, 0x00011b44a31bfde3ull},
+    {0x16561f696a0aa75cull, 0xc1bf725c5852bd6aull, 0x11a8dd7f9a7966adull, 0x63d988a2d2851026ull,
+     0x3fdfa06c3fc66c0cull, 0x5d40e38e4dd60dd2ull, 0x7ae38b38268e4d71ull, 0x3ac48d916e8357e1ull,
+     0x00120753afbd232eull, 0xe92bceb8fdd8f683ull, 0xf81669b384e72b91ull, 0x33fad52b2368a066ull},
+    {0x8d2cc8d0c422cfe8ull, 0x072b4f7b05a13acbull, 0xa3feb6e6ecf6a56full, 0x3cc355ccb90a71e2ull,
+     0x540649c6c5e41e16ull, 0x0af86430333f7735ull, 0xb2acfcd2f305e746ull, 0x16c0f429a256dca7ull,
+     0xe9b69443903e9131ull, 0xb8a494cb7a5637ceull, 0xc87cd1a4baba9244ull, 0x631eaf426bae7568ull},
+    {0x47d975b9a3700de8ull, 0x7280c5fbe2f80552ull, 0x53658f2732e45de1ull, 0x431f2c7f665f80b5ull,
+     0xb3e90410da66fe9full, 0x85dd4b526c16e5a6ull, 0xbc3d97611ef9bf83ull, 0x5599648b1ea919b5ull,
+     0xd6026344858f7b19ull, 0x14ab352fa1ea514aull, 0x8900441a2090a9d7ull, 0x7b04715f91253b26ull},
+    {0xb376c280c4e6bac6ull, 0x970ed3dd6d1d9b0bull, 0xb09a9558450bf944ull, 0x48d0acfa57cde223ull,
+     0x83edbd28acf6ae43ull, 0x86357c8b7d5c7ab4ull, 0xc0404769b7eb2c44ull, 0x59b37bf5c2f6583full,
+     0xb60f26e47dabe671ull, 0xf1d1a197622f3a37ull, 0x4208ce7ee9960394ull, 0x16234191336d3bdbull},
+  },
+  {
+    {0xdd499cd61ff38640ull, 0x29cd9bc3063625a0ull, 0x51e2d8023dd73dc3ull, 0x4a25707a203b9231ull,
+     0xb9e499def6267ff6ull, 0x7772ca7b742c0843ull, 0x23a0153fe9a4f2b1ull, 0x2cdfdfecd5d05006ull,
+     0x2ab7668a53f6ed6aull, 0x304242581dd170a1ull, 0x4000144c3ae20161ull, 0x5721896d248e49fcull},
+    {0x285d5091a1d0da4eull, 0x4baa6fa7b5fe3e08ull, 0x63e5177ce19393b3ull, 0x03c935afc4b030fdull,
+     0x0b6e5517fd181baeull, 0x9022629f2bb963b4ull, 0x5509bce932064625ull, 0x578edd74f63c13daull,
+     0x997276c6492b0c3dull, 0x47ccc2c4dfe205fcull, 0xdcd29b84dd623a3cull, 0x3ec2ab590288c7a2ull},
+    {0xa7213a09ae32d1cbull, 0x0f2b87df40f5c2d5ull, 0x0baea4c6e81eab29ull, 0x0e1bf66c6adbac5eull,
+     0xa1a0d27be4d87bb9ull, 0xa98b4deb61391aedull, 0x99a0ddd073cb9b83ull, 0x2dd5c25a200fcaceull,
+     0xe2abd5e9792c887eull, 0x1a020018cb926d5dull, 0xbfba69cdbaae5f1eull, 0x730548b35ae88f5full},
+    {0x805b094ba1d6e334ull, 0xbf3ef17709353f19ull, 0x423f06cb0622702bull, 0x585a2277d87845ddull,
+     0xc43551a3cba8b8eeull, 0x65a26f1db2115f16ull, 0x760f4f52ab8c3850ull, 0x3043443b411db8caull,
+     0xa18a5f8233d48962ull, 0x6698c4b5ec78257full, 0xa78e6fa5373e41ffull, 0x7656278950ef981full},
+    {0xe17073a3ea86cf9dull, 0x3a8cfbb707155fdcull, 0x4853e7fc31838a8eull, 0x28bbf484b613f616ull,
+     0x38c3cf59d51fc8c0ull, 0x9bedd2fd0506b6f2ull, 0x26bf109fab570e8full, 0x3f4160a8c1b846a6ull,
+     0xf2612f5c6f136c7cull, 0xafead107f6dd11beull, 0x527e9ad213de6f33ull, 0x1e79cb358188f75dull},
+    {0x77e953d8f5e08181ull, 0x84a50c44299dded9ull, 0xdc6c2d0c864525e5ull, 0x478ab52d39d1f2f4ull,
+     0x013436c3eef7e3f1ull, 0x828b6a7ffe9e10f8ull, 0x7ff908e5bcf9defcull, 0x65d7951b3a3b3831ull,
+     0x66a6a4d39252d159ull, 0xe5dde1bc871ac807ull, 0xb82c6b40a6c1c96full, 0x16d87a411a212214ull},
+    {0xfba4d5e2d54e0583ull, 0xe21fafd72ebd99faull, 0x497ac2736ee9778full, 0x1f990b577a5a6ddeull,
+     0xb3bd7e5a42066215ull, 0x879be3cd0c5a24c1ull, 0x57c05db1d6f994b7ull, 0x28f87c8165f38ca6ull,
+     0xa3344ead1be8f7d6ull, 0x7d1e50ebacea798full, 0x77c6569e520de052ull, 0x45882fe1534d6d3eull},
+    {0xd8ac9929943c6fe4ull, 0xb5f9f161a38392a2ull, 0x2699db13bec89af3ull, 0x7dcf843ce405f074ull,
+     0x6669345d757983d6ull, 0x62b6ed1117aa11a6ull, 0x7ddd1857985e128full, 0x688fe5b8f626f6ddull,
+     0x6c90d6484a4732c0ull, 0xd52143fdca563299ull, 0xb3be28c3915dc6e1ull, 0x6739687e7327191bull},
+  },
+  {
+    {0xa66dcc9dc80c1ac0ull, 0x97a05cf41b38a436ull, 0xa7ebf3be95dbd7c6ull, 0x7da0b8f68d7e7dabull,
+     0xef782014385675a6ull, 0xa2649f30aafda9e8ull, 0x4cd1eb505cdfa8cbull, 0x46115aba1d4dc0b3ull,
+     0xd40f1953c3b5da76ull, 0x1dac6f7321119e9bull, 0x03cc6021feb25960ull, 0x5a5f887e83674b4bull},
+    {0x9e9628d3a0a643b9ull, 0xb5c3cb00e6c32064ull, 0x9b5302897c2dec32ull, 0x43e37ae2d5d1c70cull,
+     0x8f6301cf70a13d11ull, 0xcfceb815350dd0c4ull, 0xf70297d4a4bca47eull, 0x3669b656e44d1434ull,
+     0x387e3f06eda6e133ull, 0x67301d5199a13ac0ull, 0xbd5ad8f836263811ull, 0x6a21e6cd4fd5e9beull},
+    {0xef4129126699b2e3ull, 0x71d30847708d1301ull, 0x325432d01182b0bdull, 0x45371b07001e8b36ull,
+     0xf1c6170a3046e65full, 0x58712a2a00d23524ull, 0x69dbbd3c8c82b755ull, 0x586bf9f1a195ff57ull,
+     0xa6db088d5ef8790bull, 0x5278f0dc610937e5ull, 0xac0349d261a16eb8ull, 0x0eafb03790e52179ull},
+    {0x5140805e0f75ae1dull, 0xec02fbe32662cc30ull, 0x2cebdf1eea92396dull, 0x44ae3344c5435bb3ull,
+     0x960555c13748042full, 0x219a41e6820baa11ull, 0x1c81f73873486d0cull, 0x309acc675a02c661ull,
+     0x9cf289b9bba543eeull, 0xf3760e9d5ac97142ull, 0x1d82e5c64f9360aaull, 0x62d5221b7f94678full},
+    {0x7585d4263af77a3cull, 0xdfae7b11fee9144dull, 0xa506708059f7193dull, 0x14f29a5383922037ull,
+     0x524c299c18d0936dull, 0xc86bb56c8a0c1a0cull, 0xa375052edb4a8631ull, 0x5c0efde4bc754562ull,
+     0xdf717edc25b2d7f5ull, 0x21f970db99b53040ull, 0xda9234b7c3ed4c62ull, 0x5e72365c7bee093eull},
+    {0x7d9339062f08b33eull, 0x5b9659e5df9f32beull, 0xacff3dad1f9ebdfdull, 0x70b20555cb7349b7ull,
+     0x575bfc074571217full, 0x3779675d0694d95bull, 0x9a0a37bbf4191e33ull, 0x77f1104c47b4eabcull,
+     0xbe5113c555112c4cull, 0x6688423a9a881fcdull, 0x446677855e503b47ull, 0x0e34398f4a06404aull},
+    {0x18930b093e4b1928ull, 0x7de3e10e73f3f640ull, 0xf43217da73395d6full, 0x6f8aded6ca379c3eull,
+     0xb67d22d93ecebde8ull, 0x09b3e84127822f07ull, 0x743fa61fb05b6d8dull, 0x5e5405368a362372ull,
+     0xe340123dfdb7b29aull, 0x487b97e1a21ab291ull, 0xf9967d02fde6949eull, 0x780de72ec8d3de97ull},
+    {0x671feaf300f42772ull, 0x8f72eb2a2a8c41aaull, 0x29a17fd797373292ull, 0x1defc6ad32b587a6ull,
+     0x0ae28545089ae7bcull, 0x388ddecf1c7f4d06ull, 0x38ac15510a4811b8ull, 0x0eb28bf671928ce4ull,
+     0xaf5bbe1aef5195a7ull, 0x148c1277917b15edull, 0x2991f7fb7ae5da2eull, 0x467d201bf8dd2867ull},
+  },
+  {
+    {0xbc1ef4bd567ae7a9ull, 0x3f624cb2d64498bdull, 0xe41064d22c1f4ec8ull, 0x2ef9c5a5ba384001ull,
+     0x95fe919a74ef4fadull, 0x3a827becf6a308a2ull, 0x964e01d309a47b01ull, 0x71c43c4f5ba3c797ull,
+     0xb6fd6df6fa9e74cdull, 0xf18278bce4af267aull, 0x8255b3d0f1ef990eull, 0x5a758ca390c5f293ull},
+    {0x8ce0918b1d61dc94ull, 0x8ded36469a813066ull, 0xd4e6a829afe8aad3ull, 0x0a738027f639d43full,
+     0xa2b72710d9462495ull, 0x3aa8c6d2d57d5003ull, 0xe3d400bfa0b487caull, 0x2dbae244b3eb72ecull,
+     0x980f4a2f57ffe1ccull, 0x00670d0de1839843ull, 0x105c3f4a49fb15fdull, 0x2698ca635126a69cull},
+    {0x2e3d702f5e3dd90eull, 0x9e3f0918e4d25386ull, 0x5e773ef6024da96aull, 0x3c004b0c4afa3332ull,
+     0xe765318832b0ba78ull, 0x381831f7925cff8bull, 0x08a81b91a0291fccull, 0x1fb43dcc49caeb07ull,
+     0x9aa946ac06f4b82bull, 0x1ca284a5a806c4f3ull, 0x3ed3265fc6cd4787ull, 0x6b43fd01cd1fd217ull},
+    {0xb5c742583e760ef3ull, 0x75dc52b9ee0ab990ull, 0xbf1427c2072b923full, 0x73420b2d6ff0d9f0ull,
+     0xc7a75d4b4697c544ull, 0x15fdf848df0fffbfull, 0x2868b9ebaa46785aull, 0x5a68d7105b52f714ull,
+     0xaf2cf6cb9e851e06ull, 0x8f593913c62238c4ull, 0xda8ab89699fbf373ull, 0x3db5632fea34bc9eull},
+    {0x2e4990b1829825d5ull, 0xedeaeb873e9a8991ull, 0xeef03d394c704af8ull, 0x59197ea495df2b0eull,
+     0xf46eee2bf75dd9d8ull, 0x0d17b1f6396759a5ull, 0x1bf2d131499e7273ull, 0x04321adf49d75f13ull,
+     0x04e16019e4e55aaeull, 0xe77b437a7e2f92e9ull, 0xc7ce2dc16f159aa4ull, 0x45eafdc1f4d70cc0ull},
+    {0xb60e4624cfccb1edull, 0x59dbc292bd5c0395ull, 0x31a09d1ddc0481c9ull, 0x3f73ceea5d56d940ull,
+     0x698401858045d72bull, 0x4c22faa2cf2f0651ull, 0x941a36656b222dc6ull, 0x5a5eebc80362dadeull,
+     0xb7a7bfd10a4e8dc6ull, 0xbe57007e44c9b339ull, 0x60c1207f1557aefaull, 0x26058891266218dbull},
+    {0x4c818e3cc676e542ull, 0x5e422c9303ceccadull, 0xec07cccab4129f08ull, 0x0dedfa10b24443b8ull,
+     0x59f704a68360ff04ull, 0xc3d93fde7661e6f4ull, 0x831b2a7312873551ull, 0x54ad0c2e4e615d57ull,
+     0xee3b67d5b82b522aull, 0x36f163469fa5c1ebull, 0xa5b4d2f26ec19fd3ull, 0x62ecb2baa77a9408ull},
+    {0x92072836afb62874ull, 0x5fcd5e8579e104a5ull, 0x5aad01adc630a14aull, 0x61913d5075663f98ull,
+     0xe5ed795261152b3dull, 0x4962357d0eddd7d1ull, 0x7482c8d0b96b4c71ull, 0x2e59f919a966d8beull,
+     0x0dc62d361a3231daull, 0xfa47583294200270ull, 0x02d801513f9594ceull, 0x3ddbc2a131c05d5cull},
+  },
+  {
+    {0xf3aa57a22796bb14ull, 0x883abab79b07da21ull, 0xe54be21831a0391cull, 0x5ee7fb38d83205f9ull,
+     0x9adc0ff9ce5ec54bull, 0x039c2a6b8c2f130dull, 0x028007c7f0f89515ull, 0x78968314ac04b36bull,
+     0x538dfdcb41446a8eull, 0xa5acfda9434937f9ull, 0x46af908d263c8c78ull, 0x61d0633c9bca0d09ull},
+    {0xada328bcf8fc73dfull, 0xee84695da6f037fcull, 0x637fb4db38c2a909ull, 0x5b23ac2df8067bdcull,
+     0x63744935ffdb2566ull, 0xc5bd6b89780b68bbull, 0x6f1b3280553eec03ull, 0x6e965fd847aed7f5ull,
+     0x9ad2b953ee80527bull, 0xe88f19aafade6d8dull, 0x0e711704150e82cfull, 0x79b9bbb9dd95dedcull},
+    {0xd1997dae8e9f7374ull, 0xa032a2f8cfbb0816ull, 0xcd6cba126d445f0aull, 0x1ba811460accb834ull,
+     0xebb355406a3126c2ull, 0xd26383a868c8c393ull, 0x6c0c6429e5b97a82ull, 0x5065f158c9fd2147ull,
+     0x708169fb0c429954ull, 0xe14600acd76ecf67ull, 0x2eaab98a70e645baull, 0x3981f39e58a4faf2ull},
+    {0xc845dfa56de66fdeull, 0xe152a5002c40483aull, 0xe9d2e163c7b4f632ull, 0x30f4452edcbc1b65ull,
+     0x18fb8a7559230a93ull, 0x1d168f6960e6f45dull, 0x3a85a94514a93cb5ull, 0x38dc083705acd0fdull,
+     0x856d2782c5759740ull, 0xfa134569f99cbeccull, 0x8844fc73c0ea4e71ull, 0x632d9a1a593f2469ull},
+    {0xbf09fd11ed0c84a7ull, 0x63f071810d9f693aull, 0x21908c2d57cf8779ull, 0x3a5a7df28af64ba2ull,
+     0xf6bb6b15b807cba6ull, 0x1823c7dfbc54f0d7ull, 0xbb1d97036e29670bull, 0x0b24f48847ed4a57ull,
+     0xdcdad4be511beac7ull, 0xa4538075ed26ccf2ull, 0xe19cff9f005f9a65ull, 0x34fcf74475481f63ull},
+    {0xa5bb1dab78cfaa98ull, 0x5ceda267190b72f2ull, 0x9309c9110a92608eull, 0x0119a3042fb374b0ull,
+     0xc197e04c789767caull, 0xb8714dcb38d9467dull, 0x55de888283f95fa8ull, 0x3d3bdc164dfa63f7ull,
+     0x67a2d89ce8c2177dull, 0x669da5f66895d0c1ull, 0xf56598e5b282a2b0ull, 0x56c088f1ede20a73ull},
+    {0x581b5fac24f38f02ull, 0xa90be9febae30cbdull, 0x9a2169028acf92f0ull, 0x038b7ea48359038full,
+     0x336d3d1110a86e17ull, 0xd7f388320b75b2faull, 0xf915337625072988ull, 0x09674c6b99108b87ull,
+     0x9f4ef82199316ff8ull, 0x2f49d282eaa78d4full, 0x0971a5ab5aef3174ull, 0x6e5e31025969eb65ull},
+    {0x3304fb0e63066222ull, 0xfb35068987acba3full, 0xbd1924778c1061a3ull, 0x3058ad43d1838620ull,
+     0xb16c62f587e593fbull, 0x4999eddeca5d3e71ull, 0xb491c1e014cc3e6dull, 0x08f5114789a8dba8ull,
+     0x323c0ffde57663d0ull, 0x05c3df38a22ea610ull, 0xbdc78abdac994f9aull, 0x26549fa4efe3dc99ull},
+  },
+  {
+    {0xdb468549af3f666eull, 0xd77fcf04f14a0ea5ull, 0x3df23ff7a4ba0c47ull, 0x3a10dfe132ce3c85ull,
+     0x741d5a461e6bf9d6ull, 0x2305b3fc7777a581ull, 0xd45574a26474d3d9ull, 0x1926e1dc6401e0ffull,
+     0xe07f4e8aea17cea0ull, 0x2fd515463a1fc1fdull, 0x175322fd31f2c0f1ull, 0x1fa1d01d861e5d15ull},
+    {0x38dcac00d1df94abull, 0x2e712bddd1080de9ull, 0x7f13e93efdd5e262ull, 0x73fced18ee9a01e5ull,
+     0xcc8055947d599832ull, 0x1e4656da37f15520ull, 0x99f6f7744e059320ull, 0x773563bc6a75cf33ull,
+     0x06b1e90863139cb3ull, 0xa493da67c5a03ecdull, 0x8d77cec8ad638932ull, 0x1f426b701b864f44ull},
+    {0xf17e35c891a12552ull, 0xb76b8153575e9c76ull, 0xfa83406f0d9b723eull, 0x0b76bb1b3fa7e438ull,
+     0xefc9264c41911c01ull, 0xf1a3b7b817a22c25ull, 0x5875da6bf30f1447ull, 0x4e1af5271d31b090ull,
+     0x08b8c1f97f92939bull, 0xbe6771cbd444ab6eull, 0x22e5646399bb8017ull, 0x7b6dd61eb772a955ull},
+    {0x5730abf9ab01d2c7ull, 0x16fb76dc40143b18ull, 0x866cbe65a0cbb281ull, 0x53fa9b659bff6afeull,
+     0xb7adc1e850f33d92ull, 0x7998fa4f608cd5cfull, 0xad962dbd8dfc5bdbull, 0x703e9bceaf1d2f4full,
+     0x6c14c8e994885455ull, 0x843a5d6665aed4e5ull, 0x181bb73ebcd65af1ull, 0x398d93e5c4c61f50ull},
+    {0xc3877c60d2e7e3f2ull, 0x3b34aaa030828bb1ull, 0x283e26e7739ef138ull, 0x699c9c9002c30577ull,
+     0x1c4bd16733e248f3ull, 0xbd9e128715bf0a5full, 0xd43f8cf0a10b0376ull, 0x53b09b5ddf191b13ull,
+     0xf306a7235946f1ccull, 0x921718b5cce5d97dull, 0x28cdd24781b4e975ull, 0x51caf30c6fcdd907ull},
+    {0x737af99a18ac54c7ull, 0x903378dcc51cb30full, 0x2b89bc334ce10cc7ull, 0x12ae29c189f8e99aull,
+     0xa60ba7427674e00aull, 0x630e8570a17a7bf3ull, 0x3758563dcf3324ccull, 0x5504aa292383fdaaull,
+     0xa99ec0cb1f0d01cfull, 0x0dd1efcc3a34f7aeull, 0x55ca7521d09c4e22ull, 0x5fd14fe958eba5eaull},
+    {0x3c42fe5ebf93cb8eull, 0xbedfa85136d4565full, 0xe0f0859e884220e8ull, 0x7dd73f960725d128ull,
+     0xb5dc2ddf2845ab2cull, 0x069491b10a7fe993ull, 0x4daaf3d64002e346ull, 0x093ff26e586474d1ull,
+     0xb10d24fe68059829ull, 0x75730672dbaf23e5ull, 0x1367253ab457ac29ull, 0x2f59bcbc86b470a4ull},
+    {0x7041d560b691c301ull, 0x85201b3fadd7e71eull, 0x16c2e16311335585ull, 0x2aa55e3d010828b1ull,
+     0x83847d429917135full, 0xad1b911f567d03d7ull, 0x7e7748d9be77aad1ull, 0x5458b42e2e51af4aull,
+     0xed5192e60c07444full, 0x42c54e2d74421d10ull, 0x352b4c82fdb5c864ull, 0x13e9004a8a768664ull},
+  },
+  {
+    {0xbb2e00c9193b877full, 0xece3a890e0dc506bull, 0xecf3b7c036de649full, 0x5f46040898de9e1aull,
+     0x739d8845832fcedbull, 0xfa38d6c9ae6bf863ull, 0x32bc0dcab74ffef7ull, 0x73937e8814bce45eull,
+     0xb9037116297bf48dull, 0xa9d13b22d4f06834ull, 0xe19715574696bdc6ull, 0x2cf8a4e891d5e835ull},
+    {0x2cb5487e17d06ba2ull, 0x24d2381c3950196bull, 0xd7659c8185978a30ull, 0x7a6f7f2891d6a4f6ull,
+     0x6d93fd8707110f67ull, 0xdd4c09d37c38b549ull, 0x7cb16a4cc2736a86ull, 0x2049bd6e58252a09ull,
+     0x7d09fd8d6a9aef49ull, 0xf0ee60be5b3db90bull, 0x4c21b52c519ebfd4ull, 0x6011aadfc545941dull},
+    {0x63ded0c802cbf890ull, 0xfbd098ca0dff6aaaull, 0x624d0afdb9b6ed99ull, 0x69ce18b779340b1eull,
+     0x5f67926dcf95f83cull, 0x7c7e856171289071ull, 0xd6a1e7f3998f7a5bull, 0x6fc5cc1b0b62f9e0ull,
+     0xd1ef5528b29879cbull, 0xdd1aae3cd47e9092ull, 0x127e0442189f2352ull, 0x15596b3ae57101f1ull},
+    {0x09ff31167e5124caull, 0x0be4158bd9c745dfull, 0x292b7d227ef556e5ull, 0x3aa4e241afb6d138ull,
+     0x462739d23f9179a2ull, 0xff83123197d6ddcfull, 0x1307deb553f2148aull, 0x0d2237687b5f4ddaull,
+     0x2cc138bf2a3305f5ull, 0x48583f8fa2e926c3ull, 0x083ab1a25549d2ebull, 0x32fcaa6e4687a36cull},
+    {0x3207a4732787ccdfull, 0x17e31908f213e3f8ull, 0xd5b2ecd7f60d964eull, 0x746f6336c2600be9ull,
+     0x7bc56e8dc57d9af5ull, 0x3e0bd2ed9df0bdf2ull, 0xaac014de22efe4a3ull, 0x4627e9cefebd6a5cull,
+     0x3f4af345ab6c971cull, 0xe288eb729943731full, 0x33596a8a0344186dull, 0x7b4917007ed66293ull},
+    {0x54341b28dd53a2ddull, 0xaa17905bdf42fc3full, 0x0ff592d94dd2f8f4ull, 0x1d03620fe08cd37dull,
+     0x2d85fb5cab84b064ull, 0x497810d289f3bc14ull, 0x476adc447b15ce0cull, 0x122ba376f844fd7bull,
+     0xc20232cda2b4e554ull, 0x9ed0fd42115d187full, 0x2eabb4be7dd479d9ull, 0x02c70bf52b68ec4cull},
+    {0xace532bf458d72e1ull, 0x5be768e07cb73cb5ull, 0x56cf7d94ee8bbde7ull, 0x6b0697e3feb43a03ull,
+     0xa287ec4b5d0b2fbbull, 0x415c5790074882caull, 0xe044a61ec1d0815cull, 0x26334f0a409ef5e0ull,
+     0xb6c8f04adf62a3c0ull, 0x3ef000ef076da45dull, 0x9c9cb95849f0d2a9ull, 0x1cc37f43441b2faeull},
+    {0xd76656f1c9ceaeb9ull, 0x1c5b15f818e5656aull, 0x26e72832844c2334ull, 0x3a346f772f196838ull,
+     0x508f565a5cc7324full, 0xd061c4c0e506a922ull, 0xfb18abdb5c45ac19ull, 0x6c6809c10380314aull,
+     0xd2d55112e2da6ac8ull, 0xe9bd0331b1e851edull, 0x960746dd8ec67262ull, 0x05911b9f6ef7c5d0ull},
+  },
+  {
+    {0x5349acf3512eeaefull, 0x20c141d31cc1cb49ull, 0x24180c07a99a688dull, 0x555ef9d1c64b2d17ull,
+     0xc1339983f5df0ebbull, 0xc0f3758f512c4cacull, 0x2cf1130a0bb398e1ull, 0x6b3cecf9aa270c62ull,
+     0x36a770ba3b73bd08ull, 0x624aef08a3afbf0cull, 0x5737ff98b40946f2ull, 0x675f4de13381749dull},
+    {0xa12ff6d93bdab31dull, 0x0725d80f9d652dfeull, 0x019c4ff39abe9487ull, 0x60f450b882cd3c43ull,
+     0x0e2c52036b1782fcull, 0x64816c816cad83b4ull, 0xd0dcbdd96964073eull, 0x13d99df70164c520ull,
+     0x014b5ec321e5c0caull, 0x4fcb69c9d719bfa2ull, 0x4e5f1c18750023a0ull, 0x1c06de9e55edac80ull},
+    {0xffd52b40ff6d69aaull, 0x34530b18dc4049bbull, 0x5e4a5c2fa34d9897ull, 0x78096f8e7d32ba2dull,
+     0x990f7ad6a33ec4e2ull, 0x6608f938be2ee08eull, 0x9ca143c563284515ull, 0x4cf38a1fec2db60dull,
+     0xa0aaaa650dfa5ce7ull, 0xf9c49e2a48b5478cull, 0x4f09cc7d7003725bull, 0x373cad3a26091abeull},
+    {0xf1bea8fb89ddbbadull, 0x3bcb2cbc61aeaecbull, 0x8f58a7bb1f9b8d9dull, 0x21547eda5112a686ull,
+     0xb294634d82c9f57cull, 0x1fcbfde124934536ull, 0x9e9c4db3418cdb5aull, 0x0040f3d9454419fcull,
+     0xdefde939fd5986d3ull, 0xf4272c89510a380cull, 0xb72ba407bb3119b9ull, 0x63550a334a254df4ull},
+    {0x9bba584572547b49ull, 0xf305c6fae2c408e0ull, 0x60e8fa69c734f18dull, 0x39a92bafaa7d767aull,
+     0x6507d6edb569cf37ull, 0x178429b00ca52ee1ull, 0xea7c0090eb6bd65dull, 0x3eea62c7daf78f51ull,
+     0x9d24c713e693274eull, 0x5f63857768dbd375ull, 0x70525560eb8ab39aull, 0x68436a0665c9c4cdull},
+    {0x1e56d317e820107cull, 0xc5266844840ae965ull, 0xc1e0a1c6320ffc7aull, 0x5373669c91611472ull,
+     0xbc0235e8202f3f27ull, 0xc75c00e264f975b0ull, 0x91a4e9d5a38c2416ull, 0x17b6e7f68ab789f9ull,
+     0x5d2814ab9a0e5257ull, 0x908f2084c9cab3fcull, 0xafcaf5885b2d1ecaull, 0x1cb4b5a678f87d11ull},
+    {0x6b74aa62a2a007e7ull, 0xf311e0b0f071c7b1ull, 0x5707e438000be223ull, 0x2dc0fd2d82ef6eacull,
+     0xb664c06b394afc6cull, 0x0c88de2498da5fb1ull, 0x4f8d03164bcad834ull, 0x330bca78de7434a2ull,
+     0x982eff841119744eull, 0xf9695e962b074724ull, 0xc58ac14fbfc953fbull, 0x3c31be1b369f1cf5ull},
+    {0xc168bc93f9cb4272ull, 0xaeb8711fc7cedb98ull, 0x7f0e52aa34ac8d7aull, 0x41cec1097e7d55bbull,
+     0xb0f4864d08948aeeull, 0x07dc19ee91ba1c6full, 0x7975cdaea6aca158ull, 0x330b61134262d4bbull,
+     0xf79619d7a26d808aull, 0xbb1fd49e1d9e156dull, 0x73d7c36cdba1df27ull, 0x26b44cd91f28777dull},
+  },
+  {
+    {0xe1b7f29362730383ull, 0x4b5279ffebca8a2cull, 0xdafc778abfd41314ull, 0x7deb10149c72610full,
+     0x51f048478f387475ull, 0xb25dbcf49cbecb3cull, 0x9aab1244d99f2055ull, 0x2c709e6c1c10a5d6ull,
+     0xcb62af6a8766ee7aull, 0x66cbec045553cd0eull, 0x588001380f0be4b5ull, 0x08e68e9ff62ce2eaull},
+    {0x2f2d09d50ab8f2f9ull, 0xacb9218dc55923dfull, 0x4a8f342673766cb9ull, 0x4cb13bd738f719f5ull,
+     0x34ad500a4bc130adull, 0x8d38db493d0bd49cull, 0xa25c3d98500a89beull, 0x2f1f3f87eeba3b09ull,
+     0xf7848c75e515b64aull, 0xa59501badb4a9038ull, 0xc20d313f3f751b50ull, 0x19a1e353c0ae2ee8ull},
+    {0xb42172cdd596bdbdull, 0x93e0454398eefc40ull, 0x9fb15347b44109b5ull, 0x736bd3990266ae34ull,
+     0x7d1c7560bafa05c3ull, 0xb3e1a0a0c6e55e61ull, 0xe3529718c0d66473ull, 0x41546b11c20c3486ull,
+     0x85532d509334b3b4ull, 0x46fd114b60816573ull, 0xcc5f5f30425c8375ull, 0x412295a2b87fab5cull},
+    {0x2e655261e293eac6ull, 0x845a92032133acdbull, 0x460975cb7900996bull, 0x0760bb8d195add80ull,
+     0x19c99b88f57ed6e9ull, 0x5393cb266df8c825ull, 0x5cee3213b30ad273ull, 0x14e153ebb52d2e34ull,
+     0x413e1a17cde6818aull, 0x57156da9ed69a084ull, 0x2cbf268f46caccb1ull, 0x6b34be9bc33ac5f2ull},
+    {0x11fc69656571f2d3ull, 0xc6c9e845530e737aull, 0xe33ae7a2d4fe5035ull, 0x01b9c7b62e6dd30bull,
+     0xf3df2f643a78c0b2ull, 0x4c3e971ef22e027cull, 0xec7d1c5e49c1b5a3ull, 0x2012c18f0922dd2dull,
+     0x880b55e55ac89d29ull, 0x1483241f45a0a763ull, 0x3d36efdfc2e76c1full, 0x08af5b784e4bade8ull},
+    {0xe27314d289cc2c4bull, 0x4be4bd11a287178dull, 0x18d528d6fa3364ceull, 0x6423c1d5afd9826eull,
+     0x283499dc881f2533ull, 0x9d0525da779323b6ull, 0x897addfb673441f4ull, 0x32b79d71163a168dull,
+     0xcc85f8d9edfcb36aull, 0x22bcc28f3746e5f9ull, 0xe49de338f9e5d3cdull, 0x480a5efbc13e2dccull},
+    {0xb6614ce442ce221full, 0x6e199dcc4c053928ull, 0x663fb4a4dc1cbe03ull, 0x24b31d47691c8e06ull,
+     0x0b51e70b01622071ull, 0x06b505cf8b1dafc5ull, 0x2c6bb061ef5aabcdull, 0x47aa27600cb7bf31ull,
+     0x2a541eedc015f8c3ull, 0x11a4fe7e7c693f7cull, 0xf0af66134ea278d6ull, 0x545b585d14dda094ull},
+    {0x6204e4d0e3b321e1ull, 0x3baa637a28ff1e95ull, 0x0b0ccffd5b99bd9eull, 0x4d22dc3e64c8d071ull,
+     0x67bf275ea0d43a0full, 0xade68e34089beebeull, 0x4289134cd479e72eull, 0x0f62f9c332ba5454ull,
+     0xfcb46589d63b5f39ull, 0x5cae6a3f57cbcf61ull, 0xfebac2d2953afa05ull, 0x1c0fa01a36371436ull},
+  },
+  {
+    {0x69082b0e8c936a50ull, 0xf9c9a035c1dac5b6ull, 0x6fb73e54c4dfb634ull, 0x4005419b1d2bc140ull,
+     0xd2c604b622943dffull, 0xbc8cbece44cfb3a0ull, 0x5d254ff397808678ull, 0x0fa3614f3b1ca6bfull,
+     0xa003febdb9be82f0ull, 0x2089c1af3a44ac90ull, 0xf8499f911954fa8eull, 0x1fba218aef40ab42ull},
+    {0x4f3e57043e7b0194ull, 0xa81d3eee08daaf7full, 0xc839c6ab99dcdef1ull, 0x6c535d13ff7761d5ull,
+     0xab549448fac8f53eull, 0x81f6e89a7ba63741ull, 0x74fd6c7d6c2b5e01ull, 0x392e3acaa8c86e42ull,
+     0x4cbd34e93e8a35afull, 0x2e0781445887e816ull, 0x19319c76f29ab0abull, 0x25e17fe4d50ac13bull},
+    {0x915f7ff576f121a7ull, 0xc34a32272fcd87e3ull, 0xccba2fde4d1be526ull, 0x6bba828f8969899bull,
+     0x0a289bd71e04f676ull, 0x208e1c52d6420f95ull, 0x5186d8b034691fabull, 0x255751442a9fb351ull,
+     0xe2d1bc6690fe3901ull, 0x4cb54a18a0997ad5ull, 0x971d6914af8460d4ull, 0x559d504f7f6b7be4ull},
+    {0x9c4891e7f6d266fdull, 0x0744a19b0307781bull, 0x88388f1d6061e23bull, 0x123ea6a3354bd50eull,
+     0xa7738378b3eb54d5ull, 0x1d69d366a5553c7cull, 0x0a26cf62f92800baull, 0x01ab12d5807e3217ull,
+     0x118d189041e32d96ull, 0xb9ede3c2d8315848ull, 0x1eab4271d83245d9ull, 0x4a3961e2c918a154ull},
+    {0x0327d644f3233f1eull, 0x499a260e34fcf016ull, 0x83b5a716f2dab979ull, 0x68aceead9bd4111full,
+     0x71dc3be0f8e6bba0ull, 0xd6cef8347effe30aull, 0xa992425fe13a476aull, 0x2cd6bce3fb1db763ull,
+     0x38b4c90ef3d7c210ull, 0x308e6e24b7ad040cull, 0x3860d9f1b7e73e23ull, 0x595760d5b508f597ull},
+    {0x882acbebfd022790ull, 0x89af3305c4115760ull, 0x65f492e37d3473f4ull, 0x2cb2c5df54515a2bull,
+     0x6129bfe104aa6397ull, 0x8f960008a4a7fccbull, 0x3f8bc0897d909458ull, 0x709fa43edcb291a9ull,
+     0xeb0a5d8c63fd2acaull, 0xd22bc1662e694effull, 0x2723f36ef8cbb03aull, 0x70f029ecf0c8131full},
+    {0x2a6aafaa5e10b0b9ull, 0x78f0a370ef041aa9ull, 0x773efb77aa3ad61full, 0x44eca5a2a74bd9e1ull,
+     0x461307b32eed3e33ull, 0xae042f33a45581e7ull, 0xc94449d3195f0366ull, 0x0b7d5d8a6c314858ull,
+     0x25d448327b95d543ull, 0x70d38300a3340f1dull, 0xde1c531c60e1c52bull, 0x272224512c7de9e4ull},
+    {0xbf7bbb8a42a975fcull, 0x8c5c397796ada358ull, 0xe27fc76fcdedaa48ull, 0x19735fd7f6bc20a6ull,
+     0x1abc92af49c5342eull, 0xffeed811b2e6fad0ull, 0xefa28c8dfcc84e29ull, 0x11b5df18a44cc543ull,
+     0xe3ab90d042c84266ull, 0xeb848e0f7f19547eull, 0x2503a1d065a497b9ull, 0x0fef911191df895full},
+  },
+};
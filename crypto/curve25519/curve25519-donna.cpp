@@ -403,7 +403,8 @@ fsquare(limb *output, const limb *in) {
   memcpy(output, t, sizeof(limb) * 10);
 }
 
-/* Take a little-endian, 32-byte number and expand it into polynomial form */
+/* Take a little-endian, 32-byte number and expand it into polynomial form.
+ * Bit 255 is ignored, as RFC 7748 says, like the x64 code does. */
 static void
 fexpand(limb *output, const u8 *input) {
 #define F(n,start,shift,mask) \
@@ -420,7 +421,7 @@ fexpand(limb *output, const u8 *input) {
   F(6, 19, 1, 0x3ffffff);
   F(7, 22, 3, 0x1ffffff);
   F(8, 25, 4, 0x3ffffff);
-  F(9, 28, 6, 0x3ffffff);
+  F(9, 28, 6, 0x1ffffff);
 #undef F
 }
 
@@ -720,6 +721,22 @@ void curve25519_normalize(u8 *e) {
   e[31] |= 64;
 }
 
+#if !defined(ARCH_CPU_X86_64) || defined(COMPILER_MSVC)
+void curve25519_base_ladder(uint8 *mypublic, const uint8 *secret) {
+  curve25519_donna(mypublic, secret, kCurve25519Basepoint);
+}
+#endif
+
+#if defined(ARCH_CPU_X86_64) && defined(COMPILER_MSVC)
+// Clear bit 255 here, so this doesn't depend on how the asm loads it.
+void curve25519_donna_x64_win(uint8 *mypublic, const uint8 *secret, const uint8 *basepoint) {
+  uint8 bp[32];
+  memcpy(bp, basepoint, 32);
+  bp[31] &= 127;
+  curve25519_donna_x64(mypublic, secret, bp);
+}
+#endif
+
 void curve25519_donna_ref(uint8_t *mypublic, const uint8_t *secret, const uint8_t *basepoint) {
   limb bp[10], x[10], z[11], zmone[10];
   uint8_t e[32];
@@ -7,11 +7,28 @@ void curve25519_donna_ref(uint8 *mypublic, const uint8 *secret, const uint8 *bas
 extern "C" void curve25519_donna_x64(uint8 *mypublic, const uint8 *secret, const uint8 *basepoint);
 
 #if defined(ARCH_CPU_X86_64) && defined(COMPILER_MSVC)
-#define curve25519_donna curve25519_donna_x64
+// Clears bit 255 of |basepoint| before calling the asm, like RFC 7748 says.
+void curve25519_donna_x64_win(uint8 *mypublic, const uint8 *secret, const uint8 *basepoint);
+#define curve25519_donna curve25519_donna_x64_win
+#elif defined(ARCH_CPU_X86_64)
+// curve25519-x64.cpp, picks MULX/ADX or 51-bit limbs at runtime.
+void curve25519_donna_x64_mulx(uint8 *mypublic, const uint8 *secret, const uint8 *basepoint);
+void curve25519_donna_x64_51(uint8 *mypublic, const uint8 *secret, const uint8 *basepoint);
+void curve25519_donna_x64_gcc(uint8 *mypublic, const uint8 *secret, const uint8 *basepoint);
+#define curve25519_donna curve25519_donna_x64_gcc
+// Public key of |secret|, from precomputed multiples of the basepoint.
+void curve25519_base_x64_gcc(uint8 *mypublic, const uint8 *secret);
+#define curve25519_base curve25519_base_x64_gcc
 #else
 #define curve25519_donna curve25519_donna_ref
 #endif
 
+#if !defined(curve25519_base)
+// Public key of |secret|, through the variable base ladder.
+void curve25519_base_ladder(uint8 *mypublic, const uint8 *secret);
+#define curve25519_base curve25519_base_ladder
+#endif
+
 void curve25519_normalize(uint8 *e);
 
 extern const uint8 kCurve25519Basepoint[32];
@@ -0,0 +1,717 @@
+// SPDX-License-Identifier: AGPL-1.0-only
+// Copyright (C) 2018 Ludvig Strigeus <info@tunsafe.com>. All Rights Reserved.
+//
+// Curve25519 for x86-64 with gcc and clang. Field elements are either four
+// 64-bit limbs multiplied with MULX and two carry chains (ADCX/ADOX), or
+// five 51-bit limbs with 128-bit products on cpus that lack BMI2/ADX. Both
+// run the same Montgomery ladder from RFC 7748.
+#include "stdafx.h"
+#include "crypto/curve25519/curve25519-donna.h"
+#include "tunsafe_endian.h"
+#include "tunsafe_cpu.h"
+#include "crypto_ops.h"
+#include <string.h>
+
+#if defined(ARCH_CPU_X86_64) && !defined(COMPILER_MSVC)
+
+typedef unsigned __int128 uint128;
+
+// Five limbs of 51 bits. Limbs are at most 2^51 + 2^18 after mul, sqr and
+// mul121665, and below 2^54 after add and sub, which keeps every sum of
+// products within 128 bits.
+struct Fe51 {
+  typedef uint64 fe[5];
+  enum { kMask = (1ull << 51) - 1 };
+
+  static FORCEINLINE void frombytes(fe out, const uint8 in[32]) {
+    out[0] = ReadLE64(in) & kMask;
+    out[1] = (ReadLE64(in + 6) >> 3) & kMask;
+    out[2] = (ReadLE64(in + 12) >> 6) & kMask;
+    out[3] = (ReadLE64(in + 19) >> 1) & kMask;
+    out[4] = (ReadLE64(in + 24) >> 12) & kMask;
+  }
+
+  static void tobytes(uint8 out[32], const fe in) {
+    uint64 t0 = in[0], t1 = in[1], t2 = in[2], t3 = in[3], t4 = in[4];
+    // Carry twice to get below 2^255, then add 19 to see whether the
+    // value is at least p, and if it is keep the sum minus 2^255.
+    for (int i = 0; i < 2; i++) {
+      t1 += t0 >> 51; t0 &= kMask;
+      t2 += t1 >> 51; t1 &= kMask;
+      t3 += t2 >> 51; t2 &= kMask;
+      t4 += t3 >> 51; t3 &= kMask;
+      t0 += (t4 >> 51) * 19; t4 &= kMask;
+    }
+    uint64 g0 = t0 + 19, g1, g2, g3, g4;
+    g1 = t1 + (g0 >> 51); g0 &= kMask;
+    g2 = t2 + (g1 >> 51); g1 &= kMask;
+    g3 = t3 + (g2 >> 51); g2 &= kMask;
+    g4 = t4 + (g3 >> 51); g3 &= kMask;
+    uint64 mask = 0 - (g4 >> 51);
+    g4 &= kMask;
+    t0 = (t0 & ~mask) | (g0 & mask);
+    t1 = (t1 & ~mask) | (g1 & mask);
+    t2 = (t2 & ~mask) | (g2 & mask);
+    t3 = (t3 & ~mask) | (g3 & mask);
+    t4 = (t4 & ~mask) | (g4 & mask);
+    WriteLE64(out, t0 | (t1 << 51));
+    WriteLE64(out + 8, (t1 >> 13) | (t2 << 38));
+    WriteLE64(out + 16, (t2 >> 26) | (t3 << 25));
+    WriteLE64(out + 24, (t3 >> 39) | (t4 << 12));
+  }
+
+  static FORCEINLINE void set(fe out, uint64 v) {
+    out[0] = v, out[1] = out[2] = out[3] = out[4] = 0;
+  }
+
+  static FORCEINLINE void copy(fe out, const fe in) {
+    memcpy(out, in, sizeof(fe));
+  }
+
+  static FORCEINLINE void add(fe out, const fe a, const fe b) {
+    for (int i = 0; i < 5; i++)
+      out[i] = a[i] + b[i];
+  }
+
+  // a - b + 2p, b must come out of mul, sqr or mul121665.
+  static FORCEINLINE void sub(fe out, const fe a, const fe b) {
+    out[0] = a[0] + 0xfffffffffffdaull - b[0];
+    for (int i = 1; i < 5; i++)
+      out[i] = a[i] + 0xffffffffffffeull - b[i];
+  }
+
+  static FORCEINLINE void carry(fe out, uint128 t0, uint128 t1, uint128 t2, uint128 t3, uint128 t4) {
+    uint64 r0, r1, r2, r3, r4;
+    t1 += (uint64)(t0 >> 51); r0 = (uint64)t0 & kMask;
+    t2 += (uint64)(t1 >> 51); r1 = (uint64)t1 & kMask;
+    t3 += (uint64)(t2 >> 51); r2 = (uint64)t2 & kMask;
+    t4 += (uint64)(t3 >> 51); r3 = (uint64)t3 & kMask;
+    r4 = (uint64)t4 & kMask;
+    t0 = (uint128)(uint64)(t4 >> 51) * 19 + r0;
+    r0 = (uint64)t0 & kMask;
+    r1 += (uint64)(t0 >> 51);
+    out[0] = r0, out[1] = r1, out[2] = r2, out[3] = r3, out[4] = r4;
+  }
+
+  static FORCEINLINE void mul(fe out, const fe a, const fe b) {
+    uint64 a0 = a[0], a1 = a[1], a2 = a[2], a3 = a[3], a4 = a[4];
+    uint64 b0 = b[0], b1 = b[1], b2 = b[2], b3 = b[3], b4 = b[4];
+    uint64 b1_19 = b1 * 19, b2_19 = b2 * 19, b3_19 = b3 * 19, b4_19 = b4 * 19;
+    carry(out,
+          (uint128)a0 * b0 + (uint128)a1 * b4_19 + (uint128)a2 * b3_19 + (uint128)a3 * b2_19 + (uint128)a4 * b1_19,
+          (uint128)a0 * b1 + (uint128)a1 * b0 + (uint128)a2 * b4_19 + (uint128)a3 * b3_19 + (uint128)a4 * b2_19,
+          (uint128)a0 * b2 + (uint128)a1 * b1 + (uint128)a2 * b0 + (uint128)a3 * b4_19 + (uint128)a4 * b3_19,
+          (uint128)a0 * b3 + (uint128)a1 * b2 + (uint128)a2 * b1 + (uint128)a3 * b0 + (uint128)a4 * b4_19,
+          (uint128)a0 * b4 + (uint128)a1 * b3 + (uint128)a2 * b2 + (uint128)a3 * b1 + (uint128)a4 * b0);
+  }
+
+  static FORCEINLINE void sqr(fe out, const fe a) {
+    uint64 a0 = a[0], a1 = a[1], a2 = a[2], a3 = a[3], a4 = a[4];
+    uint64 d0 = a0 * 2, d1 = a1 * 2, d2_19 = a2 * 38, a3_19 = a3 * 19, d4_19 = a4 * 38;
+    carry(out,
+          (uint128)a0 * a0 + (uint128)d4_19 * a1 + (uint128)d2_19 * a3,
+          (uint128)d0 * a1 + (uint128)d4_19 * a2 + (uint128)a3_19 * a3,
+          (uint128)d0 * a2 + (uint128)a1 * a1 + (uint128)d4_19 * a3,
+          (uint128)d0 * a3 + (uint128)d1 * a2 + (uint128)(a4 * 19) * a4,
+          (uint128)d0 * a4 + (uint128)d1 * a3 + (uint128)a2 * a2);
+  }
+
+  static FORCEINLINE void mul121665(fe out, const fe a) {
+    carry(out, (uint128)a[0] * 121665, (uint128)a[1] * 121665, (uint128)a[2] * 121665,
+          (uint128)a[3] * 121665, (uint128)a[4] * 121665);
+  }
+
+  static FORCEINLINE void cswap(fe a, fe b, uint64 swap) {
+    uint64 mask = 0 - swap;
+    for (int i = 0; i < 5; i++) {
+      uint64 t = mask & (a[i] ^ b[i]);
+      a[i] ^= t;
+      b[i] ^= t;
+    }
+  }
+};
+
+// Four limbs of 64 bits, reduced mod 2^256 - 38 and only fully reduced
+// mod p in tobytes. Only used when the cpu has BMI2 and ADX.
+struct Fe64 {
+  typedef uint64 fe[4];
+
+  static FORCEINLINE void frombytes(fe out, const uint8 in[32]) {
+    out[0] = ReadLE64(in);
+    out[1] = ReadLE64(in + 8);
+    out[2] = ReadLE64(in + 16);
+    out[3] = ReadLE64(in + 24) & 0x7fffffffffffffffull;
+  }
+
+  static void tobytes(uint8 out[32], const fe in) {
+    uint64 t[4], g[4], c, mask;
+    uint128 s;
+    int i;
+    // Fold bit 255 and up twice, which leaves a value below 2^255.
+    memcpy(t, in, sizeof(t));
+    for (int j = 0; j < 2; j++) {
+      c = (t[3] >> 63) * 19;
+      t[3] &= 0x7fffffffffffffffull;
+      for (i = 0; i < 4; i++) {
+        s = (uint128)t[i] + c;
+        t[i] = (uint64)s;
+        c = (uint64)(s >> 64);
+      }
+    }
+    // t >= p exactly when t + 19 reaches 2^255.
+    c = 19;
+    for (i = 0; i < 4; i++) {
+      s = (uint128)t[i] + c;
+      g[i] = (uint64)s;
+      c = (uint64)(s >> 64);
+    }
+    mask = 0 - (g[3] >> 63);
+    g[3] &= 0x7fffffffffffffffull;
+    for (i = 0; i < 4; i++)
+      WriteLE64(out + i * 8, (t[i] & ~mask) | (g[i] & mask));
+  }
+
+  static FORCEINLINE void set(fe out, uint64 v) {
+    out[0] = v, out[1] = out[2] = out[3] = 0;
+  }
+
+  static FORCEINLINE void copy(fe out, const fe in) {
+    memcpy(out, in, sizeof(fe));
+  }
+
+  static FORCEINLINE void add(fe out, const fe a, const fe b) {
+    __asm__(
+      "movq 0(%1), %%r8\n"
+      "addq 0(%2), %%r8\n"
+      "movq 8(%1), %%r9\n"
+      "adcq 8(%2), %%r9\n"
+      "movq 16(%1), %%r10\n"
+      "adcq 16(%2), %%r10\n"
+      "movq 24(%1), %%r11\n"
+      "adcq 24(%2), %%r11\n"
+      // 2^256 = 38, twice since the first fold can carry again.
+      "movl $0, %%eax\n"
+      "movl $38, %%edx\n"
+      "cmovc %%rdx, %%rax\n"
+      "addq %%rax, %%r8\n"
+      "adcq $0, %%r9\n"
+      "adcq $0, %%r10\n"
+      "adcq $0, %%r11\n"
+      "movl $0, %%eax\n"
+      "cmovc %%rdx, %%rax\n"
+      "addq %%rax, %%r8\n"
+      "movq %%r8, 0(%0)\n"
+      "movq %%r9, 8(%0)\n"
+      "movq %%r10, 16(%0)\n"
+      "movq %%r11, 24(%0)\n"
+      : : "r"(out), "r"(a), "r"(b)
+      : "rax", "rdx", "r8", "r9", "r10", "r11", "memory", "cc");
+  }
+
+  static FORCEINLINE void sub(fe out, const fe a, const fe b) {
+    __asm__(
+      "movq 0(%1), %%r8\n"
+      "subq 0(%2), %%r8\n"
+      "movq 8(%1), %%r9\n"
+      "sbbq 8(%2), %%r9\n"
+      "movq 16(%1), %%r10\n"
+      "sbbq 16(%2), %%r10\n"
+      "movq 24(%1), %%r11\n"
+      "sbbq 24(%2), %%r11\n"
+      "movl $0, %%eax\n"
+      "movl $38, %%edx\n"
+      "cmovc %%rdx, %%rax\n"
+      "subq %%rax, %%r8\n"
+      "sbbq $0, %%r9\n"
+      "sbbq $0, %%r10\n"
+      "sbbq $0, %%r11\n"
+      "movl $0, %%eax\n"
+      "cmovc %%rdx, %%rax\n"
+      "subq %%rax, %%r8\n"
+      "movq %%r8, 0(%0)\n"
+      "movq %%r9, 8(%0)\n"
+      "movq %%r10, 16(%0)\n"
+      "movq %%r11, 24(%0)\n"
+      : : "r"(out), "r"(a), "r"(b)
+      : "rax", "rdx", "r8", "r9", "r10", "r11", "memory", "cc");
+  }
+
+  // Schoolbook 4x4 limbs, one row per limb of a. Within a row the low
+  // halves go through the CF chain (ADCX) and the high halves through the
+  // OF chain (ADOX). The 512-bit product is then folded with 2^256 = 38.
+  static FORCEINLINE void mul(fe out, const fe a, const fe b) {
+    uint64 t[3];
+    __asm__(
+      "movq 0(%1), %%rdx\n"
+      "mulxq 0(%2), %%r8, %%r9\n"
+      "movq %%r8, 0(%3)\n"
+      "mulxq 8(%2), %%r10, %%r11\n"
+      "addq %%r9, %%r10\n"
+      "mulxq 16(%2), %%rbx, %%r13\n"
+      "adcq %%r11, %%rbx\n"
+      "mulxq 24(%2), %%r14, %%rax\n"
+      "adcq %%r13, %%r14\n"
+      "adcq $0, %%rax\n"
+      // t1 = r10, t2 = rbx, t3 = r14, t4 = rax
+      "movq 8(%1), %%rdx\n"
+      "xorl %%r8d, %%r8d\n"
+      "mulxq 0(%2), %%r9, %%r11\n"
+      "adcxq %%r9, %%r10\n"
+      "adoxq %%r11, %%rbx\n"
+      "mulxq 8(%2), %%r9, %%r11\n"
+      "adcxq %%r9, %%rbx\n"
+      "adoxq %%r11, %%r14\n"
+      "mulxq 16(%2), %%r9, %%r11\n"
+      "adcxq %%r9, %%r14\n"
+      "adoxq %%r11, %%rax\n"
+      "mulxq 24(%2), %%r9, %%r11\n"
+      "adcxq %%r9, %%rax\n"
+      "adoxq %%r11, %%r8\n"
+      "movl $0, %%r9d\n"
+      "adcxq %%r9, %%r8\n"
+      "movq %%r10, 8(%3)\n"
+      // t2 = rbx, t3 = r14, t4 = rax, t5 = r8
+      "movq 16(%1), %%rdx\n"
+      "xorl %%r10d, %%r10d\n"
+      "mulxq 0(%2), %%r9, %%r11\n"
+      "adcxq %%r9, %%rbx\n"
+      "adoxq %%r11, %%r14\n"
+      "mulxq 8(%2), %%r9, %%r11\n"
+      "adcxq %%r9, %%r14\n"
+      "adoxq %%r11, %%rax\n"
+      "mulxq 16(%2), %%r9, %%r11\n"
+      "adcxq %%r9, %%rax\n"
+      "adoxq %%r11, %%r8\n"
+      "mulxq 24(%2), %%r9, %%r11\n"
+      "adcxq %%r9, %%r8\n"
+      "adoxq %%r11, %%r10\n"
+      "movl $0, %%r9d\n"
+      "adcxq %%r9, %%r10\n"
+      "movq %%rbx, 16(%3)\n"
+      // t3 = r14, t4 = rax, t5 = r8, t6 = r10
+      "movq 24(%1), %%rdx\n"
+      "xorl %%ebx, %%ebx\n"
+      "mulxq 0(%2), %%r9, %%r11\n"
+      "adcxq %%r9, %%r14\n"
+      "adoxq %%r11, %%rax\n"
+      "mulxq 8(%2), %%r9, %%r11\n"
+      "adcxq %%r9, %%rax\n"
+      "adoxq %%r11, %%r8\n"
+      "mulxq 16(%2), %%r9, %%r11\n"
+      "adcxq %%r9, %%r8\n"
+      "adoxq %%r11, %%r10\n"
+      "mulxq 24(%2), %%r9, %%r11\n"
+      "adcxq %%r9, %%r10\n"
+      "adoxq %%r11, %%rbx\n"
+      "movl $0, %%r9d\n"
+      "adcxq %%r9, %%rbx\n"
+      // Low half is t0-t2 in memory and r14, high half is rax, r8, r10, rbx.
+      "movl $38, %%edx\n"
+      "xorl %%r12d, %%r12d\n"
+      "mulxq %%rax, %%r9, %%r11\n"
+      "adoxq 0(%3), %%r9\n"
+      "mulxq %%r8, %%r13, %%rax\n"
+      "adcxq %%r11, %%r13\n"
+      "adoxq 8(%3), %%r13\n"
+      "mulxq %%r10, %%r8, %%r11\n"
+      "adcxq %%rax, %%r8\n"
+      "adoxq 16(%3), %%r8\n"
+      "mulxq %%rbx, %%r10, %%rax\n"
+      "adcxq %%r11, %%r10\n"
+      "adoxq %%r14, %%r10\n"
+      "adcxq %%r12, %%rax\n"
+      "adoxq %%r12, %%rax\n"
+      "imulq %%rdx, %%rax\n"
+      "addq %%rax, %%r9\n"
+      "adcq %%r12, %%r13\n"
+      "adcq %%r12, %%r8\n"
+      "adcq %%r12, %%r10\n"
+      "movl $0, %%eax\n"
+      "cmovc %%rdx, %%rax\n"
+      "addq %%rax, %%r9\n"
+      "movq %%r9, 0(%0)\n"
+      "movq %%r13, 8(%0)\n"
+      "movq %%r8, 16(%0)\n"
+      "movq %%r10, 24(%0)\n"
+      : : "r"(out), "r"(a), "r"(b), "r"(t)
+      : "rax", "rbx", "rdx", "r8", "r9", "r10", "r11", "r12", "r13", "r14", "memory", "cc");
+  }
+
+  // The six cross products are computed once and doubled, then the four
+  // squares are added on the diagonal.
+  static FORCEINLINE void sqr(fe out, const fe a) {
+    __asm__(
+      "movq 0(%1), %%rdx\n"
+      "mulxq 8(%1), %%r9, %%r10\n"
+      "mulxq 16(%1), %%rax, %%r11\n"
+      "addq %%rax, %%r10\n"
+      "mulxq 24(%1), %%rax, %%r12\n"
+      "adcq %%rax, %%r11\n"
+      "adcq $0, %%r12\n"
+      "movq 8(%1), %%rdx\n"
+      "xorl %%r13d, %%r13d\n"
+      "mulxq 16(%1), %%rax, %%rbx\n"
+      "adcxq %%rax, %%r11\n"
+      "adoxq %%rbx, %%r12\n"
+      "mulxq 24(%1), %%rax, %%rbx\n"
+      "adcxq %%rax, %%r12\n"
+      "adoxq %%rbx, %%r13\n"
+      "movq 16(%1), %%rdx\n"
+      "mulxq 24(%1), %%rax, %%r14\n"
+      "adcxq %%rax, %%r13\n"
+      "movl $0, %%r15d\n"
+      "adcxq %%r15, %%r14\n"
+      // Cross products are in r9-r14, double them into r9-r15.
+      "addq %%r9, %%r9\n"
+      "adcq %%r10, %%r10\n"
+      "adcq %%r11, %%r11\n"
+      "adcq %%r12, %%r12\n"
+      "adcq %%r13, %%r13\n"
+      "adcq %%r14, %%r14\n"
+      "adcq %%r15, %%r15\n"
+      "movq 0(%1), %%rdx\n"
+      "mulxq %%rdx, %%r8, %%rax\n"
+      "addq %%rax, %%r9\n"
+      "movq 8(%1), %%rdx\n"
+      "mulxq %%rdx, %%rax, %%rbx\n"
+      "adcq %%rax, %%r10\n"
+      "adcq %%rbx, %%r11\n"
+      "movq 16(%1), %%rdx\n"
+      "mulxq %%rdx, %%rax, %%rbx\n"
+      "adcq %%rax, %%r12\n"
+      "adcq %%rbx, %%r13\n"
+      "movq 24(%1), %%rdx\n"
+      "mulxq %%rdx, %%rax, %%rbx\n"
+      "adcq %%rax, %%r14\n"
+      "adcq %%rbx, %%r15\n"
+      // Fold the high half r12-r15 into r8-r11 as in mul.
+      "movl $38, %%edx\n"
+      "xorl %%ebx, %%ebx\n"
+      "mulxq %%r12, %%rax, %%r12\n"
+      "adoxq %%rax, %%r8\n"
+      "mulxq %%r13, %%rax, %%r13\n"
+      "adcxq %%r12, %%rax\n"
+      "adoxq %%rax, %%r9\n"
+      "mulxq %%r14, %%rax, %%r14\n"
+      "adcxq %%r13, %%rax\n"
+      "adoxq %%rax, %%r10\n"
+      "mulxq %%r15, %%rax, %%r15\n"
+      "adcxq %%r14, %%rax\n"
+      "adoxq %%rax, %%r11\n"
+      "adcxq %%rbx, %%r15\n"
+      "adoxq %%rbx, %%r15\n"
+      "imulq %%rdx, %%r15\n"
+      "addq %%r15, %%r8\n"
+      "adcq %%rbx, %%r9\n"
+      "adcq %%rbx, %%r10\n"
+      "adcq %%rbx, %%r11\n"
+      "movl $0, %%eax\n"
+      "cmovc %%rdx, %%rax\n"
+      "addq %%rax, %%r8\n"
+      "movq %%r8, 0(%0)\n"
+      "movq %%r9, 8(%0)\n"
+      "movq %%r10, 16(%0)\n"
+      "movq %%r11, 24(%0)\n"
+      : : "r"(out), "r"(a)
+      : "rax", "rbx", "rdx", "r8", "r9", "r10", "r11", "r12", "r13", "r14", "r15", "memory", "cc");
+  }
+
+  static FORCEINLINE void mul121665(fe out, const fe a) {
+    __asm__(
+      "movl $121665, %%edx\n"
+      "mulxq 0(%1), %%r8, %%r9\n"
+      "mulxq 8(%1), %%r10, %%r11\n"
+      "addq %%r9, %%r10\n"
+      "mulxq 16(%1), %%r9, %%rax\n"
+      "adcq %%r11, %%r9\n"
+      "mulxq 24(%1), %%r11, %%rcx\n"
+      "adcq %%rax, %%r11\n"
+      "adcq $0, %%rcx\n"
+      "movl $38, %%edx\n"
+      "imulq %%rdx, %%rcx\n"
+      "addq %%rcx, %%r8\n"
+      "adcq $0, %%r10\n"
+      "adcq $0, %%r9\n"
+      "adcq $0, %%r11\n"
+      "movl $0, %%eax\n"
+      "cmovc %%rdx, %%rax\n"
+      "addq %%rax, %%r8\n"
+      "movq %%r8, 0(%0)\n"
+      "movq %%r10, 8(%0)\n"
+      "movq %%r9, 16(%0)\n"
+      "movq %%r11, 24(%0)\n"
+      : : "r"(out), "r"(a)
+      : "rax", "rcx", "rdx", "r8", "r9", "r10", "r11", "memory", "cc");
+  }
+
+  static FORCEINLINE void cswap(fe a, fe b, uint64 swap) {
+    uint64 mask = 0 - swap;
+    for (int i = 0; i < 4; i++) {
+      uint64 t = mask & (a[i] ^ b[i]);
+      a[i] ^= t;
+      b[i] ^= t;
+    }
+  }
+};
+
+template<typename F>
+static FORCEINLINE void fe_sqr_n(typename F::fe out, const typename F::fe in, int n) {
+  F::sqr(out, in);
+  while (--n)
+    F::sqr(out, out);
+}
+
+// out = z^(p - 2), the same chain as crecip in curve25519-donna.cpp.
+template<typename F>
+static void fe_invert(typename F::fe out, const typename F::fe z) {
+  typename F::fe z2, z9, z11, z2_5_0, z2_10_0, z2_20_0, z2_50_0, z2_100_0, t;
+
+  F::sqr(z2, z);
+  fe_sqr_n<F>(t, z2, 2);
+  F::mul(z9, t, z);
+  F::mul(z11, z9, z2);
+  F::sqr(t, z11);
+  F::mul(z2_5_0, t, z9);
+  fe_sqr_n<F>(t, z2_5_0, 5);
+  F::mul(z2_10_0, t, z2_5_0);
+  fe_sqr_n<F>(t, z2_10_0, 10);
+  F::mul(z2_20_0, t, z2_10_0);
+  fe_sqr_n<F>(t, z2_20_0, 20);
+  F::mul(t, t, z2_20_0);
+  fe_sqr_n<F>(t, t, 10);
+  F::mul(z2_50_0, t, z2_10_0);
+  fe_sqr_n<F>(t, z2_50_0, 50);
+  F::mul(z2_100_0, t, z2_50_0);
+  fe_sqr_n<F>(t, z2_100_0, 100);
+  F::mul(t, t, z2_100_0);
+  fe_sqr_n<F>(t, t, 50);
+  F::mul(t, t, z2_50_0);
+  fe_sqr_n<F>(t, t, 5);
+  F::mul(out, t, z11);
+}
+
+template<typename F>
+static void curve25519_ladder(uint8 *mypublic, const uint8 *secret, const uint8 *basepoint) {
+  typename F::fe x1, x2, z2, x3, z3, a, aa, b, bb, c, d, e, da, cb;
+  uint8 k[32];
+  uint64 swap = 0;
+
+  memcpy(k, secret, 32);
+  curve25519_normalize(k);
+
+  F::frombytes(x1, basepoint);
+  F::set(x2, 1);
+  F::set(z2, 0);
+  F::copy(x3, x1);
+  F::set(z3, 1);
+
+  for (int pos = 254; pos >= 0; pos--) {
+    uint64 bit = (k[pos >> 3] >> (pos & 7)) & 1;
+    swap ^= bit;
+    F::cswap(x2, x3, swap);
+    F::cswap(z2, z3, swap);
+    swap = bit;
+
+    F::add(a, x2, z2);
+    F::sub(b, x2, z2);
+    F::add(c, x3, z3);
+    F::sub(d, x3, z3);
+    F::mul(da, d, a);
+    F::mul(cb, c, b);
+    F::sqr(aa, a);
+    F::sqr(bb, b);
+    F::add(x3, da, cb);
+    F::sqr(x3, x3);
+    F::sub(z3, da, cb);
+    F::sqr(z3, z3);
+    F::mul(z3, z3, x1);
+    F::mul(x2, aa, bb);
+    F::sub(e, aa, bb);
+    F::mul121665(a, e);
+    F::add(a, a, aa);
+    F::mul(z2, e, a);
+  }
+  F::cswap(x2, x3, swap);
+  F::cswap(z2, z3, swap);
+
+  fe_invert<F>(z2, z2);
+  F::mul(x2, x2, z2);
+  F::tobytes(mypublic, x2);
+
+  memzero_crypto(k, sizeof(k));
+  memzero_crypto(x2, sizeof(x2));
+  memzero_crypto(z2, sizeof(z2));
+  memzero_crypto(x3, sizeof(x3));
+  memzero_crypto(z3, sizeof(z3));
+}
+
+#include "crypto/curve25519/curve25519-base-table.h"
+
+// Fixed base scalar multiplication on edwards25519, the twisted Edwards form
+// of the same curve, as in the ref10 ge_scalarmult_base. The scalar is split
+// into 64 signed digits in [-8, 8] and each digit picks a multiple of the
+// basepoint out of kCurve25519BaseTable, so only four doublings are needed.
+// The Montgomery u of the result is (1 + y) / (1 - y).
+
+// x = X/Z, y = Y/Z, x*y = T/Z. After an addition or doubling, before the
+// final multiplications, x = X/Z and y = Y/T.
+template<typename F>
+struct GePoint {
+  typename F::fe X, Y, Z, T;
+};
+
+template<typename F>
+struct GePrecomp {
+  typename F::fe ypx, ymx, xy2d;
+};
+
+// Only subtracts outputs of mul and sqr, which Fe51::sub requires.
+template<typename F>
+static FORCEINLINE void ge_madd(GePoint<F> *r, const GePoint<F> *p, const GePrecomp<F> *q) {
+  typename F::fe t0;
+  F::add(r->X, p->Y, p->X);
+  F::sub(r->Y, p->Y, p->X);
+  F::mul(r->Z, r->X, q->ypx);
+  F::mul(r->Y, r->Y, q->ymx);
+  F::mul(r->T, q->xy2d, p->T);
+  F::add(t0, p->Z, p->Z);
+  F::sub(r->X, r->Z, r->Y);
+  F::add(r->Y, r->Z, r->Y);
+  F::add(r->Z, t0, r->T);
+  F::sub(r->T, t0, r->T);
+}
+
+// Doubles |p|, ignoring its T.
+template<typename F>
+static FORCEINLINE void ge_dbl(GePoint<F> *r, const GePoint<F> *p) {
+  typename F::fe t0;
+  F::sqr(r->X, p->X);
+  F::sqr(r->Z, p->Y);
+  F::sqr(r->T, p->Z);
+  F::add(t0, p->X, p->Y);
+  F::sqr(t0, t0);
+  F::add(r->T, r->T, r->T);
+  F::add(r->T, r->T, r->X);
+  F::sub(r->T, r->T, r->Z);
+  F::sub(t0, t0, r->Z);
+  F::add(r->Y, r->Z, r->X);
+  F::sub(r->Z, r->Z, r->X);
+  F::sub(r->X, t0, r->X);
+}
+
+template<typename F>
+static FORCEINLINE void ge_finish(GePoint<F> *r, const GePoint<F> *p, bool with_t) {
+  F::mul(r->X, p->X, p->T);
+  F::mul(r->Y, p->Y, p->Z);
+  F::mul(r->Z, p->Z, p->T);
+  if (with_t)
+    F::mul(r->T, p->X, p->Y);
+}
+
+// Constant time lookup of b * 16^(2 * pos) * B, for b in [-8, 8].
+template<typename F>
+static FORCEINLINE void ge_select(GePrecomp<F> *t, int pos, int b) {
+  uint64 e[12] = {1, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0};
+  uint64 bnegative = (uint64)(b >> 8) & 1;
+  uint64 babs = (uint64)(b - ((-(int)bnegative & b) << 1));
+  typename F::fe neg;
+
+  for (int i = 0; i < 8; i++) {
+    uint64 mask = 0 - (((babs ^ (i + 1)) - 1) >> 63);
+    for (int j = 0; j < 12; j++)
+      e[j] ^= mask & (e[j] ^ kCurve25519BaseTable[pos][i][j]);
+  }
+  // The limbs are little endian, same as the bytes frombytes expects.
+  F::frombytes(t->ypx, (const uint8*)e);
+  F::frombytes(t->ymx, (const uint8*)(e + 4));
+  F::frombytes(t->xy2d, (const uint8*)(e + 8));
+  // -(x, y) is (-x, y), which swaps y + x with y - x and negates xy.
+  F::cswap(t->ypx, t->ymx, bnegative);
+  F::set(neg, 0);
+  F::sub(neg, neg, t->xy2d);
+  F::cswap(t->xy2d, neg, bnegative);
+  memzero_crypto(e, sizeof(e));
+}
+
+template<typename F>
+static void curve25519_base(uint8 *mypublic, const uint8 *secret) {
+  GePoint<F> h, r;
+  GePrecomp<F> t;
+  typename F::fe u, v;
+  uint8 k[32];
+  int8 e[64];
+  int i, carry;
+
+  memcpy(k, secret, 32);
+  curve25519_normalize(k);
+
+  // Radix 16 digits, then move them into [-8, 8]. The top bit of k is clear
+  // so the last digit stays at most 8.
+  for (i = 0; i < 32; i++) {
+    e[2 * i + 0] = k[i] & 15;
+    e[2 * i + 1] = k[i] >> 4;
+  }
+  carry = 0;
+  for (i = 0; i < 63; i++) {
+    e[i] += carry;
+    carry = (e[i] + 8) >> 4;
+    e[i] -= carry << 4;
+  }
+  e[63] += carry;
+
+  F::set(h.X, 0);
+  F::set(h.Y, 1);
+  F::set(h.Z, 1);
+  F::set(h.T, 0);
+  // Odd digits first, then multiply by 16 and add in the even digits.
+  for (i = 1; i < 64; i += 2) {
+    ge_select<F>(&t, i >> 1, e[i]);
+    ge_madd<F>(&r, &h, &t);
+    ge_finish<F>(&h, &r, true);
+  }
+  for (i = 0; i < 4; i++) {
+    ge_dbl<F>(&r, &h);
+    ge_finish<F>(&h, &r, i == 3);
+  }
+  for (i = 0; i < 64; i += 2) {
+    ge_select<F>(&t, i >> 1, e[i]);
+    ge_madd<F>(&r, &h, &t);
+    ge_finish<F>(&h, &r, i != 62);
+  }
+
+  F::add(u, h.Z, h.Y);
+  F::sub(v, h.Z, h.Y);
+  fe_invert<F>(v, v);
+  F::mul(u, u, v);
+  F::tobytes(mypublic, u);
+
+  memzero_crypto(k, sizeof(k));
+  memzero_crypto(e, sizeof(e));
+  memzero_crypto(&h, sizeof(h));
+  memzero_crypto(&r, sizeof(r));
+  memzero_crypto(&t, sizeof(t));
+}
+
+void curve25519_donna_x64_mulx(uint8 *mypublic, const uint8 *secret, const uint8 *basepoint) {
+  curve25519_ladder<Fe64>(mypublic, secret, basepoint);
+}
+
+void curve25519_donna_x64_51(uint8 *mypublic, const uint8 *secret, const uint8 *basepoint) {
+  curve25519_ladder<Fe51>(mypublic, secret, basepoint);
+}
+
+void curve25519_donna_x64_gcc(uint8 *mypublic, const uint8 *secret, const uint8 *basepoint) {
+  if (X86_PCAP_BMI2 && X86_PCAP_ADX)
+    curve25519_donna_x64_mulx(mypublic, secret, basepoint);
+  else
+    curve25519_donna_x64_51(mypublic, secret, basepoint);
+}
+
+void curve25519_base_x64_gcc(uint8 *mypublic, const uint8 *secret) {
+  if (X86_PCAP_BMI2 && X86_PCAP_ADX)
+    curve25519_base<Fe64>(mypublic, secret);
+  else
+    curve25519_base<Fe51>(mypublic, secret);
+}
+
+#endif  // defined(ARCH_CPU_X86_64) && !defined(COMPILER_MSVC)
@@ -0,0 +1,58 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: AGPL-1.0-only
+# Copyright (C) 2018 Ludvig Strigeus <info@tunsafe.com>. All Rights Reserved.
+#
+# Generates crypto/curve25519/curve25519-base-table.h, the multiples of the
+# edwards25519 basepoint used by the fixed base scalar multiplication in
+# curve25519-x64.cpp. Entry [j][i] is (i + 1) * 16^(2j) * B in affine
+# coordinates, stored as y + x, y - x and 2 * d * x * y, each as four
+# little endian 64-bit limbs.
+#
+#   python3 crypto/tools/curve25519-base-table.py > crypto/curve25519/curve25519-base-table.h
+
+p = 2**255 - 19
+d = -121665 * pow(121666, p - 2, p) % p
+
+def inv(x):
+  return pow(x, p - 2, p)
+
+def add(P, Q):
+  (x1, y1), (x2, y2) = P, Q
+  t = d * x1 * x2 * y1 * y2 % p
+  return ((x1 * y2 + x2 * y1) * inv(1 + t) % p,
+          (y1 * y2 + x1 * x2) * inv(1 - t) % p)
+
+def base_point():
+  y = 4 * inv(5) % p
+  xx = (y * y - 1) * inv(d * y * y + 1) % p
+  x = pow(xx, (p + 3) // 8, p)
+  if (x * x - xx) % p:
+    x = x * pow(2, (p - 1) // 4, p) % p
+  if x & 1:
+    x = p - x
+  return (x, y)
+
+def limbs(v):
+  return ', '.join('0x%016xull' % ((v >> (64 * i)) & (2**64 - 1)) for i in range(4))
+
+def main():
+  print('// Generated by crypto/tools/curve25519-base-table.py, do not edit.')
+  print('// kCurve25519BaseTable[j][i] = (i + 1) * 16^(2j) * B as y + x, y - x, 2dxy.')
+  print('static const uint64 kCurve25519BaseTable[32][8][12] = {')
+  P = base_point()
+  for j in range(32):
+    print('  {')
+    Q = P
+    for i in range(8):
+      x, y = Q
+      print('    {%s,' % limbs((y + x) % p))
+      print('     %s,' % limbs((y - x) % p))
+      print('     %s},' % limbs(2 * d * x * y % p))
+      Q = add(Q, P)
+    print('  },')
+    # Q is now 9 * P, step on to 256 * P.
+    for _ in range(8):
+      P = add(P, P)
+  print('};')
+
+main()
@@ -46,6 +46,10 @@ enum {
   // Wireguard UDP framed inside of TCP
   kPacketProtocolTcp = 2,
 
+  // This is OR:ed with kPacketProtocolUdp for packets that came in through
+  // AF_XDP, their addr.xdp also says which link to send replies over.
+  kPacketProtocolXdp = 0x40,
+
   // This is OR:ed with the value in case it's an incoming connection
   // and it's not possible to connect back to it, e.g. incoming tcp
   kPacketProtocolIncomingConnection = 0x80,
@@ -58,6 +62,7 @@ struct Packet : QueuedItem {
   byte *data;
   uint8 userdata;
   uint8 protocol;         // which protocol is this packet for/from
+  uint16 seq;             // read order, when packets are handled in parallel
   IpAddr addr;            // Optionally set to target/source of the packet
 
   enum {
@@ -3,6 +3,7 @@
 #include "network_bsd.h"
 #include "network_common.h"
 #include "tunsafe_endian.h"
+#include "tunsafe_threading.h"
 #include "util.h"
 
 #include <stdio.h>
@@ -16,6 +17,7 @@
 #include <sys/stat.h>
 #include <sys/un.h>
 #include <sys/uio.h>
+#include <sys/mman.h>
 #include <stdlib.h>
 #include <errno.h>
 #include <assert.h>
@@ -26,9 +28,45 @@
 #include <sys/inotify.h>
 #include <limits.h>
 #include <sys/prctl.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <netinet/udp.h>
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103
+#endif
+#ifndef UDP_GRO
+#define UDP_GRO 104
+#endif
+#include <linux/if_tun.h>
+#ifndef TUN_F_USO4
+#define TUN_F_USO4 0x20
+#define TUN_F_USO6 0x40
+#endif
+
+// From <linux/virtio_net.h>, which doesn't compile as C++.
+struct virtio_net_hdr {
+  uint8 flags;
+  uint8 gso_type;
+  uint16 hdr_len;
+  uint16 gso_size;
+  uint16 csum_start;
+  uint16 csum_offset;
+};
+#define VIRTIO_NET_HDR_F_NEEDS_CSUM 1
+#define VIRTIO_NET_HDR_GSO_NONE 0
+#define VIRTIO_NET_HDR_GSO_TCPV4 1
+#define VIRTIO_NET_HDR_GSO_TCPV6 4
+#define VIRTIO_NET_HDR_GSO_UDP_L4 5
+#define VIRTIO_NET_HDR_GSO_ECN 0x80
 #endif
 
 #include <algorithm>
+#include <functional>
+#include <vector>
+
+#if !defined(MAP_NORESERVE)
+#define MAP_NORESERVE 0
+#endif
 
 #include "wireguard.h"
 #include "wireguard_config.h"
@@ -39,7 +77,260 @@
 #define TUN_PREFIX_BYTES 0
 #endif
 
-static Packet *freelist;
+#if defined(OS_LINUX)
+// Room for the UDP_SEGMENT control message of each batched send.
+static const size_t kGsoCmsgSpace = CMSG_SPACE(sizeof(uint16_t));
+// Room for the UDP_GRO and SO_RXQ_OVFL control messages of each batched receive.
+static const size_t kRecvCmsgSpace = CMSG_SPACE(sizeof(int)) + CMSG_SPACE(sizeof(uint32));
+#endif  // defined(OS_LINUX)
+
+// Free packets are cached per thread, in magazines of up to kMagazineSize
+// packets. Magazines that no thread needs right now are kept in a shared
+// depot, so a thread that frees more packets than it allocates, such as a
+// writer thread, hands full magazines to the threads that allocate them. The
+// depot lock is only taken once per magazine.
+//
+// The packets are carved out of 2MB regions of one reserved address range,
+// so they end up on huge pages when the OS has any, and a packet is known to
+// be ours by its address. The size of the range is the memory cap, past it
+// AllocPacket fails and the readers drop what they receive. Once a second, if more than
+// |high_watermark| packets are in the depot, regions whose packets are all in
+// the depot are unmapped until |low_watermark| packets remain.
+enum {
+  kMagazineSize = 64,
+  kArenaRegionSize = 2 * 1024 * 1024,
+  kArenaPacketStride = 2048,
+  kArenaRegionPackets = kArenaRegionSize / kArenaPacketStride,
+
+  kDefaultPacketMemory = 256 * 1024 * 1024,
+  // The io_uring buffer rings alone hold 2MB of packets.
+  kMinPacketMemory = 8 * 1024 * 1024,
+  kDefaultPacketLowWatermark = 1024,
+  kDefaultPacketHighWatermark = 8192,
+};
+static_assert((int)kPacketAllocSize <= (int)kArenaPacketStride, "kArenaPacketStride too small");
+
+struct PacketCache {
+  Packet *head;
+  int count;
+  ~PacketCache();
+};
+
+struct PacketMagazine {
+  Packet *head;
+  int count;
+};
+
+struct PacketArena {
+  uint8 *base;
+  uint32 max_regions;
+  uint32 num_regions;
+  uint32 low_watermark, high_watermark;
+  uint32 depot_packets;
+  // Nonzero for the regions that are mapped.
+  std::vector<uint8> mapped;
+  // How many times AllocPacket failed because of the cap.
+  uint64 alloc_failures;
+};
+
+static Mutex packet_depot_lock;
+static std::vector<PacketMagazine> packet_depot;
+static PacketArena packet_arena = {
+  NULL, kDefaultPacketMemory / kArenaRegionSize, 0,
+  kDefaultPacketLowWatermark, kDefaultPacketHighWatermark,
+};
+static thread_local PacketCache packet_cache;
+
+static inline bool IsArenaPacket(Packet *packet) {
+  return (uintptr_t)((uint8*)packet - packet_arena.base) < (size_t)packet_arena.max_regions * kArenaRegionSize;
+}
+
+static void ReturnMagazine(PacketCache *c) {
+  Packet *p = c->head, **pp;
+  for (int i = 1; i < kMagazineSize; i++)
+    p = Packet_NEXT(p);
+  pp = &Packet_NEXT(p);
+  PacketMagazine m = {c->head, kMagazineSize};
+  c->head = *pp;
+  *pp = NULL;
+  c->count -= kMagazineSize;
+  packet_depot_lock.Acquire();
+  packet_depot.push_back(m);
+  packet_arena.depot_packets += kMagazineSize;
+  packet_depot_lock.Release();
+}
+
+static void ReturnCache(PacketCache *c) {
+  while (c->count >= kMagazineSize)
+    ReturnMagazine(c);
+  if (c->head) {
+    PacketMagazine m = {exch_null(c->head), c->count};
+    c->count = 0;
+    packet_depot_lock.Acquire();
+    packet_depot.push_back(m);
+    packet_arena.depot_packets += m.count;
+    packet_depot_lock.Release();
+  }
+}
+
+static bool ReserveArena(PacketArena *a) {
+  size_t size = (size_t)a->max_regions * kArenaRegionSize;
+  uint8 *p = (uint8*)mmap(NULL, size + kArenaRegionSize, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (p == (uint8*)MAP_FAILED) {
+    RERROR("Unable to reserve %d MB for packets", (int)(size >> 20));
+    a->max_regions = 0;
+    return false;
+  }
+  // Regions are aligned so they can be backed by huge pages.
+  uint8 *base = (uint8*)(((uintptr_t)p + kArenaRegionSize - 1) & ~(uintptr_t)(kArenaRegionSize - 1));
+  if (base != p)
+    munmap(p, base - p);
+  munmap(base + size, p + kArenaRegionSize - base);
+  a->mapped.assign(a->max_regions, 0);
+  a->base = base;
+  return true;
+}
+
+static uint8 *MapArenaRegion(PacketArena *a) {
+  if (a->num_regions == a->max_regions || (a->base == NULL && !ReserveArena(a)))
+    return NULL;
+  uint32 i = 0;
+  while (a->mapped[i])
+    i++;
+  uint8 *p = a->base + (size_t)i * kArenaRegionSize;
+  void *r = MAP_FAILED;
+#if defined(MAP_HUGETLB)
+  r = mmap(p, kArenaRegionSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED | MAP_HUGETLB, -1, 0);
+#endif  // defined(MAP_HUGETLB)
+  if (r == MAP_FAILED) {
+    // No reserved huge pages, hope for transparent ones.
+    r = mmap(p, kArenaRegionSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0);
+    if (r == MAP_FAILED)
+      return NULL;
+#if defined(MADV_HUGEPAGE)
+    madvise(p, kArenaRegionSize, MADV_HUGEPAGE);
+#endif  // defined(MADV_HUGEPAGE)
+  }
+  a->mapped[i] = 1;
+  a->num_regions++;
+  return p;
+}
+
+static void UnmapArenaRegion(PacketArena *a, uint32 i) {
+  mmap(a->base + (size_t)i * kArenaRegionSize, kArenaRegionSize, PROT_NONE,
+       MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED | MAP_NORESERVE, -1, 0);
+  a->mapped[i] = 0;
+  a->num_regions--;
+}
+
+// Takes a magazine from the depot, or carves a new region into magazines.
+// Returns false once the cap is reached.
+static bool TakeMagazine(PacketMagazine *result) {
+  bool rv = true;
+  packet_depot_lock.Acquire();
+  if (packet_depot.empty()) {
+    uint8 *region = MapArenaRegion(&packet_arena);
+    if (region == NULL) {
+      if (packet_arena.alloc_failures++ == 0)
+        RERROR("Packet memory cap of %d MB reached, dropping packets", (int)(packet_arena.max_regions * (kArenaRegionSize >> 20)));
+      rv = false;
+      goto out;
+    }
+    for (int i = 0; i < kArenaRegionPackets; i += kMagazineSize) {
+      PacketMagazine m = {(Packet*)(region + i * kArenaPacketStride), kMagazineSize};
+      for (int j = 0; j < kMagazineSize; j++) {
+        Packet *p = (Packet*)(region + (i + j) * kArenaPacketStride);
+        Packet_NEXT(p) = (j == kMagazineSize - 1) ? NULL : (Packet*)((uint8*)p + kArenaPacketStride);
+      }
+      packet_depot.push_back(m);
+    }
+    packet_arena.depot_packets += kArenaRegionPackets;
+  }
+  *result = packet_depot.back();
+  packet_depot.pop_back();
+  packet_arena.depot_packets -= result->count;
+out:
+  packet_depot_lock.Release();
+  return rv;
+}
+
+// Unmaps the regions that only have packets in the depot, as long as
+// |low_watermark| packets remain. The depot is rebuilt so that the packets
+// at low addresses are handed out first, which lets the high regions drain.
+static void TrimArena(uint32 low_watermark, uint32 high_watermark) {
+  PacketArena *a = &packet_arena;
+  packet_depot_lock.Acquire();
+  if (a->depot_packets > high_watermark && a->depot_packets >= low_watermark + kArenaRegionPackets) {
+    std::vector<Packet*> packets;
+    std::vector<uint16> free_in_region(a->max_regions);
+    packets.reserve(a->depot_packets);
+    for (const PacketMagazine &m : packet_depot) {
+      for (Packet *p = m.head; p; p = Packet_NEXT(p)) {
+        packets.push_back(p);
+        free_in_region[((uint8*)p - a->base) / kArenaRegionSize]++;
+      }
+    }
+    std::sort(packets.begin(), packets.end(), std::greater<Packet*>());
+    uint32 remain = a->depot_packets;
+    for (uint32 i = a->max_regions; i-- > 0 && remain >= low_watermark + kArenaRegionPackets; ) {
+      if (free_in_region[i] == kArenaRegionPackets) {
+        UnmapArenaRegion(a, i);
+        remain -= kArenaRegionPackets;
+      }
+    }
+    packet_depot.clear();
+    a->depot_packets = 0;
+    for (size_t i = 0; i < packets.size(); ) {
+      if (!a->mapped[((uint8*)packets[i] - a->base) / kArenaRegionSize]) {
+        i += kArenaRegionPackets;
+        continue;
+      }
+      PacketMagazine m = {NULL, 0};
+      Packet **pp = &m.head;
+      for (; i < packets.size() && m.count < kMagazineSize &&
+             a->mapped[((uint8*)packets[i] - a->base) / kArenaRegionSize]; i++, m.count++) {
+        *pp = packets[i];
+        pp = &Packet_NEXT(packets[i]);
+      }
+      *pp = NULL;
+      packet_depot.push_back(m);
+      a->depot_packets += m.count;
+    }
+  }
+  packet_depot_lock.Release();
+}
+
+PacketCache::~PacketCache() {
+  // The thread exits, give the packets to the others.
+  ReturnCache(this);
+}
+
+bool ConfigurePacketArena(size_t max_bytes, uint32 low_watermark, uint32 high_watermark) {
+  PacketArena *a = &packet_arena;
+  bool rv = true;
+  packet_depot_lock.Acquire();
+  if (max_bytes != 0) {
+    if (a->base != NULL) {
+      RERROR("The packet memory cap can't change once packets are allocated");
+      rv = false;
+    } else if (max_bytes < kMinPacketMemory) {
+      RERROR("The packet memory cap must be at least %d MB", kMinPacketMemory >> 20);
+      rv = false;
+    } else {
+      a->max_regions = (uint32)((max_bytes + kArenaRegionSize - 1) / kArenaRegionSize);
+    }
+  }
+  if (high_watermark != 0) {
+    a->low_watermark = low_watermark;
+    a->high_watermark = std::max(low_watermark, high_watermark);
+  }
+  packet_depot_lock.Release();
+  return rv;
+}
+
+void TrimPacketArena() {
+  TrimArena(packet_arena.low_watermark, packet_arena.high_watermark);
+}
 
 void tunsafe_die(const char *msg) {
   fprintf(stderr, "%s\n", msg);
@@ -53,32 +344,84 @@ void SetThreadName(const char *name) {
 }
 
 void FreePacket(Packet *packet) {
-  packet->queue_next = freelist;
-  freelist = packet;
+#if defined(OS_LINUX)
+  if (XdpSocketBsd::IsUmemPacket(packet)) {
+    XdpSocketBsd::FreeUmemPacket(packet);
+    return;
+  }
+#endif  // defined(OS_LINUX)
+  assert(IsArenaPacket(packet));
+  PacketCache *c = &packet_cache;
+  Packet_NEXT(packet) = c->head;
+  c->head = packet;
+  if (++c->count >= 2 * kMagazineSize)
+    ReturnMagazine(c);
+}
+
+// Free |count| packets linked from |packet|, where |end| points at the next
+// pointer of the last one.
+void FreePackets(Packet *packet, Packet **end, int count) {
+#if defined(OS_LINUX)
+  // UMEM frames go back to their fill ring, FreePacket sorts them out.
+  if (XdpSocketBsd::HasUmem()) {
+    *end = NULL;
+    FreePacketList(packet);
+    return;
+  }
+#endif  // defined(OS_LINUX)
+#if !defined(NDEBUG)
+  Packet *last = packet;
+  for (int i = 1; i < count; i++)
+    last = Packet_NEXT(last);
+  assert(&Packet_NEXT(last) == end);
+  for (Packet *p = packet; ; p = Packet_NEXT(p)) {
+    assert(IsArenaPacket(p));
+    if (p == last)
+      break;
+  }
+#endif  // !defined(NDEBUG)
+  PacketCache *c = &packet_cache;
+  *end = c->head;
+  c->head = packet;
+  c->count += count;
+  while (c->count >= 2 * kMagazineSize)
+    ReturnMagazine(c);
 }
 
 Packet *AllocPacket() {
-  Packet *p = freelist;
-  if (p) {
-    freelist = Packet_NEXT(p);
-  } else {
-    p = (Packet*)malloc(kPacketAllocSize);  
-    if (p == NULL) {
-      RERROR("Allocation failure");
-      abort();
-    }
+  PacketCache *c = &packet_cache;
+  Packet *p = c->head;
+  if (p == NULL) {
+    PacketMagazine m;
+    if (!TakeMagazine(&m))
+      return NULL;
+    p = m.head;
+    c->count = m.count;
   }
+  c->head = Packet_NEXT(p);
+  c->count--;
   p->Reset();
   return p;
 }
 
 void FreePacketList(Packet *packet) {
   while (packet)
-    free(exch(packet, Packet_NEXT(packet)));
+    FreePacket(exch(packet, Packet_NEXT(packet)));
 }
 
+// Big enough for a TSO/USO super-packet and its virtio_net_hdr. Only the
+// kernel writes to it, so all threads can share it.
+static uint8 discard_buffer[65536 + 2048];
+
+bool DiscardPacket(int fd) {
+  return read(fd, discard_buffer, sizeof(discard_buffer)) >= 0;
+}
+
+// Returns the packets cached by the calling thread to the depot, and unmaps
+// all regions that are entirely free.
 void FreeAllPackets() {
-  FreePacketList(exch_null(freelist));
+  ReturnCache(&packet_cache);
+  TrimArena(0, 0);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
@@ -93,7 +436,17 @@ NetworkBsd::NetworkBsd(NetworkBsdDelegate *delegate, int max_sockets)
       read_packet_(NULL),
       tcp_sockets_(NULL),
       delegate_(delegate),
-      max_sockets_(max_sockets) {
+      max_sockets_(max_sockets),
+      epoll_fd_(-1),
+      epoll_cur_(0),
+      epoll_num_(0),
+      epoll_events_(NULL),
+      io_uring_(NULL),
+      busy_poll_usec_(0),
+      rr_budget_(kDefaultRoundRobinBudget),
+      backlog_iterations_(0),
+      overload_until_(0),
+      last_udp_rx_drops_(0) {
   if (max_sockets < 5 || max_sockets > 1000)
     tunsafe_die("invalid value for max_sockets");
 
@@ -105,9 +458,13 @@ NetworkBsd::NetworkBsd(NetworkBsdDelegate *delegate, int max_sockets)
     tunsafe_die("no memory");
 
   memset(iov_packets_, 0, sizeof(iov_packets_));
+  memset(&stats_, 0, sizeof(stats_));
 }
 
 NetworkBsd::~NetworkBsd() {
+#if defined(OS_LINUX)
+  delete io_uring_;
+#endif  // defined(OS_LINUX)
   assert(tcp_sockets_ == NULL);
   assert(num_sock_ == 0);
   if (read_packet_)
@@ -120,21 +477,133 @@ NetworkBsd::~NetworkBsd() {
   delete [] sockets_;
   delete [] roundrobin_;
   delete [] endloop_;
+#if defined(OS_LINUX)
+  if (epoll_fd_ >= 0)
+    close(epoll_fd_);
+  delete [] epoll_events_;
+#endif  // defined(OS_LINUX)
+}
+
+bool NetworkBsd::UseEpoll() {
+#if defined(OS_LINUX)
+  assert(num_sock_ == 0);
+  if (epoll_fd_ < 0) {
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd_ < 0) {
+      RERROR("epoll_create1 failed");
+      return false;
+    }
+    epoll_events_ = new struct epoll_event[kMaxEpollEvents];
+  }
+  return true;
+#else  // defined(OS_LINUX)
+  return false;
+#endif  // defined(OS_LINUX)
+}
+
+bool NetworkBsd::UseIoUring() {
+#if defined(OS_LINUX)
+  if (!io_uring_) {
+    IoUringBsd *uring = new IoUringBsd(this);
+    if (!uring->Initialize()) {
+      delete uring;
+      return false;
+    }
+    io_uring_ = uring;
+  }
+  return true;
+#else  // defined(OS_LINUX)
+  return false;
+#endif  // defined(OS_LINUX)
+}
+
+static uint64 GetMonotonicMicroseconds() {
+#if defined(OS_MACOSX)
+  return OsGetMilliseconds() * 1000;
+#else  // defined(OS_MACOSX)
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+#endif  // defined(OS_MACOSX)
+}
+
+#if defined(OS_LINUX)
+// Poll without blocking until something happens or the time budget runs
+// out. Returns what poll returned, 0 means it's time to sleep.
+int NetworkBsd::BusyPoll(const sigset_t *sigmask) {
+  struct timespec zero = {0, 0};
+  uint64 start = GetMonotonicMicroseconds(), now;
+  int n;
+  do {
+    if (epoll_fd_ >= 0)
+      n = epoll_pwait(epoll_fd_, epoll_events_, kMaxEpollEvents, 0, sigmask);
+    else
+      n = ppoll(pollfd_, num_sock_, &zero, sigmask);
+    now = GetMonotonicMicroseconds();
+  } while (n == 0 && now - start < (uint64)busy_poll_usec_);
+  stats_.busy_poll_usec += now - start;
+  if (n == 0)
+    stats_.busy_poll_misses++;
+  else
+    stats_.busy_poll_hits++;
+  return n;
+}
+#endif  // defined(OS_LINUX)
+
+// Called after each round robin step. We're overloaded if the kernel had to
+// drop datagrams, if the steps keep leaving work behind, or if one step took
+// much longer than it should. The budget for the next step is adjusted so it
+// takes about kRoundRobinTargetUsec.
+void NetworkBsd::UpdateOverload(bool backlog, uint64 rr_usec, uint64 now_usec) {
+  if (backlog) {
+    stats_.rr_backlogs++;
+    backlog_iterations_++;
+    if (rr_usec < kRoundRobinTargetUsec / 2)
+      rr_budget_ = std::min<int>(rr_budget_ * 2, kMaxRoundRobinBudget);
+  } else {
+    backlog_iterations_ = 0;
+  }
+  if (rr_usec > kRoundRobinTargetUsec)
+    rr_budget_ = std::max<int>(rr_budget_ / 2, kMinRoundRobinBudget);
+
+  if (stats_.udp_rx_drops != last_udp_rx_drops_ ||
+      backlog_iterations_ >= kOverloadBacklogIterations ||
+      rr_usec > kRoundRobinTargetUsec * 4) {
+    last_udp_rx_drops_ = stats_.udp_rx_drops;
+    if (!overload_)
+      stats_.overload_events++;
+    overload_ = true;
+    overload_until_ = now_usec + kOverloadHoldUsec;
+  } else if (overload_ && now_usec >= overload_until_) {
+    overload_ = false;
+  }
 }
 
 void NetworkBsd::RunLoop(const sigset_t *sigmask) {
-  int free_packet_interval = 10;
-  int overload_ctr = 0;
+  bool had_events = false;
   uint64 last_second_loop = 0;
   uint64 now = 0;
 
   if (!WithSigalarmSupport)
     last_second_loop = OsGetMilliseconds();
+
+#if defined(OS_LINUX)
+  TimerFdBsd timer(this);
+  if (!timer.Initialize())
+    return;
+  now = last_second_loop;
+#endif  // defined(OS_LINUX)
   
   while (!exit_) {
     int n;
     bool new_second = false;
 
+#if defined(OS_LINUX)
+    if (timer.CheckFired()) {
+      now = OsGetMilliseconds();
+      new_second = true;
+    }
+#else  // defined(OS_LINUX)
     if (WithSigalarmSupport) {
       if (sigalarm_flag_) {
         sigalarm_flag_ = false;
@@ -148,6 +617,7 @@ void NetworkBsd::RunLoop(const sigset_t *sigmask) {
         new_second = true;
       }
     }
+#endif  // defined(OS_LINUX)
 
     if (new_second) {
       delegate_->OnSecondLoop(now);
@@ -156,16 +626,49 @@ void NetworkBsd::RunLoop(const sigset_t *sigmask) {
       for (int i = 0; i < num_sock_; i++)
         socks[i]->Periodic();
 
-      if (free_packet_interval == 0) {
-        FreeAllPackets();
-        free_packet_interval = 10;
-      }
-      free_packet_interval--;
+      TrimPacketArena();
+    }
 
-      overload_ctr -= (overload_ctr != 0);
+#if defined(OS_LINUX)
+    // Sleep until the next timer deadline, but keep ticking every second
+    // while tcp connections depend on Periodic.
+    uint64 deadline = delegate_->GetNextTimerDeadline(now);
+    deadline = std::min<uint64>(deadline, now + (tcp_sockets_ ? 1000 : kMaxTimerIntervalMs));
+    // The overload is only cleared when the loop runs, so wake up for it.
+    if (overload_)
+      deadline = std::min<uint64>(deadline, overload_until_ / 1000 + 1);
+    timer.SetDeadline(std::max<uint64>(deadline, now + 1));
+#endif  // defined(OS_LINUX)
+
+    // Flush deferred writes right before sleeping, this also covers
+    // packets queued by the timers above.
+    struct BaseSocketBsd **endloop = endloop_;
+    for (int j = num_endloop_ - 1; j >= 0; j--) {
+      endloop[j]->endloop_slot_ = -1;
+      endloop[j]->DoEndloop();
     }
+    num_endloop_ = 0;
 
-#if defined(OS_LINUX) || defined(OS_FREEBSD)
+#if defined(OS_LINUX)
+    // Only spin while there is traffic, an idle loop goes right to sleep.
+    n = 0;
+    if (busy_poll_usec_ && had_events && !num_roundrobin_)
+      n = BusyPoll(sigmask);
+    if (n == 0) {
+      uint64 sleep_start = busy_poll_usec_ ? GetMonotonicMicroseconds() : 0;
+      // Edge triggered sockets won't be reported again, so don't block
+      // while there's still round robin work left.
+      if (epoll_fd_ >= 0)
+        n = epoll_pwait(epoll_fd_, epoll_events_, kMaxEpollEvents, num_roundrobin_ ? 0 : -1, sigmask);
+      else
+        n = ppoll(pollfd_, num_sock_, NULL, sigmask);
+      if (busy_poll_usec_) {
+        stats_.sleep_usec += GetMonotonicMicroseconds() - sleep_start;
+        stats_.sleeps++;
+      }
+    }
+    had_events = (n > 0);
+#elif defined(OS_FREEBSD)
     n = ppoll(pollfd_, num_sock_, NULL, sigmask);
 #else
     n = poll(pollfd_, num_sock_, WithSigalarmSupport ? -1 : std::max<int>((int)(last_second_loop - now) + 1000, 0));
@@ -175,6 +678,17 @@ void NetworkBsd::RunLoop(const sigset_t *sigmask) {
         RERROR("poll failed");
         break;
       }
+#if defined(OS_LINUX)
+    } else if (epoll_fd_ >= 0) {
+      // The EPOLL* flags have the same values as the POLL* flags
+      struct epoll_event *events = epoll_events_;
+      for (epoll_num_ = n, epoll_cur_ = 0; epoll_cur_ < epoll_num_; epoll_cur_++) {
+        BaseSocketBsd *sock = (BaseSocketBsd*)events[epoll_cur_].data.ptr;
+        if (sock)
+          sock->HandleEvents(events[epoll_cur_].events & (EPOLLIN | EPOLLOUT | EPOLLERR | EPOLLHUP));
+      }
+      epoll_num_ = 0;
+#endif  // defined(OS_LINUX)
     } else {
       // Iterate backwards to support deleting elements
       struct pollfd *pfd = pollfd_;
@@ -185,13 +699,8 @@ void NetworkBsd::RunLoop(const sigset_t *sigmask) {
       }
     }
 
-    overload_ = (overload_ctr != 0);
-    for (int loop = 0; ; loop++) {
-      // Whenever we don't finish set overload ctr.
-      if (loop == 256) {
-        overload_ctr = 4;
-        break;
-      }
+    uint64 rr_start = GetMonotonicMicroseconds();
+    for (int loop = 0; loop < rr_budget_; loop++) {
       int i = num_roundrobin_ - 1;
       struct BaseSocketBsd **rrlist = roundrobin_;
       if (i < 0)
@@ -201,18 +710,63 @@ void NetworkBsd::RunLoop(const sigset_t *sigmask) {
           RemoveFromRoundRobin(i);
       } while (i--);
     }
-
-    struct BaseSocketBsd **endloop = endloop_;
-    for (int j = num_endloop_ - 1; j >= 0; j--) {
-      endloop[j]->endloop_slot_ = -1;
-      endloop[j]->DoEndloop();
-    }
-    num_endloop_ = 0;
+    uint64 rr_end = GetMonotonicMicroseconds();
+    UpdateOverload(num_roundrobin_ != 0, rr_end - rr_start, rr_end);
 
     delegate_->RunAllMainThreadScheduled();
   }
 }
 
+void NetworkBsd::AppendStats(std::string *result) {
+  char buf[512];
+  snprintf(buf, sizeof(buf), "udp_recv_calls=%llu\nudp_recv_packets=%llu\nudp_recv_full_batches=%llu\n"
+           "udp_recv_gro_datagrams=%llu\nudp_recv_gro_packets=%llu\n"
+           "udp_send_calls=%llu\nudp_send_packets=%llu\nudp_send_gso_messages=%llu\nudp_send_gso_packets=%llu\n",
+           (unsigned long long)stats_.udp_recv_calls, (unsigned long long)stats_.udp_recv_packets,
+           (unsigned long long)stats_.udp_recv_full_batches,
+           (unsigned long long)stats_.udp_recv_gro_datagrams, (unsigned long long)stats_.udp_recv_gro_packets,
+           (unsigned long long)stats_.udp_send_calls, (unsigned long long)stats_.udp_send_packets,
+           (unsigned long long)stats_.udp_send_gso_messages, (unsigned long long)stats_.udp_send_gso_packets);
+  result->append(buf);
+  snprintf(buf, sizeof(buf), "tun_read_gso_packets=%llu\ntun_read_gso_segments=%llu\n"
+           "tun_write_gso_packets=%llu\ntun_write_gso_segments=%llu\n",
+           (unsigned long long)stats_.tun_read_gso_packets, (unsigned long long)stats_.tun_read_gso_segments,
+           (unsigned long long)stats_.tun_write_gso_packets, (unsigned long long)stats_.tun_write_gso_segments);
+  result->append(buf);
+  if (io_uring_) {
+    snprintf(buf, sizeof(buf), "uring_submit_calls=%llu\nuring_sqes=%llu\nuring_cqes=%llu\nuring_read_rearms=%llu\n"
+             "uring_udp_recv_packets=%llu\nuring_udp_send_packets=%llu\nuring_send_drops=%llu\n"
+             "uring_send_retries=%llu\nuring_tun_write_errors=%llu\nuring_tun_write_drops=%llu\n",
+             (unsigned long long)stats_.uring_submit_calls, (unsigned long long)stats_.uring_sqes,
+             (unsigned long long)stats_.uring_cqes, (unsigned long long)stats_.uring_read_rearms,
+             (unsigned long long)stats_.uring_udp_recv_packets, (unsigned long long)stats_.uring_udp_send_packets,
+             (unsigned long long)stats_.uring_send_drops,
+             (unsigned long long)stats_.uring_send_retries, (unsigned long long)stats_.uring_tun_write_errors,
+             (unsigned long long)stats_.uring_tun_write_drops);
+    result->append(buf);
+  }
+  snprintf(buf, sizeof(buf), "timer_wakeups=%llu\ntimer_rearms=%llu\n",
+           (unsigned long long)stats_.timer_wakeups, (unsigned long long)stats_.timer_rearms);
+  result->append(buf);
+  snprintf(buf, sizeof(buf), "udp_rx_drops=%llu\nudp_rx_oversized=%llu\nrr_budget=%d\nrr_backlogs=%llu\noverload=%d\noverload_events=%llu\n",
+           (unsigned long long)stats_.udp_rx_drops, (unsigned long long)stats_.udp_rx_oversized, rr_budget_, (unsigned long long)stats_.rr_backlogs,
+           overload_, (unsigned long long)stats_.overload_events);
+  result->append(buf);
+  packet_depot_lock.Acquire();
+  snprintf(buf, sizeof(buf), "packet_arena_bytes=%llu\npacket_depot_packets=%u\npacket_alloc_failures=%llu\n",
+           (unsigned long long)packet_arena.num_regions * kArenaRegionSize, packet_arena.depot_packets,
+           (unsigned long long)packet_arena.alloc_failures);
+  packet_depot_lock.Release();
+  result->append(buf);
+  if (busy_poll_usec_) {
+    snprintf(buf, sizeof(buf), "busy_poll_usec=%llu\nbusy_poll_hits=%llu\nbusy_poll_misses=%llu\nsleep_usec=%llu\nsleeps=%llu\n",
+             (unsigned long long)stats_.busy_poll_usec, (unsigned long long)stats_.busy_poll_hits,
+             (unsigned long long)stats_.busy_poll_misses, (unsigned long long)stats_.sleep_usec,
+             (unsigned long long)stats_.sleeps);
+    result->append(buf);
+  }
+}
+
 void NetworkBsd::RemoveFromRoundRobin(int i) {
   BaseSocketBsd *cur = roundrobin_[i], *last = roundrobin_[num_roundrobin_-- - 1];
   assert(cur->roundrobin_slot_ == i);
@@ -224,8 +778,8 @@ void NetworkBsd::RemoveFromRoundRobin(int i) {
 void NetworkBsd::ReallocateIov(size_t j) {
   Packet *p = AllocPacket();
   iov_packets_[j] = p;
-  iov_[j].iov_base = p->data;
-  iov_[j].iov_len = kPacketCapacity;
+  iov_[j].iov_base = p ? p->data : NULL;
+  iov_[j].iov_len = p ? kPacketCapacity : 0;
 }
 
 void NetworkBsd::EnsureIovAllocated() {
@@ -242,6 +796,15 @@ BaseSocketBsd::~BaseSocketBsd() {
 }
 
 void BaseSocketBsd::CloseSocket() {
+#if defined(OS_LINUX)
+  if (network_->epoll_fd_ >= 0 && pollfd_slot_ >= 0) {
+    epoll_ctl(network_->epoll_fd_, EPOLL_CTL_DEL, fd_, NULL);
+    struct epoll_event *events = network_->epoll_events_;
+    for (int i = network_->epoll_cur_ + 1; i < network_->epoll_num_; i++)
+      if (events[i].data.ptr == this)
+        events[i].data.ptr = NULL;
+  }
+#endif  // defined(OS_LINUX)
   if (fd_ != -1)
     close(fd_);
   if (roundrobin_slot_ >= 0)
@@ -262,10 +825,34 @@ void BaseSocketBsd::CloseSocket() {
   endloop_slot_ = pollfd_slot_ = roundrobin_slot_ = -1;
 }
 
-void BaseSocketBsd::InitPollSlot(int fd, int events) {
+#if defined(OS_LINUX)
+static void SetEpollFlags(int epoll_fd, int op, int fd, int events, bool edge_triggered, void *ptr) {
+  struct epoll_event ev;
+  ev.events = events | (edge_triggered ? EPOLLET : 0);
+  ev.data.ptr = ptr;
+  if (epoll_ctl(epoll_fd, op, fd, &ev) < 0)
+    RERROR("epoll_ctl failed: %d", errno);
+}
+#endif  // defined(OS_LINUX)
+
+void BaseSocketBsd::SetPollFlags(int events) {
+  struct pollfd *pfd = &network_->pollfd_[pollfd_slot_];
+#if defined(OS_LINUX)
+  if (network_->epoll_fd_ >= 0 && pfd->events != events)
+    SetEpollFlags(network_->epoll_fd_, EPOLL_CTL_MOD, fd_, events, edge_triggered_, this);
+#endif  // defined(OS_LINUX)
+  pfd->events = events;
+}
+
+void BaseSocketBsd::InitPollSlot(int fd, int events, bool edge_triggered) {
   assert(network_->num_sock_ != network_->max_sockets_);
   assert(fd_ == -1);
   fd_ = fd;
+  edge_triggered_ = edge_triggered;
+#if defined(OS_LINUX)
+  if (network_->epoll_fd_ >= 0)
+    SetEpollFlags(network_->epoll_fd_, EPOLL_CTL_ADD, fd, events, edge_triggered, this);
+#endif  // defined(OS_LINUX)
   unsigned int slot = pollfd_slot_;
   if (pollfd_slot_ < 0)
     pollfd_slot_ = slot = network_->num_sock_++;
@@ -288,17 +875,195 @@ void BaseSocketBsd::AddToEndLoop() {
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 
+#if defined(OS_LINUX)
+static void CopyFromIovec(byte *dst, const struct iovec *iov, size_t offset, size_t size) {
+  for (; size; iov++) {
+    if (offset >= iov->iov_len) {
+      offset -= iov->iov_len;
+      continue;
+    }
+    size_t n = std::min<size_t>(size, iov->iov_len - offset);
+    memcpy(dst, (byte*)iov->iov_base + offset, n);
+    dst += n, size -= n, offset = 0;
+  }
+}
+
+// Add |data| to a ones' complement sum, |data| must start at an even
+// offset of the checksummed area. Reads bytes so it's safe to use on
+// headers just written through WriteBE16/WriteBE32.
+static uint64 ChecksumAdd(const uint8 *data, size_t size, uint64 sum) {
+  for (; size >= 4; data += 4, size -= 4)
+    sum += ((uint32)data[0] << 24) | ((uint32)data[1] << 16) | ((uint32)data[2] << 8) | data[3];
+  if (size >= 2) {
+    sum += ((uint32)data[0] << 8) | data[1];
+    data += 2, size -= 2;
+  }
+  if (size)
+    sum += (uint32)data[0] << 8;
+  return sum;
+}
+
+static uint16 ChecksumFold(uint64 sum) {
+  while (sum >> 16)
+    sum = (sum & 0xFFFF) + (sum >> 16);
+  return (uint16)sum;
+}
+
+enum {
+  kTcpFin = 0x01,
+  kTcpPsh = 0x08,
+  kTcpAck = 0x10,
+  kTcpCwr = 0x80,
+};
+
+// Finish a checksum that the kernel left for the NIC to compute. The
+// checksum field already holds the sum of the pseudo header.
+static bool CompleteChecksum(uint8 *data, size_t size, size_t start, size_t offset) {
+  if (start >= size || start + offset + 2 > size)
+    return false;
+  uint16 csum = ~ChecksumFold(ChecksumAdd(data + start, size - start, 0));
+  // A zero UDP checksum means no checksum
+  if (csum == 0 && offset == 6)
+    csum = 0xFFFF;
+  WriteBE16(data + start + offset, csum);
+  return true;
+}
+
+// Fix up the headers of segment |index| of a TSO/USO super-packet, the same
+// way a NIC would do it. |data| holds a copy of the original headers.
+static void FixupGsoSegment(uint8 *data, uint32 l4_offs, uint32 size, uint32 index,
+                            uint32 mss, bool is_last, bool is_tcp) {
+  uint8 *l4 = data + l4_offs;
+  uint32 l4_size = size - l4_offs;
+  uint64 sum;
+  if ((data[0] >> 4) == 4) {
+    WriteBE16(data + 2, size);
+    WriteBE16(data + 4, ReadBE16(data + 4) + index);
+    WriteBE16(data + 10, 0);
+    WriteBE16(data + 10, (uint16)~ChecksumFold(ChecksumAdd(data, l4_offs, 0)));
+    sum = ChecksumAdd(data + 12, 8, 0);
+  } else {
+    WriteBE16(data + 4, size - 40);
+    sum = ChecksumAdd(data + 8, 32, 0);
+  }
+  sum += (is_tcp ? IPPROTO_TCP : IPPROTO_UDP) + l4_size;
+  if (is_tcp) {
+    WriteBE32(l4 + 4, ReadBE32(l4 + 4) + index * mss);
+    if (!is_last)
+      l4[13] &= ~(kTcpFin | kTcpPsh);
+    if (index != 0)
+      l4[13] &= ~kTcpCwr;
+    WriteBE16(l4 + 16, 0);
+    WriteBE16(l4 + 16, (uint16)~ChecksumFold(ChecksumAdd(l4, l4_size, sum)));
+  } else {
+    WriteBE16(l4 + 4, l4_size);
+    WriteBE16(l4 + 6, 0);
+    uint16 csum = ~ChecksumFold(ChecksumAdd(l4, l4_size, sum));
+    WriteBE16(l4 + 6, csum ? csum : 0xFFFF);
+  }
+}
+
+// Check if the packets starting at |p| are consecutive segments of one TCP
+// flow that the kernel would have merged with GRO. If so, build the headers
+// of the merged packet in |header| and |vhdr|, point |iov| at the header
+// and the payloads, and return the number of packets merged. Otherwise
+// return 0.
+static int CoalesceTcpSegments(Packet *p, struct virtio_net_hdr *vhdr, uint8 *header, struct iovec *iov) {
+  const uint8 *d = p->data;
+  uint32 size = p->size, l4_offs;
+  if (size >= 40 && d[0] == 0x45 && d[9] == IPPROTO_TCP && (ReadBE16(d + 6) & 0x3FFF) == 0) {
+    l4_offs = 20;
+  } else if (size >= 60 && (d[0] >> 4) == 6 && d[6] == IPPROTO_TCP) {
+    l4_offs = 40;
+  } else {
+    return 0;
+  }
+  const uint8 *th = d + l4_offs;
+  uint32 hdr_size = l4_offs + (th[12] >> 4) * 4;
+  if (hdr_size < l4_offs + 20 || hdr_size >= size || hdr_size > TunSocketBsd::kMaxGsoHeaderSize ||
+      th[13] != kTcpAck)
+    return 0;
+  uint32 mss = size - hdr_size, total_size = size, seq = ReadBE32(th + 4) + mss;
+  uint8 psh = 0;
+  int n = 1;
+  iov[1].iov_base = (uint8*)d + hdr_size;
+  iov[1].iov_len = mss;
+  for (Packet *q = Packet_NEXT(p); q && n < TunSocketBsd::kMaxCoalesce; q = Packet_NEXT(q)) {
+    const uint8 *qd = q->data, *qth = qd + l4_offs;
+    if (q->size <= hdr_size || q->size - hdr_size > mss || total_size + q->size - hdr_size > 65535)
+      break;
+    // Everything in the headers except lengths, ids and checksums must match
+    if (l4_offs == 20) {
+      if (qd[0] != d[0] || qd[1] != d[1] || ReadBE16(qd + 6) != ReadBE16(d + 6) ||
+          qd[8] != d[8] || qd[9] != d[9] || memcmp(qd + 12, d + 12, 8) != 0)
+        break;
+    } else {
+      if (memcmp(qd, d, 4) != 0 || qd[6] != d[6] || qd[7] != d[7] || memcmp(qd + 8, d + 8, 32) != 0)
+        break;
+    }
+    if (memcmp(qth, th, 4) != 0 || ReadBE32(qth + 4) != seq || memcmp(qth + 8, th + 8, 5) != 0 ||
+        (qth[13] & ~kTcpPsh) != kTcpAck || memcmp(qth + 14, th + 14, 2) != 0 ||
+        memcmp(qth + 20, th + 20, hdr_size - l4_offs - 20) != 0)
+      break;
+    uint32 payload = q->size - hdr_size;
+    n++;
+    iov[n].iov_base = (uint8*)qd + hdr_size;
+    iov[n].iov_len = payload;
+    total_size += payload;
+    seq += payload;
+    // Only the last segment may be short or have PSH set
+    if (payload < mss || (qth[13] & kTcpPsh)) {
+      psh = qth[13] & kTcpPsh;
+      break;
+    }
+  }
+  if (n == 1)
+    return 0;
+  memcpy(header, d, hdr_size);
+  uint8 *hth = header + l4_offs;
+  uint64 sum;
+  if (l4_offs == 20) {
+    WriteBE16(header + 2, total_size);
+    WriteBE16(header + 10, 0);
+    WriteBE16(header + 10, (uint16)~ChecksumFold(ChecksumAdd(header, 20, 0)));
+    sum = ChecksumAdd(header + 12, 8, 0);
+  } else {
+    WriteBE16(header + 4, total_size - 40);
+    sum = ChecksumAdd(header + 8, 32, 0);
+  }
+  hth[13] |= psh;
+  // The kernel completes the checksum from the pseudo header sum.
+  WriteBE16(hth + 16, ChecksumFold(sum + IPPROTO_TCP + total_size - l4_offs));
+  iov[0].iov_base = header;
+  iov[0].iov_len = hdr_size;
+  vhdr->flags = VIRTIO_NET_HDR_F_NEEDS_CSUM;
+  vhdr->gso_type = (l4_offs == 20) ? VIRTIO_NET_HDR_GSO_TCPV4 : VIRTIO_NET_HDR_GSO_TCPV6;
+  vhdr->hdr_len = hdr_size;
+  vhdr->gso_size = mss;
+  vhdr->csum_start = l4_offs;
+  vhdr->csum_offset = 16;
+  return n;
+}
+#endif  // defined(OS_LINUX)
+
 TunSocketBsd::TunSocketBsd(NetworkBsd *network, WireguardProcessor *processor)
     : BaseSocketBsd(network),
       tun_readable_(false),
       tun_writable_(false),
       tun_interface_gone_(false),
+      offload_(false),
+      rx_packets_(0),
+      tx_packets_(0),
       tun_queue_(NULL),
       tun_queue_end_(&tun_queue_),
-      processor_(processor) {
+      tun_queue_size_(0),
+      processor_(processor),
+      gso_buf_(NULL),
+      io_uring_(NULL) {
 }
 
 TunSocketBsd::~TunSocketBsd() {
+  delete [] gso_buf_;
 }
 
 bool TunSocketBsd::Initialize(int fd) {
@@ -306,11 +1071,39 @@ bool TunSocketBsd::Initialize(int fd) {
     return false;
   fcntl(fd, F_SETFD, FD_CLOEXEC);
   fcntl(fd, F_SETFL, O_NONBLOCK);
-  InitPollSlot(fd, POLLIN);
+  InitPollSlot(fd, POLLIN, true);
   tun_writable_ = true;
   return true;
 }
 
+void TunSocketBsd::EnableOffload() {
+#if defined(OS_LINUX)
+  unsigned int offloads = TUN_F_CSUM | TUN_F_TSO4 | TUN_F_TSO6;
+  // UDP segmentation offload needs Linux 6.2, retry without it.
+  if (ioctl(fd_, TUNSETOFFLOAD, offloads | TUN_F_USO4 | TUN_F_USO6) < 0 &&
+      ioctl(fd_, TUNSETOFFLOAD, offloads) < 0)
+    RERROR("ioctl(TUNSETOFFLOAD) failed");
+  if (!gso_buf_)
+    gso_buf_ = new byte[kGsoBufferSize];
+  offload_ = true;
+#endif  // defined(OS_LINUX)
+}
+
+bool TunSocketBsd::UseIoUring() {
+#if defined(OS_LINUX)
+  IoUringBsd *uring = network_->io_uring_;
+  if (!uring || offload_ || fd_ < 0)
+    return false;
+  SetPollFlags(0);
+  tun_readable_ = false;
+  io_uring_ = uring;
+  uring->StartReadTun(this);
+  return true;
+#else  // defined(OS_LINUX)
+  return false;
+#endif  // defined(OS_LINUX)
+}
+
 static inline bool IsCompatibleProto(uint32 v) {
   return v == AF_INET || v == AF_INET6;
 }
@@ -326,10 +1119,14 @@ void TunSocketBsd::HandleEvents(int revents) {
     tun_readable_ = tun_writable_ = false;
     network_->PostExit();
   } else {
-    tun_readable_ = (revents & POLLIN) != 0;
+    // Stay readable until a read says EAGAIN, edge triggered events
+    // aren't repeated.
+    tun_readable_ |= (revents & POLLIN) != 0;
     if (revents & POLLOUT) {
       SetPollFlags(POLLIN);
       tun_writable_ = true;
+      if (offload_)
+        AddToEndLoop();
     }
   }
   AddToRoundRobin();
@@ -337,9 +1134,19 @@ void TunSocketBsd::HandleEvents(int revents) {
 
 bool TunSocketBsd::DoRead() {
   assert(tun_readable_);
+  if (!network_->read_packet_) {
+    network_->read_packet_ = AllocPacket();
+    // Past the packet memory cap, what's read is dropped.
+    if (!network_->read_packet_) {
+      if (DiscardPacket(fd_))
+        return true;
+      tun_readable_ = false;
+      return false;
+    }
+  }
+  if (offload_)
+    return DoReadOffload();
   Packet *packet = network_->read_packet_;
-  if (!packet)
-    network_->read_packet_ = packet = AllocPacket();
 
   int r = read(fd_, packet->data - TUN_PREFIX_BYTES, kPacketCapacity + TUN_PREFIX_BYTES);
   if (r >= 0) {
@@ -350,6 +1157,7 @@ bool TunSocketBsd::DoRead() {
       //        read_packet_->data[0], read_packet_->data[1], read_packet_->data[2], read_packet_->data[3], 
       //        read_packet_->data[4], read_packet_->data[5], read_packet_->data[6], read_packet_->data[7]);
       network_->read_packet_ = NULL;
+      rx_packets_++;
       processor_->HandleTunPacket(packet);
     }
     return true;
@@ -362,12 +1170,118 @@ bool TunSocketBsd::DoRead() {
   }
 }
 
+// Read a packet prefixed by a virtio_net_hdr. A TSO/USO super-packet can be
+// up to 64KB, the part that doesn't fit in the packet goes to |gso_buf_|.
+bool TunSocketBsd::DoReadOffload() {
+#if defined(OS_LINUX)
+  Packet *packet = network_->read_packet_;
+  struct virtio_net_hdr hdr;
+  struct iovec iov[3];
+  iov[0].iov_base = &hdr;
+  iov[0].iov_len = sizeof(hdr);
+  iov[1].iov_base = packet->data;
+  iov[1].iov_len = kPacketCapacity;
+  iov[2].iov_base = gso_buf_;
+  iov[2].iov_len = kGsoBufferSize;
+  ssize_t r = readv(fd_, iov, 3);
+  if (r < 0) {
+    if (errno != EAGAIN) {
+      fprintf(stderr, "Read from tun failed\n");
+    }
+    tun_readable_ = false;
+    return false;
+  }
+  if (r <= (ssize_t)sizeof(hdr))
+    return true;
+  packet->size = r - sizeof(hdr);
+  if (hdr.gso_type != VIRTIO_NET_HDR_GSO_NONE) {
+    if (HandleGsoPacket(packet, &hdr, iov + 1))
+      network_->read_packet_ = NULL;
+  } else if (packet->size <= kPacketCapacity &&
+             (!(hdr.flags & VIRTIO_NET_HDR_F_NEEDS_CSUM) ||
+              CompleteChecksum(packet->data, packet->size, hdr.csum_start, hdr.csum_offset))) {
+    network_->read_packet_ = NULL;
+    rx_packets_++;
+    processor_->HandleTunPacket(packet);
+  }
+  return true;
+#else  // defined(OS_LINUX)
+  return false;
+#endif  // defined(OS_LINUX)
+}
+
+// Split a TSO/USO super-packet into packets of at most |gso_size| bytes of
+// payload each. The first segment is built in place, the others are copied
+// into new packets, and they are all passed on in order. Returns false if
+// the packet wasn't consumed.
+bool TunSocketBsd::HandleGsoPacket(Packet *packet, const struct virtio_net_hdr *hdr, const struct iovec *iov) {
+#if defined(OS_LINUX)
+  uint8 *data = packet->data;
+  uint32 size = packet->size, l4_offs = hdr->csum_start, mss = hdr->gso_size;
+  int gso_type = hdr->gso_type & ~VIRTIO_NET_HDR_GSO_ECN;
+  bool is_tcp = (gso_type == VIRTIO_NET_HDR_GSO_TCPV4 || gso_type == VIRTIO_NET_HDR_GSO_TCPV6);
+  if (!is_tcp && gso_type != VIRTIO_NET_HDR_GSO_UDP_L4)
+    return false;
+  if (mss == 0 || !(hdr->flags & VIRTIO_NET_HDR_F_NEEDS_CSUM) || l4_offs + 20 > std::min<uint32>(size, kPacketCapacity))
+    return false;
+  if ((data[0] >> 4) == 4 ? (l4_offs != (data[0] & 0xF) * 4u) : ((data[0] >> 4) != 6 || l4_offs < 40))
+    return false;
+  uint32 hdr_size = l4_offs + (is_tcp ? (data[l4_offs + 12] >> 4) * 4 : 8);
+  if (hdr_size > kMaxGsoHeaderSize || hdr_size >= size || hdr_size + mss > kPacketCapacity)
+    return false;
+
+  uint8 header[kMaxGsoHeaderSize];
+  memcpy(header, data, hdr_size);
+  uint32 payload = size - hdr_size;
+  uint32 segments = (payload + mss - 1) / mss;
+  Packet *last = packet;
+  uint32 made = 1;
+  for (; made < segments; made++) {
+    Packet *q = AllocPacket();
+    // Past the packet memory cap the remaining segments are dropped.
+    if (q == NULL)
+      break;
+    uint32 seg_payload = std::min<uint32>(mss, payload - made * mss);
+    memcpy(q->data, header, hdr_size);
+    CopyFromIovec(q->data + hdr_size, iov, hdr_size + made * mss, seg_payload);
+    q->size = hdr_size + seg_payload;
+    FixupGsoSegment(q->data, l4_offs, q->size, made, mss, made == segments - 1, is_tcp);
+    Packet_NEXT(last) = q;
+    last = q;
+  }
+  Packet_NEXT(last) = NULL;
+  packet->size = hdr_size + std::min<uint32>(mss, payload);
+  FixupGsoSegment(data, l4_offs, packet->size, 0, mss, segments == 1, is_tcp);
+
+  NetworkBsd::Stats *stats = &network_->stats_;
+  stats->tun_read_gso_packets++;
+  stats->tun_read_gso_segments += made;
+  rx_packets_ += made;
+  Packet *ready[kWgCryptoBatchSize];
+  size_t num_ready = 0;
+  do {
+    Packet *next = Packet_NEXT(packet);
+    ready[num_ready++] = packet;
+    if (num_ready == kWgCryptoBatchSize || next == NULL) {
+      processor_->HandleTunPackets(ready, num_ready);
+      num_ready = 0;
+    }
+    packet = next;
+  } while (packet);
+  return true;
+#else  // defined(OS_LINUX)
+  return false;
+#endif  // defined(OS_LINUX)
+}
+
 static uint32 GetProtoFromPacket(const uint8 *data, size_t size) {
   return size < 1 || (data[0] >> 4) != 6 ? AF_INET : AF_INET6;
 }
 
 bool TunSocketBsd::DoWrite() {
   assert(tun_writable_);
+  if (offload_)
+    return DoWriteOffload();
   if (TUN_PREFIX_BYTES) {
     WriteBE32(tun_queue_->data - TUN_PREFIX_BYTES, GetProtoFromPacket(tun_queue_->data, tun_queue_->size));
   }
@@ -383,29 +1297,98 @@ bool TunSocketBsd::DoWrite() {
     r -= TUN_PREFIX_BYTES;
     if (r != tun_queue_->size)
       RERROR("Write to tun incomplete!");
+    tx_packets_++;
     //    else
     //      RINFO("Wrote %d bytes to TUN", r);
   }
   Packet *next = Packet_NEXT(tun_queue_);
   FreePacket(tun_queue_);
+  tun_queue_size_--;
   if ((tun_queue_ = next) != NULL) return true;
   tun_queue_end_ = &tun_queue_;
   return false;
 }
 
+// Write the packet at the head of the queue prefixed by a virtio_net_hdr.
+// A run of in-order segments of one TCP flow is merged into a single GSO
+// packet, so the kernel gets it like it had been through GRO.
+bool TunSocketBsd::DoWriteOffload() {
+#if defined(OS_LINUX)
+  struct virtio_net_hdr vhdr;
+  uint8 header[kMaxGsoHeaderSize];
+  struct iovec iov[kMaxCoalesce + 2];
+  memset(&vhdr, 0, sizeof(vhdr));
+  iov[0].iov_base = &vhdr;
+  iov[0].iov_len = sizeof(vhdr);
+  int n = CoalesceTcpSegments(tun_queue_, &vhdr, header, iov + 1), iovcnt = n + 2;
+  if (n == 0) {
+    iov[1].iov_base = tun_queue_->data;
+    iov[1].iov_len = tun_queue_->size;
+    n = 1, iovcnt = 2;
+  }
+  ssize_t r = writev(fd_, iov, iovcnt);
+  if (r < 0) {
+    if (errno == EAGAIN) {
+      tun_writable_ = false;
+      SetPollFlags(POLLIN | POLLOUT);
+      return false;
+    }
+    RERROR("Write to tun failed");
+  } else {
+    tx_packets_ += n;
+    if (n > 1) {
+      NetworkBsd::Stats *stats = &network_->stats_;
+      stats->tun_write_gso_packets++;
+      stats->tun_write_gso_segments += n;
+    }
+  }
+  Packet *p = tun_queue_;
+  for (int i = 0; i < n; i++) {
+    Packet *next = Packet_NEXT(p);
+    FreePacket(p);
+    p = next;
+  }
+  tun_queue_size_ -= n;
+  if ((tun_queue_ = p) != NULL) return true;
+  tun_queue_end_ = &tun_queue_;
+  return false;
+#else  // defined(OS_LINUX)
+  return false;
+#endif  // defined(OS_LINUX)
+}
+
 void TunSocketBsd::WritePacket(Packet *packet) {
   assert(fd_ >= 0);
+#if defined(OS_LINUX)
+  if (io_uring_) {
+    io_uring_->WriteTunPacket(this, packet);
+    return;
+  }
+#endif  // defined(OS_LINUX)
   Packet *queue_is_used = tun_queue_;
   *tun_queue_end_ = packet;
   tun_queue_end_ = &Packet_NEXT(packet);
   packet->queue_next = NULL;
-  if (!queue_is_used)
+  tun_queue_size_++;
+  if (offload_) {
+    // Let packets accumulate until the end of the loop so runs of TCP
+    // segments can be merged.
+    if (tun_queue_size_ >= kMaxCoalesce && tun_writable_)
+      DoWrite();
+    else
+      AddToEndLoop();
+  } else if (!queue_is_used) {
     DoWrite();
+  }
+}
+
+void TunSocketBsd::DoEndloop() {
+  while (tun_queue_ && tun_writable_ && DoWrite()) {}
 }
 
 bool TunSocketBsd::DoRoundRobin() {
   bool more_work = false;
-  if (tun_queue_ && tun_writable_)
+  if (tun_queue_ && tun_writable_ && (!offload_ || tun_queue_size_ >= kMaxCoalesce))
     more_work = DoWrite();
   if (tun_readable_)
     more_work |= DoRead();
@@ -420,10 +1403,99 @@ UdpSocketBsd::UdpSocketBsd(NetworkBsd *network, WireguardProcessor *processor)
       udp_writable_(false),
       udp_queue_(NULL),
       udp_queue_end_(&udp_queue_),
-      processor_(processor) {
+      udp_queue_size_(0),
+      processor_(processor),
+      batch_size_(1),
+      batch_packets_(NULL),
+      batch_msgs_(NULL),
+      batch_iov_(NULL),
+      batch_recv_cmsg_(NULL),
+      batch_gro_buf_(NULL),
+      batch_send_msgs_(NULL),
+      batch_send_iov_(NULL),
+      batch_send_cmsg_(NULL),
+#if defined(OS_LINUX)
+      gso_enabled_(true),
+#else
+      gso_enabled_(false),
+#endif
+      gso_skip_once_(false),
+#if defined(OS_LINUX)
+      gro_enabled_(true),
+#else
+      gro_enabled_(false),
+#endif
+      gro_active_(false),
+      busy_poll_usec_(0),
+      rx_drops_(0),
+      io_uring_(NULL) {
+  SetBatchSize(kDefaultBatchSize);
 }
 
 UdpSocketBsd::~UdpSocketBsd() {
+  FreeBatch();
+}
+
+void UdpSocketBsd::FreeBatch() {
+  if (batch_packets_) {
+    for (int i = 0; i < batch_size_; i++)
+      if (batch_packets_[i])
+        FreePacket(batch_packets_[i]);
+  }
+  delete [] batch_packets_;
+  delete [] batch_msgs_;
+  delete [] batch_iov_;
+  delete [] batch_recv_cmsg_;
+  delete [] batch_gro_buf_;
+  delete [] batch_send_msgs_;
+  delete [] batch_send_iov_;
+  delete [] batch_send_cmsg_;
+  batch_packets_ = NULL;
+  batch_msgs_ = NULL;
+  batch_iov_ = NULL;
+  batch_recv_cmsg_ = NULL;
+  batch_gro_buf_ = NULL;
+  batch_send_msgs_ = NULL;
+  batch_send_iov_ = NULL;
+  batch_send_cmsg_ = NULL;
+  batch_size_ = 1;
+}
+
+void UdpSocketBsd::SetGsoEnabled(bool enabled) {
+#if defined(OS_LINUX)
+  gso_enabled_ = enabled;
+#endif  // defined(OS_LINUX)
+}
+
+void UdpSocketBsd::SetGroEnabled(bool enabled) {
+#if defined(OS_LINUX)
+  gro_enabled_ = enabled;
+  SetBatchSize(batch_size_);
+#endif  // defined(OS_LINUX)
+}
+
+void UdpSocketBsd::SetBatchSize(int batch_size) {
+  FreeBatch();
+#if defined(OS_LINUX)
+  batch_size = std::max<int>(std::min<int>(batch_size, kMaxBatchSize), 1);
+  if (batch_size == 1)
+    return;
+  batch_packets_ = new Packet*[batch_size];
+  batch_msgs_ = new struct mmsghdr[batch_size];
+  // Each message has room for a packet, followed by a spill-over area
+  // for the remaining segments of a GRO datagram.
+  batch_iov_ = new struct iovec[batch_size * 2];
+  batch_recv_cmsg_ = new char[batch_size * kRecvCmsgSpace];
+  if (gro_enabled_)
+    batch_gro_buf_ = new byte[batch_size * kGroBufferSize];
+  batch_send_msgs_ = new struct mmsghdr[batch_size];
+  batch_send_iov_ = new struct iovec[batch_size];
+  batch_send_cmsg_ = new char[batch_size * kGsoCmsgSpace];
+  memset(batch_packets_, 0, sizeof(Packet*) * batch_size);
+  memset(batch_msgs_, 0, sizeof(struct mmsghdr) * batch_size);
+  memset(batch_send_msgs_, 0, sizeof(struct mmsghdr) * batch_size);
+  batch_size_ = batch_size;
+#endif  // defined(OS_LINUX)
 }
 
 bool UdpSocketBsd::Initialize(int listen_port) {
@@ -446,36 +1518,142 @@ bool UdpSocketBsd::Initialize(int listen_port) {
   }
   fcntl(udp_fd, F_SETFD, FD_CLOEXEC);
   fcntl(udp_fd, F_SETFL, O_NONBLOCK);
-  InitPollSlot(udp_fd, POLLIN);
+#if defined(OS_LINUX)
+  // Kernels without UDP_SEGMENT support fail to read the option.
+  if (gso_enabled_) {
+    int gso_size = 0;
+    socklen_t optlen = sizeof(gso_size);
+    if (getsockopt(udp_fd, SOL_UDP, UDP_SEGMENT, &gso_size, &optlen) != 0) {
+      RINFO("UDP GSO not supported by the kernel");
+      gso_enabled_ = false;
+    }
+  }
+  // GRO datagrams can only be received through the batched path.
+  if (gro_enabled_ && batch_size_ > 1) {
+    int one = 1;
+    gro_active_ = (setsockopt(udp_fd, SOL_UDP, UDP_GRO, &one, sizeof(one)) == 0);
+    if (!gro_active_)
+      RINFO("UDP GRO not supported by the kernel");
+  }
+  // Have the reads report how many datagrams didn't fit in the receive buffer.
+  int one = 1;
+  if (setsockopt(udp_fd, SOL_SOCKET, SO_RXQ_OVFL, &one, sizeof(one)) != 0)
+    RINFO("Unable to set SO_RXQ_OVFL: %d", errno);
+  // Raising it above net.core.busy_read needs CAP_NET_ADMIN.
+  if (busy_poll_usec_ &&
+      setsockopt(udp_fd, SOL_SOCKET, SO_BUSY_POLL, &busy_poll_usec_, sizeof(busy_poll_usec_)) != 0)
+    RINFO("Unable to set SO_BUSY_POLL: %d", errno);
+#endif  // defined(OS_LINUX)
+  InitPollSlot(udp_fd, POLLIN, true);
   udp_writable_ = true;
   return true;
 }
 
+bool UdpSocketBsd::UseIoUring() {
+#if defined(OS_LINUX)
+  IoUringBsd *uring = network_->io_uring_;
+  if (!uring || fd_ < 0)
+    return false;
+  // Multishot receives don't get the control messages, so GRO can't be used.
+  if (gro_active_) {
+    int zero = 0;
+    setsockopt(fd_, SOL_UDP, UDP_GRO, &zero, sizeof(zero));
+    gro_active_ = false;
+  }
+  SetPollFlags(0);
+  udp_readable_ = false;
+  io_uring_ = uring;
+  uring->StartReadUdp(this);
+  return true;
+#else  // defined(OS_LINUX)
+  return false;
+#endif  // defined(OS_LINUX)
+}
+
 void UdpSocketBsd::HandleEvents(int revents) {
   if (revents & (POLLERR | POLLHUP | POLLNVAL)) {
     RERROR("UDP error %d, closing.", revents);
     network_->PostExit();
   } else {
-    udp_readable_ = (revents & POLLIN) != 0;
+    udp_readable_ |= (revents & POLLIN) != 0;
     if (revents & POLLOUT) {
       SetPollFlags(POLLIN);
       udp_writable_ = true;
+      if (batch_size_ > 1)
+        AddToEndLoop();
     }
   }
   AddToRoundRobin();
 }
 
+#if defined(OS_LINUX)
+// Returns the segment size of a datagram coalesced by UDP_GRO, or 0. The
+// SO_RXQ_OVFL drop counter is stored in |drops| when it's present.
+static int ParseRecvCmsg(struct msghdr *mh, uint32 *drops) {
+  int segment_size = 0;
+  for (struct cmsghdr *cm = CMSG_FIRSTHDR(mh); cm; cm = CMSG_NXTHDR(mh, cm)) {
+    if (cm->cmsg_level == SOL_UDP && cm->cmsg_type == UDP_GRO) {
+      memcpy(&segment_size, CMSG_DATA(cm), sizeof(segment_size));
+    } else if (cm->cmsg_level == SOL_SOCKET && cm->cmsg_type == SO_RXQ_OVFL) {
+      memcpy(drops, CMSG_DATA(cm), sizeof(*drops));
+    }
+  }
+  return segment_size;
+}
+
+// The counter is only included once the kernel dropped something, so
+// |drops| is the last value seen when it's missing.
+void UdpSocketBsd::CountRxDrops(uint32 drops) {
+  if (drops != rx_drops_) {
+    network_->stats_.udp_rx_drops += (uint32)(drops - rx_drops_);
+    rx_drops_ = drops;
+  }
+}
+#endif  // defined(OS_LINUX)
+
 bool UdpSocketBsd::DoRead() {
+  if (batch_size_ > 1)
+    return DoReadBatch();
+
   socklen_t sin_len;
   Packet *read_packet = network_->read_packet_;
-  if (read_packet == NULL)
+  if (read_packet == NULL) {
     network_->read_packet_ = read_packet = AllocPacket();
+    // Past the packet memory cap, what's read is dropped.
+    if (read_packet == NULL) {
+      if (DiscardPacket(fd_))
+        return true;
+      udp_readable_ = false;
+      return false;
+    }
+  }
 
+#if defined(OS_LINUX)
+  // recvmsg so that the SO_RXQ_OVFL counter comes along.
+  char cmsg[kRecvCmsgSpace];
+  struct iovec iov = {read_packet->data, kPacketCapacity};
+  struct msghdr mh;
+  memset(&mh, 0, sizeof(mh));
+  mh.msg_name = &read_packet->addr.sin;
+  mh.msg_namelen = sizeof(read_packet->addr.sin);
+  mh.msg_iov = &iov;
+  mh.msg_iovlen = 1;
+  mh.msg_control = cmsg;
+  mh.msg_controllen = sizeof(cmsg);
+  int r = recvmsg(fd_, &mh, 0);
+  sin_len = mh.msg_namelen;
+#else  // defined(OS_LINUX)
   sin_len = sizeof(read_packet->addr.sin);
   int r = recvfrom(fd_, read_packet->data, kPacketCapacity, 0,
                    (sockaddr*)&read_packet->addr.sin, &sin_len);
+#endif  // defined(OS_LINUX)
   if (r >= 0) {
     //    printf("Read %d bytes from UDP\n", r);
+#if defined(OS_LINUX)
+    uint32 drops = rx_drops_;
+    ParseRecvCmsg(&mh, &drops);
+    CountRxDrops(drops);
+#endif  // defined(OS_LINUX)
     read_packet->sin_size = sin_len;
     read_packet->size = r;
     read_packet->protocol = kPacketProtocolUdp;
@@ -491,8 +1669,144 @@ bool UdpSocketBsd::DoRead() {
   }
 }
 
+#if defined(OS_LINUX)
+// Split a GRO datagram back into the packets it was made of. The first
+// segment stays in place in |p|, the others are copied into new packets.
+// All of them are then passed on in their original order.
+void UdpSocketBsd::HandleGroDatagram(Packet *p, uint32 segment_size, const struct iovec *iov) {
+  uint32 total_size = p->size;
+  Packet *last = p;
+  int segments = 1;
+  for (uint32 offset = segment_size; offset < total_size; offset += segment_size, segments++) {
+    Packet *q = AllocPacket();
+    // Past the packet memory cap the remaining segments are dropped.
+    if (q == NULL)
+      break;
+    q->size = std::min<uint32>(segment_size, total_size - offset);
+    CopyFromIovec(q->data, iov, offset, q->size);
+    q->sin_size = p->sin_size;
+    q->addr = p->addr;
+    q->protocol = kPacketProtocolUdp;
+    Packet_NEXT(last) = q;
+    last = q;
+  }
+  Packet_NEXT(last) = NULL;
+  p->size = segment_size;
+  NetworkBsd::Stats *stats = &network_->stats_;
+  stats->udp_recv_gro_datagrams++;
+  stats->udp_recv_gro_packets += segments;
+  Packet *ready[kWgCryptoBatchSize];
+  size_t num_ready = 0;
+  do {
+    Packet *next = Packet_NEXT(p);
+    ready[num_ready++] = p;
+    if (num_ready == kWgCryptoBatchSize || next == NULL) {
+      processor_->HandleUdpPackets(ready, num_ready, network_->overload_);
+      num_ready = 0;
+    }
+    p = next;
+  } while (p);
+}
+#endif  // defined(OS_LINUX)
+
+// Read up to |batch_size_| datagrams with a single syscall, and pass them
+// all on to the processor.
+bool UdpSocketBsd::DoReadBatch() {
+#if defined(OS_LINUX)
+  int n = batch_size_;
+  Packet **packets = batch_packets_;
+  struct mmsghdr *msgs = batch_msgs_;
+  bool gro = gro_active_;
+  for (int i = 0; i < n; i++) {
+    struct iovec *iov = &batch_iov_[i * 2];
+    if (packets[i] == NULL) {
+      Packet *p = packets[i] = AllocPacket();
+      // Past the packet memory cap, read into the packets there are.
+      if (p == NULL) {
+        n = i;
+        break;
+      }
+      iov[0].iov_base = p->data;
+      iov[0].iov_len = kPacketCapacity;
+      iov[1].iov_base = batch_gro_buf_ + i * kGroBufferSize;
+      iov[1].iov_len = kGroBufferSize;
+      msgs[i].msg_hdr.msg_name = &p->addr.sin;
+      msgs[i].msg_hdr.msg_iov = iov;
+      msgs[i].msg_hdr.msg_iovlen = gro ? 2 : 1;
+    }
+    msgs[i].msg_hdr.msg_namelen = sizeof(packets[i]->addr.sin);
+    msgs[i].msg_hdr.msg_control = batch_recv_cmsg_ + i * kRecvCmsgSpace;
+    msgs[i].msg_hdr.msg_controllen = kRecvCmsgSpace;
+  }
+  if (n == 0) {
+    if (DiscardPacket(fd_))
+      return true;
+    udp_readable_ = false;
+    return false;
+  }
+  int r = recvmmsg(fd_, msgs, n, 0, NULL);
+  if (r <= 0) {
+    if (r < 0 && errno != EAGAIN)
+      fprintf(stderr, "Read from UDP failed\n");
+    udp_readable_ = false;
+    return false;
+  }
+  NetworkBsd::Stats *stats = &network_->stats_;
+  stats->udp_recv_calls++;
+  stats->udp_recv_packets += r;
+  stats->udp_recv_full_batches += (r == n);
+  uint32 drops = rx_drops_;
+  // Detach all packets from the batch before handing them to the processor,
+  // which decrypts up to kWgCryptoBatchSize of them together.
+  Packet *ready[kWgCryptoBatchSize];
+  size_t num_ready = 0;
+  for (int i = 0; i < r; i++) {
+    Packet *p = packets[i];
+    packets[i] = NULL;
+    p->sin_size = msgs[i].msg_hdr.msg_namelen;
+    p->size = msgs[i].msg_len;
+    p->protocol = kPacketProtocolUdp;
+    int segment_size = ParseRecvCmsg(&msgs[i].msg_hdr, &drops);
+    bool split = gro && segment_size > 0 && p->size > (uint32)segment_size;
+    // With GRO the datagram may continue into the spill buffer. Packets are
+    // processed in place, so anything that doesn't fit in one is dropped
+    // whole, as are GRO datagrams with segments that don't.
+    if ((split ? (uint32)segment_size : p->size) > kPacketCapacity ||
+        (msgs[i].msg_hdr.msg_flags & MSG_TRUNC)) {
+      stats->udp_rx_oversized++;
+      FreePacket(p);
+      continue;
+    }
+    if (split) {
+      processor_->HandleUdpPackets(ready, num_ready, network_->overload_);
+      num_ready = 0;
+      HandleGroDatagram(p, segment_size, &batch_iov_[i * 2]);
+    } else {
+      ready[num_ready++] = p;
+      if (num_ready == kWgCryptoBatchSize) {
+        processor_->HandleUdpPackets(ready, num_ready, network_->overload_);
+        num_ready = 0;
+      }
+    }
+  }
+  processor_->HandleUdpPackets(ready, num_ready, network_->overload_);
+  CountRxDrops(drops);
+  // A partial batch means the socket buffer was drained, so skip the
+  // extra syscall that would just return EAGAIN.
+  if (r < n) {
+    udp_readable_ = false;
+    return false;
+  }
+  return true;
+#else  // defined(OS_LINUX)
+  return false;
+#endif  // defined(OS_LINUX)
+}
+
 bool UdpSocketBsd::DoWrite() {
   assert(udp_writable_);
+  if (batch_size_ > 1)
+    return DoWriteBatch();
   //  RINFO("Send %d bytes to %s", (int)udp_queue_->size, inet_ntoa(udp_queue_->sin.sin_addr));
   int r = sendto(fd_, udp_queue_->data, udp_queue_->size, 0,
                  (sockaddr*)&udp_queue_->addr.sin, sizeof(udp_queue_->addr.sin));
@@ -511,24 +1825,149 @@ bool UdpSocketBsd::DoWrite() {
   }
   Packet *next = Packet_NEXT(udp_queue_);
   FreePacket(udp_queue_);
+  udp_queue_size_--;
   if ((udp_queue_ = next) != NULL) return true;
   udp_queue_end_ = &udp_queue_;
   return false;
 }
 
+#if defined(OS_LINUX)
+static inline bool IsSameUdpEndpoint(const Packet *a, const Packet *b) {
+  return a->addr.sin.sin_addr.s_addr == b->addr.sin.sin_addr.s_addr &&
+         a->addr.sin.sin_port == b->addr.sin.sin_port;
+}
+#endif  // defined(OS_LINUX)
+
+// Send up to |batch_size_| queued datagrams with a single syscall. Each
+// message carries its own destination address. With GSO, runs of packets
+// to the same endpoint are joined into one message that the kernel splits
+// up again at the UDP_SEGMENT size.
+bool UdpSocketBsd::DoWriteBatch() {
+#if defined(OS_LINUX)
+  struct mmsghdr *msgs = batch_send_msgs_;
+  struct iovec *iov = batch_send_iov_;
+  bool use_gso = gso_enabled_ && !gso_skip_once_;
+  int n = 0, niov = 0;
+  gso_skip_once_ = false;
+  for (Packet *p = udp_queue_; p && niov < batch_size_; n++) {
+    Packet *first = p;
+    uint32 segment_size = p->size, total_size = 0;
+    int segments = 0;
+    struct msghdr *mh = &msgs[n].msg_hdr;
+    mh->msg_name = &p->addr.sin;
+    mh->msg_namelen = sizeof(p->addr.sin);
+    mh->msg_iov = &iov[niov];
+    // All segments must have the size of the first one, except the last
+    // one which may be shorter.
+    for (;;) {
+      iov[niov].iov_base = p->data;
+      iov[niov].iov_len = p->size;
+      niov++, segments++;
+      total_size += p->size;
+      bool is_short = (p->size < segment_size);
+      p = Packet_NEXT(p);
+      if (!use_gso || is_short || p == NULL || niov == batch_size_ ||
+          segments == kMaxGsoSegments || p->size > segment_size ||
+          total_size + p->size > kMaxGsoBytes || !IsSameUdpEndpoint(first, p))
+        break;
+    }
+    mh->msg_iovlen = segments;
+    if (segments > 1) {
+      struct cmsghdr *cm = (struct cmsghdr*)(batch_send_cmsg_ + n * kGsoCmsgSpace);
+      uint16_t gso_size = segment_size;
+      cm->cmsg_level = SOL_UDP;
+      cm->cmsg_type = UDP_SEGMENT;
+      cm->cmsg_len = CMSG_LEN(sizeof(gso_size));
+      memcpy(CMSG_DATA(cm), &gso_size, sizeof(gso_size));
+      mh->msg_control = cm;
+      mh->msg_controllen = kGsoCmsgSpace;
+    } else {
+      mh->msg_control = NULL;
+      mh->msg_controllen = 0;
+    }
+  }
+  int r = sendmmsg(fd_, msgs, n, 0), packets_done = 0;
+  if (r < 0) {
+    if (errno == EAGAIN) {
+      udp_writable_ = false;
+      SetPollFlags(POLLIN | POLLOUT);
+      return false;
+    }
+    if (msgs[0].msg_hdr.msg_iovlen > 1) {
+      // Resend the run as individual datagrams, and stop using GSO
+      // altogether if the kernel or device can't do it.
+      if (errno == EIO || errno == ENOPROTOOPT || errno == EOPNOTSUPP) {
+        RINFO("UDP GSO failed with error %d, disabling", errno);
+        gso_enabled_ = false;
+      }
+      gso_skip_once_ = true;
+      return true;
+    }
+    // The error refers to the first message, drop it and keep going.
+    perror("Write to UDP failed");
+    packets_done = 1;
+  } else {
+    NetworkBsd::Stats *stats = &network_->stats_;
+    for (int i = 0; i < r; i++) {
+      int segments = (int)msgs[i].msg_hdr.msg_iovlen;
+      packets_done += segments;
+      if (segments > 1) {
+        stats->udp_send_gso_messages++;
+        stats->udp_send_gso_packets += segments;
+      }
+    }
+    stats->udp_send_calls++;
+    stats->udp_send_packets += packets_done;
+  }
+  // On a partial send only the packets that went out are freed, the error
+  // for the next one (if any) is reported by the next call.
+  Packet *p = udp_queue_;
+  for (int i = 0; i < packets_done; i++) {
+    Packet *next = Packet_NEXT(p);
+    FreePacket(p);
+    p = next;
+  }
+  udp_queue_size_ -= packets_done;
+  if ((udp_queue_ = p) != NULL) return true;
+  udp_queue_end_ = &udp_queue_;
+  return false;
+#else  // defined(OS_LINUX)
+  return false;
+#endif  // defined(OS_LINUX)
+}
+
 void UdpSocketBsd::WritePacket(Packet *packet) {
   assert(fd_ >= 0);
+#if defined(OS_LINUX)
+  if (io_uring_) {
+    io_uring_->WriteUdpPacket(this, packet);
+    return;
+  }
+#endif  // defined(OS_LINUX)
   Packet *queue_is_used = udp_queue_;
   *udp_queue_end_ = packet;
   udp_queue_end_ = &Packet_NEXT(packet);
   packet->queue_next = NULL;
-  if (!queue_is_used)
+  udp_queue_size_++;
+  if (batch_size_ > 1) {
+    // Let packets accumulate until the end of the loop, unless a full
+    // batch is already available.
+    if (udp_queue_size_ >= batch_size_ && udp_writable_)
+      DoWrite();
+    else
+      AddToEndLoop();
+  } else if (!queue_is_used) {
     DoWrite();
+  }
+}
+
+void UdpSocketBsd::DoEndloop() {
+  while (udp_queue_ && udp_writable_ && DoWrite()) {}
 }
 
 bool UdpSocketBsd::DoRoundRobin() {
   bool did_work = false;
-  if (udp_queue_ && udp_writable_)
+  if (udp_queue_ && udp_writable_ && (batch_size_ == 1 || udp_queue_size_ >= batch_size_))
     did_work = DoWrite();
   if (udp_readable_)
     did_work |= DoRead();
@@ -937,7 +2376,19 @@ void TcpSocketBsd::DoEndloop() {
 }
 
 void TcpSocketBsd::DoRead() {
-  ssize_t bytes_read = readv(fd_, network_->iov_, NetworkBsd::kMaxIovec);
+  NetworkBsd *net = network_;
+  // The buffers must be in one run. Past the packet memory cap the data
+  // stays in the socket until packets are freed.
+  int num_iov = 0;
+  for (; num_iov < NetworkBsd::kMaxIovec; num_iov++) {
+    if (net->iov_packets_[num_iov] == NULL)
+      net->ReallocateIov(num_iov);
+    if (net->iov_packets_[num_iov] == NULL)
+      break;
+  }
+  if (num_iov == 0)
+    return;
+  ssize_t bytes_read = readv(fd_, net->iov_, num_iov);
   ssize_t bytes_read_org = bytes_read;
   if (bytes_read < 0) {
     if (errno != EAGAIN) {
@@ -947,7 +2398,6 @@ void TcpSocketBsd::DoRead() {
     return;
   }
   // Go through and read the packet structures that are ready and queue them up
-  NetworkBsd *net = network_;
   for (size_t j = 0; bytes_read; j++) {
     size_t m = std::min<size_t>(bytes_read, net->iov_[j].iov_len);
     Packet *p = net->iov_packets_[j];
@@ -1008,6 +2458,60 @@ void TcpSocketBsd::CloseSocketAndDestroy() {
   delete this;
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+
+#if defined(OS_LINUX)
+TimerFdBsd::TimerFdBsd(NetworkBsd *network)
+    : BaseSocketBsd(network),
+      deadline_(0),
+      fired_(false) {
+}
+
+TimerFdBsd::~TimerFdBsd() {
+}
+
+bool TimerFdBsd::Initialize() {
+  if (!HasFreePollSlot()) {
+    RERROR("No free poll slots for the timer");
+    return false;
+  }
+  int fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+  if (fd < 0) {
+    RERROR("timerfd_create failed");
+    return false;
+  }
+  InitPollSlot(fd, POLLIN);
+  return true;
+}
+
+void TimerFdBsd::SetDeadline(uint64 deadline) {
+  if (deadline == deadline_)
+    return;
+  // OsGetMilliseconds uses CLOCK_MONOTONIC too, so this can be absolute.
+  struct itimerspec its = {0};
+  its.it_value.tv_sec = deadline / 1000;
+  its.it_value.tv_nsec = (deadline % 1000) * 1000000;
+  if (timerfd_settime(fd_, TFD_TIMER_ABSTIME, &its, NULL) < 0) {
+    RERROR("timerfd_settime failed");
+    return;
+  }
+  deadline_ = deadline;
+  network_->stats_.timer_rearms++;
+}
+
+void TimerFdBsd::HandleEvents(int revents) {
+  if (revents & POLLIN) {
+    uint64 expirations;
+    if (read(fd_, &expirations, sizeof(expirations)) == sizeof(expirations)) {
+      network_->stats_.timer_wakeups++;
+      fired_ = true;
+      // It needs to be armed again after each expiration
+      deadline_ = 0;
+    }
+  }
+}
+#endif  // defined(OS_LINUX)
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 NotificationPipeBsd::NotificationPipeBsd(NetworkBsd *network)
     : BaseSocketBsd(network),
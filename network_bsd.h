@@ -9,20 +9,54 @@
 #include <string>
 #include "network_common.h"
 
+struct mmsghdr;
+struct virtio_net_hdr;
+struct epoll_event;
+struct msghdr;
+struct io_uring_sqe;
+struct io_uring_cqe;
+struct io_uring_buf;
+struct xdp_ring_offset;
+
 class BaseSocketBsd;
+class IoUringBsd;
+class XdpSocketBsd;
+class TimerFdBsd;
 class TcpSocketBsd;
 class WireguardProcessor;
 class Packet;
+class UdpInterface;
+class WorkerLoop;
+class UdpLoop;
+class TunLoop;
+class PacketQueueMt;
+
+// Packets come from 2MB regions of at most |max_bytes| of address space, once
+// they're all in use AllocPacket returns NULL. Regions that are entirely free
+// are unmapped once more than |high_watermark| packets are free, down to
+// |low_watermark|. Zero keeps the current setting, and the cap can only be
+// set before the first packet is allocated. It must be at least 8MB.
+bool ConfigurePacketArena(size_t max_bytes, uint32 low_watermark, uint32 high_watermark);
+// Called once a second by the main thread.
+void TrimPacketArena();
+// Reads one packet or datagram from |fd| and drops it, for the readers that
+// got no packet from AllocPacket. Returns false if there was nothing to read.
+bool DiscardPacket(int fd);
 
 class NetworkBsd {
   friend class BaseSocketBsd;
   friend class TcpSocketBsd;
   friend class UdpSocketBsd;
   friend class TunSocketBsd;
+  friend class IoUringBsd;
+  friend class TimerFdBsd;
 public:
   enum {
 #if defined(OS_ANDROID)
     WithSigalarmSupport = 0,
+#elif defined(OS_LINUX)
+    // Linux uses a timerfd in the poll set instead
+    WithSigalarmSupport = 0,
 #else
     WithSigalarmSupport = 1
 #endif
@@ -31,12 +65,74 @@ public:
   class NetworkBsdDelegate {
   public:
     virtual void OnSecondLoop(uint64 now) {}
+    // Returns when OnSecondLoop needs to be called next, in milliseconds.
+    // Only used on Linux, where the loop sleeps until that deadline.
+    virtual uint64 GetNextTimerDeadline(uint64 now) { return now + 1000; }
     virtual void RunAllMainThreadScheduled() {}
   };
 
+  // Counters for the socket layer, exposed through the configuration protocol.
+  struct Stats {
+    // Number of recvmmsg calls that returned data, and the packets they returned.
+    uint64 udp_recv_calls, udp_recv_packets;
+    // Number of recvmmsg calls that completely filled the batch.
+    uint64 udp_recv_full_batches;
+    // Number of UDP_GRO datagrams received, and the packets they were split into.
+    uint64 udp_recv_gro_datagrams, udp_recv_gro_packets;
+    // Number of sendmmsg calls that sent data, and the packets they sent.
+    uint64 udp_send_calls, udp_send_packets;
+    // Number of UDP_SEGMENT messages sent, and the packets they contained.
+    uint64 udp_send_gso_messages, udp_send_gso_packets;
+    // Number of TSO/USO super-packets read from tun, and the segments they made.
+    uint64 tun_read_gso_packets, tun_read_gso_segments;
+    // Number of merged packets written to tun, and the segments they contained.
+    uint64 tun_write_gso_packets, tun_write_gso_segments;
+    // Number of io_uring_enter calls that submitted work, and the SQEs they submitted.
+    uint64 uring_submit_calls, uring_sqes;
+    // Number of io_uring completions, and multishot reads that had to be re-armed.
+    uint64 uring_cqes, uring_read_rearms;
+    // Number of datagrams received and sent through io_uring.
+    uint64 uring_udp_recv_packets, uring_udp_send_packets;
+    // Number of datagrams dropped because too many sends were in flight, or
+    // because a send that found the socket buffer full couldn't be retried.
+    uint64 uring_send_drops;
+    // Number of sends retried once the socket buffer had room again.
+    uint64 uring_send_retries;
+    // Number of failed writes to tun through io_uring, and the packets dropped
+    // because too many writes were in flight.
+    uint64 uring_tun_write_errors, uring_tun_write_drops;
+    // Time spent spinning in busy poll, and spins that found events or gave up.
+    uint64 busy_poll_usec, busy_poll_hits, busy_poll_misses;
+    // Time spent sleeping in poll and the number of sleeps, with busy poll on.
+    uint64 sleep_usec, sleeps;
+    // Number of times the timer fired, and the number of times it was moved.
+    uint64 timer_wakeups, timer_rearms;
+    // Datagrams the kernel dropped because the udp receive buffer was full,
+    // and with threads also those dropped because the inbox was full.
+    uint64 udp_rx_drops;
+    // Datagrams, or GRO segments, that were too big for a packet and dropped.
+    uint64 udp_rx_oversized;
+    // Round robin steps that ran out of budget with work left, and the
+    // number of times we went into the overload state.
+    uint64 rr_backlogs, overload_events;
+  };
+
   explicit NetworkBsd(NetworkBsdDelegate *delegate, int max_sockets);
   ~NetworkBsd();
 
+  // Use epoll instead of poll to wait for events, must be called before
+  // any sockets are added.
+  bool UseEpoll();
+
+  // Create an io_uring that the tun and udp sockets can use for their
+  // reads and writes. Returns false if the kernel lacks support.
+  bool UseIoUring();
+  IoUringBsd *io_uring() { return io_uring_; }
+
+  // While there is traffic, spin on non-blocking polls for up to |usec|
+  // microseconds before going to sleep. 0 disables it.
+  void SetBusyPoll(int usec) { busy_poll_usec_ = usec; }
+
   void RunLoop(const sigset_t *sigmask);
   void PostExit() { exit_ = true; }
 
@@ -45,8 +141,14 @@ public:
 
   TcpSocketBsd *tcp_sockets() { return tcp_sockets_; }
   bool overload() { return overload_; }
+  Stats &stats() { return stats_; }
+
+  // Append the stats as key=value lines
+  void AppendStats(std::string *result);
 private:
   void RemoveFromRoundRobin(int slot);
+  int BusyPoll(const sigset_t *sigmask);
+  void UpdateOverload(bool backlog, uint64 rr_usec, uint64 now_usec);
 
   void ReallocateIov(size_t i);
   void EnsureIovAllocated();
@@ -59,6 +161,21 @@ private:
   enum {
     // This controls the max # of sockets we can support
     kMaxIovec = 16,
+    // Max # of events returned by each epoll_wait
+    kMaxEpollEvents = 256,
+    // Longest time the timer sleeps even if there's no deadline
+    kMaxTimerIntervalMs = 10000,
+    // Limits for the number of round robin passes between two polls
+    kMinRoundRobinBudget = 16,
+    kMaxRoundRobinBudget = 4096,
+    kDefaultRoundRobinBudget = 256,
+    // How long the round robin passes may keep the other sockets waiting
+    kRoundRobinTargetUsec = 2000,
+    // Number of polls in a row that left work behind, which means we're
+    // not keeping up
+    kOverloadBacklogIterations = 3,
+    // How long the overload state stays on after the last sign of it
+    kOverloadHoldUsec = 4000000,
   };
   int num_sock_;
   int num_roundrobin_;
@@ -67,12 +184,30 @@ private:
 
   SimplePacketPool packet_pool_;
   NetworkBsdDelegate *delegate_;
+  Stats stats_;
   
   struct pollfd *pollfd_;
   BaseSocketBsd **sockets_;
   BaseSocketBsd **roundrobin_;
   BaseSocketBsd **endloop_;
 
+  // With epoll, the events currently being handled. Sockets that are closed
+  // clear their pending entries.
+  int epoll_fd_;
+  int epoll_cur_, epoll_num_;
+  struct epoll_event *epoll_events_;
+
+  IoUringBsd *io_uring_;
+
+  int busy_poll_usec_;
+
+  // Number of round robin passes allowed between two polls, adjusted
+  // after each step so they take about kRoundRobinTargetUsec.
+  int rr_budget_;
+  int backlog_iterations_;
+  uint64 overload_until_;
+  uint64 last_udp_rx_drops_;
+
   // Linked list of all tcp sockets
   TcpSocketBsd *tcp_sockets_;
 
@@ -84,7 +219,7 @@ private:
 class BaseSocketBsd {
   friend class NetworkBsd;
 public:
-  BaseSocketBsd(NetworkBsd *network) : pollfd_slot_(-1), roundrobin_slot_(-1), endloop_slot_(-1), fd_(-1), network_(network) {}
+  BaseSocketBsd(NetworkBsd *network) : pollfd_slot_(-1), roundrobin_slot_(-1), endloop_slot_(-1), fd_(-1), edge_triggered_(false), network_(network) {}
   virtual ~BaseSocketBsd();
 
   virtual void HandleEvents(int revents) = 0;
@@ -103,10 +238,10 @@ public:
   int GetFd() { return fd_; }
 
 protected:
-  void SetPollFlags(int events) {
-    network_->pollfd_[pollfd_slot_].events = events;
-  }
-  void InitPollSlot(int fd, int events);
+  void SetPollFlags(int events);
+  // |edge_triggered| may only be used by sockets that keep reading until
+  // EAGAIN, it has no effect unless epoll is used.
+  void InitPollSlot(int fd, int events, bool edge_triggered = false);
   bool HasFreePollSlot() { return network_->num_sock_ != network_->max_sockets_; }
   void CloseSocket();
 
@@ -115,52 +250,390 @@ protected:
   int roundrobin_slot_;
   int endloop_slot_;
   int fd_;
+  bool edge_triggered_;
 };
 
 class TunSocketBsd : public BaseSocketBsd {
+  friend class IoUringBsd;
 public:
   explicit TunSocketBsd(NetworkBsd *network, WireguardProcessor *processor);
   virtual ~TunSocketBsd();
 
   bool Initialize(int fd);
 
+  // Use the offload support of the tun device, the fd must have been
+  // opened with IFF_VNET_HDR. Super-packets from the kernel are split up
+  // when read, and TCP segments are merged when written.
+  void EnableOffload();
+
+  // Hand reads and writes over to the io_uring of the network. Returns
+  // false if there is none or offload is enabled, poll is used then.
+  bool UseIoUring();
+
   virtual void HandleEvents(int revents) override;
   virtual bool DoRoundRobin() override;
+  virtual void DoEndloop() override;
 
   void WritePacket(Packet *packet);
 
   bool tun_interface_gone() const { return tun_interface_gone_; }
 
+  // Number of packets read from and written to the tun fd.
+  uint64 rx_packets() const { return rx_packets_; }
+  uint64 tx_packets() const { return tx_packets_; }
+
+  enum {
+    // Largest TSO/USO packet the kernel can hand us
+    kGsoBufferSize = 65536,
+    // Max size of the IP and TCP/UDP headers of a packet to split or merge
+    kMaxGsoHeaderSize = 128,
+    // Max number of packets merged into one write
+    kMaxCoalesce = 64,
+  };
+
 private:
   bool DoRead();
   bool DoWrite();
+  bool DoReadOffload();
+  bool DoWriteOffload();
+  bool HandleGsoPacket(Packet *packet, const struct virtio_net_hdr *hdr, const struct iovec *iov);
 
   bool tun_readable_, tun_writable_;
   bool tun_interface_gone_;
+  bool offload_;
+  uint64 rx_packets_, tx_packets_;
   Packet *tun_queue_, **tun_queue_end_;
+  int tun_queue_size_;
   WireguardProcessor *processor_;
+  byte *gso_buf_;
+  IoUringBsd *io_uring_;
 };
 
 class UdpSocketBsd : public BaseSocketBsd {
+  friend class IoUringBsd;
 public:
   explicit UdpSocketBsd(NetworkBsd *network, WireguardProcessor *processor);
   virtual ~UdpSocketBsd();
 
   bool Initialize(int listen_port);
 
+  // Set the max # of datagrams to read or write with each recvmmsg/sendmmsg,
+  // 1 disables batching.
+  void SetBatchSize(int batch_size);
+
+  // Enable or disable UDP GSO for batched sends, must be called before
+  // Initialize. Only used if the kernel supports it.
+  void SetGsoEnabled(bool enabled);
+
+  // Enable or disable UDP GRO for batched receives, must be called before
+  // Initialize. Only used if the kernel supports it.
+  void SetGroEnabled(bool enabled);
+
+  // Set SO_BUSY_POLL on the socket, must be called before Initialize.
+  void SetBusyPoll(int usec) { busy_poll_usec_ = usec; }
+
+  // Hand reads and writes over to the io_uring of the network, must be
+  // called after Initialize. Returns false if there is none.
+  bool UseIoUring();
+
   virtual void HandleEvents(int revents) override;
   virtual bool DoRoundRobin() override;
+  virtual void DoEndloop() override;
 
   bool DoRead();
   bool DoWrite();
 
   void WritePacket(Packet *packet);
+
+  enum {
+    kMaxBatchSize = 256,
+#if defined(OS_LINUX)
+    kDefaultBatchSize = 32,
+#else
+    kDefaultBatchSize = 1,
+#endif
+    // Limits for the segments joined into one UDP_SEGMENT message.
+    kMaxGsoSegments = 64,
+    kMaxGsoBytes = 65000,
+    // Spill-over area for each GRO datagram, past the first packet.
+    kGroBufferSize = 65536,
+  };
   
 private:
+  bool DoReadBatch();
+  void HandleGroDatagram(Packet *p, uint32 segment_size, const struct iovec *iov);
+  // Add the growth of the SO_RXQ_OVFL counter to the udp_rx_drops stat.
+  void CountRxDrops(uint32 drops);
+  bool DoWriteBatch();
+  void FreeBatch();
+
   bool udp_readable_, udp_writable_;
   Packet *udp_queue_, **udp_queue_end_;
+  int udp_queue_size_;
+  WireguardProcessor *processor_;
+
+  // Packets and message headers used by recvmmsg
+  int batch_size_;
+  Packet **batch_packets_;
+  struct mmsghdr *batch_msgs_;
+  struct iovec *batch_iov_;
+  char *batch_recv_cmsg_;
+  byte *batch_gro_buf_;
+
+  // Message headers used by sendmmsg
+  struct mmsghdr *batch_send_msgs_;
+  struct iovec *batch_send_iov_;
+  char *batch_send_cmsg_;
+  bool gso_enabled_;
+  bool gso_skip_once_;
+  bool gro_enabled_;
+  bool gro_active_;
+  int busy_poll_usec_;
+  // The SO_RXQ_OVFL drop counter of the socket, as last seen
+  uint32 rx_drops_;
+  IoUringBsd *io_uring_;
+};
+
+#if defined(OS_LINUX)
+// Runs the reads and writes of the tun and udp sockets through io_uring.
+// Reads are multishot requests that stay armed and take their packets from
+// a provided buffer ring, writes are queued as SQEs and submitted together
+// at the end of the loop. The ring fd is in the poll set so we wake up
+// when there are completions.
+class IoUringBsd : public BaseSocketBsd {
+public:
+  explicit IoUringBsd(NetworkBsd *network);
+  virtual ~IoUringBsd();
+
+  bool Initialize();
+
+  // Arm the multishot read of a socket.
+  void StartReadUdp(UdpSocketBsd *udp);
+  void StartReadTun(TunSocketBsd *tun);
+
+  void WriteUdpPacket(UdpSocketBsd *udp, Packet *packet);
+  void WriteTunPacket(TunSocketBsd *tun, Packet *packet);
+
+  virtual void HandleEvents(int revents) override;
+  virtual bool DoRoundRobin() override;
+  virtual void DoEndloop() override;
+
+  enum {
+    kSqEntries = 256,
+    kCqEntries = 4096,
+    // Number of packets in each provided buffer ring, power of two
+    kBufferRingEntries = 512,
+    // Max # of udp sends and tun writes in flight
+    kMaxSendOps = 1024,
+    // Max # of completions handled in each round robin step
+    kMaxCqesPerStep = 64,
+  };
+
+private:
+  struct SendOp;
+  enum {
+    kUdpGroup = 0,
+    kTunGroup = 1,
+    kNumGroups = 2,
+  };
+
+  bool SetupBufferRing(int group);
+  void AddBuffer(int group, int bid);
+  void PublishBuffers(int group);
+  Packet *TakeBuffer(int group, int bid);
+  struct io_uring_sqe *GetSqe();
+  void Submit();
+  void PrepareSend(struct io_uring_sqe *sqe, SendOp *op);
+  bool RetrySend(SendOp *op);
+  void HandleCompletion(const struct io_uring_cqe *cqe);
+  void HandleUdpRead(UdpSocketBsd *udp, const struct io_uring_cqe *cqe);
+  void HandleTunRead(TunSocketBsd *tun, const struct io_uring_cqe *cqe);
+
+  void *ring_ptr_;
+  size_t ring_size_;
+  struct io_uring_sqe *sqes_;
+  size_t sqes_size_;
+  unsigned *sq_head_, *sq_tail_, *sq_array_;
+  unsigned sq_mask_, sq_entries_;
+  unsigned sq_local_tail_, sq_submitted_;
+  unsigned *cq_head_, *cq_tail_;
+  unsigned cq_mask_;
+  struct io_uring_cqe *cqes_;
+
+  struct io_uring_buf *buf_ring_[kNumGroups];
+  Packet **buf_packets_[kNumGroups];
+  uint16 buf_tail_[kNumGroups];
+
+  struct msghdr *recv_msg_;
+  SendOp *send_ops_, *free_send_ops_;
+};
+
+// Receives and sends the WireGuard udp traffic of one interface through an
+// AF_XDP socket. An XDP program redirects IPv4 udp packets for the listen
+// port to the socket, and the UMEM frames they arrive in are used directly
+// as Packets. Outgoing packets are copied into UMEM frames, with headers
+// built from what was learned from the packets of the same peer. Packets to
+// peers we haven't heard from yet go out through the regular udp socket.
+class XdpSocketBsd : public BaseSocketBsd {
+public:
+  explicit XdpSocketBsd(NetworkBsd *network, WireguardProcessor *processor);
+  virtual ~XdpSocketBsd();
+
+  // |udp| must already be bound to the listen port.
+  bool Initialize(const char *ifname, UdpSocketBsd *udp);
+
+  void WritePacket(Packet *packet);
+
+  virtual void HandleEvents(int revents) override;
+  virtual bool DoRoundRobin() override;
+  virtual void DoEndloop() override;
+
+  // Called by FreePacket, packets that live in the UMEM go back to the
+  // fill ring.
+  static bool IsUmemPacket(Packet *packet) {
+    return (size_t)((uint8*)packet - umem_begin_) < umem_size_;
+  }
+  static void FreeUmemPacket(Packet *packet);
+  // Whether some socket has a UMEM, so packets may live in it.
+  static bool HasUmem() { return umem_size_ != 0; }
+
+  uint64 rx_packets() const { return rx_packets_; }
+  uint64 tx_packets() const { return tx_packets_; }
+  uint64 tx_fallbacks() const { return tx_fallbacks_; }
+
+  enum {
+    kFrameSize = 4096,
+    kNumRxFrames = 2048,
+    kNumTxFrames = 1024,
+    // Size of each ring, the fill ring must fit all rx frames.
+    kRingSize = 2048,
+    // Max # of packets received in each round robin step
+    kMaxRxPerStep = 64,
+  };
+
+private:
+  struct Ring {
+    uint32 *producer, *consumer, *flags;
+    void *desc;
+    uint32 cached;
+    void *map;
+    size_t map_size;
+  };
+  bool MapRing(Ring *ring, const struct xdp_ring_offset *off, uint32 entry_size, uint64 pgoff);
+  bool LoadProgram(int ifindex, uint16 port);
+  void HandleFrame(uint64 addr, uint32 len);
+  void ReapCompletions();
+  bool WriteFrame(Packet *packet);
+
+  WireguardProcessor *processor_;
+  UdpSocketBsd *udp_;
+  int map_fd_, prog_fd_, link_fd_;
+  uint8 *umem_;
+  Ring rx_, tx_, fill_, comp_;
+  uint16 port_;
+  uint8 mac_[6];
+  uint64 *free_tx_;
+  int num_free_tx_;
+  int rx_frames_out_;
+  uint64 rx_packets_, tx_packets_, tx_fallbacks_;
+
+  static uint8 *umem_begin_;
+  static size_t umem_size_;
+  static XdpSocketBsd *umem_owner_;
+};
+#endif  // defined(OS_LINUX)
+
+#if defined(OS_LINUX)
+// A timerfd in the poll set that wakes up the loop at an absolute
+// CLOCK_MONOTONIC deadline, in place of the SIGALRM every second.
+class TimerFdBsd : public BaseSocketBsd {
+public:
+  explicit TimerFdBsd(NetworkBsd *network);
+  virtual ~TimerFdBsd();
+
+  bool Initialize();
+  // Arm the timer to fire at |deadline|, in OsGetMilliseconds() time.
+  void SetDeadline(uint64 deadline);
+  // Returns true once after the timer fired.
+  bool CheckFired() { bool rv = fired_; fired_ = false; return rv; }
+
+  virtual void HandleEvents(int revents) override;
+
+private:
+  uint64 deadline_;
+  bool fired_;
+};
+#endif  // defined(OS_LINUX)
+
+#if defined(OS_LINUX)
+// Runs the data plane on several threads (--threads). The udp socket and the
+// tun device get dedicated reader and writer threads, and data packets are
+// encrypted and decrypted by a pool of WorkerLoop threads. Handshakes, timers
+// and the control sockets stay on the NetworkBsd loop, this socket is how the
+// other threads hand packets to it and wake it up.
+class ThreadedDataPlaneBsd : public BaseSocketBsd {
+  friend class WorkerLoop;
+  friend class UdpLoop;
+  friend class TunLoop;
+public:
+  ThreadedDataPlaneBsd(NetworkBsd *network, WireguardProcessor *processor, UdpInterface *udp,
+                       int num_workers, int num_tun_queues);
+  virtual ~ThreadedDataPlaneBsd();
+
+  bool InitializeUdp(int listen_port);
+  // Takes ownership of |udp_fd|, a socket that's already bound.
+  void InitializeUdpSocket(int udp_fd);
+  // Takes ownership of the fds of all num_tun_queues() queues.
+  bool InitializeTun(const int *tun_fds);
+  int num_tun_queues() const { return num_tun_; }
+
+  void Start();
+  void Stop();
+
+  // Called for all packets the processor writes. Returns false for tcp
+  // packets written from the main thread, the caller writes those.
+  bool WriteUdpPacket(Packet *packet);
+  void WriteTunPacket(Packet *packet);
+
+  // Called by the main thread once per loop iteration, deletes the objects
+  // that all workers have stopped using.
+  void MainCheckpoint();
+
+  void AppendStats(std::string *result);
+
+  virtual void HandleEvents(int revents) override;
+  virtual bool DoRoundRobin() override;
+
+  enum {
+    kMaxWorkers = 64,
+    kMaxTunQueues = 16,
+    // Max # of packets read or written with each syscall
+    kBatchSize = 64,
+    // Max # of inbox packets handled in each round robin step
+    kMaxInboxPerStep = 16,
+  };
+
+private:
+  void PostToMainThread(Packet *packet);
+  void Wakeup();
+
   WireguardProcessor *processor_;
+  UdpInterface *udp_interface_;
+  int num_workers_;
+  int num_tun_;
+  bool started_;
+  WorkerLoop *workers_[kMaxWorkers];
+  UdpLoop *udp_;
+  TunLoop *tun_[kMaxTunQueues];
+  // Packets for the main thread, handshakes and tcp writes.
+  PacketQueueMt *inbox_;
+  // Taken from the inbox but not handled yet.
+  Packet *inbox_pending_;
+  // How much of the udp and inbox drops went into udp_rx_drops.
+  uint64 reported_drops_;
+  std::atomic<bool> wakeup_pending_;
 };
+#endif  // defined(OS_LINUX)
 
 #if defined(OS_LINUX)
 // Keeps track of when the unix socket gets deleted
@@ -1,585 +1,1090 @@
 // SPDX-License-Identifier: AGPL-1.0-only
 // Copyright (C) 2018 Ludvig Strigeus <info@tunsafe.com>. All Rights Reserved.
-// Note: This is an experimental implementation that doesn't work, there's no way
-// for the alarm signal to interrupt the tunsafe main thread.
-#include "network_bsd_common.h"
-#include "tunsafe_endian.h"
+// The multithreaded data plane of the Linux backend, see ThreadedDataPlaneBsd.
+#include "network_bsd.h"
 #include "tunsafe_config.h"
 #include "tunsafe_threading.h"
+#include "wireguard.h"
 #include "util.h"
 
 #include <stdio.h>
 #include <unistd.h>
 #include <fcntl.h>
-#include <sys/ioctl.h>
-#include <net/if.h>
 #include <netinet/in.h>
 #include <string.h>
-#include <arpa/inet.h>
-#include <sys/stat.h>
 #include <stdlib.h>
 #include <errno.h>
 #include <assert.h>
-#include <signal.h>
-#include <pthread.h>
-
-static Packet *freelist;
-
-void FreePacket(Packet *packet) {
-  free(packet);
-//  packet->next = freelist;
-//  freelist = packet;
-}
+#include <poll.h>
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+#if defined(OS_LINUX)
+#include <sched.h>
+#include <sys/socket.h>
+#include <sys/eventfd.h>
+
+enum {
+  // What a worker does with a packet, packets from tun queue i have
+  // kTargetTun + i.
+  kTargetUdp = 0,
+  kTargetTun = 1,
+  // What the main thread does with a packet
+  kTargetHandleUdp = 0,
+  kTargetWriteUdp = 1,
+};
 
-Packet *AllocPacket() {
-  Packet *p = NULL;// freelist;
-  if (p) {
-    freelist = p->next;
-  } else {
-    p = (Packet*)malloc(kPacketAllocSize);  
-    if (p == NULL) {
-      RERROR("Allocation failure");
-      abort();
+// A list of packets that's handed between threads as a whole, so the queue
+// locks are taken once per batch instead of once per packet.
+struct PacketList {
+  Packet *head, **tail;
+  int count;
+
+  PacketList() { Clear(); }
+  void Clear() { head = NULL; tail = &head; count = 0; }
+  void Append(Packet *packet) {
+    Packet_NEXT(packet) = NULL;
+    *tail = packet;
+    tail = &Packet_NEXT(packet);
+    count++;
+  }
+  void AppendList(PacketList *list) {
+    if (list->head) {
+      *tail = list->head;
+      tail = list->tail;
+      count += list->count;
+      list->Clear();
     }
   }
-  p->data = p->data_buf + Packet::HEADROOM_BEFORE;
-  p->size = 0;
-  return p;
-}
-
-void FreePackets() {
-  Packet *p;
-  while ( (p = freelist ) != NULL) {
-    freelist = p->next;
-    free(p);
+  // Free the first |n| packets with a single call.
+  void FreeFront(int n) {
+    Packet **end = &head;
+    for (int i = 0; i < n; i++)
+      end = &Packet_NEXT(*end);
+    Packet *first = head;
+    if ((head = *end) == NULL)
+      tail = &head;
+    count -= n;
+    if (n)
+      FreePackets(first, end, n);
   }
-}
+};
 
-class WorkerLoop {
+// A queue of packets with one consumer thread, on top of a lock free ring.
+// The consumer sleeps on an eventfd, which is only written when the consumer
+// found the ring empty. A producer that finds the ring full either waits for
+// the consumer to make room, or drops what doesn't fit.
+class PacketQueueMt {
 public:
-  WorkerLoop();
-  ~WorkerLoop();
+  enum {
+    kCapacity = 4096,
+    kChunk = 64,
+  };
 
-  bool Initialize(WireguardProcessor *processor);
+  PacketQueueMt() : ring_(kCapacity), shutting_down_(false), drops_(0) {
+    wake_fd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (wake_fd_ < 0)
+      tunsafe_die("eventfd failed");
+  }
+  ~PacketQueueMt() {
+    PacketList list;
+    Drain(&list);
+    FreePacketList(list.head);
+    close(wake_fd_);
+  }
+
+  void Push(PacketList *list) {
+    Push(list, NULL);
+  }
 
-  void *ThreadMain();
-  void StartThread();
+  // Like Push, but never waits. What doesn't fit is moved to |overflow| and
+  // counted as dropped, the caller frees it.
+  void Push(PacketList *list, PacketList *overflow) {
+    Packet *items[kChunk];
+    int pushed = 0;
+    Packet *p = list->head;
+    while (p) {
+      size_t n = 0, done = 0;
+      for (; p && n < kChunk; p = Packet_NEXT(p))
+        items[n++] = p;
+      while (done < n) {
+        bool wake = false;
+        size_t r = ring_.Push(items + done, n - done, &wake);
+        if (wake) {
+          uint64 value = 1;
+          write(wake_fd_, &value, sizeof(value));
+        }
+        done += r;
+        pushed += r;
+        if (r == 0 && overflow) {
+          PacketList rest;
+          rest.head = items[done];
+          rest.tail = list->tail;
+          rest.count = list->count - pushed;
+          drops_ += rest.count;
+          overflow->AppendList(&rest);
+          list->Clear();
+          return;
+        }
+        if (r == 0) {
+          // Nobody will make room once the consumer is shut down.
+          if (shutting_down_.load()) {
+            Packet_NEXT(items[n - 1]) = NULL;
+            FreePacketList(items[done]);
+            FreePacketList(p);
+            list->Clear();
+            return;
+          }
+          sched_yield();
+        }
+      }
+    }
+    list->Clear();
+  }
 
-  void StopThread();
+  void Push(Packet *packet) {
+    PacketList list;
+    list.Append(packet);
+    Push(&list);
+  }
 
-  void NotifyStop();
+  // Frees |packet| if the queue is full.
+  void TryPush(Packet *packet) {
+    PacketList list, overflow;
+    list.Append(packet);
+    Push(&list, &overflow);
+    FreePacketList(overflow.head);
+  }
 
-  enum {
-    TARGET_UDP, TARGET_TUN
-  };
+  uint64 drops() const { return drops_.load(); }
 
-  void HandleUdpPacket(Packet *packet) {
-    HandlePacket(packet, TARGET_UDP);
+  // Move the queued packets to |list|, waiting up to |timeout_ms| for some to
+  // arrive. -1 waits forever, 0 doesn't wait. Returns false after Shutdown.
+  bool Pop(PacketList *list, int timeout_ms) {
+    if (!Drain(list) && timeout_ms != 0 && !shutting_down_.load()) {
+      if (ring_.PrepareToWait() && !shutting_down_.load()) {
+        struct pollfd pfd = {wake_fd_, POLLIN, 0};
+        poll(&pfd, 1, timeout_ms);
+      }
+      ring_.FinishWait();
+      uint64 value;
+      read(wake_fd_, &value, sizeof(value));
+      Drain(list);
+    }
+    return !shutting_down_.load();
   }
-  void HandleTunPacket(Packet *packet) {
-    HandlePacket(packet, TARGET_TUN);
+
+  void Shutdown() {
+    shutting_down_.store(true);
+    uint64 value = 1;
+    write(wake_fd_, &value, sizeof(value));
   }
 
-  void HandleSigAlrm() {
-    got_sig_alarm_ = true;
+  // Packets queued before the consumer starts are kept.
+  void Restart() {
+    shutting_down_.store(false);
   }
 
 private:
-  static void *ThreadMainStatic(void *x);
-  void HandlePacket(Packet *packet, int target);
+  bool Drain(PacketList *list) {
+    Packet *items[kChunk];
+    size_t n, total = 0;
+    do {
+      n = ring_.Pop(items, kChunk);
+      for (size_t i = 0; i < n; i++)
+        list->Append(items[i]);
+      total += n;
+    } while (n == kChunk);
+    return total != 0;
+  }
 
-  WireguardProcessor *processor_;
-  pthread_t tid_;
-  Packet *queue_, **queue_end_;
-  bool shutting_down_;
-  bool got_sig_alarm_;
+  MpscRing<Packet*> ring_;
+  int wake_fd_;
+  std::atomic<bool> shutting_down_;
+  std::atomic<uint64> drops_;
+};
 
-  Mutex lock_;
-  pthread_cond_t cond_;
+// Runs a member function on a Thread.
+template<typename T, void (T::*Func)()>
+class MemberRunner : public Thread::Runner {
+public:
+  explicit MemberRunner(T *obj) : obj_(obj) {}
+  virtual void ThreadMain() override { (obj_->*Func)(); }
+private:
+  T *obj_;
 };
 
-// Handles the threads that read/write to the udp socket.
-class UdpLoop {
+// Wait until |fd| has |events|, or until |stop_fd| is readable. Returns
+// false in the latter case.
+static bool WaitForFd(int fd, int events, int stop_fd) {
+  struct pollfd pfd[2] = {{fd, (short)events, 0}, {stop_fd, POLLIN, 0}};
+  if (poll(pfd, 2, -1) < 0 && errno != EINTR) {
+    RERROR("poll failed: %d", errno);
+    return false;
+  }
+  return pfd[1].revents == 0;
+}
+
+// Puts the packets that the workers produced back in the order their input
+// was read, the same way the serial queues of the Linux kernel do. The reader
+// stamps every packet with a sequence number, and the output of each packet
+// is released to the writer once everything read before it is done. A packet
+// that produced no output still has to be completed.
+class ReorderQueue {
 public:
-  UdpLoop();
-  ~UdpLoop();
+  enum { kWindow = 4096 };
 
-  bool Initialize(int listen_port, WorkerLoop *worker);
-  void Start();
-  void Stop();
+  // The output of one input packet, possibly empty.
+  struct Completion {
+    uint16 seq;
+    int count;
+    Packet *head, **tail;
+  };
 
-  void WriteUdpPacket(Packet *packet);
-private:
-  static void *ReaderMainStatic(void *x);
-  static void *WriterMainStatic(void *x);
-  void *ReaderMain();
-  void *WriterMain();
-  
-  int fd_;
-  WorkerLoop *worker_;
-  pthread_t read_tid_, write_tid_;
+  explicit ReorderQueue(PacketQueueMt *out) : out_(out), next_seq_(0), head_(0), drops_(0) {
+    for (int i = 0; i < kWindow; i++)
+      done_[i] = false;
+  }
+  ~ReorderQueue() {
+    for (int i = 0; i < kWindow; i++)
+      FreePacketList(slots_[i].head);
+  }
 
-  Packet *queue_, **queue_end_;
+  // Called by the reader only. Returns false when the window is full, the
+  // packet must be dropped then.
+  bool Stamp(Packet *packet) {
+    if ((uint16)(next_seq_ - head_.load(std::memory_order_acquire)) >= kWindow) {
+      drops_++;
+      return false;
+    }
+    packet->seq = next_seq_++;
+    return true;
+  }
 
-  bool shutting_down_;
+  void Complete(const Completion *c, size_t n) {
+    PacketList ready;
+    lock_.Acquire();
+    for (size_t i = 0; i < n; i++) {
+      int slot = c[i].seq & (kWindow - 1);
+      assert(!done_[slot]);
+      done_[slot] = true;
+      if (c[i].head) {
+        *slots_[slot].tail = c[i].head;
+        slots_[slot].tail = c[i].tail;
+        slots_[slot].count += c[i].count;
+      }
+    }
+    uint16 head = head_.load(std::memory_order_relaxed);
+    for (; done_[head & (kWindow - 1)]; head++) {
+      done_[head & (kWindow - 1)] = false;
+      ready.AppendList(&slots_[head & (kWindow - 1)]);
+    }
+    head_.store(head, std::memory_order_release);
+    // Still under the lock, or two workers could swap their output.
+    if (ready.head)
+      out_->Push(&ready);
+    lock_.Release();
+  }
 
+  // Completes the packets in |list| without output and frees them, for when
+  // they couldn't be handed to a worker.
+  void Cancel(PacketList *list) {
+    Completion c[PacketQueueMt::kChunk];
+    size_t n = 0;
+    for (Packet *p = list->head; p; p = Packet_NEXT(p)) {
+      Completion x = {p->seq, 0, NULL, NULL};
+      c[n++] = x;
+      if (n == PacketQueueMt::kChunk) {
+        Complete(c, n);
+        n = 0;
+      }
+    }
+    if (n)
+      Complete(c, n);
+    FreePacketList(list->head);
+    list->Clear();
+  }
+
+  uint64 drops() const { return drops_; }
+
+private:
   Mutex lock_;
-  pthread_cond_t cond_;
+  PacketQueueMt *out_;
+  uint16 next_seq_;
+  std::atomic<uint16> head_;
+  uint64 drops_;
+  bool done_[kWindow];
+  PacketList slots_[kWindow];
 };
 
-// Handles the threads that read/write to the tun socket.
-class TunLoop {
+//////////////////////////////////////////////////////////////////////////////////////////////
+
+// Encrypts and decrypts data packets. Everything the processor writes while
+// handling a batch is collected and passed on to the writer threads once the
+// batch is done, through the ReorderQueue of the writer.
+class WorkerLoop {
 public:
-  TunLoop();
-  ~TunLoop();
+  WorkerLoop(ThreadedDataPlaneBsd *owner, uint32 thread_id)
+      : owner_(owner), thread_id_(thread_id), packets_(0), runner_(this) {}
 
-  bool Initialize(char devname[16], WorkerLoop *worker);
-  void Start();
-  void Stop();
+  void Start() {
+    queue_.Restart();
+    thread_.StartThread(&runner_);
+  }
+  void Stop() {
+    queue_.Shutdown();
+    thread_.StopThread();
+  }
+  // Packets that don't fit in the queue are moved to |overflow|, so a slow
+  // worker can't stall the readers.
+  void Post(PacketList *list, PacketList *overflow) { queue_.Push(list, overflow); }
 
-  void WriteTunPacket(Packet *packet);
-private:
-  static void *ReaderMainStatic(void *x);
-  static void *WriterMainStatic(void *x);
-  void *ReaderMain();
-  void *WriterMain();
+  uint64 packets() const { return packets_; }
+  uint64 drops() const { return queue_.drops(); }
 
-  int fd_;
-  bool shutting_down_;
+  // The worker that runs on this thread, or NULL.
+  static thread_local WorkerLoop *current_;
 
-  WorkerLoop *worker_;
-  pthread_t read_tid_, write_tid_;
-  Packet *queue_, **queue_end_;
-  Mutex lock_;
-  pthread_cond_t cond_;
+  PacketList udp_out_, tun_out_;
+
+private:
+  void ThreadMain();
+  void Complete(std::vector<ReorderQueue::Completion> *done, uint16 seq, size_t count, PacketList *out);
+
+  ThreadedDataPlaneBsd *owner_;
+  uint32 thread_id_;
+  uint64 packets_;
+  PacketQueueMt queue_;
+  MemberRunner<WorkerLoop, &WorkerLoop::ThreadMain> runner_;
+  Thread thread_;
 };
 
-WorkerLoop::WorkerLoop() {
-  queue_end_ = &queue_;
-  queue_ = NULL;
-  tid_ = 0;
-  shutting_down_ = false;
-  got_sig_alarm_ = false;
-  processor_ = NULL;
-  if (pthread_cond_init(&cond_, NULL) != 0)
-    tunsafe_die("pthread_cond_init failed");
-}
+thread_local WorkerLoop *WorkerLoop::current_;
 
-WorkerLoop::~WorkerLoop() {
-  pthread_cond_destroy(&cond_);
-}
+// Reads and writes the udp socket, each on its own thread. Data packets are
+// spread evenly over the workers, and what they decrypt is written to the
+// tun device in the order it was read. Everything else goes to the main
+// thread.
+class UdpLoop {
+public:
+  UdpLoop(ThreadedDataPlaneBsd *owner, int num_tun_queues);
+  ~UdpLoop();
 
-bool WorkerLoop::Initialize(WireguardProcessor *processor) {
-  processor_ = processor;
-  return true;
-}
+  bool Initialize(int listen_port);
+  // Takes ownership of |udp_fd|, which is already bound.
+  void SetSocket(int udp_fd);
+  void Start();
+  void Stop();
+  void Write(PacketList *list) { write_queue_.Push(list); }
+  // Orders what the workers encrypt from tun queue |queue|. Each tun reader
+  // stamps its packets on its own, the queues are ordered independently.
+  ReorderQueue *reorder(int queue) { return reorder_[queue]; }
+  uint64 reorder_drops() const;
 
-void WorkerLoop::StartThread() {
-  assert(tid_ == 0);
-  if (pthread_create(&tid_, NULL, &ThreadMainStatic, this) != 0)
-    tunsafe_die("pthread_create failed");
-}
+  uint64 rx_packets() const { return rx_packets_; }
+  uint64 tx_packets() const { return tx_packets_; }
+  // Datagrams the kernel dropped because the receive buffer was full.
+  uint64 rx_drops() const { return rx_drops_.load(std::memory_order_relaxed); }
 
-void WorkerLoop::StopThread() {
-  lock_.Acquire();
-  shutting_down_ = true;
-  lock_.Release();
+private:
+  void ReaderMain();
+  void WriterMain();
+
+  ThreadedDataPlaneBsd *owner_;
+  int fd_, stop_fd_;
+  bool started_;
+  // Checked between batches, the readers may never go idle.
+  std::atomic<bool> stopping_;
+  uint64 rx_packets_, tx_packets_;
+  std::atomic<uint64> rx_drops_;
+  // The last value of the SO_RXQ_OVFL counter of |fd_|, used by the reader.
+  uint32 kernel_drops_;
+  PacketQueueMt write_queue_;
+  int num_reorder_;
+  ReorderQueue *reorder_[ThreadedDataPlaneBsd::kMaxTunQueues];
+  MemberRunner<UdpLoop, &UdpLoop::ReaderMain> reader_runner_;
+  MemberRunner<UdpLoop, &UdpLoop::WriterMain> writer_runner_;
+  Thread reader_, writer_;
+};
 
-  if (tid_) {
-    void *x;
-    pthread_join(tid_, &x);
-    tid_ = 0;
-  }
-}
+// Reads and writes one queue of the tun device, each on its own thread.
+// Packets are spread evenly over the workers, and what they encrypt is sent
+// in the order it was read. With several queues, each one has its own reader
+// so the reads are spread over the cores, but everything is written through
+// the first one.
+class TunLoop {
+public:
+  TunLoop(ThreadedDataPlaneBsd *owner, int queue);
+  ~TunLoop();
 
+  void Initialize(int tun_fd);
+  void Start();
+  void Stop();
+  void Write(PacketList *list) { write_queue_.Push(list); }
+  // Orders what the workers decrypt, only used on the first queue.
+  ReorderQueue *reorder() { return &reorder_; }
 
-// This is called from signal handler so cannot block etc.
-void WorkerLoop::NotifyStop() {
-  shutting_down_ = true;
-}
+  uint64 rx_packets() const { return rx_packets_; }
+  uint64 tx_packets() const { return tx_packets_; }
 
-void WorkerLoop::HandlePacket(Packet *packet, int target) {
-//  RINFO("WorkerLoop::HandlePacket");
-  packet->post_target = target;
-  lock_.Acquire();
-  Packet *old_queue = queue_;
-  *queue_end_ = packet;
-  queue_end_ = &packet->next;
-  packet->next = NULL;
-  if (old_queue == NULL) {
-    lock_.Release();
-    pthread_cond_signal(&cond_);
-  } else {
-    lock_.Release();
-  }
-}
+private:
+  void ReaderMain();
+  void WriterMain();
+
+  ThreadedDataPlaneBsd *owner_;
+  int queue_;
+  int fd_, stop_fd_;
+  bool started_;
+  // Checked between batches, the readers may never go idle.
+  std::atomic<bool> stopping_;
+  uint64 rx_packets_, tx_packets_;
+  PacketQueueMt write_queue_;
+  ReorderQueue reorder_;
+  MemberRunner<TunLoop, &TunLoop::ReaderMain> reader_runner_;
+  MemberRunner<TunLoop, &TunLoop::WriterMain> writer_runner_;
+  Thread reader_, writer_;
+};
 
-void *WorkerLoop::ThreadMainStatic(void *x) {
-  return ((WorkerLoop*)x)->ThreadMain();
-}
+//////////////////////////////////////////////////////////////////////////////////////////////
 
-void *WorkerLoop::ThreadMain() {
-  Packet *packet_queue;
+void WorkerLoop::ThreadMain() {
+  WireguardProcessor *processor = owner_->processor_;
+  MultithreadedDelayedDelete *delayed_delete = processor->dev().delayed_delete();
+  std::vector<ReorderQueue::Completion> udp_done[ThreadedDataPlaneBsd::kMaxTunQueues], tun_done;
+  int num_tun = owner_->num_tun_;
+  PacketList list;
+  char name[16];
 
-  lock_.Acquire();
+  snprintf(name, sizeof(name), "tunsafe-w%d", thread_id_);
+  SetThreadName(name);
+  current_ = this;
+  delayed_delete->Checkpoint(thread_id_);
   for (;;) {
-    // Grab the whole list
-    for (;;) {
-      while (got_sig_alarm_) {
-        got_sig_alarm_ = false;
-        lock_.Release();
-        processor_->SecondLoop();
-        processor_->RunAllMainThreadScheduled();
-        lock_.Acquire();
-      }
-      if (shutting_down_ || queue_ != NULL)
-        break;
-      pthread_cond_wait(&cond_, lock_.impl());
+    bool running = queue_.Pop(&list, 0);
+    if (running && list.head == NULL) {
+      // Don't hold up the deletes while waiting for packets.
+      delayed_delete->Offline(thread_id_);
+      running = queue_.Pop(&list, -1);
+      delayed_delete->Checkpoint(thread_id_);
     }
-    if (shutting_down_)
+    if (!running)
       break;
-    packet_queue = queue_;
-    queue_ = NULL;
-    queue_end_ = &queue_;
-    
-    lock_.Release();
-    // And send all items in the list
-    while (packet_queue != NULL) {
-      Packet *next = packet_queue->next;
-      if (packet_queue->post_target == TARGET_TUN) {
-        processor_->HandleTunPacket(packet_queue);
+    for (Packet *packet = list.head; packet; ) {
+      // The readers hand out runs of consecutive packets, so their crypto
+      // can be done together. What a run produces is in read order, so it
+      // can all be completed under the last sequence number of the run.
+      Packet *run[kWgCryptoBatchSize];
+      uint8 target = packet->userdata;
+      uint16 seq = packet->seq;
+      size_t n = 0;
+      do {
+        run[n++] = packet;
+        packet = Packet_NEXT(packet);
+      } while (packet && n < kWgCryptoBatchSize && packet->userdata == target && packet->seq == (uint16)(seq + n));
+      if (target >= kTargetTun) {
+        processor->HandleTunPackets(run, n);
+        Complete(&udp_done[target - kTargetTun], seq, n, &udp_out_);
       } else {
-        processor_->HandleUdpPacket(packet_queue, false);
+        processor->HandleUdpPackets(run, n, false);
+        Complete(&tun_done, seq, n, &tun_out_);
       }
-      packet_queue = next;
     }
-    processor_->RunAllMainThreadScheduled();
-    lock_.Acquire();
+    packets_ += list.count;
+    list.Clear();
+    for (int i = 0; i < num_tun; i++) {
+      if (!udp_done[i].empty()) {
+        owner_->udp_->reorder(i)->Complete(udp_done[i].data(), udp_done[i].size());
+        udp_done[i].clear();
+      }
+    }
+    owner_->tun_[0]->reorder()->Complete(tun_done.data(), tun_done.size());
+    tun_done.clear();
+    // Keepalives and the like, these don't need to be ordered.
+    if (udp_out_.head)
+      owner_->udp_->Write(&udp_out_);
+    if (tun_out_.head)
+      owner_->tun_[0]->Write(&tun_out_);
+    // No pointers to peers or keypairs are held past this point.
+    delayed_delete->Checkpoint(thread_id_);
+    // Handshakes and timer updates are scheduled for the main thread.
+    if (processor->dev().has_main_thread_scheduled())
+      owner_->Wakeup();
   }
-  lock_.Release();
-  return NULL;
+  current_ = NULL;
+  // The readers are stopped, but the sequence numbers of what's left must be
+  // completed or the writers would wait for them forever.
+  for (Packet *packet = list.head, *next; packet; packet = next) {
+    next = Packet_NEXT(packet);
+    PacketList empty;
+    Complete(packet->userdata >= kTargetTun ? &udp_done[packet->userdata - kTargetTun] : &tun_done,
+             packet->seq, 1, &empty);
+    FreePacket(packet);
+  }
+  for (int i = 0; i < num_tun; i++)
+    owner_->udp_->reorder(i)->Complete(udp_done[i].data(), udp_done[i].size());
+  owner_->tun_[0]->reorder()->Complete(tun_done.data(), tun_done.size());
+  delayed_delete->Offline(thread_id_);
 }
 
+// Completes |count| sequence numbers starting at |seq|, |out| goes with the
+// last one.
+void WorkerLoop::Complete(std::vector<ReorderQueue::Completion> *done, uint16 seq, size_t count, PacketList *out) {
+  for (size_t i = 1; i < count; i++) {
+    ReorderQueue::Completion c = {seq++, 0, NULL, NULL};
+    done->push_back(c);
+  }
+  ReorderQueue::Completion c = {seq, out->count, out->head, out->tail};
+  done->push_back(c);
+  out->Clear();
+}
 
-
-UdpLoop::UdpLoop() {
-  fd_ = -1;
-  read_tid_ = 0;
-  write_tid_ = 0;
-  shutting_down_ = false;
-  worker_ = NULL;
-  queue_ = NULL;
-  queue_end_ = &queue_;
-  if (pthread_cond_init(&cond_, NULL) != 0)
-    tunsafe_die("pthread_cond_init failed");
+//////////////////////////////////////////////////////////////////////////////////////////////
+
+UdpLoop::UdpLoop(ThreadedDataPlaneBsd *owner, int num_tun_queues)
+    : owner_(owner),
+      fd_(-1),
+      started_(false),
+      stopping_(false),
+      rx_packets_(0),
+      tx_packets_(0),
+      rx_drops_(0),
+      kernel_drops_(0),
+      num_reorder_(num_tun_queues),
+      reader_runner_(this),
+      writer_runner_(this) {
+  stop_fd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+  if (stop_fd_ < 0)
+    tunsafe_die("eventfd failed");
+  for (int i = 0; i < num_reorder_; i++)
+    reorder_[i] = new ReorderQueue(&write_queue_);
 }
 
 UdpLoop::~UdpLoop() {
-  if (fd_ != -1)
+  Stop();
+  if (fd_ >= 0)
     close(fd_);
-  pthread_cond_destroy(&cond_);
+  close(stop_fd_);
+  for (int i = 0; i < num_reorder_; i++)
+    delete reorder_[i];
 }
 
-bool UdpLoop::Initialize(int listen_port, WorkerLoop *worker) {
-  int fd = open_udp(listen_port);
-  if (fd < 0) { RERROR("Error opening udp"); return false; }
-  fcntl(fd, F_SETFD, FD_CLOEXEC);
-  fd_ = fd;
-  worker_ = worker;
-  return true;
+uint64 UdpLoop::reorder_drops() const {
+  uint64 drops = 0;
+  for (int i = 0; i < num_reorder_; i++)
+    drops += reorder_[i]->drops();
+  return drops;
 }
 
-void UdpLoop::Start() {
-  if (pthread_create(&read_tid_, NULL, &ReaderMainStatic, this) != 0)
-    tunsafe_die("pthread_create failed");
-  if (pthread_create(&write_tid_, NULL, &WriterMainStatic, this) != 0)
-    tunsafe_die("pthread_create failed");
+bool UdpLoop::Initialize(int listen_port) {
+  int udp_fd = socket(AF_INET, SOCK_DGRAM, 0);
+  if (udp_fd < 0) {
+    RERROR("socket(SOCK_DGRAM) failed");
+    return false;
+  }
+  sockaddr_in sin = {0};
+  sin.sin_family = AF_INET;
+  sin.sin_port = htons(listen_port);
+  if (bind(udp_fd, (struct sockaddr*)&sin, sizeof(sin)) != 0) {
+    close(udp_fd);
+    RERROR("bind on udp socket port %d failed", listen_port);
+    return false;
+  }
+  SetSocket(udp_fd);
+  return true;
 }
 
-void UdpLoop::Stop() {
-  void *x;
-
-  lock_.Acquire();
-  shutting_down_ = true;
-  lock_.Release();
-  pthread_cond_signal(&cond_);
-
-  pthread_kill(read_tid_, SIGUSR1);
-  pthread_kill(write_tid_, SIGUSR1);
-  
-  pthread_join(read_tid_, &x);
-  pthread_join(write_tid_, &x);
-
-  read_tid_ = 0;
-  write_tid_ = 0;
+void UdpLoop::SetSocket(int udp_fd) {
+  fcntl(udp_fd, F_SETFD, FD_CLOEXEC);
+  fcntl(udp_fd, F_SETFL, O_NONBLOCK);
+  // The drop counter of the socket tells the main thread it's overloaded.
+  int one = 1;
+  if (setsockopt(udp_fd, SOL_SOCKET, SO_RXQ_OVFL, &one, sizeof(one)) != 0)
+    RINFO("Unable to set SO_RXQ_OVFL: %d", errno);
+  // The threads need to be restarted when the socket changes.
+  bool was_started = started_;
+  Stop();
+  if (fd_ >= 0)
+    close(fd_);
+  fd_ = udp_fd;
+  kernel_drops_ = 0;
+  if (was_started)
+    Start();
 }
 
-void *UdpLoop::ReaderMainStatic(void *x) {
-  SetThreadName("tunsafe-ur");
-  return ((UdpLoop*)x)->ReaderMain();
+void UdpLoop::Start() {
+  if (started_ || fd_ < 0)
+    return;
+  started_ = true;
+  write_queue_.Restart();
+  reader_.StartThread(&reader_runner_);
+  writer_.StartThread(&writer_runner_);
 }
 
-void *UdpLoop::WriterMainStatic(void *x) {
-  SetThreadName("tunsafe-uw");
-  return ((UdpLoop*)x)->WriterMain();
+void UdpLoop::Stop() {
+  if (!started_)
+    return;
+  started_ = false;
+  stopping_.store(true);
+  uint64 value = 1;
+  write(stop_fd_, &value, sizeof(value));
+  write_queue_.Shutdown();
+  reader_.StopThread();
+  writer_.StopThread();
+  read(stop_fd_, &value, sizeof(value));
+  stopping_.store(false);
 }
 
-void *UdpLoop::ReaderMain() {
-  Packet *packet;
-  socklen_t sin_len;
-  int r;
+void UdpLoop::ReaderMain() {
+  enum { kBatchSize = ThreadedDataPlaneBsd::kBatchSize };
+  Packet *packets[kBatchSize] = {0};
+  struct mmsghdr msgs[kBatchSize];
+  struct iovec iov[kBatchSize];
+  char cmsg_buf[kBatchSize][CMSG_SPACE(sizeof(uint32))];
+  PacketList lists[ThreadedDataPlaneBsd::kMaxWorkers], overflow;
+  int num_workers = owner_->num_workers_, next_worker = 0, run = 0;
+  ReorderQueue *reorder = owner_->tun_[0]->reorder();
 
-  while (!shutting_down_) {
-    packet = AllocPacket();
-    sin_len = sizeof(packet->addr.sin);
-    r = recvfrom(fd_, packet->data, kPacketCapacity, 0, (sockaddr*)&packet->addr.sin, &sin_len);
-    if (r < 0) {
-      FreePacket(packet);
-      if (shutting_down_)
+  SetThreadName("tunsafe-ur");
+  memset(msgs, 0, sizeof(msgs));
+  while (!stopping_.load()) {
+    int n = kBatchSize;
+    for (int i = 0; i < n; i++) {
+      if (packets[i] == NULL) {
+        Packet *p = packets[i] = AllocPacket();
+        // Past the packet memory cap, read into the packets there are.
+        if (p == NULL) {
+          n = i;
+          break;
+        }
+        iov[i].iov_base = p->data;
+        iov[i].iov_len = kPacketCapacity;
+        msgs[i].msg_hdr.msg_name = &p->addr.sin;
+        msgs[i].msg_hdr.msg_iov = &iov[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+      }
+      msgs[i].msg_hdr.msg_namelen = sizeof(packets[i]->addr.sin);
+      msgs[i].msg_hdr.msg_control = cmsg_buf[i];
+      msgs[i].msg_hdr.msg_controllen = sizeof(cmsg_buf[i]);
+    }
+    if (n == 0) {
+      if (!DiscardPacket(fd_) && !WaitForFd(fd_, POLLIN, stop_fd_))
         break;
-
-      RERROR("ReadMain failed %d", errno);
-
-    } else {
-      packet->size = r;
-      worker_->HandleUdpPacket(packet);
+      continue;
+    }
+    int r = recvmmsg(fd_, msgs, n, 0, NULL);
+    if (r <= 0) {
+      if (r < 0 && errno != EAGAIN && errno != EINTR)
+        RERROR("Read from UDP failed: %d", errno);
+      if (!WaitForFd(fd_, POLLIN, stop_fd_))
+        break;
+      continue;
+    }
+    rx_packets_ += r;
+    // The total number of drops of the socket, only present once nonzero.
+    uint32 drops = kernel_drops_;
+    for (int i = 0; i < r; i++) {
+      struct cmsghdr *cm = CMSG_FIRSTHDR(&msgs[i].msg_hdr);
+      if (cm && cm->cmsg_level == SOL_SOCKET && cm->cmsg_type == SO_RXQ_OVFL)
+        memcpy(&drops, CMSG_DATA(cm), sizeof(drops));
     }
+    if (drops != kernel_drops_) {
+      rx_drops_.fetch_add((uint32)(drops - kernel_drops_), std::memory_order_relaxed);
+      kernel_drops_ = drops;
+    }
+    for (int i = 0; i < r; i++) {
+      Packet *p = packets[i];
+      packets[i] = NULL;
+      p->sin_size = msgs[i].msg_hdr.msg_namelen;
+      p->size = msgs[i].msg_len;
+      p->protocol = kPacketProtocolUdp;
+      if (WireguardProcessor::IsMainThreadPacket(p)) {
+        p->userdata = kTargetHandleUdp;
+        owner_->PostToMainThread(p);
+      } else if (reorder->Stamp(p)) {
+        p->userdata = kTargetUdp;
+        lists[next_worker].Append(p);
+        // Runs of packets go to the same worker, which decrypts them together.
+        if (++run == kWgCryptoBatchSize) {
+          run = 0;
+          if (++next_worker == num_workers)
+            next_worker = 0;
+        }
+      } else {
+        FreePacket(p);
+      }
+    }
+    for (int i = 0; i < num_workers; i++) {
+      if (lists[i].head)
+        owner_->workers_[i]->Post(&lists[i], &overflow);
+    }
+    if (overflow.head)
+      reorder->Cancel(&overflow);
   }
-  return NULL;
+  for (int i = 0; i < kBatchSize; i++)
+    if (packets[i])
+      FreePacket(packets[i]);
 }
 
-void *UdpLoop::WriterMain() {
-  Packet *queue;
+void UdpLoop::WriterMain() {
+  enum { kBatchSize = ThreadedDataPlaneBsd::kBatchSize };
+  struct mmsghdr msgs[kBatchSize];
+  struct iovec iov[kBatchSize];
+  PacketList list;
 
-  lock_.Acquire();
-  for (;;) {
-    // Grab the whole list
-    while (!shutting_down_ && queue_ == NULL)
-      pthread_cond_wait(&cond_, lock_.impl());
-    if (shutting_down_)
-      break;
-    queue = queue_;
-    queue_ = NULL;
-    queue_end_ = &queue_;
-    lock_.Release();
-    // And send all items in the list
-    while (queue != NULL) {
-      int r = sendto(fd_, queue->data, queue->size, 0,
-          (sockaddr*)&queue->addr.sin, sizeof(queue->addr.sin));
-      if (r != queue->size) {
+  SetThreadName("tunsafe-uw");
+  memset(msgs, 0, sizeof(msgs));
+  while (write_queue_.Pop(&list, -1)) {
+    while (list.head) {
+      int n = 0;
+      for (Packet *p = list.head; p && n < kBatchSize; p = Packet_NEXT(p), n++) {
+        iov[n].iov_base = p->data;
+        iov[n].iov_len = p->size;
+        msgs[n].msg_hdr.msg_name = &p->addr.sin;
+        msgs[n].msg_hdr.msg_namelen = sizeof(p->addr.sin);
+        msgs[n].msg_hdr.msg_iov = &iov[n];
+        msgs[n].msg_hdr.msg_iovlen = 1;
+      }
+      int r = sendmmsg(fd_, msgs, n, 0);
+      if (r < 0) {
+        if (errno == EAGAIN) {
+          if (!WaitForFd(fd_, POLLOUT, stop_fd_))
+            goto getout;
+          continue;
+        }
+        // The error refers to the first packet, drop it and keep going.
         if (errno != ENOBUFS)
-          RERROR("WriterMain failed: %d", errno);
+          RERROR("Write to UDP failed: %d", errno);
+        r = 1;
       } else {
-//        RINFO("WRote udp packet!");
+        tx_packets_ += r;
       }
-      Packet *to_free = queue;
-      queue = queue->next;
-      FreePacket(to_free);
+      list.FreeFront(r);
     }
-    lock_.Acquire();
-  }
-  lock_.Release();
-  return NULL;
-}
-
-void UdpLoop::WriteUdpPacket(Packet *packet) {
-//  RINFO("write udp packet to queue!");
-  packet->next = NULL;
-
-  lock_.Acquire();
-  Packet *old_queue = queue_;
-  *queue_end_ = packet;
-  queue_end_ = &packet->next;
-  if (old_queue == NULL) {
-    lock_.Release();
-    pthread_cond_signal(&cond_);
-  } else {
-    lock_.Release();
   }
+getout:
+  FreePacketList(list.head);
 }
 
-TunLoop::TunLoop() {
-  fd_ = -1;
-  shutting_down_ = false;
-  worker_ = NULL;
-  read_tid_ = 0;
-  write_tid_ = 0;
-  queue_ = NULL;
-  queue_end_ = &queue_;
-  if (pthread_cond_init(&cond_, NULL) != 0)
-    tunsafe_die("pthread_cond_init failed");
+//////////////////////////////////////////////////////////////////////////////////////////////
+
+TunLoop::TunLoop(ThreadedDataPlaneBsd *owner, int queue)
+    : owner_(owner),
+      queue_(queue),
+      fd_(-1),
+      started_(false),
+      stopping_(false),
+      rx_packets_(0),
+      tx_packets_(0),
+      reorder_(&write_queue_),
+      reader_runner_(this),
+      writer_runner_(this) {
+  stop_fd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+  if (stop_fd_ < 0)
+    tunsafe_die("eventfd failed");
 }
 
 TunLoop::~TunLoop() {
-  if (fd_ != -1)
+  Stop();
+  if (fd_ >= 0)
     close(fd_);
-  pthread_cond_destroy(&cond_);
+  close(stop_fd_);
 }
 
-bool TunLoop::Initialize(char devname[16], WorkerLoop *worker) {
-  int fd = open_tun(devname, 16);
-  if (fd < 0) { RERROR("Error opening tun"); return false; }
-  fcntl(fd, F_SETFD, FD_CLOEXEC);
-  fd_ = fd;
-  worker_ = worker;
-  return true;
+void TunLoop::Initialize(int tun_fd) {
+  fcntl(tun_fd, F_SETFD, FD_CLOEXEC);
+  fcntl(tun_fd, F_SETFL, O_NONBLOCK);
+  bool was_started = started_;
+  Stop();
+  if (fd_ >= 0)
+    close(fd_);
+  fd_ = tun_fd;
+  if (was_started)
+    Start();
 }
 
 void TunLoop::Start() {
-  if (pthread_create(&read_tid_, NULL, &ReaderMainStatic, this) != 0)
-    tunsafe_die("pthread_create failed");
-  if (pthread_create(&write_tid_, NULL, &WriterMainStatic, this) != 0)
-    tunsafe_die("pthread_create failed");
+  if (started_ || fd_ < 0)
+    return;
+  started_ = true;
+  write_queue_.Restart();
+  reader_.StartThread(&reader_runner_);
+  writer_.StartThread(&writer_runner_);
 }
 
 void TunLoop::Stop() {
-  void *x;
-
-  lock_.Acquire();
-  shutting_down_ = true;
-  lock_.Release();
-
-  pthread_kill(read_tid_, SIGUSR1);
-  pthread_kill(write_tid_, SIGUSR1);
-  pthread_join(read_tid_, &x);
-  pthread_join(write_tid_, &x);
-
-  read_tid_ = 0;
-  write_tid_ = 0;
-}
-
-void *TunLoop::ReaderMainStatic(void *x) {
-  SetThreadName("tunsafe-tr");
-  return ((TunLoop*)x)->ReaderMain();
+  if (!started_)
+    return;
+  started_ = false;
+  stopping_.store(true);
+  uint64 value = 1;
+  write(stop_fd_, &value, sizeof(value));
+  write_queue_.Shutdown();
+  reader_.StopThread();
+  writer_.StopThread();
+  read(stop_fd_, &value, sizeof(value));
+  stopping_.store(false);
 }
 
-void *TunLoop::WriterMainStatic(void *x) {
-  SetThreadName("tunsafe-tw");
-  return ((TunLoop*)x)->WriterMain();
-}
-
-void *TunLoop::ReaderMain() {
-  Packet *packet = AllocPacket();
-  while (!shutting_down_) {
-    int r = read(fd_, packet->data - TUN_PREFIX_BYTES, kPacketCapacity + TUN_PREFIX_BYTES);
-    if (r >= 0) {
-      packet->size = r - TUN_PREFIX_BYTES;
-      if (r >= TUN_PREFIX_BYTES && (!TUN_PREFIX_BYTES || ReadBE32(packet->data - TUN_PREFIX_BYTES) == AF_INET)) {
-        worker_->HandleTunPacket(packet);
+void TunLoop::ReaderMain() {
+  PacketList lists[ThreadedDataPlaneBsd::kMaxWorkers], overflow;
+  int num_workers = owner_->num_workers_, next_worker = 0, run = 0;
+  ReorderQueue *reorder = owner_->udp_->reorder(queue_);
+  Packet *packet = NULL;
+  char name[16];
+
+  snprintf(name, sizeof(name), "tunsafe-tr%d", queue_);
+  SetThreadName(name);
+  while (!stopping_.load()) {
+    int n = 0;
+    for (; n < ThreadedDataPlaneBsd::kBatchSize; n++) {
+      if (packet == NULL)
         packet = AllocPacket();
+      // Past the packet memory cap, what's read is dropped.
+      if (packet == NULL) {
+        if (!DiscardPacket(fd_))
+          break;
+        continue;
+      }
+      int r = read(fd_, packet->data, kPacketCapacity);
+      if (r <= 0)
+        break;
+      if (!reorder->Stamp(packet))
+        continue;
+      packet->size = r;
+      packet->userdata = kTargetTun + queue_;
+      lists[next_worker].Append(packet);
+      // Runs of packets go to the same worker, which encrypts them together.
+      if (++run == kWgCryptoBatchSize) {
+        run = 0;
+        if (++next_worker == num_workers)
+          next_worker = 0;
       }
+      packet = NULL;
+    }
+    rx_packets_ += n;
+    for (int i = 0; i < num_workers; i++) {
+      if (lists[i].head)
+        owner_->workers_[i]->Post(&lists[i], &overflow);
     }
+    if (overflow.head)
+      reorder->Cancel(&overflow);
+    if (n == 0 && !WaitForFd(fd_, POLLIN, stop_fd_))
+      break;
   }
-  return NULL;
+  if (packet)
+    FreePacket(packet);
 }
 
-void *TunLoop::WriterMain() {
-  Packet *queue;
-
-  lock_.Acquire();
-  for (;;) {
-    // Grab the whole list
-    while (!shutting_down_ && queue_ == NULL) {
-      pthread_cond_wait(&cond_, lock_.impl());
-    }
-    if (shutting_down_)
-      break;
-    queue = queue_;
-    queue_ = NULL;
-    queue_end_ = &queue_;
-    lock_.Release();
-    // And send all items in the list
-    while (queue != NULL) {
-      if (TUN_PREFIX_BYTES)
-        WriteBE32(queue->data - TUN_PREFIX_BYTES, AF_INET);
-      int r = write(fd_, queue->data - TUN_PREFIX_BYTES, queue->size + TUN_PREFIX_BYTES);
-      if (r != queue->size + TUN_PREFIX_BYTES) {
-        RERROR("WriterMain failed: %d", errno);
-        break;
+void TunLoop::WriterMain() {
+  PacketList list;
+  char name[16];
+
+  snprintf(name, sizeof(name), "tunsafe-tw%d", queue_);
+  SetThreadName(name);
+  while (write_queue_.Pop(&list, -1)) {
+    int n = 0;
+    for (Packet *p = list.head; p; p = Packet_NEXT(p), n++) {
+      while (write(fd_, p->data, p->size) < 0 && errno == EAGAIN) {
+        if (!WaitForFd(fd_, POLLOUT, stop_fd_)) {
+          list.FreeFront(n);
+          goto getout;
+        }
       }
-      Packet *to_free = queue;
-      queue = queue->next;
-      FreePacket(to_free);
     }
-    lock_.Acquire();
+    tx_packets_ += n;
+    list.FreeFront(n);
   }
-  lock_.Release();
-  return NULL;
+getout:
+  FreePacketList(list.head);
 }
 
-void TunLoop::WriteTunPacket(Packet *packet) {
-  packet->next = NULL;
-
-  lock_.Acquire();
-  Packet *old_queue = queue_;
-  *queue_end_ = packet;
-  queue_end_ = &packet->next;
-  if (old_queue == NULL) {
-    lock_.Release();
-    pthread_cond_signal(&cond_);
-  } else {
-    lock_.Release();
-  }
+//////////////////////////////////////////////////////////////////////////////////////////////
+
+ThreadedDataPlaneBsd::ThreadedDataPlaneBsd(NetworkBsd *network, WireguardProcessor *processor, UdpInterface *udp,
+                                           int num_workers, int num_tun_queues)
+    : BaseSocketBsd(network),
+      processor_(processor),
+      udp_interface_(udp),
+      num_workers_(std::max<int>(std::min<int>(num_workers, kMaxWorkers), 1)),
+      num_tun_(std::max<int>(std::min<int>(num_tun_queues, kMaxTunQueues), 1)),
+      started_(false),
+      inbox_pending_(NULL),
+      reported_drops_(0),
+      wakeup_pending_(false) {
+  if (!HasFreePollSlot())
+    tunsafe_die("no free poll slots");
+  int fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+  if (fd < 0)
+    tunsafe_die("eventfd failed");
+  InitPollSlot(fd, POLLIN);
+
+  // Peers and keypairs are now deleted once no worker can see them anymore.
+  processor_->dev().delayed_delete()->Configure(num_workers_);
+  processor_->dev().PublishIpToPeerMap();
+
+  for (int i = 0; i < num_workers_; i++)
+    workers_[i] = new WorkerLoop(this, i);
+  udp_ = new UdpLoop(this, num_tun_);
+  for (int i = 0; i < num_tun_; i++)
+    tun_[i] = new TunLoop(this, i);
+  inbox_ = new PacketQueueMt;
 }
 
-class TunsafeBackendBsdImpl : public TunsafeBackendBsd {
-public:
-  TunsafeBackendBsdImpl();
-  virtual ~TunsafeBackendBsdImpl();
-
-  // -- from TunInterface
-  virtual void WriteTunPacket(Packet *packet) override;
-
-  // -- from UdpInterface
-  virtual bool Initialize(int listen_port) override;
-  virtual void WriteUdpPacket(Packet *packet) override;
+ThreadedDataPlaneBsd::~ThreadedDataPlaneBsd() {
+  Stop();
+  delete udp_;
+  for (int i = 0; i < num_tun_; i++)
+    delete tun_[i];
+  for (int i = 0; i < num_workers_; i++)
+    delete workers_[i];
+  FreePacketList(inbox_pending_);
+  delete inbox_;
+}
 
-  virtual void HandleSigAlrm() override { worker_.HandleSigAlrm(); }
-  virtual void HandleExit() override { worker_.NotifyStop(); }
+bool ThreadedDataPlaneBsd::InitializeUdp(int listen_port) {
+  return udp_->Initialize(listen_port);
+}
 
-  virtual bool InitializeTun(char devname[16]) override;  
+void ThreadedDataPlaneBsd::InitializeUdpSocket(int udp_fd) {
+  udp_->SetSocket(udp_fd);
+}
 
-  virtual void RunLoopInner() override;
-private:
-  WorkerLoop worker_;
-  UdpLoop udp_;
-  TunLoop tun_;
-};
+bool ThreadedDataPlaneBsd::InitializeTun(const int *tun_fds) {
+  for (int i = 0; i < num_tun_; i++)
+    tun_[i]->Initialize(tun_fds[i]);
+  return true;
+}
 
-TunsafeBackendBsdImpl::TunsafeBackendBsdImpl() {
+void ThreadedDataPlaneBsd::Start() {
+  if (started_)
+    return;
+  started_ = true;
+  for (int i = 0; i < num_workers_; i++)
+    workers_[i]->Start();
+  udp_->Start();
+  for (int i = 0; i < num_tun_; i++)
+    tun_[i]->Start();
+  RINFO("Using %d worker threads", num_workers_);
 }
 
-TunsafeBackendBsdImpl::~TunsafeBackendBsdImpl() {
+void ThreadedDataPlaneBsd::Stop() {
+  if (!started_)
+    return;
+  started_ = false;
+  // Stop the readers first so nothing new is posted to the workers.
+  udp_->Stop();
+  for (int i = 0; i < num_tun_; i++)
+    tun_[i]->Stop();
+  for (int i = 0; i < num_workers_; i++)
+    workers_[i]->Stop();
 }
 
-bool TunsafeBackendBsdImpl::InitializeTun(char devname[16]) {
-  return tun_.Initialize(devname, &worker_);
+bool ThreadedDataPlaneBsd::WriteUdpPacket(Packet *packet) {
+  WorkerLoop *worker = WorkerLoop::current_;
+  if (packet->protocol & kPacketProtocolTcp) {
+    // The tcp sockets belong to the main thread
+    if (worker == NULL)
+      return false;
+    packet->userdata = kTargetWriteUdp;
+    PostToMainThread(packet);
+  } else if (worker != NULL) {
+    worker->udp_out_.Append(packet);
+  } else {
+    PacketList list;
+    list.Append(packet);
+    udp_->Write(&list);
+  }
+  return true;
 }
 
-void TunsafeBackendBsdImpl::WriteTunPacket(Packet *packet) override {
-  tun_.WriteTunPacket(packet);
+void ThreadedDataPlaneBsd::WriteTunPacket(Packet *packet) {
+  if (WorkerLoop *worker = WorkerLoop::current_) {
+    worker->tun_out_.Append(packet);
+  } else {
+    PacketList list;
+    list.Append(packet);
+    tun_[0]->Write(&list);
+  }
 }
 
-// Called to initialize udp
-bool TunsafeBackendBsdImpl::Initialize(int listen_port) override {
-  return udp_.Initialize(listen_port, &worker_);
+void ThreadedDataPlaneBsd::PostToMainThread(Packet *packet) {
+  // Dropped when the main thread falls behind, a handshake flood must not
+  // stall the reader and with it the data packets.
+  inbox_->TryPush(packet);
+  Wakeup();
 }
 
-void TunsafeBackendBsdImpl::WriteUdpPacket(Packet *packet) override {
-  udp_.WriteUdpPacket(packet);
+void ThreadedDataPlaneBsd::Wakeup() {
+  if (!wakeup_pending_.exchange(true)) {
+    uint64 value = 1;
+    write(fd_, &value, sizeof(value));
+  }
 }
 
-void TunsafeBackendBsdImpl::RunLoopInner() {  
-  worker_.Initialize(processor_);
-  udp_.Start();
-  tun_.Start();
+void ThreadedDataPlaneBsd::MainCheckpoint() {
+  processor_->dev().delayed_delete()->MainCheckpoint();
+}
 
-  worker_.ThreadMain();
+void ThreadedDataPlaneBsd::HandleEvents(int revents) {
+  uint64 value;
+  read(fd_, &value, sizeof(value));
+  // Clear it before looking at the inbox, so no wakeup is missed.
+  wakeup_pending_.store(false);
+  AddToRoundRobin();
+}
 
-  tun_.Stop();
-  udp_.Stop();
+// Handles the inbox a few packets at a time, like the sockets of the main
+// loop, so a full inbox shows up as a backlog and drops as udp_rx_drops.
+// Both put the main loop in the overload state.
+bool ThreadedDataPlaneBsd::DoRoundRobin() {
+  uint64 drops = udp_->rx_drops() + inbox_->drops();
+  network_->stats().udp_rx_drops += drops - reported_drops_;
+  reported_drops_ = drops;
+
+  if (inbox_pending_ == NULL) {
+    PacketList list;
+    inbox_->Pop(&list, 0);
+    inbox_pending_ = list.head;
+  }
+  for (int i = 0; i < kMaxInboxPerStep && inbox_pending_; i++) {
+    Packet *packet = inbox_pending_;
+    inbox_pending_ = Packet_NEXT(packet);
+    if (packet->userdata == kTargetWriteUdp)
+      udp_interface_->WriteUdpPacket(packet);
+    else
+      processor_->HandleUdpPacket(packet, network_->overload());
+  }
+  return inbox_pending_ != NULL;
 }
 
-TunsafeBackendBsd *CreateTunsafeBackendBsd() {
-  return new TunsafeBackendBsdImpl;
+void ThreadedDataPlaneBsd::AppendStats(std::string *result) {
+  char buf[128];
+  uint64 tun_rx_packets = 0;
+  for (int i = 0; i < num_tun_; i++)
+    tun_rx_packets += tun_[i]->rx_packets();
+  snprintf(buf, sizeof(buf), "mt_udp_rx_packets=%llu\nmt_udp_tx_packets=%llu\nmt_tun_rx_packets=%llu\nmt_tun_tx_packets=%llu\n",
+           (unsigned long long)udp_->rx_packets(), (unsigned long long)udp_->tx_packets(),
+           (unsigned long long)tun_rx_packets, (unsigned long long)tun_[0]->tx_packets());
+  result->append(buf);
+  for (int i = 0; num_tun_ > 1 && i < num_tun_; i++) {
+    snprintf(buf, sizeof(buf), "mt_tun_queue_%d_rx_packets=%llu\n", i, (unsigned long long)tun_[i]->rx_packets());
+    result->append(buf);
+  }
+  snprintf(buf, sizeof(buf), "mt_udp_reorder_drops=%llu\nmt_tun_reorder_drops=%llu\n",
+           (unsigned long long)udp_->reorder_drops(), (unsigned long long)tun_[0]->reorder()->drops());
+  result->append(buf);
+  snprintf(buf, sizeof(buf), "mt_inbox_drops=%llu\n", (unsigned long long)inbox_->drops());
+  result->append(buf);
+  MultithreadedDelayedDelete *delayed_delete = processor_->dev().delayed_delete();
+  snprintf(buf, sizeof(buf), "mt_reclaim_epoch=%u\nmt_reclaim_pending=%llu\n",
+           delayed_delete->epoch(), (unsigned long long)delayed_delete->pending());
+  result->append(buf);
+  for (int i = 0; i < num_workers_; i++) {
+    snprintf(buf, sizeof(buf), "mt_worker_%d_packets=%llu\nmt_worker_%d_drops=%llu\n",
+             i, (unsigned long long)workers_[i]->packets(), i, (unsigned long long)workers_[i]->drops());
+    result->append(buf);
+  }
 }
+
+#endif  // defined(OS_LINUX)
@@ -0,0 +1,528 @@
+// SPDX-License-Identifier: AGPL-1.0-only
+// Copyright (C) 2018 Ludvig Strigeus <info@tunsafe.com>. All Rights Reserved.
+#include "network_bsd.h"
+#include "network_common.h"
+#include "util.h"
+#include "wireguard.h"
+
+#if defined(OS_LINUX)
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <assert.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <netinet/in.h>
+#include <linux/io_uring.h>
+#include <algorithm>
+
+// Added in Linux 6.7, older headers lack it.
+static const uint8 kIoringOpReadMultishot = 49;
+
+// A datagram from a multishot recvmsg is prefixed by an io_uring_recvmsg_out,
+// the source address and room for the SO_RXQ_OVFL control message. The
+// buffers start this far before packet->data so the payload lands where the
+// packet expects it.
+static const size_t kRecvmsgControl = CMSG_SPACE(sizeof(uint32));
+static const size_t kRecvmsgPrefix = sizeof(struct io_uring_recvmsg_out) + sizeof(struct sockaddr_in) + kRecvmsgControl;
+static_assert(kRecvmsgPrefix <= Packet::HEADROOM_BEFORE, "recvmsg prefix must fit in the headroom");
+
+// The low bits of the user_data tell what kind of operation completed, the
+// rest is a pointer to the socket, SendOp or packet.
+enum {
+  kOpUdpRead = 0,
+  kOpTunRead = 1,
+  kOpUdpWrite = 2,
+  kOpTunWrite = 3,
+  // A poll that a retried send is linked to, its completion is ignored.
+  kOpPoll = 4,
+  kOpMask = 7,
+};
+
+static int SysIoUringSetup(unsigned entries, struct io_uring_params *p) {
+  return (int)syscall(__NR_io_uring_setup, entries, p);
+}
+
+static int SysIoUringEnter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+  return (int)syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, NULL, 0);
+}
+
+static int SysIoUringRegister(int fd, unsigned opcode, void *arg, unsigned nr_args) {
+  return (int)syscall(__NR_io_uring_register, fd, opcode, arg, nr_args);
+}
+
+// Multishot reads need Linux 6.7, which also has everything else we use:
+// provided buffer rings and multishot recvmsg.
+static bool HasMultishotRead(int fd) {
+  enum { kNumProbeOps = 256 };
+  size_t size = sizeof(struct io_uring_probe) + kNumProbeOps * sizeof(struct io_uring_probe_op);
+  struct io_uring_probe *probe = (struct io_uring_probe*)calloc(1, size);
+  if (!probe)
+    return false;
+  bool rv = SysIoUringRegister(fd, IORING_REGISTER_PROBE, probe, kNumProbeOps) >= 0 &&
+            probe->last_op >= kIoringOpReadMultishot &&
+            (probe->ops[kIoringOpReadMultishot].flags & IO_URING_OP_SUPPORTED) != 0;
+  free(probe);
+  return rv;
+}
+
+// A udp send or a tun write in flight.
+struct IoUringBsd::SendOp {
+  SendOp *next;
+  Packet *packet;
+  int fd;
+  TunSocketBsd *tun;
+  struct msghdr msg;
+  struct iovec iov;
+};
+
+IoUringBsd::IoUringBsd(NetworkBsd *network)
+    : BaseSocketBsd(network),
+      ring_ptr_(MAP_FAILED),
+      ring_size_(0),
+      sqes_((struct io_uring_sqe*)MAP_FAILED),
+      sqes_size_(0),
+      sq_head_(NULL),
+      sq_tail_(NULL),
+      sq_array_(NULL),
+      sq_mask_(0),
+      sq_entries_(0),
+      sq_local_tail_(0),
+      sq_submitted_(0),
+      cq_head_(NULL),
+      cq_tail_(NULL),
+      cq_mask_(0),
+      cqes_(NULL),
+      recv_msg_(NULL),
+      send_ops_(NULL),
+      free_send_ops_(NULL) {
+  for (int i = 0; i < kNumGroups; i++) {
+    buf_ring_[i] = NULL;
+    buf_packets_[i] = NULL;
+    buf_tail_[i] = 0;
+  }
+}
+
+IoUringBsd::~IoUringBsd() {
+  // Closing the ring cancels the armed reads, the buffers can be released
+  // after that.
+  CloseSocket();
+  if (sqes_ != MAP_FAILED)
+    munmap(sqes_, sqes_size_);
+  if (ring_ptr_ != MAP_FAILED)
+    munmap(ring_ptr_, ring_size_);
+  for (int i = 0; i < kNumGroups; i++) {
+    if (buf_packets_[i]) {
+      for (int j = 0; j < kBufferRingEntries; j++)
+        if (buf_packets_[i][j])
+          FreePacket(buf_packets_[i][j]);
+      delete [] buf_packets_[i];
+    }
+    if (buf_ring_[i])
+      munmap(buf_ring_[i], kBufferRingEntries * sizeof(struct io_uring_buf));
+  }
+  // Sends still in flight were cancelled with the ring.
+  if (send_ops_) {
+    for (int i = 0; i < kMaxSendOps; i++)
+      if (send_ops_[i].packet)
+        FreePacket(send_ops_[i].packet);
+  }
+  delete [] send_ops_;
+  delete recv_msg_;
+}
+
+bool IoUringBsd::Initialize() {
+  if (!HasFreePollSlot()) {
+    RERROR("No free internal sockets");
+    return false;
+  }
+  struct io_uring_params p;
+  memset(&p, 0, sizeof(p));
+  p.flags = IORING_SETUP_CQSIZE;
+  p.cq_entries = kCqEntries;
+  int fd = SysIoUringSetup(kSqEntries, &p);
+  if (fd < 0) {
+    RINFO("io_uring not supported by the kernel");
+    return false;
+  }
+  InitPollSlot(fd, POLLIN);
+  if (!(p.features & IORING_FEAT_SINGLE_MMAP) || !(p.features & IORING_FEAT_NODROP) || !HasMultishotRead(fd)) {
+    RINFO("io_uring lacks support for multishot reads");
+    return false;
+  }
+
+  ring_size_ = std::max<size_t>(p.sq_off.array + p.sq_entries * sizeof(unsigned),
+                                p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe));
+  ring_ptr_ = mmap(NULL, ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+  sqes_size_ = p.sq_entries * sizeof(struct io_uring_sqe);
+  sqes_ = (struct io_uring_sqe*)mmap(NULL, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+  if (ring_ptr_ == MAP_FAILED || sqes_ == MAP_FAILED) {
+    RERROR("mmap of io_uring failed");
+    return false;
+  }
+  uint8 *ring = (uint8*)ring_ptr_;
+  sq_head_ = (unsigned*)(ring + p.sq_off.head);
+  sq_tail_ = (unsigned*)(ring + p.sq_off.tail);
+  sq_array_ = (unsigned*)(ring + p.sq_off.array);
+  sq_mask_ = *(unsigned*)(ring + p.sq_off.ring_mask);
+  sq_entries_ = p.sq_entries;
+  sq_local_tail_ = sq_submitted_ = *sq_tail_;
+  cq_head_ = (unsigned*)(ring + p.cq_off.head);
+  cq_tail_ = (unsigned*)(ring + p.cq_off.tail);
+  cq_mask_ = *(unsigned*)(ring + p.cq_off.ring_mask);
+  cqes_ = (struct io_uring_cqe*)(ring + p.cq_off.cqes);
+  // SQEs are always used in ring order, so the index array never changes.
+  for (unsigned i = 0; i < sq_entries_; i++)
+    sq_array_[i] = i;
+
+  for (int i = 0; i < kNumGroups; i++) {
+    if (!SetupBufferRing(i)) {
+      RERROR("io_uring buffer ring setup failed");
+      return false;
+    }
+  }
+
+  recv_msg_ = new struct msghdr;
+  memset(recv_msg_, 0, sizeof(struct msghdr));
+  recv_msg_->msg_namelen = sizeof(struct sockaddr_in);
+  recv_msg_->msg_controllen = kRecvmsgControl;
+
+  send_ops_ = new SendOp[kMaxSendOps];
+  memset(send_ops_, 0, sizeof(SendOp) * kMaxSendOps);
+  for (int i = 0; i < kMaxSendOps; i++) {
+    send_ops_[i].msg.msg_iov = &send_ops_[i].iov;
+    send_ops_[i].msg.msg_iovlen = 1;
+    send_ops_[i].next = (i + 1 < kMaxSendOps) ? &send_ops_[i + 1] : NULL;
+  }
+  free_send_ops_ = send_ops_;
+  return true;
+}
+
+// Register a ring of packets that the kernel picks from when a read in
+// |group| completes.
+bool IoUringBsd::SetupBufferRing(int group) {
+  size_t size = kBufferRingEntries * sizeof(struct io_uring_buf);
+  void *mem = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (mem == MAP_FAILED)
+    return false;
+  buf_ring_[group] = (struct io_uring_buf*)mem;
+  struct io_uring_buf_reg reg;
+  memset(&reg, 0, sizeof(reg));
+  reg.ring_addr = (uint64)(uintptr_t)mem;
+  reg.ring_entries = kBufferRingEntries;
+  reg.bgid = group;
+  if (SysIoUringRegister(fd_, IORING_REGISTER_PBUF_RING, &reg, 1) < 0)
+    return false;
+  buf_packets_[group] = new Packet*[kBufferRingEntries]();
+  for (int i = 0; i < kBufferRingEntries; i++) {
+    buf_packets_[group][i] = AllocPacket();
+    if (buf_packets_[group][i] == NULL)
+      return false;
+    AddBuffer(group, i);
+  }
+  PublishBuffers(group);
+  return true;
+}
+
+// Give the packet with id |bid| back to the kernel. The new tail is
+// published after the completions have been handled.
+void IoUringBsd::AddBuffer(int group, int bid) {
+  Packet *packet = buf_packets_[group][bid];
+  size_t offset = (group == kUdpGroup) ? kRecvmsgPrefix : 0;
+  struct io_uring_buf *buf = &buf_ring_[group][buf_tail_[group]++ & (kBufferRingEntries - 1)];
+  buf->addr = (uint64)(uintptr_t)(packet->data - offset);
+  buf->len = (uint32)(kPacketCapacity + offset);
+  buf->bid = (uint16)bid;
+}
+
+// The tail of the ring overlays the unused field of the first buffer. Not
+// using io_uring_buf_ring because its flexible array member gets a nonzero
+// offset in C++.
+void IoUringBsd::PublishBuffers(int group) {
+  __atomic_store_n(&buf_ring_[group][0].resv, buf_tail_[group], __ATOMIC_RELEASE);
+}
+
+// Take ownership of the packet the kernel read into, and put a fresh one
+// in its place. Past the packet memory cap the packet goes back to the
+// kernel instead, and what it read is dropped by returning NULL.
+Packet *IoUringBsd::TakeBuffer(int group, int bid) {
+  Packet *packet = buf_packets_[group][bid];
+  Packet *fresh = AllocPacket();
+  if (fresh != NULL)
+    buf_packets_[group][bid] = fresh;
+  AddBuffer(group, bid);
+  return fresh ? packet : NULL;
+}
+
+struct io_uring_sqe *IoUringBsd::GetSqe() {
+  if (sq_local_tail_ - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE) >= sq_entries_) {
+    Submit();
+    if (sq_local_tail_ - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE) >= sq_entries_)
+      return NULL;
+  }
+  struct io_uring_sqe *sqe = &sqes_[sq_local_tail_++ & sq_mask_];
+  memset(sqe, 0, sizeof(*sqe));
+  AddToEndLoop();
+  return sqe;
+}
+
+void IoUringBsd::Submit() {
+  unsigned n = sq_local_tail_ - sq_submitted_;
+  if (n == 0)
+    return;
+  __atomic_store_n(sq_tail_, sq_local_tail_, __ATOMIC_RELEASE);
+  int r = SysIoUringEnter(fd_, n, 0, 0);
+  if (r < 0) {
+    if (errno != EINTR && errno != EAGAIN && errno != EBUSY)
+      RERROR("io_uring_enter failed: %d", errno);
+    return;
+  }
+  sq_submitted_ += r;
+  NetworkBsd::Stats *stats = &network_->stats_;
+  stats->uring_submit_calls++;
+  stats->uring_sqes += r;
+}
+
+void IoUringBsd::StartReadUdp(UdpSocketBsd *udp) {
+  struct io_uring_sqe *sqe = GetSqe();
+  if (!sqe) {
+    RERROR("io_uring submission queue full");
+    return;
+  }
+  sqe->opcode = IORING_OP_RECVMSG;
+  sqe->fd = udp->GetFd();
+  sqe->addr = (uint64)(uintptr_t)recv_msg_;
+  sqe->len = 1;
+  sqe->ioprio = IORING_RECV_MULTISHOT;
+  sqe->flags = IOSQE_BUFFER_SELECT;
+  sqe->buf_group = kUdpGroup;
+  sqe->user_data = (uint64)(uintptr_t)udp | kOpUdpRead;
+}
+
+void IoUringBsd::StartReadTun(TunSocketBsd *tun) {
+  struct io_uring_sqe *sqe = GetSqe();
+  if (!sqe) {
+    RERROR("io_uring submission queue full");
+    return;
+  }
+  sqe->opcode = kIoringOpReadMultishot;
+  sqe->fd = tun->GetFd();
+  sqe->off = (uint64)-1;
+  sqe->flags = IOSQE_BUFFER_SELECT;
+  sqe->buf_group = kTunGroup;
+  sqe->user_data = (uint64)(uintptr_t)tun | kOpTunRead;
+}
+
+void IoUringBsd::WriteUdpPacket(UdpSocketBsd *udp, Packet *packet) {
+  SendOp *op = free_send_ops_;
+  struct io_uring_sqe *sqe;
+  if (op == NULL || (sqe = GetSqe()) == NULL) {
+    network_->stats_.uring_send_drops++;
+    FreePacket(packet);
+    return;
+  }
+  free_send_ops_ = op->next;
+  op->packet = packet;
+  op->fd = udp->GetFd();
+  op->iov.iov_base = packet->data;
+  op->iov.iov_len = packet->size;
+  op->msg.msg_name = &packet->addr.sin;
+  op->msg.msg_namelen = sizeof(packet->addr.sin);
+  PrepareSend(sqe, op);
+}
+
+void IoUringBsd::PrepareSend(struct io_uring_sqe *sqe, SendOp *op) {
+  sqe->opcode = IORING_OP_SENDMSG;
+  sqe->fd = op->fd;
+  sqe->addr = (uint64)(uintptr_t)&op->msg;
+  sqe->len = 1;
+  sqe->user_data = (uint64)(uintptr_t)op | kOpUdpWrite;
+}
+
+// io_uring normally waits for room itself when the socket buffer is full, but
+// a send that was handed to an io-wq worker fails with EAGAIN instead, since
+// the sockets are non-blocking. Like the poll backend, wait until the socket
+// is writable and send it again, by linking the send to a poll for POLLOUT.
+bool IoUringBsd::RetrySend(SendOp *op) {
+  if (sq_local_tail_ + 2 - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE) > sq_entries_) {
+    Submit();
+    if (sq_local_tail_ + 2 - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE) > sq_entries_)
+      return false;
+  }
+  struct io_uring_sqe *sqe = GetSqe();
+  sqe->opcode = IORING_OP_POLL_ADD;
+  sqe->fd = op->fd;
+  sqe->poll32_events = POLLOUT;
+  sqe->flags = IOSQE_IO_LINK;
+  sqe->user_data = kOpPoll;
+  PrepareSend(GetSqe(), op);
+  network_->stats_.uring_send_retries++;
+  return true;
+}
+
+void IoUringBsd::WriteTunPacket(TunSocketBsd *tun, Packet *packet) {
+  SendOp *op = free_send_ops_;
+  struct io_uring_sqe *sqe;
+  if (op == NULL || (sqe = GetSqe()) == NULL) {
+    network_->stats_.uring_tun_write_drops++;
+    FreePacket(packet);
+    return;
+  }
+  free_send_ops_ = op->next;
+  op->packet = packet;
+  op->tun = tun;
+  sqe->opcode = IORING_OP_WRITE;
+  sqe->fd = tun->GetFd();
+  sqe->off = (uint64)-1;
+  sqe->addr = (uint64)(uintptr_t)packet->data;
+  sqe->len = packet->size;
+  sqe->user_data = (uint64)(uintptr_t)op | kOpTunWrite;
+}
+
+void IoUringBsd::HandleEvents(int revents) {
+  if (revents & (POLLERR | POLLHUP | POLLNVAL)) {
+    RERROR("io_uring error %d, closing.", revents);
+    network_->PostExit();
+  }
+  AddToRoundRobin();
+}
+
+bool IoUringBsd::DoRoundRobin() {
+  unsigned head = *cq_head_;
+  unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+  int n = 0;
+  for (; head != tail && n < kMaxCqesPerStep; head++, n++) {
+    // Copy it so the slot can be reused while the packet is processed.
+    struct io_uring_cqe cqe = cqes_[head & cq_mask_];
+    __atomic_store_n(cq_head_, head + 1, __ATOMIC_RELEASE);
+    HandleCompletion(&cqe);
+  }
+  for (int i = 0; i < kNumGroups; i++)
+    PublishBuffers(i);
+  network_->stats_.uring_cqes += n;
+  return head != __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+}
+
+void IoUringBsd::DoEndloop() {
+  Submit();
+}
+
+// Returns true if a multishot read that ended with |res| should be armed
+// again. It ends when the buffer ring runs dry, or for good on real errors.
+static bool ShouldRearmRead(int res) {
+  return res >= 0 || res == -ENOBUFS || res == -EAGAIN || res == -EINTR;
+}
+
+void IoUringBsd::HandleCompletion(const struct io_uring_cqe *cqe) {
+  void *ptr = (void*)(uintptr_t)(cqe->user_data & ~(uint64)kOpMask);
+  switch (cqe->user_data & kOpMask) {
+  case kOpUdpRead:
+    HandleUdpRead((UdpSocketBsd*)ptr, cqe);
+    break;
+  case kOpTunRead:
+    HandleTunRead((TunSocketBsd*)ptr, cqe);
+    break;
+  case kOpUdpWrite: {
+    SendOp *op = (SendOp*)ptr;
+    if (cqe->res >= 0) {
+      network_->stats_.uring_udp_send_packets++;
+    } else if (cqe->res == -EAGAIN) {
+      if (RetrySend(op))
+        break;
+      network_->stats_.uring_send_drops++;
+    } else if (cqe->res == -ECANCELED) {
+      // The poll it was linked to failed.
+      network_->stats_.uring_send_drops++;
+    } else {
+      RERROR("Write to UDP failed: %d", -cqe->res);
+    }
+    FreePacket(op->packet);
+    op->packet = NULL;
+    op->next = free_send_ops_;
+    free_send_ops_ = op;
+    break;
+  }
+  case kOpTunWrite: {
+    SendOp *op = (SendOp*)ptr;
+    if (cqe->res >= 0) {
+      op->tun->tx_packets_++;
+    } else {
+      // Counted, and logged at exponentially growing intervals, so a tun
+      // device that goes down doesn't flood the log.
+      uint64 errors = ++network_->stats_.uring_tun_write_errors;
+      if ((errors & (errors - 1)) == 0)
+        RERROR("Write to tun failed: %d (%llu times)", -cqe->res, (unsigned long long)errors);
+    }
+    FreePacket(op->packet);
+    op->packet = NULL;
+    op->next = free_send_ops_;
+    free_send_ops_ = op;
+    break;
+  }
+  case kOpPoll:
+    break;
+  }
+}
+
+void IoUringBsd::HandleUdpRead(UdpSocketBsd *udp, const struct io_uring_cqe *cqe) {
+  if (cqe->flags & IORING_CQE_F_BUFFER) {
+    Packet *packet = TakeBuffer(kUdpGroup, cqe->flags >> IORING_CQE_BUFFER_SHIFT);
+    struct io_uring_recvmsg_out *out = packet ? (struct io_uring_recvmsg_out*)(packet->data - kRecvmsgPrefix) : NULL;
+    if (packet == NULL) {
+      // What was read is dropped, see TakeBuffer.
+    } else if (cqe->res >= 0 && !(out->flags & MSG_TRUNC) && out->namelen <= sizeof(packet->addr.sin)) {
+      memcpy(&packet->addr.sin, out + 1, sizeof(packet->addr.sin));
+      packet->sin_size = out->namelen;
+      packet->size = out->payloadlen;
+      packet->protocol = kPacketProtocolUdp;
+      network_->stats_.uring_udp_recv_packets++;
+      if (out->controllen) {
+        struct msghdr mh;
+        memset(&mh, 0, sizeof(mh));
+        mh.msg_control = (uint8*)(out + 1) + sizeof(struct sockaddr_in);
+        mh.msg_controllen = out->controllen;
+        uint32 drops = udp->rx_drops_;
+        ParseRecvCmsg(&mh, &drops);
+        udp->CountRxDrops(drops);
+      }
+      udp->processor_->HandleUdpPacket(packet, network_->overload_);
+    } else {
+      FreePacket(packet);
+    }
+  }
+  if (!(cqe->flags & IORING_CQE_F_MORE)) {
+    if (ShouldRearmRead(cqe->res)) {
+      network_->stats_.uring_read_rearms++;
+      StartReadUdp(udp);
+    } else {
+      RERROR("Read from UDP failed: %d", -cqe->res);
+    }
+  }
+}
+
+void IoUringBsd::HandleTunRead(TunSocketBsd *tun, const struct io_uring_cqe *cqe) {
+  if (cqe->flags & IORING_CQE_F_BUFFER) {
+    Packet *packet = TakeBuffer(kTunGroup, cqe->flags >> IORING_CQE_BUFFER_SHIFT);
+    if (packet == NULL) {
+      // What was read is dropped, see TakeBuffer.
+    } else if (cqe->res > 0) {
+      packet->size = cqe->res;
+      tun->rx_packets_++;
+      tun->processor_->HandleTunPacket(packet);
+    } else {
+      FreePacket(packet);
+    }
+  }
+  if (!(cqe->flags & IORING_CQE_F_MORE)) {
+    if (ShouldRearmRead(cqe->res)) {
+      network_->stats_.uring_read_rearms++;
+      StartReadTun(tun);
+    } else {
+      RERROR("Read from tun failed: %d", -cqe->res);
+    }
+  }
+}
+
+#endif  // defined(OS_LINUX)
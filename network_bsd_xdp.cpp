@@ -0,0 +1,452 @@
+// SPDX-License-Identifier: AGPL-1.0-only
+// Copyright (C) 2018 Ludvig Strigeus <info@tunsafe.com>. All Rights Reserved.
+#include "network_bsd.h"
+#include "network_common.h"
+#include "util.h"
+#include "wireguard.h"
+
+#if defined(OS_LINUX)
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <assert.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/ioctl.h>
+#include <net/if.h>
+#include <net/if_arp.h>
+#include <netinet/in.h>
+#include <linux/if_ether.h>
+#include <linux/bpf.h>
+#include <linux/if_link.h>
+#include <linux/if_xdp.h>
+#include <algorithm>
+
+#ifndef SOL_XDP
+#define SOL_XDP 283
+#endif
+
+enum {
+  // Ethernet, IPv4 without options and udp
+  kXdpHeaderSize = 14 + 20 + 8,
+  // The kernel puts this much space in front of a received frame
+  kXdpPacketHeadroom = 256,
+};
+
+// The Packet header is at the start of a frame, in front of the data.
+static_assert(sizeof(Packet) <= kXdpPacketHeadroom, "Packet must fit in front of the frame data");
+
+uint8 *XdpSocketBsd::umem_begin_;
+size_t XdpSocketBsd::umem_size_;
+XdpSocketBsd *XdpSocketBsd::umem_owner_;
+
+static int SysBpf(int cmd, union bpf_attr *attr) {
+  return (int)syscall(__NR_bpf, cmd, attr, sizeof(*attr));
+}
+
+static struct bpf_insn BpfInsn(uint8 code, uint8 dst, uint8 src, int16 off, int32 imm) {
+  struct bpf_insn insn;
+  insn.code = code;
+  insn.dst_reg = dst;
+  insn.src_reg = src;
+  insn.off = off;
+  insn.imm = imm;
+  return insn;
+}
+
+// Loads done by the program are in host byte order, which is what htons
+// gives for the big endian fields.
+bool XdpSocketBsd::LoadProgram(int ifindex, uint16 port) {
+  union bpf_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.map_type = BPF_MAP_TYPE_XSKMAP;
+  attr.key_size = sizeof(uint32);
+  attr.value_size = sizeof(uint32);
+  attr.max_entries = 1;
+  map_fd_ = SysBpf(BPF_MAP_CREATE, &attr);
+  if (map_fd_ < 0) {
+    RERROR("Unable to create XSKMAP: %d", errno);
+    return false;
+  }
+  uint32 key = 0, value = (uint32)fd_;
+  memset(&attr, 0, sizeof(attr));
+  attr.map_fd = map_fd_;
+  attr.key = (uint64)(uintptr_t)&key;
+  attr.value = (uint64)(uintptr_t)&value;
+  if (SysBpf(BPF_MAP_UPDATE_ELEM, &attr) < 0) {
+    RERROR("Unable to add socket to XSKMAP: %d", errno);
+    return false;
+  }
+
+  enum { kPass = 23 };
+  struct bpf_insn prog[] = {
+    // r6 = ctx, r2 = data, r3 = data_end
+    /* 0*/ BpfInsn(BPF_ALU64 | BPF_MOV | BPF_X, 6, 1, 0, 0),
+    /* 1*/ BpfInsn(BPF_LDX | BPF_MEM | BPF_W, 2, 1, offsetof(struct xdp_md, data), 0),
+    /* 2*/ BpfInsn(BPF_LDX | BPF_MEM | BPF_W, 3, 1, offsetof(struct xdp_md, data_end), 0),
+    /* 3*/ BpfInsn(BPF_ALU64 | BPF_MOV | BPF_X, 4, 2, 0, 0),
+    /* 4*/ BpfInsn(BPF_ALU64 | BPF_ADD | BPF_K, 4, 0, 0, kXdpHeaderSize),
+    /* 5*/ BpfInsn(BPF_JMP | BPF_JGT | BPF_X, 4, 3, kPass - 6, 0),
+    // IPv4 without options or fragmentation, udp to our port
+    /* 6*/ BpfInsn(BPF_LDX | BPF_MEM | BPF_H, 5, 2, 12, 0),
+    /* 7*/ BpfInsn(BPF_JMP | BPF_JNE | BPF_K, 5, 0, kPass - 8, htons(ETH_P_IP)),
+    /* 8*/ BpfInsn(BPF_LDX | BPF_MEM | BPF_B, 5, 2, 14, 0),
+    /* 9*/ BpfInsn(BPF_JMP | BPF_JNE | BPF_K, 5, 0, kPass - 10, 0x45),
+    /*10*/ BpfInsn(BPF_LDX | BPF_MEM | BPF_B, 5, 2, 23, 0),
+    /*11*/ BpfInsn(BPF_JMP | BPF_JNE | BPF_K, 5, 0, kPass - 12, IPPROTO_UDP),
+    /*12*/ BpfInsn(BPF_LDX | BPF_MEM | BPF_H, 5, 2, 20, 0),
+    /*13*/ BpfInsn(BPF_ALU64 | BPF_AND | BPF_K, 5, 0, 0, htons(0x3fff)),
+    /*14*/ BpfInsn(BPF_JMP | BPF_JNE | BPF_K, 5, 0, kPass - 15, 0),
+    /*15*/ BpfInsn(BPF_LDX | BPF_MEM | BPF_H, 5, 2, 36, 0),
+    /*16*/ BpfInsn(BPF_JMP | BPF_JNE | BPF_K, 5, 0, kPass - 17, htons(port)),
+    // return bpf_redirect_map(&xskmap, ctx->rx_queue_index, XDP_PASS)
+    /*17*/ BpfInsn(BPF_LDX | BPF_MEM | BPF_W, 2, 6, offsetof(struct xdp_md, rx_queue_index), 0),
+    /*18*/ BpfInsn(BPF_LD | BPF_IMM | BPF_DW, 1, BPF_PSEUDO_MAP_FD, 0, map_fd_),
+    /*19*/ BpfInsn(0, 0, 0, 0, 0),
+    /*20*/ BpfInsn(BPF_ALU64 | BPF_MOV | BPF_K, 3, 0, 0, XDP_PASS),
+    /*21*/ BpfInsn(BPF_JMP | BPF_CALL, 0, 0, 0, BPF_FUNC_redirect_map),
+    /*22*/ BpfInsn(BPF_JMP | BPF_EXIT, 0, 0, 0, 0),
+    /*23*/ BpfInsn(BPF_ALU64 | BPF_MOV | BPF_K, 0, 0, 0, XDP_PASS),
+    /*24*/ BpfInsn(BPF_JMP | BPF_EXIT, 0, 0, 0, 0),
+  };
+  char log[4096];
+  log[0] = 0;
+  memset(&attr, 0, sizeof(attr));
+  attr.prog_type = BPF_PROG_TYPE_XDP;
+  attr.expected_attach_type = BPF_XDP;
+  attr.insns = (uint64)(uintptr_t)prog;
+  attr.insn_cnt = ARRAY_SIZE(prog);
+  attr.license = (uint64)(uintptr_t)"GPL";
+  attr.log_buf = (uint64)(uintptr_t)log;
+  attr.log_size = sizeof(log);
+  attr.log_level = 1;
+  prog_fd_ = SysBpf(BPF_PROG_LOAD, &attr);
+  if (prog_fd_ < 0) {
+    RERROR("Unable to load XDP program: %d\n%s", errno, log);
+    return false;
+  }
+
+  // Prefer the driver's XDP support, veth and most NICs have it.
+  static const uint32 kModes[] = {XDP_FLAGS_DRV_MODE, XDP_FLAGS_SKB_MODE};
+  for (size_t i = 0; i < ARRAY_SIZE(kModes); i++) {
+    memset(&attr, 0, sizeof(attr));
+    attr.link_create.prog_fd = prog_fd_;
+    attr.link_create.target_ifindex = ifindex;
+    attr.link_create.attach_type = BPF_XDP;
+    attr.link_create.flags = kModes[i];
+    link_fd_ = SysBpf(BPF_LINK_CREATE, &attr);
+    if (link_fd_ >= 0)
+      return true;
+  }
+  RERROR("Unable to attach XDP program: %d", errno);
+  return false;
+}
+
+XdpSocketBsd::XdpSocketBsd(NetworkBsd *network, WireguardProcessor *processor)
+    : BaseSocketBsd(network),
+      processor_(processor),
+      udp_(NULL),
+      map_fd_(-1),
+      prog_fd_(-1),
+      link_fd_(-1),
+      umem_((uint8*)MAP_FAILED),
+      port_(0),
+      free_tx_(NULL),
+      num_free_tx_(0),
+      rx_frames_out_(0),
+      rx_packets_(0),
+      tx_packets_(0),
+      tx_fallbacks_(0) {
+  memset(&rx_, 0, sizeof(rx_));
+  memset(&tx_, 0, sizeof(tx_));
+  memset(&fill_, 0, sizeof(fill_));
+  memset(&comp_, 0, sizeof(comp_));
+  memset(mac_, 0, sizeof(mac_));
+}
+
+XdpSocketBsd::~XdpSocketBsd() {
+  // Closing the link detaches the program.
+  if (link_fd_ >= 0)
+    close(link_fd_);
+  if (prog_fd_ >= 0)
+    close(prog_fd_);
+  if (map_fd_ >= 0)
+    close(map_fd_);
+  CloseSocket();
+  Ring *rings[] = {&rx_, &tx_, &fill_, &comp_};
+  for (size_t i = 0; i < ARRAY_SIZE(rings); i++)
+    if (rings[i]->map)
+      munmap(rings[i]->map, rings[i]->map_size);
+  delete [] free_tx_;
+  if (umem_owner_ == this) {
+    umem_owner_ = NULL;
+    // Packets that are still queued somewhere keep the UMEM alive, it's
+    // only freed when all of them are back.
+    if (rx_frames_out_ == 0) {
+      munmap(umem_, umem_size_);
+      umem_begin_ = NULL;
+      umem_size_ = 0;
+    }
+  }
+}
+
+bool XdpSocketBsd::MapRing(Ring *ring, const struct xdp_ring_offset *off, uint32 entry_size, uint64 pgoff) {
+  ring->map_size = off->desc + kRingSize * entry_size;
+  void *map = mmap(NULL, ring->map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, pgoff);
+  if (map == MAP_FAILED)
+    return false;
+  ring->map = map;
+  ring->producer = (uint32*)((uint8*)map + off->producer);
+  ring->consumer = (uint32*)((uint8*)map + off->consumer);
+  ring->flags = (uint32*)((uint8*)map + off->flags);
+  ring->desc = (uint8*)map + off->desc;
+  return true;
+}
+
+bool XdpSocketBsd::Initialize(const char *ifname, UdpSocketBsd *udp) {
+  if (!HasFreePollSlot()) {
+    RERROR("No free internal sockets");
+    return false;
+  }
+  if (umem_owner_ || umem_size_) {
+    RERROR("Only one XDP socket is supported");
+    return false;
+  }
+  udp_ = udp;
+  int ifindex = if_nametoindex(ifname);
+  if (ifindex == 0) {
+    RERROR("Unknown interface %s", ifname);
+    return false;
+  }
+  struct ifreq ifr;
+  memset(&ifr, 0, sizeof(ifr));
+  snprintf(ifr.ifr_name, sizeof(ifr.ifr_name), "%s", ifname);
+  if (ioctl(udp->GetFd(), SIOCGIFHWADDR, &ifr) < 0 || ifr.ifr_hwaddr.sa_family != ARPHRD_ETHER) {
+    RERROR("XDP needs an ethernet interface");
+    return false;
+  }
+  memcpy(mac_, ifr.ifr_hwaddr.sa_data, 6);
+  struct sockaddr_in sin;
+  socklen_t sin_len = sizeof(sin);
+  if (getsockname(udp->GetFd(), (struct sockaddr*)&sin, &sin_len) < 0)
+    return false;
+  port_ = ntohs(sin.sin_port);
+
+  int fd = socket(AF_XDP, SOCK_RAW | SOCK_CLOEXEC, 0);
+  if (fd < 0) {
+    RERROR("socket(AF_XDP) failed: %d", errno);
+    return false;
+  }
+  InitPollSlot(fd, POLLIN);
+
+  size_t umem_size = (size_t)(kNumRxFrames + kNumTxFrames) * kFrameSize;
+  umem_ = (uint8*)mmap(NULL, umem_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+  if (umem_ == MAP_FAILED) {
+    RERROR("Unable to allocate UMEM");
+    return false;
+  }
+  struct xdp_umem_reg mr;
+  memset(&mr, 0, sizeof(mr));
+  mr.addr = (uint64)(uintptr_t)umem_;
+  mr.len = umem_size;
+  mr.chunk_size = kFrameSize;
+  int ring_size = kRingSize;
+  struct xdp_mmap_offsets off;
+  socklen_t optlen = sizeof(off);
+  if (setsockopt(fd, SOL_XDP, XDP_UMEM_REG, &mr, sizeof(mr)) < 0 ||
+      setsockopt(fd, SOL_XDP, XDP_UMEM_FILL_RING, &ring_size, sizeof(ring_size)) < 0 ||
+      setsockopt(fd, SOL_XDP, XDP_UMEM_COMPLETION_RING, &ring_size, sizeof(ring_size)) < 0 ||
+      setsockopt(fd, SOL_XDP, XDP_RX_RING, &ring_size, sizeof(ring_size)) < 0 ||
+      setsockopt(fd, SOL_XDP, XDP_TX_RING, &ring_size, sizeof(ring_size)) < 0 ||
+      getsockopt(fd, SOL_XDP, XDP_MMAP_OFFSETS, &off, &optlen) < 0) {
+    RERROR("Unable to set up AF_XDP socket: %d", errno);
+    munmap(umem_, umem_size);
+    return false;
+  }
+  umem_begin_ = umem_;
+  umem_size_ = umem_size;
+  umem_owner_ = this;
+  if (!MapRing(&rx_, &off.rx, sizeof(struct xdp_desc), XDP_PGOFF_RX_RING) ||
+      !MapRing(&tx_, &off.tx, sizeof(struct xdp_desc), XDP_PGOFF_TX_RING) ||
+      !MapRing(&fill_, &off.fr, sizeof(uint64), XDP_UMEM_PGOFF_FILL_RING) ||
+      !MapRing(&comp_, &off.cr, sizeof(uint64), XDP_UMEM_PGOFF_COMPLETION_RING)) {
+    RERROR("Unable to map AF_XDP rings");
+    return false;
+  }
+
+  // Zero copy needs driver support, copy mode works everywhere.
+  struct sockaddr_xdp sxdp;
+  memset(&sxdp, 0, sizeof(sxdp));
+  sxdp.sxdp_family = AF_XDP;
+  sxdp.sxdp_ifindex = ifindex;
+  sxdp.sxdp_queue_id = 0;
+  sxdp.sxdp_flags = XDP_USE_NEED_WAKEUP | XDP_ZEROCOPY;
+  if (bind(fd, (struct sockaddr*)&sxdp, sizeof(sxdp)) < 0) {
+    sxdp.sxdp_flags = XDP_USE_NEED_WAKEUP | XDP_COPY;
+    if (bind(fd, (struct sockaddr*)&sxdp, sizeof(sxdp)) < 0) {
+      RERROR("Unable to bind AF_XDP socket to %s: %d", ifname, errno);
+      return false;
+    }
+  }
+
+  // The first frames are for receiving, they all start out in the fill
+  // ring. The rest are for sending.
+  uint64 *fill = (uint64*)fill_.desc;
+  for (int i = 0; i < kNumRxFrames; i++)
+    fill[i] = (uint64)i * kFrameSize;
+  fill_.cached = kNumRxFrames;
+  __atomic_store_n(fill_.producer, fill_.cached, __ATOMIC_RELEASE);
+  free_tx_ = new uint64[kNumTxFrames];
+  for (int i = 0; i < kNumTxFrames; i++)
+    free_tx_[i] = (uint64)(kNumRxFrames + i) * kFrameSize;
+  num_free_tx_ = kNumTxFrames;
+
+  if (!LoadProgram(ifindex, port_))
+    return false;
+  RINFO("Receiving udp port %d of %s through AF_XDP (%s mode)", port_, ifname,
+        (sxdp.sxdp_flags & XDP_ZEROCOPY) ? "zero copy" : "copy");
+  return true;
+}
+
+void XdpSocketBsd::FreeUmemPacket(Packet *packet) {
+  XdpSocketBsd *xdp = umem_owner_;
+  if (!xdp)
+    return;
+  Ring *fill = &xdp->fill_;
+  ((uint64*)fill->desc)[fill->cached++ & (kRingSize - 1)] = (uint8*)packet - umem_begin_;
+  __atomic_store_n(fill->producer, fill->cached, __ATOMIC_RELEASE);
+  xdp->rx_frames_out_--;
+}
+
+void XdpSocketBsd::HandleEvents(int revents) {
+  if (revents & (POLLERR | POLLHUP | POLLNVAL)) {
+    RERROR("AF_XDP error %d, closing.", revents);
+    network_->PostExit();
+  }
+  AddToRoundRobin();
+}
+
+bool XdpSocketBsd::DoRoundRobin() {
+  uint32 cons = rx_.cached;
+  uint32 n = std::min<uint32>(__atomic_load_n(rx_.producer, __ATOMIC_ACQUIRE) - cons, kMaxRxPerStep);
+  for (uint32 i = 0; i < n; i++) {
+    struct xdp_desc desc = ((struct xdp_desc*)rx_.desc)[cons++ & (kRingSize - 1)];
+    __atomic_store_n(rx_.consumer, cons, __ATOMIC_RELEASE);
+    rx_.cached = cons;
+    HandleFrame(desc.addr, desc.len);
+  }
+  return __atomic_load_n(rx_.producer, __ATOMIC_ACQUIRE) != rx_.cached;
+}
+
+// Turn a received frame into a Packet. The Packet header goes at the start
+// of the frame and the payload stays where the kernel put it.
+void XdpSocketBsd::HandleFrame(uint64 addr, uint32 len) {
+  uint8 *frame = umem_ + (addr & ~(uint64)(kFrameSize - 1));
+  uint8 *eth = umem_ + addr;
+  Packet *packet = (Packet*)frame;
+  rx_frames_out_++;
+  uint8 *ip = eth + 14, *udp = ip + 20;
+  uint32 udp_size = udp[4] << 8 | udp[5];
+  if (len < kXdpHeaderSize || eth < frame + sizeof(Packet) ||
+      udp_size < 8 || udp_size > len - (kXdpHeaderSize - 8)) {
+    FreePacket(packet);
+    return;
+  }
+  packet->Reset();
+  packet->data = udp + 8;
+  packet->size = udp_size - 8;
+  // Replies go back the way the packet came. The link details travel with
+  // the address and only become the peer's endpoint once the processor has
+  // authenticated the packet, so spoofed frames can't redirect a peer.
+  packet->protocol = kPacketProtocolUdp | kPacketProtocolXdp;
+  packet->sin_size = sizeof(packet->addr.sin);
+  memset(&packet->addr.xdp, 0, sizeof(packet->addr.xdp));
+  packet->addr.sin.sin_family = AF_INET;
+  memcpy(&packet->addr.sin.sin_port, udp, 2);
+  memcpy(&packet->addr.sin.sin_addr, ip + 12, 4);
+  memcpy(packet->addr.xdp.mac, eth + 6, 6);
+  memcpy(packet->addr.xdp.local_ip, ip + 16, 4);
+
+  rx_packets_++;
+  processor_->HandleUdpPacket(packet, network_->overload());
+}
+
+void XdpSocketBsd::ReapCompletions() {
+  uint32 cons = comp_.cached;
+  uint32 prod = __atomic_load_n(comp_.producer, __ATOMIC_ACQUIRE);
+  for (; cons != prod; cons++)
+    free_tx_[num_free_tx_++] = ((uint64*)comp_.desc)[cons & (kRingSize - 1)];
+  comp_.cached = cons;
+  __atomic_store_n(comp_.consumer, cons, __ATOMIC_RELEASE);
+}
+
+bool XdpSocketBsd::WriteFrame(Packet *packet) {
+  if (!(packet->protocol & kPacketProtocolXdp) || packet->addr.sin.sin_family != AF_INET ||
+      packet->size > kFrameSize - kXdpHeaderSize)
+    return false;
+  if (num_free_tx_ == 0) {
+    ReapCompletions();
+    if (num_free_tx_ == 0)
+      return false;
+  }
+  if (tx_.cached - __atomic_load_n(tx_.consumer, __ATOMIC_ACQUIRE) >= kRingSize)
+    return false;
+
+  uint64 addr = free_tx_[--num_free_tx_];
+  uint8 *eth = umem_ + addr, *ip = eth + 14, *udp = ip + 20;
+  memcpy(eth, packet->addr.xdp.mac, 6);
+  memcpy(eth + 6, mac_, 6);
+  eth[12] = ETH_P_IP >> 8, eth[13] = ETH_P_IP & 0xff;
+  uint32 ip_size = packet->size + 28;
+  ip[0] = 0x45, ip[1] = 0;
+  ip[2] = ip_size >> 8, ip[3] = ip_size & 0xff;
+  ip[4] = ip[5] = 0;
+  ip[6] = 0x40, ip[7] = 0;  // Don't fragment
+  ip[8] = 64, ip[9] = IPPROTO_UDP;
+  ip[10] = ip[11] = 0;
+  memcpy(ip + 12, packet->addr.xdp.local_ip, 4);
+  memcpy(ip + 16, &packet->addr.sin.sin_addr, 4);
+  uint32 sum = 0;
+  for (int i = 0; i < 20; i += 2)
+    sum += ip[i] << 8 | ip[i + 1];
+  sum = (sum & 0xffff) + (sum >> 16);
+  sum = ~(sum + (sum >> 16)) & 0xffff;
+  ip[10] = sum >> 8, ip[11] = sum & 0xff;
+  // The udp checksum is optional for IPv4.
+  udp[0] = port_ >> 8, udp[1] = port_ & 0xff;
+  memcpy(udp + 2, &packet->addr.sin.sin_port, 2);
+  udp[4] = (packet->size + 8) >> 8, udp[5] = (packet->size + 8) & 0xff;
+  udp[6] = udp[7] = 0;
+  memcpy(udp + 8, packet->data, packet->size);
+
+  struct xdp_desc *desc = &((struct xdp_desc*)tx_.desc)[tx_.cached++ & (kRingSize - 1)];
+  desc->addr = addr;
+  desc->len = packet->size + kXdpHeaderSize;
+  desc->options = 0;
+  return true;
+}
+
+void XdpSocketBsd::WritePacket(Packet *packet) {
+  if (!WriteFrame(packet)) {
+    tx_fallbacks_++;
+    udp_->WritePacket(packet);
+    return;
+  }
+  tx_packets_++;
+  FreePacket(packet);
+  AddToEndLoop();
+}
+
+void XdpSocketBsd::DoEndloop() {
+  __atomic_store_n(tx_.producer, tx_.cached, __ATOMIC_RELEASE);
+  if (__atomic_load_n(tx_.flags, __ATOMIC_ACQUIRE) & XDP_RING_NEED_WAKEUP) {
+    if (sendto(fd_, NULL, 0, MSG_DONTWAIT, NULL, 0) < 0 &&
+        errno != EAGAIN && errno != EBUSY && errno != ENOBUFS && errno != ENETDOWN)
+      RERROR("AF_XDP sendto failed: %d", errno);
+  }
+  ReapCompletions();
+}
+
+#endif  // defined(OS_LINUX)
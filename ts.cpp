@@ -491,7 +491,7 @@ getout_fail:
       if (!ParseHexString(value, binkey, sizeof(binkey)))
         goto getout_fail;
       if (!IsOnlyZeros(binkey, 32)) {
-        curve25519_donna(binkey, binkey, kCurve25519Basepoint);
+        curve25519_base(binkey, binkey);
         base64_encode(binkey, sizeof(binkey), base64key, sizeof(base64key), NULL);
       }
     } else if (strcmp(key, "address") == 0) {
@@ -822,7 +822,7 @@ int HandleCommandLine(int argc, char **argv, CommandLineOutput *output) {
   } else if (!strcmp(subcommand, "start") && output) {
     if (argc != 0 && !strcmp(argv[0], "--help")) {
 start_usage:
-      fprintf(stderr, "Usage: " EXENAME " start [-d/--daemon] [-n <interface-name>] [<filename>]\n");
+      fprintf(stderr, "Usage: " EXENAME " start [-d/--daemon] [-n <interface-name>] [--udp-batch <n>] [--no-udp-gso] [--no-udp-gro] [--tun-queues <n>] [--tun-offload] [--epoll] [--io-uring] [--xdp <interface>] [--busy-poll <usec>] [--udp-busy-poll <usec>] [--threads <n>] [--packet-memory <mb>] [--packet-watermarks <low>,<high>] [<filename>]\n");
       return 0;
     }
     for (; argc; argc--, argv++) {
@@ -837,6 +837,74 @@ start_usage:
         argc--,argv++;
         continue;
       }
+      if (strcmp(arg, "--udp-batch") == 0) {
+        if (argc < 2) goto start_usage;
+        output->udp_batch_size = atoi(argv[1]);
+        argc--,argv++;
+        continue;
+      }
+      if (strcmp(arg, "--tun-queues") == 0) {
+        if (argc < 2) goto start_usage;
+        output->tun_queues = atoi(argv[1]);
+        argc--,argv++;
+        continue;
+      }
+      if (strcmp(arg, "--epoll") == 0) {
+        output->use_epoll = true;
+        continue;
+      }
+      if (strcmp(arg, "--busy-poll") == 0) {
+        if (argc < 2) goto start_usage;
+        output->busy_poll_usec = atoi(argv[1]);
+        argc--,argv++;
+        continue;
+      }
+      if (strcmp(arg, "--udp-busy-poll") == 0) {
+        if (argc < 2) goto start_usage;
+        output->udp_busy_poll_usec = atoi(argv[1]);
+        argc--,argv++;
+        continue;
+      }
+      if (strcmp(arg, "--xdp") == 0) {
+        if (argc < 2) goto start_usage;
+        output->xdp_interface = argv[1];
+        argc--,argv++;
+        continue;
+      }
+      if (strcmp(arg, "--threads") == 0) {
+        if (argc < 2) goto start_usage;
+        output->threads = atoi(argv[1]);
+        argc--,argv++;
+        continue;
+      }
+      if (strcmp(arg, "--packet-memory") == 0) {
+        if (argc < 2) goto start_usage;
+        output->packet_memory_mb = atoi(argv[1]);
+        argc--,argv++;
+        continue;
+      }
+      if (strcmp(arg, "--packet-watermarks") == 0) {
+        if (argc < 2 || sscanf(argv[1], "%d,%d", &output->packet_low_watermark, &output->packet_high_watermark) != 2)
+          goto start_usage;
+        argc--,argv++;
+        continue;
+      }
+      if (strcmp(arg, "--io-uring") == 0) {
+        output->use_io_uring = true;
+        continue;
+      }
+      if (strcmp(arg, "--tun-offload") == 0) {
+        output->tun_offload = true;
+        continue;
+      }
+      if (strcmp(arg, "--no-udp-gso") == 0) {
+        output->no_udp_gso = true;
+        continue;
+      }
+      if (strcmp(arg, "--no-udp-gro") == 0) {
+        output->no_udp_gro = true;
+        continue;
+      }
       break;
     }
     if (argc > 1) goto start_usage;
@@ -874,7 +942,7 @@ start_usage:
       fprintf(stderr, EXENAME ": Incorrect key format\n");
       return 1;
     }
-    curve25519_donna(key, key, kCurve25519Basepoint);
+    curve25519_base(key, key);
     ansi_printf("%s\n", base64_encode(key, 32, base64buf, sizeof(base64buf), NULL));
   } else if (!strcmp(subcommand, "--help")) {
     ShowHelp();
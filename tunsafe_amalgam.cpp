@@ -15,6 +15,7 @@
 #include "ip_to_peer_map.cpp"
 #include "tunsafe_ipaddr.cpp"
 #include "crypto/curve25519/curve25519-donna.cpp"
+#include "crypto/curve25519/curve25519-x64.cpp"
 #include "crypto/chacha20poly1305.cpp"
 #include "crypto/blake2s/blake2s.cpp"
 #include "crypto/siphash/siphash.cpp"
@@ -23,6 +24,9 @@
 
 #if defined(WITH_NETWORK_BSD)
 #include "network_bsd.cpp"
+#include "network_bsd_uring.cpp"
+#include "network_bsd_xdp.cpp"
+#include "network_bsd_mt.cpp"
 #include "tunsafe_bsd.cpp"
 #include "ts.cpp"
 #include "benchmark.cpp"
@@ -23,6 +23,7 @@
 #include <sys/time.h>
 
 #include <pthread.h>
+#include <algorithm>
 
 #if defined(OS_MACOSX)
 #include <sys/kern_control.h>
@@ -314,7 +315,7 @@ did_open:
 }
 
 #elif defined(OS_LINUX)
-int open_tun(char *devname, size_t devname_size) {
+static int open_tun_with_flags(char *devname, size_t devname_size, int flags) {
   int fd, err;
   struct ifreq ifr;
 
@@ -323,7 +324,7 @@ int open_tun(char *devname, size_t devname_size) {
     return fd;
 
   memset(&ifr, 0, sizeof(ifr));
-  ifr.ifr_flags = IFF_TUN | IFF_NO_PI;
+  ifr.ifr_flags = flags;
 
   my_strlcpy(ifr.ifr_name, sizeof(ifr.ifr_name), devname);
   if ((err = ioctl(fd, TUNSETIFF, (void *) &ifr)) < 0) {
@@ -333,6 +334,26 @@ int open_tun(char *devname, size_t devname_size) {
   my_strlcpy(devname, devname_size, ifr.ifr_name);
   return fd;
 }
+
+int open_tun(char *devname, size_t devname_size) {
+  return open_tun_with_flags(devname, devname_size, IFF_TUN | IFF_NO_PI);
+}
+
+// Open |num_queues| queues of the same tun device, with extra |flags| such
+// as IFF_VNET_HDR. The first one picks the device name, the others attach
+// to it.
+bool open_tun_queues(char *devname, size_t devname_size, int *fds, int num_queues, int flags) {
+  flags |= IFF_TUN | IFF_NO_PI | (num_queues > 1 ? IFF_MULTI_QUEUE : 0);
+  for (int i = 0; i < num_queues; i++) {
+    fds[i] = open_tun_with_flags(devname, devname_size, flags);
+    if (fds[i] < 0) {
+      while (i)
+        close(fds[--i]);
+      return false;
+    }
+  }
+  return true;
+}
 #endif
 
 TunsafeBackendBsd::TunsafeBackendBsd() {
@@ -606,7 +627,10 @@ SignalCatcher::SignalCatcher(bool *exit_flag, bool *sigalarm_flag) {
     perror("sigprocmask");
     return;
   }
+#endif  // defined(OS_LINUX) || defined(OS_FREEBSD)
 
+#if defined(OS_FREEBSD)
+  // On Linux the network loop has its own timerfd.
   {
     struct itimerspec tv = {0};
     struct sigevent sev;
@@ -663,13 +687,30 @@ public:
 
   // -- from NetworkBsdDelegate
   virtual void OnSecondLoop(uint64 now) override;
+  virtual uint64 GetNextTimerDeadline(uint64 now) override;
   virtual void RunAllMainThreadScheduled() override;
 
   // -- from ProcessorDelegate
   virtual void OnConnected() override;
   virtual void OnConnectionRetry(uint32 attempts) override;
+  virtual void AppendBackendStats(std::string *result) override;
 
   WireguardProcessor *processor() { return &processor_; }
+  void SetUdpBatchSize(int batch_size) { udp_.SetBatchSize(batch_size); }
+  void SetUdpGsoEnabled(bool enabled) { udp_.SetGsoEnabled(enabled); }
+  void SetUdpGroEnabled(bool enabled) { udp_.SetGroEnabled(enabled); }
+  void SetUdpBusyPoll(int usec) { udp_.SetBusyPoll(usec); }
+  void SetBusyPoll(int usec) { network_.SetBusyPoll(usec); }
+  void SetTunQueues(int num_queues);
+  void SetTunOffload(bool enabled) { tun_offload_ = enabled; }
+  bool UseEpoll() { return network_.UseEpoll(); }
+  bool UseIoUring() { return network_.UseIoUring(); }
+  void SetXdpInterface(const char *ifname) { xdp_interface_ = ifname; }
+  bool SetThreads(int num_threads);
+
+  enum {
+    kMaxTunQueues = 16,
+  };
 
 private:
   void WriteTcpPacket(Packet *packet);
@@ -683,6 +724,17 @@ private:
   NetworkBsd network_;
   TunSocketBsd tun_;
   UdpSocketBsd udp_;
+  // With a multi queue tun device, tun_ is the first of the queues.
+  int num_tun_queues_;
+  bool tun_offload_;
+  TunSocketBsd *tun_queues_[kMaxTunQueues];
+  // With --xdp, the udp traffic of this interface goes through xdp_.
+  const char *xdp_interface_;
+#if defined(OS_LINUX)
+  XdpSocketBsd *xdp_;
+  // With --threads, the udp and tun traffic goes through data_plane_.
+  ThreadedDataPlaneBsd *data_plane_;
+#endif  // defined(OS_LINUX)
   UnixDomainSocketListenerBsd unix_socket_listener_;
   TcpSocketListenerBsd tcp_socket_listener_;
 };
@@ -694,32 +746,153 @@ TunsafeBackendBsdImpl::TunsafeBackendBsdImpl()
       network_(this, 1000),
       tun_(&network_, &processor_), 
       udp_(&network_, &processor_),
+      num_tun_queues_(1),
+      tun_offload_(false),
+      xdp_interface_(NULL),
+#if defined(OS_LINUX)
+      xdp_(NULL),
+      data_plane_(NULL),
+#endif  // defined(OS_LINUX)
       unix_socket_listener_(&network_, &processor_),
       tcp_socket_listener_(&network_, &processor_) {
+  tun_queues_[0] = &tun_;
 }
 
 TunsafeBackendBsdImpl::~TunsafeBackendBsdImpl() {
+#if defined(OS_LINUX)
+  delete xdp_;
+  delete data_plane_;
+#endif  // defined(OS_LINUX)
+  for (int i = 1; i < num_tun_queues_; i++)
+    delete tun_queues_[i];
+}
+
+void TunsafeBackendBsdImpl::SetTunQueues(int num_queues) {
+#if defined(OS_LINUX)
+  num_tun_queues_ = std::max<int>(std::min<int>(num_queues, kMaxTunQueues), 1);
+#endif  // defined(OS_LINUX)
+}
+
+bool TunsafeBackendBsdImpl::SetThreads(int num_threads) {
+#if defined(OS_LINUX)
+  if (tun_offload_ || xdp_interface_) {
+    RERROR("--threads can't be combined with --tun-offload or --xdp");
+    return false;
+  }
+  // Each tun queue gets a reader thread of its own. The queues belong to
+  // the data plane, not to tun_queues_.
+  if (!data_plane_)
+    data_plane_ = new ThreadedDataPlaneBsd(&network_, &processor_, this, num_threads, num_tun_queues_);
+  num_tun_queues_ = 1;
+  return true;
+#else  // defined(OS_LINUX)
+  RERROR("--threads is only supported on Linux");
+  return false;
+#endif  // defined(OS_LINUX)
 }
 
 bool TunsafeBackendBsdImpl::InitializeTun(char devname[16]) {
+#if defined(OS_LINUX)
+  if (data_plane_) {
+    int fds[kMaxTunQueues];
+    if (!open_tun_queues(devname, 16, fds, data_plane_->num_tun_queues(), 0)) {
+      RERROR("Error opening tun device");
+      return false;
+    }
+    data_plane_->InitializeTun(fds);
+    unix_socket_listener_.Initialize(devname);
+    return true;
+  }
+  if (num_tun_queues_ > 1 || tun_offload_) {
+    int fds[kMaxTunQueues];
+    if (!open_tun_queues(devname, 16, fds, num_tun_queues_, tun_offload_ ? IFF_VNET_HDR : 0)) {
+      RERROR("Error opening tun device");
+      return false;
+    }
+    for (int i = 0; i < num_tun_queues_; i++) {
+      if (i != 0)
+        tun_queues_[i] = new TunSocketBsd(&network_, &processor_);
+      if (!tun_queues_[i]->Initialize(fds[i])) {
+        for (; i < num_tun_queues_; i++)
+          close(fds[i]);
+        return false;
+      }
+      if (tun_offload_)
+        tun_queues_[i]->EnableOffload();
+      else
+        tun_queues_[i]->UseIoUring();
+    }
+    unix_socket_listener_.Initialize(devname);
+    return true;
+  }
+#endif  // defined(OS_LINUX)
   int tun_fd = open_tun(devname, 16);
   if (tun_fd < 0) { RERROR("Error opening tun device"); return false; }
   if (!tun_.Initialize(tun_fd)) {
     close(tun_fd);
     return false;
   }
+  tun_.UseIoUring();
   unix_socket_listener_.Initialize(devname);
   return true;  
 }
 
+// Hash the addresses and ports of a packet, so all packets of a flow are
+// written to the same tun queue.
+static uint32 TunFlowHash(const uint8 *data, size_t size) {
+  uint32 hash = 0;
+  size_t addr_offs, addr_size, l4_offs;
+  if (size >= 20 && (data[0] >> 4) == 4) {
+    addr_offs = 12, addr_size = 8, l4_offs = (data[0] & 0xF) * 4;
+  } else if (size >= 40 && (data[0] >> 4) == 6) {
+    addr_offs = 8, addr_size = 32, l4_offs = 40;
+  } else {
+    return 0;
+  }
+  for (size_t i = 0; i < addr_size; i += 4)
+    hash = (hash ^ ReadLE32(data + addr_offs + i)) * 0x9E3779B1;
+  if (l4_offs + 4 <= size)
+    hash = (hash ^ ReadLE32(data + l4_offs)) * 0x9E3779B1;
+  return hash ^ (hash >> 16);
+}
+
 void TunsafeBackendBsdImpl::WriteTunPacket(Packet *packet) {
+#if defined(OS_LINUX)
+  if (data_plane_) {
+    data_plane_->WriteTunPacket(packet);
+    return;
+  }
+#endif  // defined(OS_LINUX)
+  if (num_tun_queues_ > 1) {
+    uint32 queue = TunFlowHash(packet->data, packet->size) % num_tun_queues_;
+    tun_queues_[queue]->WritePacket(packet);
+    return;
+  }
   tun_.WritePacket(packet);
 }
 
 // Called to initialize udp
 bool TunsafeBackendBsdImpl::Configure(int listen_port, int listen_port_tcp) {
-  return udp_.Initialize(listen_port) && 
-         (listen_port_tcp == 0 || tcp_socket_listener_.Initialize(listen_port_tcp));
+#if defined(OS_LINUX)
+  if (data_plane_) {
+    return data_plane_->InitializeUdp(listen_port) &&
+           (listen_port_tcp == 0 || tcp_socket_listener_.Initialize(listen_port_tcp));
+  }
+#endif  // defined(OS_LINUX)
+  if (!udp_.Initialize(listen_port))
+    return false;
+  udp_.UseIoUring();
+#if defined(OS_LINUX)
+  if (xdp_interface_ && !xdp_) {
+    xdp_ = new XdpSocketBsd(&network_, &processor_);
+    if (!xdp_->Initialize(xdp_interface_, &udp_)) {
+      RINFO("Using the udp socket instead of AF_XDP");
+      delete xdp_;
+      xdp_ = NULL;
+    }
+  }
+#endif  // defined(OS_LINUX)
+  return listen_port_tcp == 0 || tcp_socket_listener_.Initialize(listen_port_tcp);
 }
 
 void TunsafeBackendBsdImpl::WriteTcpPacket(Packet *packet) {
@@ -759,9 +932,18 @@ void TunsafeBackendBsdImpl::WriteTcpPacket(Packet *packet) {
 }
 
 void TunsafeBackendBsdImpl::WriteUdpPacket(Packet *packet) {
-  assert((packet->protocol & 0x7F) <= 2);
+  assert((packet->protocol & ~(kPacketProtocolIncomingConnection | kPacketProtocolXdp)) <= 2);
+#if defined(OS_LINUX)
+  // Tcp packets written by the main thread are handled below.
+  if (data_plane_ && data_plane_->WriteUdpPacket(packet))
+    return;
+#endif  // defined(OS_LINUX)
   if (packet->protocol & kPacketProtocolTcp) {
     WriteTcpPacket(packet);
+#if defined(OS_LINUX)
+  } else if (xdp_) {
+    xdp_->WritePacket(packet);
+#endif  // defined(OS_LINUX)
   } else {
     udp_.WritePacket(packet);
   }
@@ -772,10 +954,22 @@ void TunsafeBackendBsdImpl::RunLoop() {
     return;
 
   SignalCatcher signal_catcher(network_.exit_flag(), network_.sigalarm_flag());
+#if defined(OS_LINUX)
+  // Started after the signals are blocked, so they all go to this thread.
+  if (data_plane_)
+    data_plane_->Start();
+  processor_.dev().ephemeral_key_pool()->Start();
+#endif  // defined(OS_LINUX)
   network_.RunLoop(&signal_catcher.orig_signal_mask_);
+#if defined(OS_LINUX)
+  processor_.dev().ephemeral_key_pool()->Stop();
+  if (data_plane_)
+    data_plane_->Stop();
+#endif  // defined(OS_LINUX)
   unix_socket_listener_.Stop();
 
-  tun_interface_gone_ = tun_.tun_interface_gone();
+  for (int i = 0; i < num_tun_queues_; i++)
+    tun_interface_gone_ |= tun_queues_[i]->tun_interface_gone();
 }
 
 void TunsafeBackendBsdImpl::OnSecondLoop(uint64 now) {
@@ -784,8 +978,16 @@ void TunsafeBackendBsdImpl::OnSecondLoop(uint64 now) {
   processor_.SecondLoop();
 }
 
+uint64 TunsafeBackendBsdImpl::GetNextTimerDeadline(uint64 now) {
+  return processor_.GetNextTimerDeadline();
+}
+
 void TunsafeBackendBsdImpl::RunAllMainThreadScheduled() {
   processor_.RunAllMainThreadScheduled();
+#if defined(OS_LINUX)
+  if (data_plane_)
+    data_plane_->MainCheckpoint();
+#endif  // defined(OS_LINUX)
 }
 
 void TunsafeBackendBsdImpl::OnConnected() {
@@ -808,6 +1010,27 @@ void TunsafeBackendBsdImpl::OnConnectionRetry(uint32 attempts) {
   }
 }
 
+void TunsafeBackendBsdImpl::AppendBackendStats(std::string *result) {
+  network_.AppendStats(result);
+  char buf[128];
+  for (int i = 0; i < num_tun_queues_; i++) {
+    snprintf(buf, sizeof(buf), "tun_queue_%d_rx_packets=%llu\ntun_queue_%d_tx_packets=%llu\n",
+             i, (unsigned long long)tun_queues_[i]->rx_packets(),
+             i, (unsigned long long)tun_queues_[i]->tx_packets());
+    result->append(buf);
+  }
+#if defined(OS_LINUX)
+  if (xdp_) {
+    snprintf(buf, sizeof(buf), "xdp_rx_packets=%llu\nxdp_tx_packets=%llu\nxdp_tx_fallbacks=%llu\n",
+             (unsigned long long)xdp_->rx_packets(), (unsigned long long)xdp_->tx_packets(),
+             (unsigned long long)xdp_->tx_fallbacks());
+    result->append(buf);
+  }
+  if (data_plane_)
+    data_plane_->AppendStats(result);
+#endif  // defined(OS_LINUX)
+}
+
 void TunsafeBackendBsdImpl::CloseOrphanTcpConnections() {
   // Add all incoming tcp connections into a lookup table
   WG_HASHTABLE_IMPL<WgAddrEntry::IpPort, void*, WgAddrEntry::IpPortHasher> lookup;
@@ -855,9 +1078,36 @@ int main(int argc, char **argv) {
 
   SetThreadName("tunsafe-m");
 
+  if ((cmd.packet_memory_mb > 0 || cmd.packet_high_watermark > 0) &&
+      !ConfigurePacketArena((size_t)std::max(cmd.packet_memory_mb, 0) << 20,
+                            std::max(cmd.packet_low_watermark, 0), std::max(cmd.packet_high_watermark, 0)))
+    return 1;
+
   TunsafeBackendBsdImpl backend;
   if (cmd.interface_name)
     backend.SetTunDeviceName(cmd.interface_name);
+  if (cmd.udp_batch_size)
+    backend.SetUdpBatchSize(cmd.udp_batch_size);
+  if (cmd.no_udp_gso)
+    backend.SetUdpGsoEnabled(false);
+  if (cmd.no_udp_gro)
+    backend.SetUdpGroEnabled(false);
+  if (cmd.tun_queues)
+    backend.SetTunQueues(cmd.tun_queues);
+  if (cmd.tun_offload)
+    backend.SetTunOffload(true);
+  if (cmd.use_epoll && !backend.UseEpoll())
+    return 1;
+  if (cmd.use_io_uring && !backend.UseIoUring())
+    RINFO("Falling back to poll for tun and udp");
+  if (cmd.xdp_interface)
+    backend.SetXdpInterface(cmd.xdp_interface);
+  if (cmd.busy_poll_usec > 0)
+    backend.SetBusyPoll(cmd.busy_poll_usec);
+  if (cmd.udp_busy_poll_usec > 0)
+    backend.SetUdpBusyPoll(cmd.udp_busy_poll_usec);
+  if (cmd.threads > 0 && !backend.SetThreads(cmd.threads))
+    return 1;
 
   DnsResolver dns_resolver(NULL);
   if (*cmd.filename_to_load && !ParseWireGuardConfigFile(backend.processor(), cmd.filename_to_load, &dns_resolver))
@@ -8,8 +8,23 @@
 #define WITH_HANDSHAKE_EXT 0
 #define WITH_SHORT_HEADERS 0
 #define WITH_HEADER_OBFUSCATION 0
+#ifndef WITH_AVX512_OPTIMIZATIONS
 #define WITH_AVX512_OPTIMIZATIONS 0
+#endif
+// Single pass ChaCha20-Poly1305 with a scalar poly1305 between the vector
+// rounds. Only pays off on cores with spare scalar ports, the separate asm
+// kernels were as fast or faster on the ones measured so far. Tests/
+// chacha20poly1305_stitched_test.cpp turns it on to check it still agrees.
+#ifndef WITH_STITCHED_CHACHA20POLY1305
+#define WITH_STITCHED_CHACHA20POLY1305 0
+#endif
 #define WITH_BENCHMARK 0
 
+// Build the peer and device locks, they're needed by the multithreaded
+// data plane of the Linux backend.
+#if defined(WITH_NETWORK_BSD) && defined(__linux__)
+#define WITH_WG_THREADING 1
+#endif
+
 // Use bytell hashmap instead. Only works in 64-bit builds
 #define WITH_BYTELL_HASHMAP 0
@@ -67,6 +67,8 @@ void PrintCpuFeatures() {
   if (X86_PCAP_PCLMULQDQ) s = strcpy_e(s, end, " pclmuldqd");
   if (X86_PCAP_AVX512F) s = strcpy_e(s, end, " avx512f");
   if (X86_PCAP_AVX512VL) s = strcpy_e(s, end, " avx512vl");
+  if (X86_PCAP_BMI2) s = strcpy_e(s, end, " bmi2");
+  if (X86_PCAP_ADX) s = strcpy_e(s, end, " adx");
 
   RINFO("Using:%s", capbuf);
 }
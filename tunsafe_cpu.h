@@ -22,7 +22,9 @@ extern uint32 x86_pcap[3];
 #define X86_PCAP_AVX (x86_pcap[1] & (1 << 28))
 // cpuid 7, ebx
 #define X86_PCAP_AVX2 (x86_pcap[2] & (1 << 5))
+#define X86_PCAP_BMI2 (x86_pcap[2] & (1 << 8))
 #define X86_PCAP_AVX512F (x86_pcap[2] & (1 << 16))
+#define X86_PCAP_ADX (x86_pcap[2] & (1 << 19))
 #define X86_PCAP_AVX512VL (x86_pcap[2] & (1 << 31))
 
 #endif  // defined(ARCH_CPU_X86_FAMILY)
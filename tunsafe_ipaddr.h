@@ -13,6 +13,13 @@
 union IpAddr {
   sockaddr_in sin;
   sockaddr_in6 sin6;
+  // An IPv4 endpoint reached through AF_XDP, with the peer's MAC and our
+  // own address on that link. Only valid with kPacketProtocolXdp.
+  struct {
+    sockaddr_in sin;
+    uint8 mac[6];
+    uint8 local_ip[4];
+  } xdp;
 };
 
 struct WgCidrAddr {
@@ -108,15 +108,25 @@ bool Thread::is_started() {
 }
 #endif
 
-MultithreadedDelayedDelete::MultithreadedDelayedDelete() {
-  table_ = NULL;
-  num_threads_ = 0;
+static std::atomic<uint32> delayed_delete_serial;
+
+MultithreadedDelayedDelete::MultithreadedDelayedDelete()
+    : num_threads_(0),
+      serial_(++delayed_delete_serial),
+      epoch_(0),
+      table_(NULL),
+      records_(NULL),
+      sealed_(NULL),
+      deleted_(0) {
 }
 
 MultithreadedDelayedDelete::~MultithreadedDelayedDelete() {
-  assert(curr_.size() == 0);
-  assert(next_.size() == 0);
-  assert(to_delete_.size() == 0);
+  assert(sealed_.load() == NULL && limbo_.empty());
+  for (ThreadRecord *r = records_.load(), *next; r; r = next) {
+    next = r->next;
+    assert(r->entries.empty());
+    delete r;
+  }
   free(table_);
 }
 
@@ -126,40 +136,122 @@ void MultithreadedDelayedDelete::Configure(uint32 num_threads) {
   table_ = (CheckpointData*)calloc(sizeof(CheckpointData), num_threads);
 }
 
+MultithreadedDelayedDelete::ThreadRecord *MultithreadedDelayedDelete::GetThreadRecord(bool create) {
+  static thread_local struct {
+    uint32 serial;
+    ThreadRecord *record;
+  } cache;
+  if (cache.serial == serial_)
+    return cache.record;
+  ThreadRecord *r = records_.load();
+  while (r && !CurrentThreadIdEquals(r->thread))
+    r = r->next;
+  if (r == NULL) {
+    if (!create)
+      return NULL;
+    // Records are only removed by the destructor, so pushing is all that's needed.
+    r = new ThreadRecord;
+    r->thread = GetCurrentThreadId();
+    r->added.store(0);
+    r->next = records_.load();
+    while (!records_.compare_exchange_weak(r->next, r)) {}
+  }
+  cache.serial = serial_;
+  cache.record = r;
+  return r;
+}
+
 void MultithreadedDelayedDelete::Add(DoDeleteFunc *func, void *param) {
   if (num_threads_ == 0) {
     func(param);
     return;
   }
-  lock_.Acquire();
+  ThreadRecord *r = GetThreadRecord(true);
   Entry e = {func, param};
-  curr_.push_back(e);
-  lock_.Release();
+  r->entries.push_back(e);
+  r->added.store(r->added.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  if (r->entries.size() >= 64)
+    Seal(r);
+}
+
+void MultithreadedDelayedDelete::Seal(ThreadRecord *r) {
+  Batch *b = new Batch;
+  b->entries.swap(r->entries);
+  // The objects were unlinked before this, so tagging them with a later
+  // epoch than the one they were added in is safe.
+  b->epoch = epoch_.load();
+  b->next = sealed_.load();
+  while (!sealed_.compare_exchange_weak(b->next, b)) {}
 }
 
 void MultithreadedDelayedDelete::Checkpoint(uint32 thread_id) {
-  table_[thread_id].value.store(1);
+  ThreadRecord *r = GetThreadRecord(false);
+  if (r && !r->entries.empty())
+    Seal(r);
+  table_[thread_id].value.store(epoch_.load() * 2 + 1);
+}
+
+void MultithreadedDelayedDelete::Offline(uint32 thread_id) {
+  ThreadRecord *r = GetThreadRecord(false);
+  if (r && !r->entries.empty())
+    Seal(r);
+  table_[thread_id].value.store(0);
 }
 
 void MultithreadedDelayedDelete::MainCheckpoint() {
-  // Wait for all threads to signal that they reached the checkpoint
-  for (size_t i = 0; i < num_threads_; i++) {
-    if (table_[i].value.load() == 0)
-      return;
-  }
+  if (num_threads_ == 0)
+    return;
+  ThreadRecord *r = GetThreadRecord(false);
+  if (r && !r->entries.empty())
+    Seal(r);
 
-  // All threads reached the checkpoint, clear the values
-  for (size_t i = 0; i < num_threads_; i++)
-    table_[i].value.store(0);
+  // Advance the epoch if all online threads have seen the current one
+  uint32 epoch = epoch_.load(), i;
+  for (i = 0; i < num_threads_; i++) {
+    uint32 v = table_[i].value.load();
+    if (v != 0 && v != epoch * 2 + 1)
+      break;
+  }
+  if (i == num_threads_)
+    epoch_.store(epoch + 1);
+  DeleteBatches(false);
+}
 
-  // Swap curr and next, and delete all nexts.
-  lock_.Acquire();
-  std::swap(curr_, next_);
-  std::swap(curr_, to_delete_);
-  lock_.Release();
+void MultithreadedDelayedDelete::DeleteBatches(bool everything) {
+  for (Batch *b = sealed_.exchange(NULL); b; b = b->next)
+    limbo_.push_back(b);
+  uint32 epoch = epoch_.load();
+  size_t j = 0;
+  for (size_t i = 0; i < limbo_.size(); i++) {
+    Batch *b = limbo_[i];
+    if (everything || (int32)(epoch - b->epoch) >= 2) {
+      for (auto it = b->entries.begin(); it != b->entries.end(); ++it)
+        it->func(it->param);
+      deleted_ += b->entries.size();
+      delete b;
+    } else {
+      limbo_[j++] = b;
+    }
+  }
+  limbo_.resize(j);
+}
 
-  for (auto it = to_delete_.begin(); it != to_delete_.end(); ++it) {
-    it->func(it->param);
+void MultithreadedDelayedDelete::Flush() {
+  // Deleting an object may add more objects, e.g. the keypairs of a peer.
+  for (;;) {
+    for (ThreadRecord *r = records_.load(); r; r = r->next) {
+      if (!r->entries.empty())
+        Seal(r);
+    }
+    if (sealed_.load() == NULL && limbo_.empty())
+      break;
+    DeleteBatches(true);
   }
-  to_delete_.clear();
+}
+
+uint64 MultithreadedDelayedDelete::pending() const {
+  uint64 added = 0;
+  for (ThreadRecord *r = records_.load(); r; r = r->next)
+    added += r->added.load(std::memory_order_relaxed);
+  return added - deleted_;
 }
@@ -2,6 +2,7 @@
 // Copyright (C) 2018 Ludvig Strigeus <info@tunsafe.com>. All Rights Reserved.
 #pragma once
 #include "tunsafe_types.h"
+#include <algorithm>
 #include <atomic>
 #include <vector>
 #include <assert.h>
@@ -86,7 +87,8 @@ private:
 class Mutex {
   friend class ConditionVariable;
 public:
-#if defined(_DEBUG)
+  // Tracked whenever asserts are on, they check it through IsPeerLocked.
+#if !defined(NDEBUG)
   bool locked_;
   bool IsLocked() { return locked_; }
 #define Mutex_SETLOCKED(x) locked_ = x;
@@ -186,38 +188,168 @@ private:
 };
 
 
-// This class deletes objects delayed. All participating threads will call a function,
-// and then once all threads did, all registered objects will get deleted.
+// A bounded lock free ring with any number of producers and a single
+// consumer, which also covers the single producer case. Items are added and
+// removed in batches, so the shared indexes are touched once per batch.
+// The ring doesn't sleep by itself, but it tells the producer when the
+// consumer has gone idle and needs to be woken up.
+template<typename T>
+class MpscRing {
+public:
+  // |capacity| must be a power of two.
+  explicit MpscRing(uint32 capacity) : mask_(capacity - 1), tail_(0), head_(0), waiting_(false) {
+    assert((capacity & mask_) == 0);
+    slots_ = new Slot[capacity];
+    for (uint32 i = 0; i < capacity; i++)
+      slots_[i].seq.store(i, std::memory_order_relaxed);
+  }
+  ~MpscRing() { delete [] slots_; }
+
+  // Add up to |n| items and return how many fit. |*wake| is set when the
+  // consumer waits for items, the caller must wake it up then.
+  size_t Push(const T *items, size_t n, bool *wake) {
+    uint32 pos = tail_.load(std::memory_order_relaxed), m;
+    do {
+      m = (uint32)std::min<size_t>(n, mask_ + 1 - (pos - head_.load(std::memory_order_acquire)));
+      if (m == 0)
+        return 0;
+    } while (!tail_.compare_exchange_weak(pos, pos + m, std::memory_order_relaxed));
+    for (uint32 i = 0; i < m; i++) {
+      Slot *slot = &slots_[(pos + i) & mask_];
+      slot->value = items[i];
+      slot->seq.store(pos + i + 1, std::memory_order_release);
+    }
+    // Pairs with the fence in PrepareToWait
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    *wake = waiting_.load(std::memory_order_relaxed) && waiting_.exchange(false);
+    return m;
+  }
+
+  // Remove up to |n| items, only the consumer may call this.
+  size_t Pop(T *items, size_t n) {
+    uint32 pos = head_.load(std::memory_order_relaxed), i;
+    for (i = 0; i < n; i++) {
+      Slot *slot = &slots_[(pos + i) & mask_];
+      if (slot->seq.load(std::memory_order_acquire) != pos + i + 1)
+        break;
+      items[i] = slot->value;
+    }
+    if (i != 0)
+      head_.store(pos + i, std::memory_order_release);
+    return i;
+  }
+
+  // Called by the consumer before it sleeps. Returns false if there's
+  // already something to pop, then it must not sleep.
+  bool PrepareToWait() {
+    waiting_.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    uint32 pos = head_.load(std::memory_order_relaxed);
+    if (slots_[pos & mask_].seq.load(std::memory_order_acquire) == pos + 1) {
+      waiting_.store(false, std::memory_order_relaxed);
+      return false;
+    }
+    return true;
+  }
+
+  // Called by the consumer once it's awake again.
+  void FinishWait() { waiting_.store(false, std::memory_order_relaxed); }
+
+private:
+  struct Slot {
+    std::atomic<uint32> seq;
+    T value;
+  };
+  Slot *slots_;
+  uint32 mask_;
+  uint8 align0_[64];
+  // Written by the producers
+  std::atomic<uint32> tail_;
+  uint8 align1_[60];
+  // Written by the consumer
+  std::atomic<uint32> head_;
+  std::atomic<bool> waiting_;
+};
+
+// This class deletes objects delayed, using epoch based reclamation. Each
+// data thread announces the current epoch when it holds no references to
+// shared objects, and the main thread advances the epoch once all of them
+// did. An object that was added in one epoch is deleted two epochs later.
+// Objects are collected in a list per thread that adds them, and handed to
+// the main thread in batches, so Add takes no lock.
 class MultithreadedDelayedDelete {
 public:
   MultithreadedDelayedDelete();
   ~MultithreadedDelayedDelete();
 
   typedef void DoDeleteFunc(void *x);
+  // Can be called from any thread.
   void Add(DoDeleteFunc *func, void *param);
 
+  // Set up |num_threads| data threads, with the ids 0 to num_threads - 1.
   void Configure(uint32 num_threads);
 
+  // Called by a data thread when it holds no references to shared objects.
+  // It also needs to be called before touching them after Offline.
   void Checkpoint(uint32 thread_id);
 
+  // A data thread that's offline isn't waited for, so one that blocks for a
+  // long time doesn't keep everything from being deleted.
+  void Offline(uint32 thread_id);
+
+  // Advance the epoch and delete what's safe to delete, on the main thread.
   void MainCheckpoint();
 
+  // Delete everything right away, once the other threads are gone.
+  void Flush();
+
   bool enabled() const { return num_threads_ != 0; }
 
+  // For the stats, only valid on the main thread.
+  uint32 epoch() const { return epoch_.load(); }
+  uint64 pending() const;
+
 private:
   struct Entry {
     DoDeleteFunc *func;
     void *param;
   };
 
+  // Objects from one thread, they can be deleted once the epoch is two past
+  // |epoch|.
+  struct Batch {
+    std::vector<Entry> entries;
+    uint32 epoch;
+    Batch *next;
+  };
+
+  // The objects added by one thread, that aren't in a batch yet.
+  struct ThreadRecord {
+    ThreadId thread;
+    std::vector<Entry> entries;
+    std::atomic<uint64> added;
+    ThreadRecord *next;
+  };
+
   struct CheckpointData {
+    // epoch * 2 + 1 when the thread last announced |epoch|, 0 when offline.
     std::atomic<uint32> value;
     uint8 align[60];
   };
 
-  uint32 num_threads_;
+  ThreadRecord *GetThreadRecord(bool create);
+  void Seal(ThreadRecord *record);
+  void DeleteBatches(bool everything);
 
-  std::vector<Entry> curr_, next_, to_delete_;
+  uint32 num_threads_;
+  // Tells apart instances in the thread local cache of GetThreadRecord.
+  uint32 serial_;
+  std::atomic<uint32> epoch_;
   CheckpointData *table_;
-  Mutex lock_;
+  std::atomic<ThreadRecord*> records_;
+  // Batches not yet seen by the main thread
+  std::atomic<Batch*> sealed_;
+  // Batches waiting for the epoch to advance, only used by the main thread.
+  std::vector<Batch*> limbo_;
+  uint64 deleted_;
 };
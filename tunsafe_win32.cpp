@@ -686,7 +686,7 @@ static INT_PTR WINAPI KeyPairDlgProc(HWND hWnd, UINT message, WPARAM wParam,
       size_t len = GetDlgItemText(hWnd, IDC_PRIVATE_KEY, buf, sizeof(buf));
       size_t olen = 32;
       if (base64_decode((uint8*)buf, len, priv, &olen) && olen == 32) {
-        curve25519_donna(pub, priv, kCurve25519Basepoint);
+        curve25519_base(pub, priv);
         SetKeyBox(hWnd, IDC_PUBLIC_KEY, pub);
       } else {
         SetDlgItemText(hWnd, IDC_PUBLIC_KEY, "(Invalid Private Key)");
@@ -699,7 +699,7 @@ static INT_PTR WINAPI KeyPairDlgProc(HWND hWnd, UINT message, WPARAM wParam,
       uint8 pub[32];
       OsGetRandomBytes(priv, 32);
       curve25519_normalize(priv);
-      curve25519_donna(pub, priv, kCurve25519Basepoint);
+      curve25519_base(pub, priv);
       SetKeyBox(hWnd, IDC_PRIVATE_KEY, priv);
       SetKeyBox(hWnd, IDC_PUBLIC_KEY, pub);
       return TRUE;
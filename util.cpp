@@ -423,6 +423,10 @@ uint64 OsGetMilliseconds() {
   return GetTickCount64();
 }
 
+uint64 OsGetMillisecondsCoarse() {
+  return GetTickCount64();
+}
+
 void OsGetTimestampTAI64N(uint8 dst[12]) {
   SYSTEMTIME systime;
   uint64 file_time_uint64 = 0;
@@ -463,6 +467,10 @@ uint64 OsGetMilliseconds() {
   return clock * (uint64_t)timebase.numer / (uint64_t)timebase.denom;
 }
 
+uint64 OsGetMillisecondsCoarse() {
+  return OsGetMilliseconds();
+}
+
 #else  // defined(OS_MACOSX)
 uint64 OsGetMilliseconds() {
   struct timespec ts;
@@ -473,6 +481,17 @@ uint64 OsGetMilliseconds() {
   }
   return (uint64)ts.tv_sec * 1000 + (ts.tv_nsec / 1000000);
 }
+
+uint64 OsGetMillisecondsCoarse() {
+#if defined(CLOCK_MONOTONIC_COARSE)
+  // The time of the last tick, the same clock as CLOCK_MONOTONIC but it
+  // doesn't have to read the hardware clock.
+  struct timespec ts;
+  if (clock_gettime(CLOCK_MONOTONIC_COARSE, &ts) == 0)
+    return (uint64)ts.tv_sec * 1000 + (ts.tv_nsec / 1000000);
+#endif  // defined(CLOCK_MONOTONIC_COARSE)
+  return OsGetMilliseconds();
+}
 #endif
 
 void OsGetTimestampTAI64N(uint8 dst[12]) {
@@ -45,6 +45,8 @@ bool ParseBase64Key(const char *s, uint8 key[32]);
 
 
 uint64 OsGetMilliseconds();
+// Like OsGetMilliseconds, but cheaper and may lag it by a few milliseconds.
+uint64 OsGetMillisecondsCoarse();
 void InitOsxGetMilliseconds();
 void OsInterruptibleSleep(int millis);
 void OsGetTimestampTAI64N(uint8 dst[12]);
@@ -53,5 +55,18 @@ struct CommandLineOutput {
   const char *filename_to_load;
   const char *interface_name;
   bool daemon;
+  int udp_batch_size;
+  bool no_udp_gso;
+  bool no_udp_gro;
+  int tun_queues;
+  bool tun_offload;
+  bool use_epoll;
+  bool use_io_uring;
+  const char *xdp_interface;
+  int busy_poll_usec;
+  int udp_busy_poll_usec;
+  int threads;
+  int packet_memory_mb;
+  int packet_low_watermark, packet_high_watermark;
 };
 int HandleCommandLine(int argc, char **argv, CommandLineOutput *output);
@@ -284,9 +284,7 @@ bool WireguardProcessor::HandleIcmpv6NeighborSolicitation(const byte *data, size
   }
 
   // Target address must match a peer's range.
-  WG_ACQUIRE_RWLOCK_SHARED(dev_.ip_to_peer_map_lock_);
   WgPeer *peer = (WgPeer*)dev_.ip_to_peer_map().LookupV6(data + 48);
-  WG_RELEASE_RWLOCK_SHARED(dev_.ip_to_peer_map_lock_);
   if (peer == NULL)
     return false;
 
@@ -334,6 +332,17 @@ static inline bool IsIpv6Multicast(const uint8 dst[16]) {
 
 // On incoming packet to the tun interface.
 void WireguardProcessor::HandleTunPacket(Packet *packet) {
+  ProcessTunPacket(packet, NULL);
+}
+
+void WireguardProcessor::HandleTunPackets(Packet **packets, size_t count) {
+  CryptoBatch batch;
+  for (size_t i = 0; i < count; i++)
+    ProcessTunPacket(packets[i], &batch);
+  FlushEncryptBatch(&batch);
+}
+
+void WireguardProcessor::ProcessTunPacket(Packet *packet, CryptoBatch *batch) {
   uint8 *data = packet->data;
   size_t data_size = packet->size;
   unsigned ip_version, size_from_header;
@@ -347,9 +356,7 @@ void WireguardProcessor::HandleTunPacket(Packet *packet) {
   ip_version = *data >> 4;
   if (ip_version == 4) {
     uint32 ip = ReadBE32(data + 16);
-    WG_ACQUIRE_RWLOCK_SHARED(dev_.ip_to_peer_map_lock_);
     peer = (WgPeer*)dev_.ip_to_peer_map().LookupV4(ip);
-    WG_RELEASE_RWLOCK_SHARED(dev_.ip_to_peer_map_lock_);
     if (peer == NULL)
       goto getout;
     if ((ip >= (224 << 24) || ip == peer->ipv4_broadcast_addr_) && !peer->allow_multicast_through_peer_)
@@ -367,9 +374,7 @@ void WireguardProcessor::HandleTunPacket(Packet *packet) {
     if (data[6] == kIpProto_ICMPv6 && HandleIcmpv6NeighborSolicitation(data, data_size))
       goto getout;
 
-    WG_ACQUIRE_RWLOCK_SHARED(dev_.ip_to_peer_map_lock_); 
     peer = (WgPeer*)dev_.ip_to_peer_map().LookupV6(data + 24);
-    WG_RELEASE_RWLOCK_SHARED(dev_.ip_to_peer_map_lock_);
     if (peer == NULL)
       goto getout;
     
@@ -385,7 +390,7 @@ void WireguardProcessor::HandleTunPacket(Packet *packet) {
 
   // WriteAndEncryptPacketToUdp needs a held lock
   WG_ACQUIRE_LOCK(peer->mutex_);
-  WriteAndEncryptPacketToUdp_WillUnlock(peer, packet);
+  WriteAndEncryptPacketToUdp_WillUnlock(peer, packet, batch);
   return;
   
 getout:
@@ -393,8 +398,9 @@ getout:
   FreePacket(packet);
 }
 
-// This function must be called with the peer lock held. It will remove the lock
-void WireguardProcessor::WriteAndEncryptPacketToUdp_WillUnlock(WgPeer *peer, Packet *packet) {
+// This function must be called with the peer lock held. It will remove the lock.
+// With a |batch|, the packet is encrypted and written once the batch is flushed.
+void WireguardProcessor::WriteAndEncryptPacketToUdp_WillUnlock(WgPeer *peer, Packet *packet, CryptoBatch *batch) {
   assert(peer->IsPeerLocked());
   uint8 *data = packet->data, *ad;
   size_t size = packet->size, ad_len, orig_size = size;
@@ -536,6 +542,16 @@ need_big_packet:
     ad_len = 0;
   }
 
+  if (batch != NULL) {
+    WgCryptoJob job = {data, size, ad, ad_len, send_ctr, keypair, false};
+    batch->jobs[batch->count] = job;
+    batch->packets[batch->count] = packet;
+    batch->peers[batch->count] = want_handshake ? peer : NULL;
+    if (++batch->count == kWgCryptoBatchSize)
+      FlushEncryptBatch(batch);
+    return;
+  }
+
   WgKeypairEncryptPayload(data, size, ad, ad_len, send_ctr, keypair);
 
   DoWriteUdpPacket(packet);
@@ -583,6 +599,16 @@ static NOINLINE void ScrambleUnscrambleAndWrite(Packet *packet, ScramblerSiphash
 #endif // WITH_HEADER_OBFUSCATION
 }
 
+void WireguardProcessor::FlushEncryptBatch(CryptoBatch *batch) {
+  WgKeypairEncryptPayloads(batch->jobs, batch->count);
+  for (size_t i = 0; i < batch->count; i++) {
+    DoWriteUdpPacket(batch->packets[i]);
+    if (batch->peers[i])
+      batch->peers[i]->ScheduleNewHandshake();
+  }
+  batch->count = 0;
+}
+
 void WireguardProcessor::DoWriteUdpPacket(Packet *packet) {
   stats_.udp_packets_out++;
   stats_.udp_bytes_out += packet->size;
@@ -594,8 +620,12 @@ void WireguardProcessor::DoWriteUdpPacket(Packet *packet) {
 
 void WireguardProcessor::RunAllMainThreadScheduled() {
   WgPeer *peer, *next;
+  uint64 now = 0;
   assert(dev_.IsMainThread());
 
+  // Changes to the allowed ips become visible once the current event is done.
+  dev_.PublishIpToPeerMap();
+
   if (dev_.main_thread_scheduled_ == NULL)
     return;
 
@@ -618,6 +648,12 @@ void WireguardProcessor::RunAllMainThreadScheduled() {
       peer->handshake_attempts_ = 0;
       SendHandshakeInitiation(peer);
     }
+    if (ev & WgPeer::kMainThreadScheduled_CheckTimeouts) {
+      // A timer that expires earlier was armed, or the keys changed
+      if (now == 0)
+        now = OsGetMilliseconds();
+      CheckPeerTimeouts(peer, now);
+    }
   }
 }
 
@@ -661,6 +697,17 @@ bool WireguardProcessor::IsMainThreadPacket(Packet *packet) {
 
 // Handles an incoming WireGuard packet from the UDP side, decrypt etc.
 void WireguardProcessor::HandleUdpPacket(Packet *packet, bool overload) {
+  ProcessUdpPacket(packet, overload, NULL);
+}
+
+void WireguardProcessor::HandleUdpPackets(Packet **packets, size_t count, bool overload) {
+  CryptoBatch batch;
+  for (size_t i = 0; i < count; i++)
+    ProcessUdpPacket(packets[i], overload, &batch);
+  FlushDecryptBatch(&batch);
+}
+
+void WireguardProcessor::ProcessUdpPacket(Packet *packet, bool overload, CryptoBatch *batch) {
   uint32 type;
   assert(packet->protocol != 0xCD && (uint16)packet->addr.sin.sin_family != 0xCDCD); // catch msvc uninit mem
 
@@ -676,10 +723,13 @@ void WireguardProcessor::HandleUdpPacket(Packet *packet, bool overload) {
   if (packet->size < sizeof(uint32))
     goto invalid_size;
   type = ReadLE32((uint32*)packet->data);
+  // The packets that are waiting to be decrypted go first.
+  if (type != MESSAGE_DATA && batch != NULL && batch->count != 0)
+    FlushDecryptBatch(batch);
   if (type == MESSAGE_DATA) {
     if (packet->size < sizeof(MessageData))
       goto invalid_size;
-    HandleDataPacket(packet);
+    HandleDataPacket(packet, batch);
 #if WITH_SHORT_HEADERS
   } else if (type & WG_SHORT_HEADER_BIT) {
     HandleShortHeaderFormatPacket(type, packet);
@@ -809,8 +859,8 @@ void WireguardProcessor::HandleShortHeaderFormatPacket(uint32 tag, Packet *packe
   keypair->send_ctr_acked = std::max<uint64>(keypair->send_ctr_acked, acked_counter);
 
   // Periodically broadcast out the short key 
-  if ((tag & WG_SHORT_HEADER_KEY_ID_MASK) == 0x00 && !keypair->did_attempt_remember_ip_port) {
-    keypair->did_attempt_remember_ip_port = true;
+  if ((tag & WG_SHORT_HEADER_KEY_ID_MASK) == 0x00 && keypair->remember_ip_port_epoch != dev_.second_loop_epoch_) {
+    keypair->remember_ip_port_epoch = dev_.second_loop_epoch_;
     if (keypair->enabled_features[WG_FEATURE_ID_SKIP_KEYID_IN])
       dev_.UpdateKeypairAddrEntry_Locked(packet->addr, keypair);
   }
@@ -849,7 +899,9 @@ void WireguardProcessor::HandleAuthenticatedDataPacket_WillUnlock(WgKeypair *key
 
   // Remember the endpoint of the peer
   if (peer->allow_endpoint_change_ &&
-      (CompareIpAddr(&peer->endpoint_, &packet->addr) | (peer->endpoint_protocol_ ^ packet->protocol)) != 0) {
+      ((CompareIpAddr(&peer->endpoint_, &packet->addr) | (peer->endpoint_protocol_ ^ packet->protocol)) != 0 ||
+       ((packet->protocol & kPacketProtocolXdp) &&
+        memcmp(&peer->endpoint_.xdp, &packet->addr.xdp, sizeof(packet->addr.xdp)) != 0))) {
 #if WITH_SHORT_HEADERS
     // When the endpoint changes, forget about using the short key.
     keypair->broadcast_short_key = 0;
@@ -907,9 +959,7 @@ void WireguardProcessor::HandleAuthenticatedDataPacket_WillUnlock(WgKeypair *key
   if (ip_version == 4) {
     if (data_size < IPV4_HEADER_SIZE)
       goto getout_error_header;
-    WG_ACQUIRE_RWLOCK_SHARED(dev_.ip_to_peer_map_lock_);
     peer_from_header = (WgPeer*)dev_.ip_to_peer_map().LookupV4(ReadBE32(data + 12));
-    WG_RELEASE_RWLOCK_SHARED(dev_.ip_to_peer_map_lock_);
     size_from_header = ReadBE16(data + 2);
     if (size_from_header < IPV4_HEADER_SIZE) {
       // too small packet?
@@ -918,9 +968,7 @@ void WireguardProcessor::HandleAuthenticatedDataPacket_WillUnlock(WgKeypair *key
   } else if (ip_version == 6) {
     if (data_size < IPV6_HEADER_SIZE)
       goto getout_error_header;
-    WG_ACQUIRE_RWLOCK_SHARED(dev_.ip_to_peer_map_lock_);
     peer_from_header = (WgPeer*)dev_.ip_to_peer_map().LookupV6(data + 8);
-    WG_RELEASE_RWLOCK_SHARED(dev_.ip_to_peer_map_lock_);
     size_from_header = IPV6_HEADER_SIZE + ReadBE16(data + 4);
   } else {
     // invalid ip version
@@ -943,7 +991,7 @@ getout:
   FreePacket(packet);
 }
 
-void WireguardProcessor::HandleDataPacket(Packet *packet) {
+void WireguardProcessor::HandleDataPacket(Packet *packet, CryptoBatch *batch) {
   assert(dev_.IsMainOrDataThread());
 
   uint8 *data = packet->data;
@@ -953,7 +1001,6 @@ void WireguardProcessor::HandleDataPacket(Packet *packet) {
   WgKeypair *keypair = dev_.LookupKeypairByKeyId(key_id);
   if (keypair == NULL || counter >= REJECT_AFTER_MESSAGES) {
     stats_.error_key_id++;
-getout:
     FreePacket(packet);
     return;
   }
@@ -961,10 +1008,52 @@ getout:
   packet->data = data + sizeof(MessageData);
   packet->size = data_size - sizeof(MessageData) - keypair->auth_tag_length;
 
-  if (!WgKeypairDecryptPayload(data + sizeof(MessageData), data_size - sizeof(MessageData),
-                               NULL, 0, counter, keypair)) {
+  if (batch != NULL) {
+    WgCryptoJob job = {data + sizeof(MessageData), data_size - sizeof(MessageData), NULL, 0, counter, keypair, false};
+    batch->jobs[batch->count] = job;
+    batch->packets[batch->count] = packet;
+    if (++batch->count == kWgCryptoBatchSize)
+      FlushDecryptBatch(batch);
+    return;
+  }
+
+  HandleDecryptedDataPacket(keypair, packet, counter, data_size,
+                            WgKeypairDecryptPayload(data + sizeof(MessageData), data_size - sizeof(MessageData),
+                                                    NULL, 0, counter, keypair));
+}
+
+void WireguardProcessor::FlushDecryptBatch(CryptoBatch *batch) {
+  WgKeypairDecryptPayloads(batch->jobs, batch->count);
+  // The packets before may switch keys, and without delayed deletes the old
+  // keypair is freed right away. DeleteKeypair clears it from the jobs.
+  bool track = !dev_.delayed_delete_.enabled();
+  if (track) {
+    dev_.flushing_jobs_ = batch->jobs;
+    dev_.flushing_jobs_count_ = batch->count;
+  }
+  for (size_t i = 0; i < batch->count; i++) {
+    WgCryptoJob *job = &batch->jobs[i];
+    if (job->keypair == NULL) {
+      stats_.error_key_id++;
+      FreePacket(batch->packets[i]);
+      continue;
+    }
+    HandleDecryptedDataPacket(job->keypair, batch->packets[i], job->nonce,
+                              (uint32)(job->size + sizeof(MessageData)), job->ok);
+  }
+  if (track) {
+    dev_.flushing_jobs_ = NULL;
+    dev_.flushing_jobs_count_ = 0;
+  }
+  batch->count = 0;
+}
+
+void WireguardProcessor::HandleDecryptedDataPacket(WgKeypair *keypair, Packet *packet, uint64 counter, uint32 data_size, bool mac_ok) {
+  if (!mac_ok) {
     stats_.error_mac++;
-    goto getout;
+getout:
+    FreePacket(packet);
+    return;
   }
 
   WG_ACQUIRE_LOCK(keypair->peer->mutex_);
@@ -1092,28 +1181,33 @@ void WireguardProcessor::SecondLoop() {
   stats_.tun_bytes_in_per_second = (float)(bytes_in * f);
   stats_.tun_bytes_out_per_second = (float)(bytes_out * f);
 
-  for (WgPeer *peer = dev_.first_peer(); peer; peer = peer->next_peer_) {
-    WgKeypair *keypair = peer->curr_keypair_;
-
-    // Allow ip/port to be remembered again for this keypair
-    if (keypair)
-      keypair->did_attempt_remember_ip_port = false;
-
-    // Avoid taking the lock if it seems unneccessary
-    if (now >= peer->time_of_next_key_event_ || peer->timers_ != 0) {
-      uint32 mask;
-      {
-        WG_SCOPED_LOCK(peer->mutex_);
-        mask = peer->CheckTimeouts_Locked(now);
-        if (mask == 0)
-          continue;
-        if (mask & WgPeer::ACTION_SEND_KEEPALIVE)
-          SendKeepalive_Locked(peer);
-      }
-      if (mask & WgPeer::ACTION_SEND_HANDSHAKE)
-        SendHandshakeInitiation(peer);
-    }
-  }
+  // Only the peers whose timers expired need to be looked at
+  while (WgPeer *peer = dev_.PopExpiredPeerTimer(now))
+    CheckPeerTimeouts(peer, now);
 
   dev_.SecondLoop(now);
 }
+
+void WireguardProcessor::CheckPeerTimeouts(WgPeer *peer, uint64 now) {
+  uint32 mask;
+  {
+    WG_SCOPED_LOCK(peer->mutex_);
+    mask = peer->CheckTimeouts_Locked(now);
+    uint64 deadline = peer->GetNextTimerDeadline_Locked(now);
+    if (deadline != peer->timer_deadline())
+      dev_.SetPeerTimer(peer, std::max<uint64>(deadline, now + 1));
+    if (mask & WgPeer::ACTION_SEND_KEEPALIVE)
+      SendKeepalive_Locked(peer);
+  }
+  if (mask & WgPeer::ACTION_SEND_HANDSHAKE)
+    SendHandshakeInitiation(peer);
+}
+
+uint64 WireguardProcessor::GetNextTimerDeadline() {
+  uint64 deadline = dev_.next_peer_timer();
+  // Keep the per second stats and the rate limiter going while there's traffic
+  if (stats_.tun_bytes_in != stats_last_bytes_in_ || stats_.tun_bytes_out != stats_last_bytes_out_ ||
+      dev_.rate_limiter()->is_used())
+    deadline = std::min<uint64>(deadline, stats_last_ts_ + 1000);
+  return deadline;
+}
@@ -57,6 +57,8 @@ class ProcessorDelegate {
 public:
   virtual void OnConnected() = 0;
   virtual void OnConnectionRetry(uint32 attempts) = 0;
+  // Append backend specific statistics as key=value lines.
+  virtual void AppendBackendStats(std::string *result) {}
 };
 
 enum InternetBlockState {
@@ -95,10 +97,18 @@ public:
 
   void HandleTunPacket(Packet *packet);
   void HandleUdpPacket(Packet *packet, bool overload);
+  // Same as above for several packets, their data packets are encrypted or
+  // decrypted together with the multi-buffer code.
+  void HandleTunPackets(Packet **packets, size_t count);
+  void HandleUdpPackets(Packet **packets, size_t count, bool overload);
   static bool IsMainThreadPacket(Packet *packet);
 
   void SecondLoop();
 
+  // Returns the time in milliseconds when SecondLoop needs to run next, so
+  // the caller can sleep until then instead of ticking every second.
+  uint64 GetNextTimerDeadline();
+
   const WgProcessorStats &GetStats();
   void ResetStats();
 
@@ -112,16 +122,32 @@ public:
   const std::vector<WgCidrAddr> &addr() { return addresses_; }
   void RunAllMainThreadScheduled();
 private:
+  // Data packets that wait to be encrypted or decrypted together.
+  struct CryptoBatch {
+    CryptoBatch() : count(0) {}
+    size_t count;
+    WgCryptoJob jobs[kWgCryptoBatchSize];
+    Packet *packets[kWgCryptoBatchSize];
+    // When encrypting, the peer that wants a new handshake.
+    WgPeer *peers[kWgCryptoBatchSize];
+  };
+
+  void ProcessTunPacket(Packet *packet, CryptoBatch *batch);
+  void ProcessUdpPacket(Packet *packet, bool overload, CryptoBatch *batch);
+  void FlushEncryptBatch(CryptoBatch *batch);
+  void FlushDecryptBatch(CryptoBatch *batch);
   void DoWriteUdpPacket(Packet *packet);
-  void WriteAndEncryptPacketToUdp_WillUnlock(WgPeer *peer, Packet *packet);
+  void WriteAndEncryptPacketToUdp_WillUnlock(WgPeer *peer, Packet *packet, CryptoBatch *batch = NULL);
   void SendHandshakeInitiation(WgPeer *peer);
   void SendKeepalive_Locked(WgPeer *peer);
   void SendQueuedPackets_Locked(WgPeer *peer);
+  void CheckPeerTimeouts(WgPeer *peer, uint64 now);
 
   void HandleHandshakeInitiationPacket(Packet *packet);
   void HandleHandshakeResponsePacket(Packet *packet);
   void HandleHandshakeCookiePacket(Packet *packet);
-  void HandleDataPacket(Packet *packet);
+  void HandleDataPacket(Packet *packet, CryptoBatch *batch);
+  void HandleDecryptedDataPacket(WgKeypair *keypair, Packet *packet, uint64 counter, uint32 data_size, bool mac_ok);
   
   void HandleAuthenticatedDataPacket_WillUnlock(WgKeypair *keypair, Packet *packet);
   void HandleShortHeaderFormatPacket(uint32 tag, Packet *packet);
@@ -147,6 +173,8 @@ private:
 
   WgDevice dev_;
 
+  // With the threaded data plane, the workers update the data path counters
+  // without synchronization, so these are approximate then.
   WgProcessorStats stats_;
 
   std::vector<WgCidrAddr> addresses_;
@@ -388,9 +388,11 @@ void WgConfig::HandleConfigurationProtocolGet(WireguardProcessor *proc, std::str
     CmsgAppendFmt(result, "listen_port=%d", proc->listen_port_);
   for(const WgCidrAddr &x : proc->addresses_)
     CmsgAppendFmt(result, "address=%s", PrintWgCidrAddr(x, buf));
+  if (proc->procdel_)
+    proc->procdel_->AppendBackendStats(result);
   
   for (WgPeer *peer = proc->dev_.peers_; peer; peer = peer->next_peer_) {
-    WG_SCOPED_LOCK(peer->lock_);
+    WG_SCOPED_LOCK(peer->mutex_);
     
     CmsgAppendHex(result, "public_key", peer->s_remote_.bytes, sizeof(peer->s_remote_));
     if (!IsOnlyZeros(peer->preshared_key_, sizeof(peer->preshared_key_)))
@@ -14,6 +14,9 @@
 #include "tunsafe_cpu.h"
 #include <algorithm>
 #include <assert.h>
+#if WITH_WG_THREADING
+#include <sched.h>
+#endif  // WITH_WG_THREADING
 #include <stdlib.h>
 #include <string.h>
 
@@ -51,15 +54,197 @@ bool ReplayDetector::CheckReplay(uint64 seq_nr) {
   return (prev & mask) == 0;
 }
 
-WgDevice::WgDevice() {
+WgKeyIdTable::WgKeyIdTable(MultithreadedDelayedDelete *delayed_delete)
+    : table_(NewTable(16)), count_(0), delayed_delete_(delayed_delete) {
+}
+
+WgKeyIdTable::~WgKeyIdTable() {
+  DeleteTable(table_.load());
+}
+
+WgKeyIdTable::Table *WgKeyIdTable::NewTable(uint32 size) {
+  Table *t = (Table*)calloc(1, offsetof(Table, buckets) + sizeof(t->buckets[0]) * size);
+  if (!t)
+    tunsafe_die("Out of memory");
+  t->mask = size - 1;
+  return t;
+}
+
+void WgKeyIdTable::DeleteTable(void *p) {
+  Table *t = (Table*)p;
+  for (uint32 i = 0; i <= t->mask; i++) {
+    for (Entry *e = t->buckets[i].load(), *next; e; e = next) {
+      next = e->next.load();
+      delete e;
+    }
+  }
+  free(t);
+}
+
+void WgKeyIdTable::DeleteEntry(void *entry) {
+  delete (Entry*)entry;
+}
+
+// Key ids are generated randomly by us so no point in wasting cycles on
+// hashing them.
+WgKeyIdTable::Entry *WgKeyIdTable::Lookup(uint32 key_id) {
+  Table *t = table_.load(std::memory_order_acquire);
+  Entry *e = t->buckets[key_id & t->mask].load(std::memory_order_acquire);
+  while (e && e->key_id != key_id)
+    e = e->next.load(std::memory_order_acquire);
+  return e;
+}
+
+bool WgKeyIdTable::Insert(uint32 key_id, WgPeer *peer) {
+  if (Lookup(key_id))
+    return false;
+  Table *t = table_.load(std::memory_order_relaxed);
+  if (count_ > t->mask) {
+    // The readers may still be walking the old table, so build a new one
+    // with new entries, and get rid of the old one once they're done.
+    Table *nt = NewTable((t->mask + 1) * 2);
+    for (uint32 i = 0; i <= t->mask; i++) {
+      for (Entry *e = t->buckets[i].load(std::memory_order_relaxed); e; e = e->next.load(std::memory_order_relaxed)) {
+        Entry *ne = new Entry;
+        ne->key_id = e->key_id;
+        ne->peer = e->peer;
+        ne->keypair.store(e->keypair.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        ne->next.store(nt->buckets[e->key_id & nt->mask].load(std::memory_order_relaxed), std::memory_order_relaxed);
+        nt->buckets[e->key_id & nt->mask].store(ne, std::memory_order_relaxed);
+      }
+    }
+    table_.store(nt, std::memory_order_release);
+    delayed_delete_->Add(&DeleteTable, t);
+    t = nt;
+  }
+  Entry *e = new Entry;
+  e->key_id = key_id;
+  e->peer = peer;
+  e->keypair.store(NULL, std::memory_order_relaxed);
+  std::atomic<Entry*> *bucket = &t->buckets[key_id & t->mask];
+  e->next.store(bucket->load(std::memory_order_relaxed), std::memory_order_relaxed);
+  bucket->store(e, std::memory_order_release);
+  count_++;
+  return true;
+}
+
+void WgKeyIdTable::Erase(uint32 key_id) {
+  Table *t = table_.load(std::memory_order_relaxed);
+  std::atomic<Entry*> *pp = &t->buckets[key_id & t->mask];
+  for (Entry *e; (e = pp->load(std::memory_order_relaxed)) != NULL; pp = &e->next) {
+    if (e->key_id == key_id) {
+      // Readers on |e| can still follow its next pointer.
+      pp->store(e->next.load(std::memory_order_relaxed), std::memory_order_release);
+      delayed_delete_->Add(&DeleteEntry, e);
+      count_--;
+      return;
+    }
+  }
+}
+
+#if WITH_WG_THREADING
+WgEphemeralKeyPool::WgEphemeralKeyPool() : ready_(kSize), free_(kSize), shutting_down_(false) {
+  uint32 indexes[kSize];
+  bool wake;
+  for (uint32 i = 0; i < kSize; i++)
+    indexes[i] = i;
+  free_.Push(indexes, kSize, &wake);
+}
+
+WgEphemeralKeyPool::~WgEphemeralKeyPool() {
+  Stop();
+  memzero_crypto(entries_, sizeof(entries_));
+}
+
+void WgEphemeralKeyPool::Start() {
+  if (!thread_.is_started()) {
+    shutting_down_ = false;
+    thread_.StartThread(this);
+  }
+}
+
+void WgEphemeralKeyPool::Stop() {
+  if (thread_.is_started()) {
+    mutex_.Acquire();
+    shutting_down_ = true;
+    wake_.Wake();
+    mutex_.Release();
+    thread_.StopThread();
+  }
+}
+
+void WgEphemeralKeyPool::ThreadMain() {
+#if defined(SCHED_IDLE)
+  // Only run when the cpu has nothing better to do, Get generates the pair
+  // inline when the pool is empty.
+  struct sched_param param = {0};
+  pthread_setschedparam(pthread_self(), SCHED_IDLE, &param);
+#endif  // defined(SCHED_IDLE)
+  uint32 indexes[kSize];
+  while (!shutting_down_.load()) {
+    size_t n = free_.Pop(indexes, kSize);
+    if (n == 0) {
+      mutex_.Acquire();
+      if (free_.PrepareToWait() && !shutting_down_.load())
+        wake_.Wait(&mutex_);
+      mutex_.Release();
+      free_.FinishWait();
+      continue;
+    }
+    for (size_t i = 0; i < n; i++) {
+      Entry *e = &entries_[indexes[i]];
+      bool wake;
+      OsGetRandomBytes(e->priv, sizeof(e->priv));
+      curve25519_normalize(e->priv);
+      curve25519_base(e->pub, e->priv);
+      ready_.Push(&indexes[i], 1, &wake);
+    }
+  }
+}
+#else  // WITH_WG_THREADING
+WgEphemeralKeyPool::WgEphemeralKeyPool() {}
+WgEphemeralKeyPool::~WgEphemeralKeyPool() {}
+void WgEphemeralKeyPool::Start() {}
+void WgEphemeralKeyPool::Stop() {}
+#endif  // WITH_WG_THREADING
+
+void WgEphemeralKeyPool::Get(uint8 priv[WG_PUBLIC_KEY_LEN], uint8 pub[WG_PUBLIC_KEY_LEN]) {
+#if WITH_WG_THREADING
+  uint32 index;
+  if (ready_.Pop(&index, 1)) {
+    Entry *e = &entries_[index];
+    bool wake = false;
+    memcpy(priv, e->priv, WG_PUBLIC_KEY_LEN);
+    memcpy(pub, e->pub, WG_PUBLIC_KEY_LEN);
+    memzero_crypto(e, sizeof(*e));
+    free_.Push(&index, 1, &wake);
+    if (wake) {
+      mutex_.Acquire();
+      wake_.Wake();
+      mutex_.Release();
+    }
+    return;
+  }
+#endif  // WITH_WG_THREADING
+  OsGetRandomBytes(priv, WG_PUBLIC_KEY_LEN);
+  curve25519_normalize(priv);
+  curve25519_base(pub, priv);
+}
+
+WgDevice::WgDevice() : key_id_lookup_(&delayed_delete_) {
   peers_ = NULL;
   last_peer_ptr_ = &peers_;
   delegate_ = NULL;
   header_obfuscation_ = false;
   is_private_key_initialized_ = false;
+  second_loop_epoch_ = 1;
   next_rng_slot_ = 0;
   main_thread_scheduled_ = NULL;
   main_thread_scheduled_last_ = &main_thread_scheduled_;
+  flushing_jobs_ = NULL;
+  flushing_jobs_count_ = 0;
+  ip_to_peer_map_rcu_.store(&ip_to_peer_map_);
+  ip_to_peer_map_dirty_ = false;
 
   low_resolution_timestamp_ = cookie_secret_timestamp_ = OsGetMilliseconds();
   OsGetRandomBytes(cookie_secret_, sizeof(cookie_secret_));
@@ -73,12 +258,18 @@ WgDevice::WgDevice() {
 WgDevice::~WgDevice() {
   assert(IsMainThread());
   RemoveAllPeers();
+  PublishIpToPeerMap();
+  delayed_delete_.Flush();
+  IpToPeerMap *map = ip_to_peer_map_rcu_.exchange(&ip_to_peer_map_);
+  if (map != &ip_to_peer_map_)
+    DeleteIpToPeerMap(map);
 }
 
 void WgDevice::SecondLoop(uint64 now) {
   assert(IsMainThread());
 
   low_resolution_timestamp_ = now;
+  second_loop_epoch_++;
   if (rate_limiter_.is_used()) {
     uint32 k[5];
     for (size_t i = 0; i < ARRAY_SIZE(k); i++)
@@ -95,36 +286,71 @@ uint32 WgDevice::InsertInKeyIdLookup(WgPeer *peer, WgKeypair *kp) {
     if (v == 0)
       continue;
 
-    // Take the exclusive lock since we're modifying it.
-    WG_SCOPED_RWLOCK_EXCLUSIVE(key_id_lookup_lock_);
+    // Take the lock since we're modifying it.
+    WG_SCOPED_LOCK(key_id_lookup_lock_);
 
-    std::pair<WgPeer*, WgKeypair*> &peer_and_keypair = key_id_lookup_[v];
-    if (peer_and_keypair.first == NULL) {
-      peer_and_keypair = std::make_pair(peer, kp);
+    if (key_id_lookup_.Insert(v, peer)) {
       uint32 &x = (kp ? kp->local_key_id : peer->local_key_id_during_hs_);
       uint32 old = x;
       x = v;
       if (old)
-        key_id_lookup_.erase(old);
+        key_id_lookup_.Erase(old);
       return v;
     }
   }
 }
 
-std::pair<WgPeer*, WgKeypair*> *WgDevice::LookupPeerInKeyIdLookup(uint32 key_id) {
-  // This function is only ever called by the main thread, so no need to lock,
-  // since the main thread is the only mutator.
+void WgDevice::PublishKeypairInKeyIdLookup(WgKeypair *kp) {
+  assert(IsMainThread() && kp->peer);
+  WG_SCOPED_LOCK(key_id_lookup_lock_);
+  WgKeyIdTable::Entry *e = key_id_lookup_.Lookup(kp->local_key_id);
+  assert(e && e->peer == kp->peer);
+  // Everything written to the keypair before this is seen by the readers.
+  e->keypair.store(kp, std::memory_order_release);
+}
+
+WgPeer *WgDevice::LookupPeerInKeyIdLookup(uint32 key_id) {
   assert(IsMainThread());
-  auto it = key_id_lookup_.find(key_id);
-  return (it != key_id_lookup_.end() && it->second.second == NULL) ? &it->second : NULL;
+  WgKeyIdTable::Entry *e = key_id_lookup_.Lookup(key_id);
+  return (e != NULL && e->keypair.load(std::memory_order_relaxed) == NULL) ? e->peer : NULL;
 }
 
 WgKeypair *WgDevice::LookupKeypairByKeyId(uint32 key_id) {
-  // This function can be called from any thread, so make sure to 
-  // lock using the shared lock.
-  WG_SCOPED_RWLOCK_SHARED(key_id_lookup_lock_);
-  auto it = key_id_lookup_.find(key_id);
-  return (it != key_id_lookup_.end()) ? it->second.second : NULL;
+  // This function can be called from any thread, and takes no lock.
+  WgKeyIdTable::Entry *e = key_id_lookup_.Lookup(key_id);
+  return (e != NULL) ? e->keypair.load(std::memory_order_acquire) : NULL;
+}
+
+void WgDevice::DeleteIpToPeerMap(void *map) {
+  delete (IpToPeerMap*)map;
+}
+
+void WgDevice::PublishIpToPeerMap() {
+  assert(IsMainThread());
+  // Without other threads the map is used directly. This is also called
+  // right after enabling them, to switch to a copy.
+  if (delayed_delete_.enabled() &&
+      (ip_to_peer_map_dirty_ || ip_to_peer_map_rcu_.load() == &ip_to_peer_map_)) {
+    // Build a copy from the allowed ips of each peer, they match
+    // |ip_to_peer_map_|.
+    IpToPeerMap *map = new IpToPeerMap;
+    for (WgPeer *peer = peers_; peer; peer = peer->next_peer_) {
+      for (auto it = peer->allowed_ips_.begin(); it != peer->allowed_ips_.end(); ++it) {
+        if (it->size == 32)
+          map->InsertV4(ReadBE32(it->addr), it->cidr, peer);
+        else
+          map->InsertV6(it->addr, it->cidr, peer);
+      }
+    }
+    IpToPeerMap *old = ip_to_peer_map_rcu_.exchange(map);
+    if (old != &ip_to_peer_map_)
+      delayed_delete_.Add(&DeleteIpToPeerMap, old);
+  }
+  ip_to_peer_map_dirty_ = false;
+  // The removed peers can't be found through the map anymore.
+  for (WgPeer *peer : peers_to_delete_)
+    delayed_delete_.Add(&WgPeer::DelayedDelete, peer);
+  peers_to_delete_.clear();
 }
 
 uint32 WgDevice::GetRandomNumber() {
@@ -162,7 +388,7 @@ void WgDevice::SetPrivateKey(const uint8 private_key[WG_PUBLIC_KEY_LEN]) {
   assert(IsMainThread());
   // Derive the public key from the private key.
   memcpy(s_priv_, private_key, sizeof(s_priv_));
-  curve25519_donna(s_pub_, s_priv_, kCurve25519Basepoint);
+  curve25519_base(s_pub_, s_priv_);
 
   // Precompute: precomputed_cookie_label_hash_ := HASH(LABEL-COOKIE || Spub_m)
   //             precomputed_label_mac1_hash_ := HASH(MAC1-COOKIE || Spub_m)
@@ -184,6 +410,64 @@ WgPeer *WgDevice::AddPeer() {
   return peer;
 }
 
+void WgDevice::SetPeerTimer(WgPeer *peer, uint64 deadline) {
+  assert(IsMainThread());
+  int i = peer->timer_heap_index_;
+  peer->timer_deadline_.store(deadline, std::memory_order_relaxed);
+  if (deadline == UINT64_MAX) {
+    if (i >= 0) {
+      peer->timer_heap_index_ = -1;
+      TimerHeapEntry last = timer_heap_.back();
+      timer_heap_.pop_back();
+      if (i != (int)timer_heap_.size()) {
+        timer_heap_[i] = last;
+        last.peer->timer_heap_index_ = i;
+        MoveInTimerHeap(i);
+      }
+    }
+    return;
+  }
+  if (i < 0) {
+    i = (int)timer_heap_.size();
+    timer_heap_.push_back(TimerHeapEntry());
+    timer_heap_[i].peer = peer;
+    peer->timer_heap_index_ = i;
+  }
+  timer_heap_[i].deadline = deadline;
+  MoveInTimerHeap(i);
+}
+
+// Restore the heap order after the deadline of entry |i| changed
+void WgDevice::MoveInTimerHeap(size_t i) {
+  TimerHeapEntry *heap = timer_heap_.data(), e = heap[i];
+  size_t n = timer_heap_.size(), j;
+  while (i > 0 && e.deadline < heap[j = (i - 1) >> 1].deadline) {
+    heap[i] = heap[j];
+    heap[i].peer->timer_heap_index_ = (int)i;
+    i = j;
+  }
+  while ((j = i * 2 + 1) < n) {
+    if (j + 1 < n && heap[j + 1].deadline < heap[j].deadline)
+      j++;
+    if (heap[j].deadline >= e.deadline)
+      break;
+    heap[i] = heap[j];
+    heap[i].peer->timer_heap_index_ = (int)i;
+    i = j;
+  }
+  heap[i] = e;
+  e.peer->timer_heap_index_ = (int)i;
+}
+
+WgPeer *WgDevice::PopExpiredPeerTimer(uint64 now) {
+  assert(IsMainThread());
+  if (timer_heap_.empty() || timer_heap_[0].deadline > now)
+    return NULL;
+  WgPeer *peer = timer_heap_[0].peer;
+  SetPeerTimer(peer, UINT64_MAX);
+  return peer;
+}
+
 void WgDevice::RemoveAllPeers() {
   assert(IsMainThread());
   while (peers_)
@@ -378,10 +662,16 @@ WgPeer::WgPeer(WgDevice *dev) {
   memset(features_, 0, sizeof(features_));
   memset(preshared_key_, 0, sizeof(preshared_key_));
   memset(&s_remote_, 0, sizeof(s_remote_));
+  time_of_next_key_event_ = 0;
+  timer_deadline_ = UINT64_MAX;
+  timer_heap_index_ = -1;
 
   // Insert into the parent's linked list
   *dev_->last_peer_ptr_ = this;
   dev_->last_peer_ptr_ = &next_peer_;
+
+  // Get the first timer check scheduled
+  dev_->SetPeerTimer(this, 0);
 }
 
 WgPeer::~WgPeer() {
@@ -424,6 +714,7 @@ void WgPeer::RemovePeer() {
 
   RemoveAllIps();
   dev_->peer_id_lookup_.erase(s_remote_);
+  dev_->SetPeerTimer(this, UINT64_MAX);
   
   WG_ACQUIRE_LOCK(mutex_);
   marked_for_delete_ = true;
@@ -434,8 +725,12 @@ void WgPeer::RemovePeer() {
 
   // The WgPeer instance may still be accessible from
   // worker threads that already started processing a packet,
-  // so defer the actual delete of it.
-  dev_->delayed_delete_.Add(&WgPeer::DelayedDelete, this);
+  // so defer the actual delete of it. With worker threads it may also
+  // still be in the published ip map.
+  if (dev_->delayed_delete_.enabled() && dev_->ip_to_peer_map_dirty_)
+    dev_->peers_to_delete_.push_back(this);
+  else
+    dev_->delayed_delete_.Add(&WgPeer::DelayedDelete, this);
 }
 
 void WgPeer::ClearKeys_Locked() {
@@ -450,8 +745,8 @@ void WgPeer::ClearHandshake_Locked() {
   uint32 v = local_key_id_during_hs_;
   if (v != 0) {
     local_key_id_during_hs_ = 0;
-    WG_SCOPED_RWLOCK_EXCLUSIVE(dev_->key_id_lookup_lock_);
-    dev_->key_id_lookup_.erase(v);
+    WG_SCOPED_LOCK(dev_->key_id_lookup_lock_);
+    dev_->key_id_lookup_.Erase(v);
   }
 }
 
@@ -532,9 +827,7 @@ void WgPeer::CreateMessageHandshakeInitiation(Packet *packet) {
   BlakeMix(hs_.hi, s_remote_.bytes, sizeof(s_remote_));
   // (Epriv_r, Epub_r) := DH-GENERATE()
   // msg.ephemeral = Epub_r
-  OsGetRandomBytes(hs_.e_priv, sizeof(hs_.e_priv));
-  curve25519_normalize(hs_.e_priv);
-  curve25519_donna(dst->ephemeral, hs_.e_priv, kCurve25519Basepoint);
+  dev_->ephemeral_key_pool_.Get(hs_.e_priv, dst->ephemeral);
   // Ci := KDF_1(Ci, msg.ephemeral)
   blake2s_hkdf(hs_.ci, sizeof(hs_.ci), NULL, 32, NULL, 32, dst->ephemeral, sizeof(dst->ephemeral), hs_.ci, WG_HASH_LEN);
   // Hi := HASH(Hi || msg.ephemeral)
@@ -646,9 +939,7 @@ WgPeer *WgPeer::ParseMessageHandshakeInitiation(WgDevice *dev, Packet *packet) {
   
   // (Epriv_r, Epub_r) := DH-GENERATE()
   // msg.ephemeral = Epub_r
-  OsGetRandomBytes(e_priv, sizeof(e_priv));
-  curve25519_normalize(e_priv);
-  curve25519_donna(dst->ephemeral, e_priv, kCurve25519Basepoint);
+  dev->ephemeral_key_pool_.Get(e_priv, dst->ephemeral);
   // Hr := HASH(Hr || msg.ephemeral)
   BlakeMix(hi, dst->ephemeral, sizeof(dst->ephemeral));
   // Ci := KDF_1(Ci, msg.ephemeral)
@@ -681,6 +972,7 @@ WgPeer *WgPeer::ParseMessageHandshakeInitiation(WgDevice *dev, Packet *packet) {
     peer->rx_bytes_ += orig_packet_size;
     peer->tx_bytes_ += packet->size;
     peer->InsertKeypairInPeer_Locked(keypair);
+    dev->PublishKeypairInKeyIdLookup(keypair);
     peer->OnHandshakeAuthComplete();
     WG_RELEASE_LOCK(peer->mutex_);
 
@@ -708,10 +1000,9 @@ WgPeer *WgPeer::ParseMessageHandshakeResponse(WgDevice *dev, const Packet *packe
   uint8 t[WG_HASH_LEN];
   uint8 k[WG_SYMMETRIC_KEY_LEN];
   WgKeypair *keypair;
-  auto peer_and_keypair = dev->LookupPeerInKeyIdLookup(src->receiver_key_id);
-  if (peer_and_keypair == NULL)
+  WgPeer *peer = dev->LookupPeerInKeyIdLookup(src->receiver_key_id);
+  if (peer == NULL)
     return NULL;
-  WgPeer *peer = peer_and_keypair->first;
   assert(src->receiver_key_id == peer->local_key_id_during_hs_);
 
   HandshakeState hs = peer->hs_;
@@ -740,10 +1031,11 @@ WgPeer *WgPeer::ParseMessageHandshakeResponse(WgDevice *dev, const Packet *packe
   if (!keypair)
     goto getout;
 
-  // Re-map the entry in the id table so it points at this keypair instead.
+  // The entry in the id table is taken over by this keypair.
   keypair->local_key_id = peer->local_key_id_during_hs_;
   peer->local_key_id_during_hs_ = 0;
-  peer_and_keypair->second = keypair;
+  // The ephemeral key is used up.
+  memzero_crypto(peer->hs_.e_priv, sizeof(peer->hs_.e_priv));
 
   WG_ACQUIRE_LOCK(peer->mutex_);
   if (peer->allow_endpoint_change_) {
@@ -752,6 +1044,7 @@ WgPeer *WgPeer::ParseMessageHandshakeResponse(WgDevice *dev, const Packet *packe
   }
   peer->rx_bytes_ += packet->size;
   peer->InsertKeypairInPeer_Locked(keypair);
+  dev->PublishKeypairInKeyIdLookup(keypair);
   WG_RELEASE_LOCK(peer->mutex_);
 
   if (0) {
@@ -769,10 +1062,9 @@ getout:
 void WgPeer::ParseMessageHandshakeCookie(WgDevice *dev, const MessageHandshakeCookie *src) {
   assert(dev->IsMainThread());
   uint8 cookie[WG_COOKIE_LEN];
-  auto peer_and_keypair = dev->LookupPeerInKeyIdLookup(src->receiver_key_id);
-  if (!peer_and_keypair)
+  WgPeer *peer = dev->LookupPeerInKeyIdLookup(src->receiver_key_id);
+  if (!peer)
     return;
-  WgPeer *peer = peer_and_keypair->first;
   if (!peer->expect_cookie_reply_)
     return;
   if (!xchacha20poly1305_decrypt(cookie, src->cookie_enc, sizeof(src->cookie_enc), 
@@ -913,11 +1205,15 @@ void WgPeer::DeleteKeypair(WgKeypair **kp) {
       dev->EraseKeypairAddrEntry_Locked(t);
     }
     if (t->local_key_id) {
-      WG_SCOPED_RWLOCK_EXCLUSIVE(dev->key_id_lookup_lock_);
-      dev->key_id_lookup_.erase(t->local_key_id);
+      WG_SCOPED_LOCK(dev->key_id_lookup_lock_);
+      dev->key_id_lookup_.Erase(t->local_key_id);
       t->local_key_id = 0;
     }
     t->recv_key_state = WgKeypair::KEY_INVALID;
+    for (size_t i = 0; i < dev->flushing_jobs_count_; i++) {
+      if (dev->flushing_jobs_[i].keypair == t)
+        dev->flushing_jobs_[i].keypair = NULL;
+    }
     dev->delayed_delete_.Add(&WgKeypairDelayedDelete, t);
   }
 }
@@ -977,6 +1273,7 @@ void WgPeer::InsertKeypairInPeer_Locked(WgKeypair *kp) {
   assert(kp->peer == NULL);
   kp->peer = this;
   time_of_next_key_event_ = 0;
+  ScheduleMainThreadEvent(kMainThreadScheduled_CheckTimeouts);
   DeleteKeypair(&prev_keypair_);
   if (kp->is_initiator) {
     // When we're the initator then we got the handshake and we can
@@ -1005,6 +1302,7 @@ bool WgPeer::CheckSwitchToNextKey_Locked(WgKeypair *keypair) {
   curr_keypair_ = next_keypair_;
   next_keypair_ = NULL;
   time_of_next_key_event_ = 0;
+  ScheduleMainThreadEvent(kMainThreadScheduled_CheckTimeouts);
   return true;
 }
 
@@ -1050,12 +1348,44 @@ enum {
   TIMER_PERSISTENT_KEEPALIVE = 4,
 };
 
-#define WgClearTimer(x) (timers_ &= ~(33 << x))
-#define WgIsTimerActive(x) (timers_ & (33 << x))
-#define WgSetTimer(x) (timers_ |= (32 << (x)))
+#define WgClearTimer(x) (timers_ &= ~(1 << x))
+#define WgIsTimerActive(x) (timers_ & (1 << x))
+#define WgSetTimer(x) SetTimer_Locked(x, now)
+
+static uint32 GetTimerTimeout(int timer, int persistent_keepalive_ms) {
+  static const uint32 kTimeouts[5] = {
+    REKEY_TIMEOUT_MS,
+    KEEPALIVE_TIMEOUT_MS,
+    KEEPALIVE_TIMEOUT_MS + REKEY_TIMEOUT_MS,
+    REJECT_AFTER_TIME_MS * 3,
+    0,
+  };
+  return (timer == TIMER_PERSISTENT_KEEPALIVE) ? (uint32)persistent_keepalive_ms : kTimeouts[timer];
+}
+
+// How long a timer that started at |start| has been running. A timer armed
+// on another thread may have started after |now32| was taken.
+static uint32 GetTimerElapsed(uint32 now32, uint32 start) {
+  return (int32)(now32 - start) > 0 ? now32 - start : 0;
+}
+
+// Timers get their start time from the cheap clock of the thread that arms
+// them. The main thread only needs to hear about a timer that expires before
+// the deadline it has for the peer, the others are seen at that deadline.
+void WgPeer::SetTimer_Locked(int timer, uint64 now) {
+  uint32 timeout = GetTimerTimeout(timer, persistent_keepalive_ms_);
+  // A persistent keepalive of 0 is off.
+  if (timer == TIMER_PERSISTENT_KEEPALIVE && timeout == 0)
+    return;
+  timer_value_[timer] = (uint32)now;
+  timers_ |= 1 << timer;
+  if (now + timeout < timer_deadline_.load(std::memory_order_relaxed))
+    ScheduleMainThreadEvent(kMainThreadScheduled_CheckTimeouts);
+}
 
 void WgPeer::OnDataSent() {
   assert(IsPeerLocked());
+  uint64 now = OsGetMillisecondsCoarse();
   WgClearTimer(TIMER_SEND_KEEPALIVE);
   if (!WgIsTimerActive(TIMER_NEW_HANDSHAKE))
     WgSetTimer(TIMER_NEW_HANDSHAKE);
@@ -1064,11 +1394,13 @@ void WgPeer::OnDataSent() {
 
 void WgPeer::OnKeepaliveSent() {
   assert(IsPeerLocked());
+  uint64 now = OsGetMillisecondsCoarse();
   WgSetTimer(TIMER_PERSISTENT_KEEPALIVE);
 }
 
 void WgPeer::OnDataReceived() {
   assert(IsPeerLocked());
+  uint64 now = OsGetMillisecondsCoarse();
   WgClearTimer(TIMER_NEW_HANDSHAKE);
   if (!WgIsTimerActive(TIMER_SEND_KEEPALIVE))
     WgSetTimer(TIMER_SEND_KEEPALIVE);
@@ -1079,12 +1411,14 @@ void WgPeer::OnDataReceived() {
 
 void WgPeer::OnKeepaliveReceived() {
   assert(IsPeerLocked());
+  uint64 now = OsGetMillisecondsCoarse();
   WgClearTimer(TIMER_NEW_HANDSHAKE);
   WgSetTimer(TIMER_PERSISTENT_KEEPALIVE);
 }
 
 void WgPeer::OnHandshakeInitSent() {
   assert(IsPeerLocked());
+  uint64 now = OsGetMillisecondsCoarse();
   WgClearTimer(TIMER_SEND_KEEPALIVE);
   WgSetTimer(TIMER_RETRANSMIT_HANDSHAKE);
   WgSetTimer(TIMER_PERSISTENT_KEEPALIVE);
@@ -1092,6 +1426,7 @@ void WgPeer::OnHandshakeInitSent() {
 
 void WgPeer::OnHandshakeAuthComplete() {
   assert(IsPeerLocked());
+  uint64 now = OsGetMillisecondsCoarse();
   WgClearTimer(TIMER_NEW_HANDSHAKE);
   WgSetTimer(TIMER_ZERO_KEYS);
   WgSetTimer(TIMER_PERSISTENT_KEEPALIVE);
@@ -1140,19 +1475,9 @@ uint32 WgPeer::CheckTimeouts_Locked(uint64 now) {
   if ((t = timers_) == 0)
     return 0;
   uint32 now32 = (uint32)now;
-  // Got any new timers?
-  if (t & (0x1f << 5)) {
-    if (t & (1 << (5+0))) timer_value_[0] = now32;
-    if (t & (1 << (5+1))) timer_value_[1] = now32;
-    if (t & (1 << (5+2))) timer_value_[2] = now32;
-    if (t & (1 << (5+3))) timer_value_[3] = now32;
-    if (t & (1 << (5+4))) timer_value_[4] = now32;
-    t |= (t >> 5);
-    t &= 0x1F;
-  }
   // Got any expired timers?
   if (t & 0x1F) {
-    if ((t & (1 << TIMER_RETRANSMIT_HANDSHAKE)) && (now32 - timer_value_[TIMER_RETRANSMIT_HANDSHAKE]) >= REKEY_TIMEOUT_MS) {
+    if ((t & (1 << TIMER_RETRANSMIT_HANDSHAKE)) && GetTimerElapsed(now32, timer_value_[TIMER_RETRANSMIT_HANDSHAKE]) >= REKEY_TIMEOUT_MS) {
       t ^= (1 << TIMER_RETRANSMIT_HANDSHAKE);
       if (handshake_attempts_ > MAX_HANDSHAKE_ATTEMPTS || endpoint_.sin.sin_family == 0) {
         t &= ~(1 << TIMER_SEND_KEEPALIVE);
@@ -1162,7 +1487,7 @@ uint32 WgPeer::CheckTimeouts_Locked(uint64 now) {
         rv |= ACTION_SEND_HANDSHAKE;
       }
     }
-    if ((t & (1 << TIMER_SEND_KEEPALIVE)) && (now32 - timer_value_[TIMER_SEND_KEEPALIVE]) >= KEEPALIVE_TIMEOUT_MS) {
+    if ((t & (1 << TIMER_SEND_KEEPALIVE)) && GetTimerElapsed(now32, timer_value_[TIMER_SEND_KEEPALIVE]) >= KEEPALIVE_TIMEOUT_MS) {
       t &= ~(1 << TIMER_SEND_KEEPALIVE);
       rv |= ACTION_SEND_KEEPALIVE;
       if (pending_keepalive_) {
@@ -1171,21 +1496,21 @@ uint32 WgPeer::CheckTimeouts_Locked(uint64 now) {
         t |= (1 << TIMER_SEND_KEEPALIVE);
       }
     }
-    if ((t & (1 << TIMER_PERSISTENT_KEEPALIVE)) && (now32 - timer_value_[TIMER_PERSISTENT_KEEPALIVE]) >= (uint32)persistent_keepalive_ms_) {
+    if ((t & (1 << TIMER_PERSISTENT_KEEPALIVE)) && GetTimerElapsed(now32, timer_value_[TIMER_PERSISTENT_KEEPALIVE]) >= (uint32)persistent_keepalive_ms_) {
       t &= ~(1 << TIMER_PERSISTENT_KEEPALIVE);
       if (persistent_keepalive_ms_) {
         t &= ~(1 << TIMER_SEND_KEEPALIVE);
         rv |= ACTION_SEND_KEEPALIVE;
       }
     }
-    if ((t & (1 << TIMER_NEW_HANDSHAKE)) && (now32 - timer_value_[TIMER_NEW_HANDSHAKE]) >= KEEPALIVE_TIMEOUT_MS + REKEY_TIMEOUT_MS) {
+    if ((t & (1 << TIMER_NEW_HANDSHAKE)) && GetTimerElapsed(now32, timer_value_[TIMER_NEW_HANDSHAKE]) >= KEEPALIVE_TIMEOUT_MS + REKEY_TIMEOUT_MS) {
       t &= ~(1 << TIMER_NEW_HANDSHAKE);
       if (endpoint_.sin.sin_family != 0) {
         handshake_attempts_ = 0;
         rv |= ACTION_SEND_HANDSHAKE;
       }
     }
-    if ((t & (1 << TIMER_ZERO_KEYS)) && (now32 - timer_value_[TIMER_ZERO_KEYS]) >= REJECT_AFTER_TIME_MS * 3) {
+    if ((t & (1 << TIMER_ZERO_KEYS)) && GetTimerElapsed(now32, timer_value_[TIMER_ZERO_KEYS]) >= REJECT_AFTER_TIME_MS * 3) {
       RINFO("Expiring all keys for peer");
       t &= ~(1 << TIMER_ZERO_KEYS);
       ClearKeys_Locked();
@@ -1196,6 +1521,20 @@ uint32 WgPeer::CheckTimeouts_Locked(uint64 now) {
   return rv;
 }
 
+uint64 WgPeer::GetNextTimerDeadline_Locked(uint64 now) {
+  assert(IsPeerLocked());
+  uint64 rv = time_of_next_key_event_;
+  uint32 t = timers_, now32 = (uint32)now;
+  for (int i = 0; i < 5; i++) {
+    if (t & (1 << i)) {
+      uint32 timeout = GetTimerTimeout(i, persistent_keepalive_ms_);
+      uint32 elapsed = GetTimerElapsed(now32, timer_value_[i]);
+      rv = std::min<uint64>(rv, now + (elapsed < timeout ? timeout - elapsed : 0));
+    }
+  }
+  return rv;
+}
+
 // Check all key stuff here to avoid calling possibly expensive timestamp routines in the packet handler
 void WgPeer::CheckAndUpdateTimeOfNextKeyEvent(uint64 now) {
   assert(dev_->IsMainThread() && IsPeerLocked());
@@ -1249,6 +1588,7 @@ bool WgPeer::SetPersistentKeepalive(int persistent_keepalive_secs) {
   if (persistent_keepalive_secs < 0 || persistent_keepalive_secs > 65535)
     return false;
   persistent_keepalive_ms_ = persistent_keepalive_secs * 1000;
+  ScheduleMainThreadEvent(kMainThreadScheduled_CheckTimeouts);
   return true;
 }
 
@@ -1263,15 +1603,11 @@ bool WgPeer::AddIp(const WgCidrAddr &cidr_addr) {
   if (cidr_addr.size == 32) {
     if (cidr_addr.cidr > 32)
       return false;
-    WG_ACQUIRE_RWLOCK_EXCLUSIVE(dev_->ip_to_peer_map_lock_);
     old_peer = (WgPeer*)dev_->ip_to_peer_map_.InsertV4(ReadBE32(cidr_addr.addr), cidr_addr.cidr, this);
-    WG_RELEASE_RWLOCK_EXCLUSIVE(dev_->ip_to_peer_map_lock_);
   } else if (cidr_addr.size == 128) {
     if (cidr_addr.cidr > 128)
       return false;
-    WG_ACQUIRE_RWLOCK_EXCLUSIVE(dev_->ip_to_peer_map_lock_);
     old_peer = (WgPeer*)dev_->ip_to_peer_map_.InsertV6(cidr_addr.addr, cidr_addr.cidr, this);
-    WG_RELEASE_RWLOCK_EXCLUSIVE(dev_->ip_to_peer_map_lock_);
   } else {
     return false;
   }
@@ -1284,12 +1620,12 @@ bool WgPeer::AddIp(const WgCidrAddr &cidr_addr) {
     }
   }
   allowed_ips_.push_back(cidr_addr);
+  dev_->ip_to_peer_map_dirty_ = true;
   return true;
 }
 
 void WgPeer::RemoveAllIps() {
   assert(dev_->IsMainThread());
-  WG_ACQUIRE_RWLOCK_EXCLUSIVE(dev_->ip_to_peer_map_lock_);
   for (auto it = allowed_ips_.begin(); it != allowed_ips_.end(); ++it) {
     if (it->size == 32) {
       dev_->ip_to_peer_map_.RemoveV4(ReadBE32(it->addr), it->cidr);
@@ -1297,8 +1633,8 @@ void WgPeer::RemoveAllIps() {
       dev_->ip_to_peer_map_.RemoveV6(it->addr, it->cidr);
     }
   }
-  WG_RELEASE_RWLOCK_EXCLUSIVE(dev_->ip_to_peer_map_lock_);
   allowed_ips_.clear();
+  dev_->ip_to_peer_map_dirty_ = true;
 }
 
 void WgPeer::SetAllowMulticast(bool allow) {
@@ -1326,8 +1662,12 @@ bool WgPeer::AddCipher(int cipher) {
 }
 
 void WgPeer::ScheduleNewHandshake() {
+  ScheduleMainThreadEvent(kMainThreadScheduled_ScheduleHandshake);
+}
+
+void WgPeer::ScheduleMainThreadEvent(uint32 ev) {
   // Note, it's possible that the peer has already been marked for delete
-  if (main_thread_scheduled_.fetch_or(WgPeer::kMainThreadScheduled_ScheduleHandshake) == 0) {
+  if (main_thread_scheduled_.fetch_or(ev) == 0) {
     main_thread_scheduled_next_ = NULL;
     WG_ACQUIRE_LOCK(dev_->main_thread_scheduled_lock_);
     *dev_->main_thread_scheduled_last_ = this;
@@ -1444,6 +1784,50 @@ bool WgKeypairDecryptPayload(uint8 *dst, size_t src_len,
   }
 }
 
+void WgKeypairEncryptPayloads(WgCryptoJob *jobs, size_t count) {
+  ChaCha20Poly1305Job cjobs[kWgCryptoBatchSize];
+  size_t n = 0;
+
+  assert(count <= kWgCryptoBatchSize);
+  for (size_t i = 0; i < count; i++) {
+    WgCryptoJob *job = &jobs[i];
+    if (job->keypair->cipher_suite == EXT_CIPHER_SUITE_CHACHA20POLY1305 && job->keypair->auth_tag_length == WG_MAC_LEN) {
+      ChaCha20Poly1305Job cjob = {job->data, job->data, job->size, job->ad, job->ad_len, job->nonce, job->keypair->send_key, NULL};
+      cjobs[n++] = cjob;
+    } else {
+      WgKeypairEncryptPayload(job->data, job->size, job->ad, job->ad_len, job->nonce, job->keypair);
+    }
+  }
+  if (n == 0)
+    return;
+  chacha20poly1305_encrypt_multi(cjobs, n);
+}
+
+void WgKeypairDecryptPayloads(WgCryptoJob *jobs, size_t count) {
+  ChaCha20Poly1305Job cjobs[kWgCryptoBatchSize];
+  __aligned(16) uint8 macs[kWgCryptoBatchSize][16];
+  WgCryptoJob *cjob_owner[kWgCryptoBatchSize];
+  size_t n = 0;
+
+  assert(count <= kWgCryptoBatchSize);
+  for (size_t i = 0; i < count; i++) {
+    WgCryptoJob *job = &jobs[i];
+    if (job->keypair->cipher_suite == EXT_CIPHER_SUITE_CHACHA20POLY1305 && job->keypair->auth_tag_length == WG_MAC_LEN &&
+        job->size >= WG_MAC_LEN) {
+      ChaCha20Poly1305Job cjob = {job->data, job->data, job->size - WG_MAC_LEN, job->ad, job->ad_len, job->nonce, job->keypair->recv_key, macs[n]};
+      cjob_owner[n] = job;
+      cjobs[n++] = cjob;
+    } else {
+      job->ok = WgKeypairDecryptPayload(job->data, job->size, job->ad, job->ad_len, job->nonce, job->keypair);
+    }
+  }
+  if (n == 0)
+    return;
+  chacha20poly1305_decrypt_get_mac_multi(cjobs, n);
+  for (size_t i = 0; i < n; i++)
+    cjob_owner[i]->ok = memcmp_crypto(macs[i], cjobs[i].dst + cjobs[i].src_len, WG_MAC_LEN) == 0;
+}
+
 // A random siphash key that can be used for hashing so it gets harder to induce hash collisions.
 struct RandomSiphashKey {
   RandomSiphashKey() { OsGetRandomBytes((uint8*)&key, sizeof(key)); }
@@ -201,6 +201,7 @@ enum {
 };
 
 struct WgKeypair;
+struct WgCryptoJob;
 class WgPeer;
 
 class WgRateLimit {
@@ -310,6 +311,85 @@ public:
 
 };
 
+// Maps key ids to either an active keypair, or to a peer during a handshake.
+// Lookups may happen on any thread and take no locks. Writers are serialized
+// by the caller, and removed entries are freed through |delayed_delete| once
+// no thread can see them anymore, so an entry returned by Lookup stays valid
+// until the next checkpoint of the calling thread.
+class WgKeyIdTable {
+public:
+  struct Entry {
+    uint32 key_id;
+    WgPeer *peer;
+    // NULL while the handshake is in progress. The data threads read it
+    // without a lock, so it's set once the keypair is ready to be used.
+    std::atomic<WgKeypair*> keypair;
+    std::atomic<Entry*> next;
+  };
+
+  explicit WgKeyIdTable(MultithreadedDelayedDelete *delayed_delete);
+  ~WgKeyIdTable();
+
+  Entry *Lookup(uint32 key_id);
+  // Returns false if |key_id| is already used.
+  bool Insert(uint32 key_id, WgPeer *peer);
+  void Erase(uint32 key_id);
+
+private:
+  struct Table {
+    uint32 mask;
+    std::atomic<Entry*> buckets[1];
+  };
+  static Table *NewTable(uint32 size);
+  static void DeleteTable(void *table);
+  static void DeleteEntry(void *entry);
+
+  std::atomic<Table*> table_;
+  uint32 count_;
+  MultithreadedDelayedDelete *delayed_delete_;
+};
+
+// A bounded pool of ephemeral key pairs that a low priority thread generates
+// ahead of time, so the handshakes on the main thread only have to copy one
+// out. The pairs live in |entries_|, and their indexes go to the main thread
+// through |ready_| and back to the thread through |free_| once the entry has
+// been zeroed, so each pair is handed out once and no secret is left behind
+// in the rings. Without threads, or when the pool runs dry, the pair is
+// generated inline.
+class WgEphemeralKeyPool
+#if WITH_WG_THREADING
+  : private Thread::Runner
+#endif  // WITH_WG_THREADING
+{
+public:
+  WgEphemeralKeyPool();
+  ~WgEphemeralKeyPool();
+
+  // Start filling the pool, does nothing if it's already running.
+  void Start();
+  void Stop();
+
+  // Get a fresh key pair. Only one thread may call this.
+  void Get(uint8 priv[WG_PUBLIC_KEY_LEN], uint8 pub[WG_PUBLIC_KEY_LEN]);
+
+private:
+#if WITH_WG_THREADING
+  virtual void ThreadMain() override;
+
+  enum { kSize = 16 };
+  struct Entry {
+    uint8 priv[WG_PUBLIC_KEY_LEN];
+    uint8 pub[WG_PUBLIC_KEY_LEN];
+  };
+  Entry entries_[kSize];
+  MpscRing<uint32> ready_, free_;
+  Mutex mutex_;
+  ConditionVariable wake_;
+  std::atomic<bool> shutting_down_;
+  Thread thread_;
+#endif  // WITH_WG_THREADING
+};
+
 class WgDevice {
   friend class WgPeer;
   friend class WireguardProcessor;
@@ -355,11 +435,26 @@ public:
   void CreateCookieMessage(MessageHandshakeCookie *dst, Packet *packet, uint32 remote_key_id);
   void SecondLoop(uint64 now);
 
-  IpToPeerMap &ip_to_peer_map() { return ip_to_peer_map_; }
+  // The peers are kept in a min-heap ordered on when their timers expire
+  // next, so only the expired ones need to be looked at. A |deadline| of
+  // UINT64_MAX removes the peer.
+  void SetPeerTimer(WgPeer *peer, uint64 deadline);
+  // Remove and return a peer whose deadline is at or before |now|, or NULL.
+  WgPeer *PopExpiredPeerTimer(uint64 now);
+  uint64 next_peer_timer() { return timer_heap_.empty() ? UINT64_MAX : timer_heap_[0].deadline; }
+
+  // The version of the map that's visible to all threads, see |ip_to_peer_map_rcu_|.
+  IpToPeerMap &ip_to_peer_map() { return *ip_to_peer_map_rcu_.load(std::memory_order_acquire); }
+  // Make the changes to the allowed ips visible to the other threads.
+  void PublishIpToPeerMap();
   WgPeer *first_peer() { return peers_; }
   const uint8 *public_key() const { return s_pub_; }
   WgRateLimit *rate_limiter() { return &rate_limiter_; }
   bool is_private_key_initialized() { return is_private_key_initialized_; }
+  MultithreadedDelayedDelete *delayed_delete() { return &delayed_delete_; }
+  WgEphemeralKeyPool *ephemeral_key_pool() { return &ephemeral_key_pool_; }
+  // Whether something was scheduled to run on the main thread, may be stale.
+  bool has_main_thread_scheduled() { return main_thread_scheduled_ != NULL; }
 
   bool IsMainThread() { return CurrentThreadIdEquals(main_thread_id_); }
   bool IsMainOrDataThread() { return CurrentThreadIdEquals(main_thread_id_) || WG_IF_LOCKS_ENABLED_ELSE(delayed_delete_.enabled(), false);  }
@@ -367,7 +462,7 @@ public:
   void SetDelegate(Delegate *del) { delegate_ = del; }
   
 private:
-  std::pair<WgPeer*, WgKeypair*> *LookupPeerInKeyIdLookup(uint32 key_id);
+  WgPeer *LookupPeerInKeyIdLookup(uint32 key_id);
   WgKeypair *LookupKeypairByKeyId(uint32 key_id);
 
   void UpdateKeypairAddrEntry_Locked(const IpAddr &addr, WgKeypair *keypair);
@@ -378,16 +473,27 @@ private:
   void MakeCookie(uint8 cookie[WG_COOKIE_LEN], Packet *packet);
   // Insert a new entry in |key_id_lookup_|
   uint32 InsertInKeyIdLookup(WgPeer *peer, WgKeypair *kp);
+  // Make |kp| findable by its key id, once kp->peer is set.
+  void PublishKeypairInKeyIdLookup(WgKeypair *kp);
   // Get a random number
   uint32 GetRandomNumber();
 
   void EraseKeypairAddrEntry_Locked(WgKeypair *kp);
+  void MoveInTimerHeap(size_t i);
+
+  static void DeleteIpToPeerMap(void *map);
 
-  // Maps IP addresses to peers
+  // Maps IP addresses to peers, only the main thread uses this one.
   IpToPeerMap ip_to_peer_map_;
 
-  // This lock protects |ip_to_peer_map_|.
-  WG_DECLARE_RWLOCK(ip_to_peer_map_lock_);
+  // What the lookups go through. It's |ip_to_peer_map_| itself as long as
+  // no other threads process packets. Otherwise it's a copy that's replaced
+  // as a whole by PublishIpToPeerMap, and the old copy is freed through
+  // |delayed_delete_|, so readers need no locks.
+  std::atomic<IpToPeerMap*> ip_to_peer_map_rcu_;
+  bool ip_to_peer_map_dirty_;
+  // Removed peers that may still be in the published map.
+  std::vector<WgPeer*> peers_to_delete_;
    
   // For enumerating all peers
   WgPeer *peers_, **last_peer_ptr_;
@@ -396,17 +502,11 @@ private:
   Delegate *delegate_;
 
 
-  // Keypair IDs are generated randomly by us so no point in wasting cycles on
-  // hashing the random value.
-  struct KeyIdHasher {
-    size_t operator()(uint32 v) const { return v;  }
-  };
-  
-  // Lock that protects key_id_lookup_
-  WG_DECLARE_RWLOCK(key_id_lookup_lock_);
+  // Serializes the writers of key_id_lookup_, readers take no lock.
+  WG_DECLARE_LOCK(key_id_lookup_lock_);
   // Mapping from key-id to either an active keypair (if keypair is non-NULL),
   // or to a handshake.
-  WG_HASHTABLE_IMPL<uint32, std::pair<WgPeer*, WgKeypair*>, KeyIdHasher> key_id_lookup_;
+  WgKeyIdTable key_id_lookup_;
 
   // Mapping from IPV4 IP/PORT to WgPeer*, so we can find the peer when a key id is
   // not explicitly included. Use void* here so we can reuse the same template instance.
@@ -428,6 +528,15 @@ private:
   // Whether a private key has been setup for the device
   bool is_private_key_initialized_;
 
+  // Incremented by each SecondLoop
+  uint32 second_loop_epoch_;
+
+  struct TimerHeapEntry {
+    uint64 deadline;
+    WgPeer *peer;
+  };
+  std::vector<TimerHeapEntry> timer_heap_;
+
   ThreadId main_thread_id_;
 
   uint64 low_resolution_timestamp_;
@@ -450,6 +559,14 @@ private:
 
   // For defering deletes until all worker threads are guaranteed not to use an object.
   MultithreadedDelayedDelete delayed_delete_;
+
+  // Without delayed deletes a keypair is freed right away, so the decrypt
+  // batch that's being flushed is kept here and its jobs are cleared when
+  // their keypair goes away. Main thread only.
+  WgCryptoJob *flushing_jobs_;
+  size_t flushing_jobs_count_;
+
+  WgEphemeralKeyPool ephemeral_key_pool_;
 };
 
 // State for peer
@@ -495,6 +612,10 @@ public:
     ACTION_SEND_HANDSHAKE = 2,
   };
   uint32 CheckTimeouts_Locked(uint64 now);
+  // Returns when CheckTimeouts_Locked needs to run next, in milliseconds.
+  uint64 GetNextTimerDeadline_Locked(uint64 now);
+  // Returns when the timers last given to WgDevice::SetPeerTimer expire.
+  uint64 timer_deadline() { return timer_deadline_.load(std::memory_order_relaxed); }
 
   void AddPacketToPeerQueue_Locked(Packet *packet);
   bool IsPeerLocked() { return WG_IF_LOCKS_ENABLED_ELSE(mutex_.IsLocked(), true); }
@@ -516,6 +637,8 @@ private:
   void ClearHandshake_Locked();
   void ClearPacketQueue_Locked();
   void ScheduleNewHandshake();
+  void ScheduleMainThreadEvent(uint32 ev);
+  void SetTimer_Locked(int timer, uint64 now);
   
   WgDevice *dev_;
   WgPeer *next_peer_;
@@ -534,11 +657,19 @@ private:
   uint32 timers_;
   uint32 timer_value_[5];
 
+  // When the timers expire and our position in the timer heap of WgDevice,
+  // only changed by the main thread. Threads that arm a timer read the
+  // deadline to see if the main thread has to hear about it.
+  std::atomic<uint64> timer_deadline_;
+  int timer_heap_index_;
+
   // Holds the entry into the key id table during handshake - mt only.
   uint32 local_key_id_during_hs_;
 
   enum {
     kMainThreadScheduled_ScheduleHandshake = 1,
+    // A timer was armed that expires before the deadline, or the keys changed
+    kMainThreadScheduled_CheckTimeouts = 2,
   };
   std::atomic<uint32> main_thread_scheduled_;
   WgPeer *main_thread_scheduled_next_;
@@ -680,9 +811,9 @@ struct WgKeypair {
   // True if i'm the initiator of the key exchange
   bool is_initiator;
 
-  // True if we saved the peer's address in our table recently,
-  // avoids doing it too much
-  bool did_attempt_remember_ip_port;
+  // The WgDevice second loop epoch when we last saved the peer's
+  // address in our table, avoids doing it too much
+  uint32 remember_ip_port_epoch;
 
   // Which features are enabled
   bool enabled_features[WG_FEATURES_COUNT];
@@ -744,3 +875,25 @@ bool WgKeypairDecryptPayload(uint8 *dst, const size_t src_len,
     const uint8 *ad, const size_t ad_len,
     const uint64 nonce, WgKeypair *keypair);
 
+// One packet of a WgKeypairEncryptPayloads / WgKeypairDecryptPayloads call.
+// |size| includes the auth tag when decrypting.
+struct WgCryptoJob {
+  uint8 *data;
+  size_t size;
+  const uint8 *ad;
+  size_t ad_len;
+  uint64 nonce;
+  WgKeypair *keypair;
+  // Set by WgKeypairDecryptPayloads if the mac matched.
+  bool ok;
+};
+
+enum {
+  kWgCryptoBatchSize = 8,
+};
+
+// Same as WgKeypairEncryptPayload / WgKeypairDecryptPayload on each job, the
+// chacha20poly1305 ones are done together with the multi-buffer code.
+void WgKeypairEncryptPayloads(WgCryptoJob *jobs, size_t count);
+void WgKeypairDecryptPayloads(WgCryptoJob *jobs, size_t count);
+